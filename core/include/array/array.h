@@ -42,6 +42,8 @@
 #include "expression.h"
 #include "fragment.h"
 #include "storage_manager_config.h"
+#include "mmap_registry.h"
+#include "tile_cache.h"
 #include "tiledb_constants.h"
 #include "expression.h"
 #include <pthread.h>
@@ -143,15 +145,57 @@ class Array {
   /** Returns the configuration parameters. */
   const StorageManagerConfig* config() const;
 
+  /**
+   * Returns the filter whose zone maps the read states check to skip tiles,
+   * NULL if there is none. A clone returns the filter of the array it serves,
+   * which it does not evaluate itself.
+   */
+  const Expression* zone_map_filter() const;
+
   /** Returns the number of fragments in this array. */
   int fragment_num() const;
 
   /** Returns the fragment objects of this array. */
   std::vector<Fragment*> fragments() const;
 
+  /**
+   * Returns the fragments the current read works on, i.e., those whose cells
+   * may overlap the subarray, in the order of fragments().
+   */
+  std::vector<Fragment*> overlapping_fragments() const;
+
+  /**
+   * Returns *true* if the box overlaps the box bounding the cells of an
+   * overlapping fragment older than the input one, i.e., if cells of the
+   * input fragment in the box may hide cells of older fragments with the
+   * same coordinates.
+   *
+   * @param fragment One of the overlapping fragments.
+   * @param box A box in the coordinates type, e.g. the MBR of a tile.
+   */
+  bool overlaps_older_fragment(const Fragment* fragment, const void* box) const;
+
   /** Returns the array mode. */
   int mode() const;
 
+  /** Returns *true* while the array is being read for consolidation. */
+  bool consolidating() const;
+
+  /**
+   * Returns *true* if finalize recorded a written fragment in the fragment
+   * manifest of the array, i.e. the array has a manifest.
+   */
+  bool fragment_manifest_recorded() const;
+
+  /** Returns the shared decompressed tile cache, NULL if disabled. */
+  TileCache* tile_cache() const;
+
+  /**
+   * Returns the registry of attribute files mapped with TILEDB_IO_MMAP,
+   * NULL if tiles are mapped individually.
+   */
+  MMapRegistry* mmap_registry() const;
+
   /**
    * Checks if *at least one* attribute buffer has overflown during a read 
    * operation.
@@ -169,6 +213,36 @@ class Array {
    */
   bool overflow(int attribute_id) const;
 
+  /**
+   * Retrieves the number of compressed tile reads needed by the read
+   * operations since the array was initialized or its subarray was last reset,
+   * along with the number of I/Os they were coalesced into.
+   *
+   * @param tile_reads The number of tile reads.
+   * @param tile_io_reads The number of I/Os issued for the tile reads.
+   * @return void
+   */
+  void tile_read_counts(size_t& tile_reads, size_t& tile_io_reads) const;
+
+  /**
+   * Returns the number of file size lookups issued to the filesystem by the
+   * read operations since the array was initialized or its subarray was last
+   * reset. It is bounded by the number of attribute files read, independent
+   * of the number of tiles.
+   */
+  size_t file_size_lookups() const;
+
+  /**
+   * Retrieves the number of access pattern hints issued for the attribute
+   * files by the read operations since the array was initialized.
+   *
+   * @param sequential The number of sequential access hints.
+   * @param random The number of random access hints.
+   * @param willneed The number of hints to prefetch the tiles to be read.
+   * @return void
+   */
+  void access_hints(size_t& sequential, size_t& random, size_t& willneed) const;
+
   /**
    * Performs a read operation in an array, which must be initialized in read 
    * mode. The function retrieves the result cells that lie inside
@@ -305,6 +379,10 @@ class Array {
    * @param config Configuration parameters.
    * @param array_clone An clone of this array object. Used specifically in 
    *     asynchronous IO (AIO) read/write operations.
+   * @param tile_cache The cache of decompressed tiles shared across arrays, 
+   *     NULL if tiles are not to be cached.
+   * @param mmap_registry The attribute files mapped with TILEDB_IO_MMAP shared
+   *     across arrays, NULL to map each tile individually.
    * @return TILEDB_AR_OK on success, and TILEDB_AR_ERR on error.
    */
   int init(
@@ -317,7 +395,9 @@ class Array {
       int attribute_num,
       const void* subarray,
       const StorageManagerConfig* config,
-      Array* array_clone = NULL);
+      Array* array_clone = NULL,
+      TileCache* tile_cache = NULL,
+      MMapRegistry* mmap_registry = NULL);
 
   /**
    * Applies a filter expression to constrain the results returned by
@@ -487,6 +567,14 @@ class Array {
   volatile bool aio_thread_created_;
   /** An array clone, used in AIO requests. */
   Array* array_clone_;
+  /** True once the array is read for consolidation. */
+  bool consolidating_;
+  /** True once finalize recorded a fragment in the fragment manifest. */
+  bool fragment_manifest_recorded_;
+  /** The shared decompressed tile cache, NULL if disabled. */
+  TileCache* tile_cache_;
+  /** The shared whole file mappings, NULL if tiles are mapped individually. */
+  MMapRegistry* mmap_registry_;
   /** The array schema. */
   const ArraySchema* array_schema_;
   /** The read state of the array. */
@@ -505,6 +593,8 @@ class Array {
   const StorageManagerConfig* config_;
   /** The array fragments. */
   std::vector<Fragment*> fragments_;
+  /** The fragments overlapping the subarray, see overlapping_fragments. */
+  std::vector<Fragment*> overlapping_fragments_;
   /** 
    * The array mode. It must be one of the following:
    *    - TILEDB_ARRAY_WRITE 
@@ -527,6 +617,9 @@ class Array {
    */
   Expression* expression_;
 
+  /** The filter whose zone maps are checked to skip tiles. */
+  const Expression* zone_map_filter_;
+
   std::string array_path_used_;
 
 
@@ -598,6 +691,41 @@ class Array {
   int open_fragments(
       const std::vector<std::string>& fragment_names,
       const std::vector<BookKeeping*>& book_keeping);
+
+  /** Returns *true* if the two boxes in the coordinates type overlap. */
+  bool boxes_overlap(const void* box_A, const void* box_B) const;
+
+  /** 
+   * Sets the sizes of all the read buffers to zero, which is the result of a
+   * read that no fragment overlaps.
+   *
+   * @param buffer_sizes The sizes of the read buffers.
+   * @return void
+   */
+  void clear_buffer_sizes(size_t* buffer_sizes) const;
+
+  /** 
+   * Returns *true* if the box bounding the cells of the fragment (see
+   * BookKeeping::bounding_domain) overlaps the subarray.
+   */
+  bool overlaps_subarray(const Fragment* fragment) const;
+
+  /**
+   * Sets the fragments overlapping the subarray and (re)initializes their
+   * read states, so that a read does not construct or walk the read states of
+   * fragments it cannot get any cells from. A subarray of a single cell also
+   * skips the fragments whose coordinates filter rules the cell out.
+   */
+  void prune_fragments();
+
+  /**
+   * Gets the hash of the point of a subarray of a single cell, to look it up
+   * in the coordinates filters of the fragments.
+   *
+   * @param hash Set to the hash of the point, see BloomFilter::hash_coords.
+   * @return *true* if the subarray is a single cell.
+   */
+  bool subarray_point_hash(uint64_t& hash) const;
 };
 
 #endif
@@ -108,6 +108,9 @@ typedef struct TileDB_Config {
    *      TileDB will use standard OS read.
    *    - TILEDB_IO_MPI
    *      TileDB will use MPI-IO read. 
+   *    - TILEDB_IO_URING
+   *      TileDB will use io_uring to batch the tile reads of all attributes,
+   *      falls back to standard OS read if io_uring is not supported.
    */
   int read_method_;
   /** 
@@ -125,6 +128,40 @@ typedef struct TileDB_Config {
    * These can be overridden with env TILEDB_DISABLE_FILE_LOCKING and TILEDB_KEEP_FILE_HANDLES_OPEN.
    */
   bool enable_shared_posixfs_optimizations_;
+  /**
+   * The size in bytes of the LRU cache of decompressed tiles shared by all
+   * the arrays opened with the context. Compressed tiles found in the cache
+   * are neither read nor decompressed again. 0 (default) disables the cache.
+   */
+  size_t tile_cache_size_;
+  /**
+   * The false-positive rate of the Bloom filters over the coordinates of new
+   * sparse fragments, which let point lookups skip fragments without the 
+   * point. The filters are only built for fragments in the sectioned 
+   * book-keeping layout, see enable_book_keeping_sections_, and this has no
+   * effect otherwise. 0 (default) uses a rate of 0.01, rates that are 
+   * negative or at least 1 disable the filters. Overridden with env 
+   * TILEDB_BLOOM_FILTER_FPR.
+   */
+  double coords_filter_false_positive_rate_;
+  /**
+   * The maximum size in bytes of the Bloom filter over the coordinates of a
+   * new sparse fragment, which also bounds the memory the filter takes while
+   * the fragment is written. 0 (default) uses 64MB. Like the rate, only
+   * applies with enable_book_keeping_sections_. Overridden with env
+   * TILEDB_BLOOM_FILTER_MAX_SIZE.
+   */
+  size_t coords_filter_max_size_;
+  /**
+   * Writes new fragments with the sectioned book-keeping layout, which is
+   * decoded per attribute on first use and also records the zone maps and
+   * coordinates filters that let filtered reads and point lookups skip tiles
+   * and fragments. Versions of TileDB without the layout cannot open these
+   * fragments, so it is disabled by default and new fragments get the legacy
+   * layout. Fragments of either layout are read regardless. Can also be
+   * enabled with env TILEDB_BOOK_KEEPING_SECTIONS.
+   */
+  bool enable_book_keeping_sections_;
 } TileDB_Config; 
 
 
@@ -157,6 +194,22 @@ TILEDB_EXPORT int tiledb_ctx_init(
  */
 TILEDB_EXPORT int tiledb_ctx_finalize(TileDB_CTX* tiledb_ctx);
 
+/** 
+ * Retrieves the statistics of the decompressed tile cache of the context, see
+ * TileDB_Config::tile_cache_size_. All are 0 if the cache is disabled.
+ *
+ * @param tiledb_ctx The TileDB context.
+ * @param hits The number of tiles found in the cache.
+ * @param misses The number of tiles not found in the cache.
+ * @param size The number of bytes currently cached.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_ctx_tile_cache_stats(
+    const TileDB_CTX* tiledb_ctx,
+    size_t* hits,
+    size_t* misses,
+    size_t* size);
+
 
 
 
@@ -415,7 +468,10 @@ TILEDB_EXPORT int tiledb_array_init(
  * @param tiledb_array The TileDB array.
  * @param filter_expression An expression string that evaluates to a boolean
  *     to allow for cells to be filtered out from the buffers while reading.
- *     If NULL or empty, no filter is applied.
+ *     If NULL or empty, no filter is applied. Tiles of sparse fragments
+ *     whose zone maps show no cell can pass a conjunction of comparisons of
+ *     attributes with constants are not read. Only fragments written with
+ *     enable_book_keeping_sections_ of TileDB_Config have zone maps.
  * @return TILEDB_OK on success, and TILEDB_ERR on error.
  */
 TILEDB_EXPORT int tiledb_array_apply_filter(
@@ -618,6 +674,72 @@ TILEDB_EXPORT int tiledb_array_overflow(
     const TileDB_Array* tiledb_array,
     int attribute_id);
 
+/**
+ * Retrieves the number of compressed tile reads needed by the read operations
+ * since the array was initialized or its subarray was last reset, and the
+ * number of I/Os they were coalesced into. Adjacent tile reads are coalesced
+ * up to the gap and size set with the env vars TILEDB_COALESCE_MAX_GAP and
+ * TILEDB_COALESCE_MAX_SIZE. Only reads with TILEDB_IO_READ and 
+ * TILEDB_IO_URING are counted.
+ *
+ * @param tiledb_array The TileDB array.
+ * @param tile_reads The number of tile reads.
+ * @param tile_io_reads The number of I/Os issued for the tile reads.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_array_tile_read_counts(
+    const TileDB_Array* tiledb_array,
+    size_t* tile_reads,
+    size_t* tile_io_reads);
+
+/**
+ * Retrieves the number of file size lookups issued to the filesystem by the
+ * read operations since the array was initialized or its subarray was last
+ * reset. Sizes are looked up at most once per attribute file of a fragment,
+ * so this is bounded by the number of files rather than tiles.
+ *
+ * @param tiledb_array The TileDB array.
+ * @param file_size_lookups The number of file size lookups.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_array_file_size_lookups(
+    const TileDB_Array* tiledb_array,
+    size_t* file_size_lookups);
+
+/**
+ * Retrieves the number of access pattern hints issued to the filesystem for
+ * the attribute files by the read operations since the array was initialized.
+ * Each fragment hints its files as sequential when the query overlaps many
+ * of its tiles or during consolidation, and as random otherwise. Sparse 
+ * sequential reads also hint the span of the tiles to be read to be
+ * prefetched.
+ *
+ * @param tiledb_array The TileDB array.
+ * @param sequential The number of sequential access hints.
+ * @param random The number of random access hints.
+ * @param willneed The number of prefetch hints.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_array_access_hints(
+    const TileDB_Array* tiledb_array,
+    size_t* sequential,
+    size_t* random,
+    size_t* willneed);
+
+/**
+ * Retrieves the number of fragments the reads work on, i.e., those whose
+ * cells may overlap the subarray the array was initialized with or last
+ * reset to. The other fragments are skipped without building their read
+ * states.
+ *
+ * @param tiledb_array The TileDB array.
+ * @param fragment_num The number of overlapping fragments.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_array_overlapping_fragment_num(
+    const TileDB_Array* tiledb_array,
+    int* fragment_num);
+
 /**
  * Consolidates the fragments of an array into a single fragment. 
  * 
@@ -60,7 +60,7 @@
 /* ********************************* */
 
 /** Stores potential error messages. */
-extern std::string tiledb_cd_errmsg;
+extern thread_local std::string tiledb_cd_errmsg;
 
 /** Stores the state necessary when writing cells to a fragment. */
 class Codec {
@@ -72,6 +72,13 @@ class Codec {
   
   static Codec* create(const ArraySchema* array_schema, const int attribute_id, const bool is_offsets_compression=false);
 
+  /**
+   * Creates a codec for a compression type without any filters, e.g. for
+   * metadata that does not belong to an attribute. Returns NULL for
+   * TILEDB_NO_COMPRESSION and unsupported types.
+   */
+  static Codec* create(const int compression_type, const int compression_level);
+
   static int get_default_level(const int compression_type);
 
   static int print_errmsg(const std::string& msg);
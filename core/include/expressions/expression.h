@@ -36,6 +36,7 @@
 
 #include "mpParser.h"
 #include "array_schema.h"
+#include "book_keeping.h"
 #include <typeinfo>
 
 /* ********************************* */
@@ -59,6 +60,9 @@ extern std::string tiledb_expr_errmsg;
 /** Default error message. */
 #define TILEDB_EXPR_ERRMSG std::string("[TileDB::Expression] Error: ")
 
+/** The number of cells a compiled expression evaluates at a time. */
+#define TILEDB_EXPR_BATCH_SIZE 1024
+
 //Forward declaration
 class ArrayReadState;
 
@@ -86,18 +90,147 @@ class Expression {
   bool evaluate_cell(void **buffers, size_t* buffer_sizes, std::vector<int64_t>& position);
 
   /**
-   * The evaluate method is called after array read is done.
-   * FIXME: This is extremely inefficient and only works
-   * for the POC on filters. The idea is to change this
-   * quickly with on-disk secondary indexing of attributes
-   * which have been annotated to be indexed
+   * The evaluate method is called after array read is done. It drops the
+   * cells that do not pass the filter from the buffers. Compiled expressions
+   * are evaluated over batches of cells, others cell by cell with muparserx.
    */
   int evaluate(void** buffers, size_t* buffer_sizes);
 
+  /**
+   * Returns true if the expression was compiled to kernels over the attribute
+   * buffers, i.e. it only combines comparisons of arithmetic over int32 and
+   * float32 attributes and constants with && and ||. Other expressions, and
+   * all expressions if the environment variable
+   * TILEDB_DISABLE_EXPRESSION_KERNELS is set, are evaluated with muparserx.
+   */
+  bool compiled() const;
+
+  /**
+   * Returns true if no cell of the tile at the input position can pass the
+   * filter, judging by the zone maps of the fragment book-keeping. This is
+   * conservative, only comparisons of attributes with constants joined by
+   * && at the top level of an expression that compiles to kernels are
+   * considered, also when TILEDB_DISABLE_EXPRESSION_KERNELS has it evaluated
+   * with muparserx. The zone maps of zone_map_attribute_ids() must have been
+   * loaded.
+   */
+  bool excludes_tile(const BookKeeping* book_keeping, int64_t tile_pos) const;
+
+  /** Returns the ids of the attributes excludes_tile consults. */
+  const std::vector<int>& zone_map_attribute_ids() const;
+
   std::map<std::string, mup::Value> attribute_map_;
 
  private:
-  void fixup_return_buffers(void** buffers, size_t* buffer_sizes, int number_of_cells, std::vector<int> cells_to_be_dropped);
+  /** The operations of the kernels of a compiled expression. */
+  enum KernelOp {
+    KERNEL_COLUMN, KERNEL_CONSTANT,
+    KERNEL_ADD, KERNEL_SUB, KERNEL_MUL, KERNEL_DIV,
+    KERNEL_LT, KERNEL_LE, KERNEL_GT, KERNEL_GE, KERNEL_EQ, KERNEL_NE,
+    KERNEL_AND, KERNEL_OR
+  };
+
+  /**
+   * A node of a compiled expression, evaluated over a batch of cells.
+   * Arithmetic kernels evaluate to doubles like muparserx does, comparisons
+   * and boolean combinators to a selection of one 0/1 byte per cell.
+   */
+  struct Kernel {
+    KernelOp op_;
+    /** The column of KERNEL_COLUMN, an index into columns_. */
+    int column_;
+    /** The value of KERNEL_CONSTANT. */
+    double value_;
+    /** The operands, indexes into kernels_. */
+    int left_;
+    int right_;
+  };
+
+  /** An attribute read by a compiled expression. */
+  struct KernelColumn {
+    int attribute_id_;
+    int type_;
+    /** The index of the attribute in attributes_. */
+    int attribute_index_;
+    /** The index of the attribute buffer in the buffers passed to evaluate. */
+    int buffer_index_;
+  };
+
+  /**
+   * Compiles the expression into kernels_ and columns_, leaving them empty if
+   * the expression has anything other than the supported operators, and
+   * extracts the attribute ranges from the kernels.
+   */
+  void compile();
+
+  /**
+   * Compiles the tokens from pos with operators binding at least as tightly
+   * as the input precedence level.
+   *
+   * @return The index of the kernel in kernels_, or -1 if unsupported.
+   */
+  int compile_kernel(const std::vector<std::string>& tokens, size_t& pos, int level);
+
+  /** Returns the index in columns_ of the named attribute, or -1 if unsupported. */
+  int compile_column(const std::string& name);
+
+  /** Returns true if the kernel evaluates to a selection. */
+  bool is_selection(int kernel) const;
+
+  /**
+   * Evaluates the compiled expression over a batch of cells, setting the
+   * selection of the cells that pass. Like with muparserx, cells with an empty
+   * value in any column pass.
+   *
+   * @param columns The values of the first cell of the batch, per column.
+   * @param cell_num The number of cells, at most TILEDB_EXPR_BATCH_SIZE.
+   * @param selection The selection, 1 for the cells that pass.
+   */
+  void evaluate_batch(const void** columns, int64_t cell_num, uint8_t* selection);
+
+  /** Evaluates an arithmetic kernel over a batch of cells. */
+  void evaluate_values(int kernel, const void** columns, int64_t cell_num, double* values);
+
+  /** Evaluates a comparison or boolean kernel over a batch of cells. */
+  void evaluate_selection(int kernel, const void** columns, int64_t cell_num, uint8_t* selection);
+
+  /**
+   * Sets the selection of a batch of cells to the comparison by op of their
+   * values with a constant.
+   */
+  template<class T>
+  static void compare_constant(KernelOp op, const T* values, double constant, int64_t cell_num, uint8_t* selection);
+
+  /**
+   * Sets the selection of a batch of cells to the comparison by op of their
+   * left and right values.
+   */
+  static void compare_values(KernelOp op, const double* left, const double* right, int64_t cell_num, uint8_t* selection);
+
+  /** The range of values of an attribute a cell must have to pass. */
+  struct AttributeRange {
+    int attribute_id_;
+    double low_;
+    bool low_open_;
+    double high_;
+    bool high_open_;
+  };
+
+  /**
+   * Sets attribute_ranges_ to the comparisons of columns with constants the
+   * kernels are a conjunction of, and zone_map_attribute_ids_ to
+   * the columns whose empty values let a cell pass regardless.
+   */
+  void extract_attribute_ranges();
+
+  /** Adds the ranges of the conjunction rooted at the input kernel. */
+  void extract_attribute_ranges(int kernel);
+
+  /**
+   * Moves the selected cells of the buffers to their front, and shrinks the
+   * buffer sizes by the cells dropped.
+   */
+  void fixup_return_buffers(void** buffers, size_t* buffer_sizes, int64_t number_of_cells, const std::vector<uint8_t>& selection);
   
   std::string expression_;
   std::vector<std::string> attributes_;
@@ -108,6 +241,18 @@ class Expression {
   const ArraySchema* array_schema_;
 
   std::vector<int64_t> last_processed_buffer_index_;
+
+  std::vector<AttributeRange> attribute_ranges_;
+  std::vector<int> zone_map_attribute_ids_;
+
+  /** The kernels of the compiled expression, operands before their users. */
+  std::vector<Kernel> kernels_;
+  /** The attributes the compiled expression reads. */
+  std::vector<KernelColumn> columns_;
+  /** The values of the right operands, TILEDB_EXPR_BATCH_SIZE per kernel. */
+  std::vector<double> kernel_values_;
+  /** The selections of the right operands, TILEDB_EXPR_BATCH_SIZE per kernel. */
+  std::vector<uint8_t> kernel_selections_;
 };
 
 #endif // __EXPRESSION_H__
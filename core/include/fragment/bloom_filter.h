@@ -0,0 +1,186 @@
+/**
+ * @file bloom_filter.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class BloomFilter.
+ */
+
+#ifndef __BLOOM_FILTER_H__
+#define __BLOOM_FILTER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+
+
+/* ********************************* */
+/*             CONSTANTS             */
+/* ********************************* */
+
+/**
+ * The default false-positive rate of the coordinates filters of new sparse
+ * fragments, overridden with coords_filter_false_positive_rate_ of 
+ * TileDB_Config or env TILEDB_BLOOM_FILTER_FPR.
+ */
+#define TILEDB_BLOOM_FILTER_FPR 0.01
+
+/**
+ * The default maximum size in bytes of the coordinates filter of a new sparse
+ * fragment, overridden with coords_filter_max_size_ of TileDB_Config or env
+ * TILEDB_BLOOM_FILTER_MAX_SIZE. It also bounds the memory taken by the filter
+ * while the fragment is written.
+ */
+#define TILEDB_BLOOM_FILTER_MAX_SIZE (64*1024*1024)
+
+/** The maximum number of bits set per key. */
+#define TILEDB_BLOOM_FILTER_MAX_HASH_NUM 16
+
+
+
+
+/**
+ * A Bloom filter over 64-bit key hashes, used to tell that a sparse fragment
+ * has no cell at a point without reading its tiles. Each key sets hash_num
+ * bits of the filter, derived from its hash by double hashing, so a key
+ * whose bits are not all set was never inserted.
+ */
+class BloomFilter {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /**
+   * Creates an empty filter sized for the input number of keys and
+   * false-positive rate. With the size capped, the false-positive rate is
+   * higher.
+   *
+   * @param key_num The number of keys to be inserted.
+   * @param false_positive_rate The target false-positive rate in (0, 1).
+   * @param max_size The maximum size of the filter bits in bytes.
+   */
+  BloomFilter(int64_t key_num, double false_positive_rate, size_t max_size);
+
+  /**
+   * Creates a filter over serialized bits, e.g. in a book-keeping section.
+   *
+   * @param bit_num The number of bits, a multiple of 64.
+   * @param hash_num The number of bits set per key.
+   * @param words The bits, bit_num/64 words. They must outlive the filter.
+   */
+  BloomFilter(int64_t bit_num, int hash_num, const uint64_t* words);
+
+
+
+
+  /* ********************************* */
+  /*             ACCESSORS             */
+  /* ********************************* */
+
+  /** Returns the number of bits. */
+  int64_t bit_num() const;
+
+  /**
+   * Returns the number of keys for which a filter at the input false-positive
+   * rate takes the input size, so that a filter created for them with the
+   * size as its maximum size has exactly size*8 bits.
+   *
+   * @param false_positive_rate The target false-positive rate in (0, 1).
+   * @param size The size of the filter bits in bytes.
+   * @return The number of keys, at least 1.
+   */
+  static int64_t capacity(double false_positive_rate, size_t size);
+
+  /** Returns the number of bits set per key. */
+  int hash_num() const;
+
+  /**
+   * Returns false if the key of the input hash was definitely not inserted,
+   * and true if it may have been.
+   */
+  bool may_contain(uint64_t hash) const;
+
+  /** Returns the bits, bit_num()/64 words. */
+  const uint64_t* words() const;
+
+  /**
+   * Returns the hash of the input coordinates. Coordinates that compare
+   * equal hash the same, i.e. -0.0 and 0.0 too.
+   *
+   * @tparam T The coordinates type.
+   * @param coords The coordinates, stride values apart.
+   * @param dim_num The number of dimensions.
+   * @param stride The distance between consecutive coordinates, e.g. 2 for
+   *     the low coordinates of a subarray.
+   * @return The hash.
+   */
+  template<class T>
+  static uint64_t hash_coords(const T* coords, int dim_num, int stride = 1);
+
+
+
+
+  /* ********************************* */
+  /*             MUTATORS              */
+  /* ********************************* */
+
+  /**
+   * Halves the filter while it stays large enough for the input number of
+   * keys at the input false-positive rate and its words divide evenly, so
+   * that a filter sized for an upper bound of keys, best a power of two
+   * bytes, can be shrunk once they are all inserted. Halving
+   * ORs the upper half of the bits into the lower half, which keeps every
+   * inserted key, since a bit position modulo half the bits equals the
+   * position modulo all the bits, modulo half the bits.
+   *
+   * @param key_num The number of keys inserted.
+   * @param false_positive_rate The target false-positive rate in (0, 1).
+   */
+  void fold(int64_t key_num, double false_positive_rate);
+
+  /** Inserts the key of the input hash. */
+  void insert(uint64_t hash);
+
+ private:
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The number of bits. */
+  int64_t bit_num_;
+  /** The number of bits set per key. */
+  int hash_num_;
+  /** The bits of a filter created for inserting keys. */
+  std::vector<uint64_t> own_words_;
+  /** The bits, either own_words_ or serialized bits. */
+  const uint64_t* words_;
+};
+
+#endif
@@ -35,8 +35,13 @@
 
 #include "array_schema.h"
 #include "buffer.h"
+#include "codec.h"
+#include "bloom_filter.h"
+#include "rtree.h"
 #include "storage_fs.h"
 #include "tiledb_constants.h"
+#include <cstdint>
+#include <mutex>
 #include <vector>
 #include <zlib.h>
 
@@ -56,6 +61,28 @@
 /** Default error message. */
 #define TILEDB_BK_ERRMSG std::string("[TileDB::BookKeeping] Error: ")
 
+/**
+ * Leads the sectioned book-keeping layout. It is never a valid non-empty
+ * domain size, which leads the legacy layout, so readers of the legacy
+ * layout fail on it. As versions of the library without the sectioned
+ * layout cannot open its fragments, new fragments get it only if
+ * StorageManagerConfig::book_keeping_sections is set.
+ */
+#define TILEDB_BK_SECTIONED SIZE_MAX
+
+/**
+ * Version of the sectioned book-keeping layout, following the marker. Loading
+ * a fragment of any other version fails with an unsupported version error,
+ * so that a newer layout is never misread.
+ */
+#define TILEDB_BK_VERSION 1
+
+/**
+ * Sections start at multiples of this many bytes, so that their arrays can
+ * be used in place.
+ */
+#define TILEDB_BK_SECTION_ALIGNMENT 8
+
 
 
 
@@ -64,7 +91,34 @@
 /* ********************************* */
 
 /** Stores potential error messages. */
-extern std::string tiledb_bk_errmsg;
+extern thread_local std::string tiledb_bk_errmsg;
+
+
+
+
+/** Locates a compressed section of the sectioned book-keeping. */
+typedef struct BookKeepingSection {
+  /** The offset of the section from the start of the book-keeping. */
+  int64_t offset_;
+  /** The compressed size of the section. */
+  int64_t compressed_size_;
+  /** The uncompressed size of the section. */
+  int64_t size_;
+} BookKeepingSection;
+
+/** 
+ * Summarizes the values of a fixed-sized numeric attribute in a sparse tile,
+ * so that tiles whose values cannot satisfy a filter can be skipped. 64-bit
+ * integers are widened to bounds exactly representable as doubles.
+ */
+typedef struct TileZoneMap {
+  /** A lower bound of the non-empty values, +inf if there are none. */
+  double min_;
+  /** An upper bound of the non-empty values, -inf if there are none. */
+  double max_;
+  /** The number of empty values, see TILEDB_EMPTY_*. */
+  int64_t empty_num_;
+} TileZoneMap;
 
 
 
@@ -83,12 +137,15 @@ class BookKeeping {
    * @param dense True if the fragment is dense, and false otherwise.
    * @param fragment_name The name of the fragment this book-keeping belongs to.
    * @param mode The mode in which the fragment was initialized in.
+   * @param write_sections True if the fragment gets the sectioned layout, 
+   *     which a loaded fragment is also looked up in first.
    */
   BookKeeping(
       const ArraySchema* array_schema, 
       bool dense, 
       const std::string& fragment_name,
-      int mode);
+      int mode,
+      bool write_sections=false);
 
   /** Destructor. */
   ~BookKeeping();
@@ -100,12 +157,31 @@ class BookKeeping {
   /*             ACCESSORS             */
   /* ********************************* */
 
-  /** Returns the bounding coordinates. */
-  const std::vector<void*>& bounding_coords() const; 
+  /** 
+   * Returns the bounding coordinates of the tile at the input position, 
+   * i.e. its first and last coordinates.
+   */
+  const void* bounding_coords(int64_t tile_pos) const; 
+
+  /**
+   * Returns the box bounding the cells of the fragment, which for a sparse
+   * fragment is the union of its MBRs and may be much narrower than the
+   * non-empty domain it was written with. It is computed on first use, which
+   * is safe to do concurrently. NULL for an empty fragment.
+   */
+  const void* bounding_domain();
 
   /** Returns the number of cells in the tile at the input position. */
   int64_t cell_num(int64_t tile_pos) const;
 
+  /**
+   * Returns the filter of the coordinates of the cells of a sparse fragment,
+   * decoded on first use, which is safe to do concurrently. NULL if there is
+   * none, i.e. for dense fragments, fragments written with the filters
+   * disabled or before them, and if it cannot be decoded.
+   */
+  const BloomFilter* coords_filter();
+
   /** 
    * Returns ture if the corresponding fragment is dense, and false if it
    * is sparse.
@@ -118,8 +194,22 @@ class BookKeeping {
   /** Returns the number of cells in the last tile. */
   int64_t last_tile_cell_num() const;
 
-  /** Returns the MBRs. */
-  const std::vector<void*>& mbrs() const; 
+  /** Returns the MBR of the tile at the input position. */
+  const void* mbr(int64_t tile_pos) const; 
+
+  /** 
+   * Returns the MBRs of all the tiles, one after the other in a contiguous
+   * buffer of the coordinates type.
+   */
+  const void* mbrs() const; 
+
+  /**
+   * Returns the MBRs as one column of low and one column of high coordinates
+   * per dimension, i.e. the low coordinates of dimension i of all the tiles
+   * start at position 2*i*tile_num and the high ones at (2*i+1)*tile_num.
+   * They are computed on first use, which is safe to do concurrently.
+   */
+  const void* mbr_columns();
 
   /** Returns the non-empty domain in which the fragment is constrained. */
   const void* non_empty_domain() const;
@@ -127,21 +217,57 @@ class BookKeeping {
   /** Returns true if the array is in read mode. */
   bool read_mode() const;
 
+  /**
+   * Returns a packed R-tree over the MBRs of the tiles, bulk-loaded on first
+   * use, which is safe to do concurrently.
+   */
+  const RTree* rtree();
+
   /** Returns the number of tiles in the fragment. */
   int64_t tile_num() const;
 
-  /** Returns the tile offsets. */
-  const std::vector<std::vector<off_t> >& tile_offsets() const;
+  /** 
+   * Returns the tile offsets of an attribute. For a loaded fragment, they
+   * are available only after load_attribute for the attribute.
+   */
+  const off_t* tile_offsets(int attribute_id) const;
 
-  /** Returns the variable tile offsets. */
-  const std::vector<std::vector<off_t> >& tile_var_offsets() const;
+  /** 
+   * Returns the variable tile offsets of an attribute. For a loaded
+   * fragment, they are available only after load_attribute for the
+   * attribute.
+   */
+  const off_t* tile_var_offsets(int attribute_id) const;
 
-  /** Returns the variable tile sizes. */
-  const std::vector<std::vector<size_t> >& tile_var_sizes() const;
+  /** 
+   * Returns the variable tile sizes of an attribute. For a loaded fragment,
+   * they are available only after load_attribute for the attribute.
+   */
+  const size_t* tile_var_sizes(int attribute_id) const;
 
   /** Returns true if the array is in write mode. */
   bool write_mode() const;
 
+  /** 
+   * Returns the name of the book-keeping file finalize writes for the layout
+   * of the fragment.
+   */
+  std::string filename() const;
+
+  /**
+   * Returns true if the fragment gets the sectioned book-keeping layout, see
+   * StorageManagerConfig::book_keeping_sections.
+   */
+  bool write_sections() const;
+
+  /**
+   * Returns the zone maps of the tiles for an attribute, NULL if they were
+   * not recorded, e.g. for variable-sized or non-numeric attributes, dense
+   * fragments and fragments written before them. For a loaded fragment,
+   * they are available only after load_attribute for the attribute.
+   */
+  const TileZoneMap* zone_maps(int attribute_id) const;
+
 
 
 
@@ -196,8 +322,31 @@ class BookKeeping {
    */
   void append_tile_var_size(int attribute_id, size_t size);
 
+  /** 
+   * Appends the zone map of the next tile for the input attribute. 
+   *
+   * @param attribute_id The id of the attribute.
+   * @param zone_map The zone map to be appended.
+   * @return void
+   */
+  void append_zone_map(int attribute_id, const TileZoneMap& zone_map);
+
+  /**
+   * Sets the filter of the coordinates of the cells of the fragment, which
+   * finalize writes as a section of its own. 
+   *
+   * @param coords_filter The filter, owned by the book-keeping from now on.
+   * @return void
+   */
+  void set_coords_filter(BloomFilter* coords_filter);
+
   /**
-   * Finalizes the book-keeping structures, properly flushing them to the disk.
+   * Finalizes the book-keeping structures, properly flushing them to the disk,
+   * in the sectioned layout if write_sections and in the legacy layout
+   * otherwise. The sections are compressed with the type named by env
+   * TILEDB_BOOK_KEEPING_COMPRESSION, one of "none", "gzip", "lz4" and
+   * "zstd", GZIP by default and for invalid values. The file is not synced,
+   * the fragment syncs it with its other files on commit.
    * @param fs The Storage File System class.
    *
    * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
@@ -214,13 +363,50 @@ class BookKeeping {
   int init(const void* non_empty_domain);
 
   /**
-   * Loads the book-keeping structures from the disk.
+   * Loads the book-keeping structures from the disk, from the book-keeping
+   * file of the layout write_sections picks if it exists and from the file
+   * of the other layout otherwise. With the sectioned layout, only the non-empty domain, the MBRs, the bounding coordinates
+   * and the last tile cell number are decoded here, the tile offsets and
+   * sizes of an attribute are decoded by load_attribute and the coordinates
+   * filter by coords_filter. The MBRs, bounding coordinates, tile offsets and
+   * sizes then point into the (decompressed) sections instead of being
+   * copied.
    * @param fs The Storage File System class.
    *
    * @return TILEDB_BK_OK for success, and TILEDB_OK_ERR for error.
    */
   int load(StorageFS *fs);
 
+  /**
+   * Loads the book-keeping structures from their serialized form, e.g. as
+   * kept in the fragment manifest.
+   *
+   * @param bytes The book-keeping as serialized by finalize, or the
+   *     uncompressed contents of a legacy book-keeping file.
+   * @param size The size of bytes.
+   * @return TILEDB_BK_OK for success, and TILEDB_OK_ERR for error.
+   */
+  int load(const void* bytes, size_t size);
+
+  /**
+   * Decodes the tile offsets, variable tile offsets and variable tile sizes
+   * of an attribute on its first use. It is a no-op if they are already
+   * decoded, and is safe to call concurrently.
+   *
+   * @param attribute_id The id of the attribute, attribute_num for the
+   *     coordinates.
+   * @return TILEDB_BK_OK for success, and TILEDB_OK_ERR for error.
+   */
+  int load_attribute(int attribute_id);
+
+  /**
+   * Returns the book-keeping serialized by finalize, NULL before finalize.
+   */
+  void* serialized_buffer();
+
+  /** Returns the size of the serialized book-keeping. */
+  size_t serialized_buffer_size();
+
   /**
    * Simply sets the number of cells for the last tile.
    *
@@ -240,10 +426,57 @@ class BookKeeping {
   // Buffer backing the book_keeping contents
   Buffer buffer_;
 
+  /** True for each attribute whose tile offsets and sizes are decoded. */
+  std::vector<bool> attribute_loaded_;
+  /** The number of attributes whose tile offsets and sizes are decoded. */
+  size_t attribute_loaded_num_;
+  /** Serializes load_attribute and decoding the coordinates filter. */
+  std::mutex attribute_mtx_;
+  /** The index of the sections of a sectioned book-keeping. */
+  std::vector<BookKeepingSection> section_index_;
+  /** The compression type of the sections of a sectioned book-keeping. */
+  int section_compression_;
+  /** 
+   * The decompressed sections of a sectioned book-keeping, NULL for
+   * sections not decompressed yet or used in place from sections_.
+   */
+  std::vector<void*> section_buffers_;
+  /** 
+   * The loaded sectioned book-keeping. It is kept until the tile offsets and
+   * sizes of every attribute are decoded, or for good if the sections are
+   * uncompressed and used in place.
+   */
+  Buffer sections_;
+  /** The MBRs in a section, NULL if they are not used in place. */
+  const char* section_mbrs_;
+  /** The bounding coordinates in a section, NULL if not used in place. */
+  const char* section_bounding_coords_;
+  /** The tile offsets of each attribute in a section, if sectioned. */
+  std::vector<const off_t*> section_tile_offsets_;
+  /** The variable tile offsets of each attribute in a section, if sectioned. */
+  std::vector<const off_t*> section_tile_var_offsets_;
+  /** The variable tile sizes of each attribute in a section, if sectioned. */
+  std::vector<const size_t*> section_tile_var_sizes_;
+  /** The zone maps of each attribute in a section, if sectioned. */
+  std::vector<const TileZoneMap*> section_zone_maps_;
+  /** The filter of the coordinates, see coords_filter. */
+  BloomFilter* coords_filter_;
+  /** True once coords_filter tried to decode the filter. */
+  bool coords_filter_loaded_;
+
   /** The array schema */
   const ArraySchema* array_schema_;
-  /** The first and last coordinates of each tile. */
-  std::vector<void*> bounding_coords_;
+  /** 
+   * The first and last coordinates of each tile, unless used in place from
+   * a section.
+   */
+  std::vector<char> bounding_coords_;
+  /** The number of bounding coordinates. */
+  int64_t bounding_coords_num_;
+  /** The box bounding the cells of a sparse fragment, see bounding_domain. */
+  std::vector<char> bounding_domain_;
+  /** Serializes computing the bounding domain. */
+  std::mutex bounding_domain_mtx_;
   /** True if the fragment is dense, and false if it is sparse. */
   bool dense_;
   /**
@@ -257,10 +490,23 @@ class BookKeeping {
   std::string fragment_name_;
   /** Number of cells in the last tile (meaningful only in the sparse case). */
   int64_t last_tile_cell_num_;
-  /** The MBRs (applicable only to the sparse case with irregular tiles). */
-  std::vector<void*> mbrs_;
+  /** 
+   * The MBRs (applicable only to the sparse case with irregular tiles),
+   * unless used in place from a section.
+   */
+  std::vector<char> mbrs_;
+  /** The MBRs as columns, see mbr_columns. */
+  std::vector<char> mbr_columns_;
+  /** Serializes computing the MBR columns. */
+  std::mutex mbr_columns_mtx_;
+  /** The number of MBRs. */
+  int64_t mbr_num_;
   /** The mode in which the fragment was initialized. */
   int mode_;
+  /** The R-tree over the MBRs, see rtree. */
+  RTree* rtree_;
+  /** Serializes bulk-loading the R-tree. */
+  std::mutex rtree_mtx_;
   /** The offsets of the next tile for each attribute. */
   std::vector<off_t> next_tile_offsets_;
   /** The offsets of the next variable tile for each attribute. */
@@ -285,12 +531,33 @@ class BookKeeping {
    * Meaningful only when there is compression for variable tiles.
    */
   std::vector<std::vector<size_t> > tile_var_sizes_;
+  /** True if the fragment gets the sectioned layout, see write_sections. */
+  bool write_sections_;
+  /** The zone maps of the tiles of each attribute, see zone_maps. */
+  std::vector<std::vector<TileZoneMap> > zone_maps_;
 
 
   /* ********************************* */
   /*           PRIVATE METHODS         */
   /* ********************************* */
 
+  /** Computes the union of the MBRs into bounding_domain_. */
+  template<class T>
+  void compute_bounding_domain();
+
+  /**
+   * Compresses the book-keeping buffer as the next section and empties it.
+   * @param codec The codec compressing the section, NULL for no compression.
+   * @param sections The compressed sections, to which the new one is
+   *     appended at the next multiple of TILEDB_BK_SECTION_ALIGNMENT.
+   * @param section The index entry to fill in for the new section.
+   * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
+   */
+  int compress_section(
+      Codec* codec,
+      Buffer& sections, 
+      BookKeepingSection& section);
+
   /**
    * Writes the bounding coordinates to the book-keeping buffer.
    * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
@@ -316,22 +583,46 @@ class BookKeeping {
   int flush_non_empty_domain();
 
  /**
-   * Writes the tile offsets to the book-keeping buffer.
+   * Writes the tile offsets of an attribute to the book-keeping buffer.
+   * @param attribute_id The id of the attribute.
    * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
    */
-  int flush_tile_offsets();
+  int flush_tile_offsets(int attribute_id);
 
  /**
-   * Writes the variable tile offsets to the book-keeping buffer.
+   * Writes the variable tile offsets of an attribute to the book-keeping buffer.
+   * @param attribute_id The id of the attribute.
    * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
    */
-  int flush_tile_var_offsets();
+  int flush_tile_var_offsets(int attribute_id);
 
  /**
-   * Writes the variable tile sizes to the book-keeping buffer.
+   * Writes the variable tile sizes of an attribute to the book-keeping buffer.
+   * @param attribute_id The id of the attribute.
    * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
    */
-  int flush_tile_var_sizes();
+  int flush_tile_var_sizes(int attribute_id);
+
+ /**
+   * Writes the zone maps of an attribute to the book-keeping buffer.
+   * @param attribute_id The id of the attribute.
+   * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
+   */
+  int flush_zone_maps(int attribute_id);
+
+  /**
+   * Writes the coordinates filter to the book-keeping buffer.
+   * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
+   */
+  int flush_coords_filter();
+
+  /**
+   * Writes the book-keeping of a fragment in the legacy layout, a single
+   * GZIP stream readable by every version of the library.
+   * @param fs The Storage File System class.
+   * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
+   */
+  int flush_legacy(StorageFS *fs);
 
   /**
    * Loads the bounding coordinates from the book-keeping buffer.
@@ -339,6 +630,18 @@ class BookKeeping {
    */
   int load_bounding_coords();
 
+  /**
+   * Parses the book-keeping structures from the book-keeping buffer.
+   * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
+   */
+  int load_buffer();
+
+  /**
+   * Decodes the coordinates filter from its section, if there is one.
+   * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
+   */
+  int load_coords_filter();
+
   /**
    * Loads the cell number of the last tile from the book-keeping buffer
    * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
@@ -358,22 +661,43 @@ class BookKeeping {
   int load_non_empty_domain();
 
   /**
-   * Loads the tile offsets from the book-keeping buffer.
+   * Gets a section of the sectioned book-keeping, decompressing it on first
+   * use unless it is uncompressed.
+   * @param section The index of the section.
+   * @param data Set to the contents of the section, which live as long as
+   *     the book-keeping.
+   * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
+   */
+  int load_section(int section, const char** data);
+
+  /**
+   * Parses the index and the first section of the sectioned book-keeping
+   * held in the book-keeping buffer, keeping the other sections for
+   * load_attribute and coords_filter.
+   * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
+   */
+  int load_sections();
+
+  /**
+   * Loads the tile offsets of an attribute from the book-keeping buffer.
+   * @param attribute_id The id of the attribute.
    * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
    */
-  int load_tile_offsets();
+  int load_tile_offsets(int attribute_id);
 
   /**
-   * Loads the variable tile offsets from the book-keeping buffer.
+   * Loads the variable tile offsets of an attribute from the book-keeping buffer.
+   * @param attribute_id The id of the attribute.
    * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
    */
-  int load_tile_var_offsets();
+  int load_tile_var_offsets(int attribute_id);
 
   /**
-   * Loads the variable tile sizes from the book-keeping buffer.
+   * Loads the variable tile sizes of an attribute from the book-keeping buffer.
+   * @param attribute_id The id of the attribute.
    * @return TILEDB_BK_OK on success and TILEDB_BK_ERR on error.
    */
-  int load_tile_var_sizes();
+  int load_tile_var_sizes(int attribute_id);
 };
 
 #endif
@@ -101,6 +101,9 @@ class Fragment {
   /** Returns the array the fragment belongs to. */
   const Array* array() const;
 
+  /** Returns the book-keeping of the fragment. */
+  BookKeeping* book_keeping() const;
+
   /** Returns the number of cell per (full) tile. */
   int64_t cell_num_per_tile() const;
 
@@ -110,13 +113,22 @@ class Fragment {
   /** Returns the fragment name. */
   const std::string& fragment_name() const;
 
+  /** 
+   * Returns true if the committed fragment was recorded in the fragment
+   * manifest of the array.
+   */
+  bool manifest_recorded() const;
+
   /** Returns the mode of the fragment. */
   int mode() const;
 
   /** Returns true if the array is in read mode. */
   bool read_mode() const;
 
-  /** Returns the read state of the fragment. */
+  /** 
+   * Returns the read state of the fragment, NULL until it is first reset for
+   * a subarray the fragment overlaps.
+   */
   ReadState* read_state() const;
 
   /** 
@@ -168,7 +180,10 @@ class Fragment {
       const std::string& fragment_name, 
       BookKeeping* book_keeping);
 
-  /** Resets the read state (typically to start a new read). */
+  /** 
+   * Resets the read state (typically to start a new read), creating it on
+   * first use.
+   */
   void reset_read_state();
 
   /**
@@ -240,6 +255,8 @@ class Fragment {
   bool dense_;
   /** The fragment name. */
   std::string fragment_name_;
+  /** True if the committed fragment was recorded in the fragment manifest. */
+  bool manifest_recorded_;
   /**
    * The fragment mode. It must be one of the following:
    *    - TILEDB_WRITE 
@@ -259,6 +276,17 @@ class Fragment {
   /*          PRIVATE METHODS          */
   /* ********************************* */
 
+  /**
+   * Commits a written fragment. All the fragment files are synced together
+   * with the fragment directory, before the fragment is made visible by
+   * renaming it and creating the fragment file. The new directory entries
+   * are synced last, and then the fragment is recorded in the fragment
+   * manifest of the array, if it has one.
+   *
+   * @return TILEDB_FG_OK for success, and TILEDB_FG_ERR for error.
+   */
+  int commit();
+
   /** 
    * Changes the temporary fragment name into a stable one.
    *
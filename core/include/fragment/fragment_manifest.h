@@ -0,0 +1,267 @@
+/**
+ * @file fragment_manifest.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class FragmentManifest, an optional array-level cache of
+ * the names, non-empty domains and book-keeping of the committed fragments of
+ * an array, so that opening the array does not need the dense check and the
+ * book-keeping read of each fragment.
+ */
+
+#ifndef __FRAGMENT_MANIFEST_H__
+#define __FRAGMENT_MANIFEST_H__
+
+#include "storage_fs.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+
+
+/* ********************************* */
+/*             CONSTANTS             */
+/* ********************************* */
+
+/**@{*/
+/** Return code. */
+#define TILEDB_FM_OK          0
+#define TILEDB_FM_ERR        -1
+/**@}*/
+
+/** Version of the manifest format. */
+#define TILEDB_FM_VERSION     1
+
+/** Default number of shards above which writers fold them into the manifest. */
+#define TILEDB_FM_MAX_SHARD_NUM 64
+
+/** Default error message. */
+#define TILEDB_FM_ERRMSG std::string("[TileDB::FragmentManifest] Error: ")
+
+
+
+
+/* ********************************* */
+/*          GLOBAL VARIABLES         */
+/* ********************************* */
+
+/** Stores potential error messages. */
+extern std::string tiledb_fm_errmsg;
+
+
+
+
+/** The manifest entry of one committed fragment. */
+typedef struct FragmentManifestEntry {
+  /** True if the fragment is dense. */
+  bool dense_;
+  /** The non-empty domain of the fragment. */
+  std::vector<char> non_empty_domain_;
+  /** The serialized, uncompressed book-keeping of the fragment. */
+  std::vector<char> book_keeping_;
+} FragmentManifestEntry;
+
+/**
+ * The manifest is a cache, the listing of the array directory stays the
+ * source of truth. Readers only use entries of fragments that are still
+ * listed, and check the fragment file only of the listed directories missing
+ * from the manifest, so a missing or stale manifest never changes what is
+ * read. Entries are only recorded once the fragment file exists, and
+ * consolidation drops them before deleting the fragments.
+ *
+ * Each committed fragment writes its entry to its own shard file next to the
+ * manifest, so concurrent writers never rewrite each other's entries and the
+ * bytes written stay linear in the number of fragments. Consolidation folds
+ * the shards into the manifest file, and so do writers once there are more
+ * than TILEDB_FM_MAX_SHARD_NUM shards, so that the shards read on open stay
+ * bounded. Writers record their fragments only when env
+ * TILEDB_FRAGMENT_MANIFEST is set or once the manifest file exists.
+ */
+class FragmentManifest {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /**
+   * Constructor.
+   *
+   * @param fs The Storage File System class.
+   * @param dir The array or metadata directory.
+   */
+  FragmentManifest(StorageFS* fs, const std::string& dir);
+
+
+
+
+  /* ********************************* */
+  /*             ACCESSORS             */
+  /* ********************************* */
+
+  /**
+   * Returns the entry of the input fragment, or NULL if it is not in the
+   * manifest.
+   *
+   * @param fragment_name The fragment directory, full path or name only.
+   */
+  const FragmentManifestEntry* entry(const std::string& fragment_name) const;
+
+  /** Returns the number of fragments in the manifest. */
+  size_t fragment_num() const;
+
+  /** Returns the manifest file name. */
+  std::string filename() const;
+
+  /** 
+   * Returns the name of the shard file holding the entry of the input
+   * fragment until it is folded into the manifest file.
+   *
+   * @param fragment_name The fragment directory, full path or name only.
+   */
+  std::string shard_filename(const std::string& fragment_name) const;
+
+  /**
+   * Returns the number of shard files not folded into the manifest file yet,
+   * or 0 if the array has no manifest file.
+   */
+  size_t shard_num() const;
+
+
+
+
+  /* ********************************* */
+  /*             MUTATORS              */
+  /* ********************************* */
+
+  /**
+   * Loads the manifest file and the shards, if they exist. Missing or
+   * unreadable files are skipped, as if their entries were not recorded.
+   *
+   * @return true if the manifest file or any shard was loaded.
+   */
+  bool load();
+
+  /**
+   * Loads the manifest file, and then only the shards of the input fragment
+   * directories missing from it. The array directory is listed for the shards
+   * only if there are such directories. Nothing is loaded if the manifest
+   * file is missing or unreadable, so that leftover shards are not trusted
+   * without it.
+   *
+   * @param fragment_dirs The directories listed in the array directory.
+   * @return true if the manifest file was loaded.
+   */
+  bool load(const std::vector<std::string>& fragment_dirs);
+
+  /**
+   * Records a newly committed fragment in its shard. Does nothing if the
+   * array has no manifest file and env TILEDB_FRAGMENT_MANIFEST is not set,
+   * otherwise creates an empty manifest file first if missing.
+   *
+   * @param fragment_name The fragment directory.
+   * @param entry The entry of the fragment.
+   * @param recorded If not NULL, set to true if the shard was written, and
+   *     to false if the array has no manifest or on error.
+   * @return TILEDB_FM_OK on success and TILEDB_FM_ERR if the shard could not
+   *     be written, in which case the fragment is found through its
+   *     directory instead.
+   */
+  int add(
+      const std::string& fragment_name, 
+      const FragmentManifestEntry& entry,
+      bool* recorded=NULL);
+
+  /**
+   * Folds the shards into the manifest file, dropping the removed fragments
+   * and the entries whose directories no longer exist, and then deletes the
+   * folded shards. The new manifest replaces the old one atomically on
+   * filesystems that support renames, and by delete and write otherwise, as
+   * readers fall back to the fragment directories while it is missing. If it
+   * cannot be written or the shards cannot be deleted, the old one is deleted
+   * so that it is not trusted. Must only be called with the consolidation
+   * lock held, exclusively by consolidation and shared by writers bounding
+   * the shards. Concurrent folds by writers at worst turn entries into misses.
+   *
+   * @param removed The fragments to be dropped, e.g. after consolidation.
+   * @return TILEDB_FM_OK on success and TILEDB_FM_ERR on error.
+   */
+  int compact(const std::vector<std::string>& removed);
+
+  /**
+   * Deletes the manifest file and all the shards.
+   *
+   * @return TILEDB_FM_OK on success and TILEDB_FM_ERR on error.
+   */
+  int clear();
+
+
+
+
+ private:
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The array or metadata directory. */
+  std::string dir_;
+  /** The fragment entries by fragment name. */
+  std::map<std::string, FragmentManifestEntry> entries_;
+  /** The shard files read by the last load(). */
+  std::vector<std::string> shard_filenames_;
+  /** The Storage File System class. */
+  StorageFS* fs_;
+
+
+
+
+  /* ********************************* */
+  /*           PRIVATE METHODS         */
+  /* ********************************* */
+
+  /**
+   * Parses the uncompressed manifest or shard into the entries.
+   * @return TILEDB_FM_OK on success and TILEDB_FM_ERR on error.
+   */
+  int deserialize(const char* buffer, size_t buffer_size);
+
+  /** Reads the input manifest or shard file into the entries. */
+  bool load_file(const std::string& filename);
+
+  /** Serializes the manifest into the input buffer. */
+  void serialize(std::vector<char>& buffer) const;
+
+  /**
+   * Writes the entries to the input manifest or shard file, replacing the
+   * existing one.
+   * @return TILEDB_FM_OK on success and TILEDB_FM_ERR on error.
+   */
+  int store(const std::string& filename);
+};
+
+#endif
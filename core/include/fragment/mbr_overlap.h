@@ -0,0 +1,64 @@
+/**
+ * @file mbr_overlap.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines the scan of the MBRs of a fragment for the tiles that
+ * overlap a subarray.
+ */
+
+#ifndef __MBR_OVERLAP_H__
+#define __MBR_OVERLAP_H__
+
+#include <cstdint>
+
+/**
+ * Returns the position of the first tile in [start, end] whose MBR overlaps
+ * the subarray, or end+1 if there is none. The MBRs are compared a block of
+ * tiles at a time, one dimension after the other, with loops the compiler
+ * turns into SIMD comparisons.
+ *
+ * @tparam T The coordinates type.
+ * @param mbr_columns The MBRs as one column of low and one column of high
+ *     coordinates per dimension, as returned by BookKeeping::mbr_columns.
+ * @param tile_num The number of tiles, i.e. the length of each column.
+ * @param dim_num The number of dimensions.
+ * @param subarray The subarray, a low and a high coordinate per dimension.
+ * @param start The position of the first tile to check.
+ * @param end The position of the last tile to check.
+ * @return The position of the first overlapping tile, or end+1.
+ */
+template<class T>
+int64_t next_overlapping_mbr(
+    const T* mbr_columns,
+    int64_t tile_num,
+    int dim_num,
+    const T* subarray,
+    int64_t start,
+    int64_t end);
+
+#endif
@@ -37,7 +37,9 @@
 #include "book_keeping.h"
 #include "codec.h"
 #include "fragment.h"
+#include "mmap_registry.h"
 #include "storage_buffer.h"
+#include <memory>
 #include <vector>
 
 
@@ -57,6 +59,12 @@
 /** Default error message. */
 #define TILEDB_RS_ERRMSG std::string("[TileDB::ReadState] Error: ")
 
+/**
+ * Queries overlapping at most this many tiles of a fragment are considered
+ * random accesses when hinting the access pattern to the filesystem.
+ */
+#define TILEDB_RS_RANDOM_ACCESS_MAX_TILES 4
+
 
 
 
@@ -168,6 +176,30 @@ class ReadState {
    */
   bool subarray_area_covered() const;
 
+  /**
+   * Returns the number of compressed tile reads needed so far, i.e. the number
+   * of I/Os if every tile was read separately.
+   */
+  size_t tile_reads() const;
+
+  /** 
+   * Returns the number of I/Os issued so far for compressed tiles, after
+   * adjacent tile reads were coalesced.
+   */
+  size_t tile_io_reads() const;
+
+  /**
+   * Returns the number of file size lookups issued to the filesystem so far,
+   * at most one per attribute file.
+   */
+  size_t file_size_lookups() const;
+
+  /**
+   * Returns the number of access pattern hints of the given kind, one of 
+   * TILEDB_FS_ACCESS_*, issued so far for the attribute files.
+   */
+  size_t access_hints(int advice) const;
+
 
 
 
@@ -427,8 +459,13 @@ class ReadState {
   std::vector<int64_t> fetched_tile_;
   /** The fragment the read state belongs to. */
   const Fragment* fragment_;
-  /** Keeps track of whether each attribute is empty or not. */
+  /** 
+   * Keeps track of whether each attribute is empty or not, once checked by
+   * is_empty_attribute.
+   */
   std::vector<bool> is_empty_attribute_;
+  /** True for each attribute checked by is_empty_attribute. */
+  std::vector<bool> is_empty_attribute_checked_;
   /** 
    * Last investigated tile coordinates. Applicable only to **sparse** fragments
    * for **dense** arrays.
@@ -449,6 +486,30 @@ class ReadState {
   std::vector<void*> map_addr_var_;
   /** The corresponding lengths of the buffers in map_addr_var_. */
   std::vector<size_t> map_addr_var_lengths_;
+  /** 
+   * True if tiles are served from whole attribute files mapped through the
+   * mmap registry of the array instead of mapping each tile.
+   */
+  bool use_mapped_files_;
+  /** The mapped attribute files, NULL until first accessed. */
+  std::vector<std::shared_ptr<MappedFile> > mapped_files_;
+  /** The mapped variable attribute files, NULL until first accessed. */
+  std::vector<std::shared_ptr<MappedFile> > mapped_var_files_;
+  /** True for each attribute whose tile points into mapped_files_. */
+  std::vector<bool> tiles_mapped_;
+  /** True for each attribute whose variable tile points into mapped_var_files_. */
+  std::vector<bool> tiles_var_mapped_;
+  /** 
+   * The access pattern hinted for the query, one of TILEDB_FS_ACCESS_*, or
+   * -1 if not computed yet.
+   */
+  int access_pattern_;
+  /** True for each attribute file whose access pattern has been hinted. */
+  std::vector<bool> advised_;
+  /** True for each variable attribute file whose access pattern has been hinted. */
+  std::vector<bool> advised_var_;
+  /** Number of access pattern hints issued, indexed by TILEDB_FS_ACCESS_*. */
+  std::vector<size_t> access_hints_;
   /** 
    * The overlap between an MBR and the current tile under investigation
    * in the case of **sparse** fragments in **dense** arrays. The overlap
@@ -474,6 +535,16 @@ class ReadState {
   void* search_tile_overlap_subarray_;
   /** The positions of the currently investigated tile. */
   int64_t search_tile_pos_;
+  /**
+   * The R-tree over the MBRs of the fragment, see BookKeeping::rtree. Got on
+   * the first sparse search for overlapping tiles.
+   */
+  const RTree* rtree_;
+  /** 
+   * The filter expression whose attributes have their zone maps loaded, see
+   * tile_filtered_out.
+   */
+  const Expression* zone_map_expression_;
   /** 
    * True if the fragment non-empty domain fully covers the subarray area
    * in the current overlapping tile.
@@ -483,6 +554,56 @@ class ReadState {
   void* tile_compressed_;
   /** Allocated size for internal buffer used in the case of compression. */
   size_t tile_compressed_allocated_size_;
+  /** 
+   * True if compressed tiles are fetched with read_tiles_from_file_v into
+   * tiles_compressed_/tiles_var_compressed_, i.e. when they are read in
+   * batches across attributes or coalesced across tiles.
+   */
+  bool batch_tile_reads_;
+  /** 
+   * True if the compressed tiles of all attributes are fetched together with
+   * one vectored read, i.e. for TILEDB_IO_URING and for TILEDB_IO_READ on
+   * non-posix filesystems where separate reads are serialized by latency.
+   * With download buffers set, the blocks missing from the buffers of all
+   * the files are downloaded together instead.
+   */
+  bool batch_attribute_reads_;
+  /** 
+   * Maximum bytes of unneeded tiles between two needed tiles of a file for
+   * their reads to be coalesced into one.
+   */
+  size_t coalesce_max_gap_;
+  /** Maximum size of a coalesced read, 0 if coalescing is disabled. */
+  size_t coalesce_max_size_;
+  /** 
+   * Runs of consecutive compressed tiles (one per attribute) read with one
+   * I/O each when batch_tile_reads_ is set.
+   */
+  std::vector<void*> tiles_compressed_;
+  /** Allocated sizes for tiles_compressed_. */
+  std::vector<size_t> tiles_compressed_allocated_size_;
+  /** Runs of consecutive compressed variable tiles. */
+  std::vector<void*> tiles_var_compressed_;
+  /** Allocated sizes for tiles_var_compressed_. */
+  std::vector<size_t> tiles_var_compressed_allocated_size_;
+  /** 
+   * The [first, last] tile range held in tiles_compressed_ and 
+   * tiles_var_compressed_ for each attribute, [-1, -1] if none.
+   */
+  std::vector<std::pair<int64_t, int64_t> > prefetched_tiles_;
+  /** Number of compressed tile reads, see tile_reads(). */
+  size_t tile_reads_;
+  /** Number of I/Os for compressed tiles, see tile_io_reads(). */
+  size_t tile_io_reads_;
+  /** 
+   * Sizes of the attribute files, looked up once when first needed and -1
+   * until then (one per attribute plus coordinates).
+   */
+  std::vector<off_t> file_sizes_;
+  /** Sizes of the variable-sized attribute files, -1 until looked up. */
+  std::vector<off_t> file_var_sizes_;
+  /** Number of file size lookups, see file_size_lookups(). */
+  size_t file_size_lookups_;
   /** File offset for each attribute tile. */
   std::vector<off_t> tiles_file_offsets_;
   /** File offset for each variable-sized attribute tile. */
@@ -521,8 +642,55 @@ class ReadState {
   /*          PRIVATE METHODS          */
   /* ********************************* */
 
+  /**
+   * Classifies the query on this fragment for hinting the filesystem.
+   * Consolidation streams whole files, queries overlapping more than
+   * TILEDB_RS_RANDOM_ACCESS_MAX_TILES tiles are scans and the rest are
+   * point/small range lookups.
+   *
+   * @return TILEDB_FS_ACCESS_SEQUENTIAL or TILEDB_FS_ACCESS_RANDOM.
+   */
+  int access_pattern();
+
+  /**
+   * Hints the access pattern of the query for an attribute file the first
+   * time a tile is read from it. For sparse scans, the span of the file
+   * holding the tiles in the search range is also requested to be read
+   * ahead. Hints are best effort, errors are ignored.
+   *
+   * @param attribute_id The attribute id, attribute_num_ and 
+   *     attribute_num_+1 both refer to the coordinates.
+   * @param is_var True for the variable-sized file of the attribute.
+   * @return void
+   */
+  void advise_access(int attribute_id, bool is_var);
+
   std::string construct_filename(int attribute_id, bool is_var);
 
+  /**
+   * Returns the size of the fixed or variable-sized file of an attribute,
+   * querying the filesystem only the first time. Fragment files are not
+   * modified once written, so the size is fixed for the lifetime of the
+   * read state.
+   *
+   * @param attribute_id The attribute id, attribute_num_ and 
+   *     attribute_num_+1 both refer to the coordinates.
+   * @param is_var True for the variable-sized file of the attribute.
+   * @return The file size or TILEDB_FS_ERR.
+   */
+  off_t get_file_size(int attribute_id, bool is_var);
+
+  /**
+   * Returns the buffer caching the downloaded blocks of the fixed or
+   * variable-sized file of an attribute, created on first use. Only used
+   * if the filesystem has a download buffer size.
+   *
+   * @param attribute_id The attribute id, attribute_num_ for the coordinates.
+   * @param is_var True for the variable-sized file of the attribute.
+   * @return The buffer.
+   */
+  StorageBuffer* get_file_buffer(int attribute_id, bool is_var);
+
   /**
    * Resets all internal buffers associated with attribute files.
    */
@@ -703,8 +871,68 @@ class ReadState {
       int64_t i,
       const size_t*& offset);
 
-  /** Returns *true* if the file of the input attribute is empty. */
-  bool is_empty_attribute(int attribute_id) const;
+  /** 
+   * Returns *true* if the file of the input attribute is empty. The file is
+   * looked up on the first call for the attribute.
+   */
+  bool is_empty_attribute(int attribute_id);
+
+  /**
+   * Decodes the tile offsets and sizes of an attribute in the book-keeping
+   * on its first use.
+   *
+   * @param attribute_id The attribute id.
+   * @return TILEDB_RS_OK for success and TILEDB_RS_ERR for error.
+   */
+  int load_attribute(int attribute_id);
+
+  /** 
+   * Returns *true* if the MBR of the input tile overlaps with the query
+   * subarray. Applicable only to **sparse** fragments.
+   *
+   * @param tile_i The tile position.
+   * @return *true* if there is overlap.
+   */
+  bool mbr_overlaps_subarray(int64_t tile_i) const;
+
+  /** 
+   * Returns *true* if the MBR of the input tile overlaps with the query
+   * subarray. Applicable only to **sparse** fragments.
+   *
+   * @tparam T The coordinates type.
+   * @param tile_i The tile position.
+   * @return *true* if there is overlap.
+   */
+  template<class T>
+  bool mbr_overlaps_subarray(int64_t tile_i) const;
+
+  /**
+   * Returns the number of tiles of a **dense** fragment overlapping the
+   * query subarray.
+   *
+   * @tparam T The coordinates type.
+   * @return The number of overlapping tiles.
+   */
+  template<class T>
+  int64_t overlapping_tile_num() const;
+
+  /**
+   * Returns a pointer to a range of an attribute file mapped whole, the file
+   * is mapped through the mmap registry the first time it is accessed.
+   *
+   * @param attribute_id The id of the attribute the range belongs to.
+   * @param is_var True for the variable file of the attribute.
+   * @param offset The offset of the range in the file.
+   * @param length The length of the range.
+   * @param data Set to the start of the range.
+   * @return TILEDB_RS_OK for success, and TILEDB_RS_ERR for error.
+   */
+  int get_mapped_range(
+      int attribute_id,
+      bool is_var,
+      off_t offset,
+      size_t length,
+      const char*& data);
 
   /** 
    * Maps a tile from the disk for an attribute into a local buffer, using 
@@ -900,6 +1128,22 @@ class ReadState {
       off_t offset,
       size_t tile_size);
 
+  /** 
+   * Reads the compressed tile of the input attribute into 
+   * tiles_compressed_/tiles_var_compressed_. With batch_attribute_reads_, the
+   * same tile of every other compressed attribute in the query that has not
+   * been fetched yet is read along with it, with a single
+   * StorageFS::read_from_file_v call. For sparse fragments, the read of each
+   * file is extended to the next tiles overlapping the query subarray, as
+   * long as the coalesced read is within coalesce_max_gap_ and 
+   * coalesce_max_size_.
+   *
+   * @param attribute_id The id of the attribute the read occurs for.
+   * @param tile_i The tile position.
+   * @return TILEDB_RS_OK for success, and TILEDB_RS_ERR for error.
+   */
+  int read_tiles_from_file_v(int attribute_id, int64_t tile_i);
+
   /** 
    * Reads a tile from the disk for an attribute into a local buffer. This
    * function focuses on the case of variable-sized tiles and any compression. 
@@ -962,6 +1206,18 @@ class ReadState {
       void* buffer, 
       int64_t offset_num, 
       size_t new_start_offset);
+
+  /**
+   * Returns *true* if the input tile need not be read, because the zone maps
+   * of its attributes show that none of its cells can pass the filter 
+   * expression of the array (see Expression::excludes_tile), and its cells 
+   * cannot hide cells of older fragments that would pass instead. Applicable
+   * only to **sparse** fragments.
+   *
+   * @param tile_i The tile position.
+   * @return *true* if the tile can be skipped.
+   */
+  bool tile_filtered_out(int64_t tile_i);
 };
 
 #endif
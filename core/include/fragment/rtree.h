@@ -0,0 +1,181 @@
+/**
+ * @file rtree.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class RTree.
+ */
+
+#ifndef __RTREE_H__
+#define __RTREE_H__
+
+#include <cstdint>
+#include <vector>
+
+
+
+
+/* ********************************* */
+/*             CONSTANTS             */
+/* ********************************* */
+
+/** The number of children of each R-tree node. */
+#define TILEDB_RTREE_FANOUT 16
+
+
+
+
+/**
+ * A packed R-tree over the MBRs of the tiles of a sparse fragment. The leaves
+ * are the tiles in the order they are stored, which is the global cell order
+ * of the fragment, and every TILEDB_RTREE_FANOUT consecutive nodes of a level
+ * are bounded by one node of the level above. Keeping the tiles in storage
+ * order lets the overlapping tiles be enumerated by increasing position, as
+ * the read algorithm requires, without sorting.
+ */
+class RTree {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /**
+   * Bulk-loads the tree.
+   *
+   * @param coords_type The type of the coordinates.
+   * @param dim_num The number of dimensions.
+   * @param tile_num The number of tiles.
+   * @param mbr_columns The tile MBRs as columns, as returned by
+   *     BookKeeping::mbr_columns. They must outlive the tree.
+   * @param fanout The number of children of each node.
+   */
+  RTree(
+      int coords_type,
+      int dim_num,
+      int64_t tile_num,
+      const void* mbr_columns,
+      int fanout = TILEDB_RTREE_FANOUT);
+
+
+
+
+  /* ********************************* */
+  /*             ACCESSORS             */
+  /* ********************************* */
+
+  /** Returns the number of levels above the tiles. */
+  int level_num() const;
+
+  /**
+   * Returns the position of the first tile in [start, end] whose MBR overlaps
+   * any of the input ranges, or end+1 if there is none. Subtrees that overlap
+   * none of the ranges are skipped, so the cost depends on the number of
+   * overlapping tiles rather than on the number of tiles in [start, end].
+   *
+   * @tparam T The coordinates type.
+   * @param ranges The ranges one after the other, each a low and a high
+   *     coordinate per dimension like a subarray.
+   * @param range_num The number of ranges.
+   * @param start The position of the first tile to check.
+   * @param end The position of the last tile to check.
+   * @return The position of the first overlapping tile, or end+1.
+   */
+  template<class T>
+  int64_t next_overlapping_tile(
+      const T* ranges,
+      int range_num,
+      int64_t start,
+      int64_t end) const;
+
+ private:
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The number of dimensions. */
+  int dim_num_;
+  /** The number of children of each node. */
+  int fanout_;
+  /** The tile MBRs as columns, see BookKeeping::mbr_columns. */
+  const void* mbr_columns_;
+  /**
+   * The MBRs of the nodes of every level above the tiles, bottom-up, each a
+   * low and a high coordinate per dimension. 
+   */
+  std::vector<char> nodes_;
+  /** The position of the first node of each level in nodes_, by level. */
+  std::vector<int64_t> level_offsets_;
+  /** The number of nodes of each level, with the tiles as level 0. */
+  std::vector<int64_t> level_sizes_;
+  /** The number of tiles under a node of each level. */
+  std::vector<int64_t> level_spans_;
+
+
+
+
+  /* ********************************* */
+  /*          PRIVATE METHODS          */
+  /* ********************************* */
+
+  /** Computes the node MBRs of all levels. */
+  template<class T>
+  void build();
+
+  /** Returns the MBR of a node of a level above the tiles. */
+  template<class T>
+  const T* node_mbr(int level, int64_t node) const;
+
+  /** Returns true if the MBR overlaps any of the ranges. */
+  template<class T>
+  bool overlaps(const T* mbr, const T* ranges, int range_num) const;
+
+  /**
+   * Returns the first overlapping tile in [start, end] under a node, or end+1
+   * if there is none.
+   */
+  template<class T>
+  int64_t search(
+      int level,
+      int64_t node,
+      const T* ranges,
+      int range_num,
+      int64_t start,
+      int64_t end) const;
+
+  /**
+   * Returns the first tile in [start, end] overlapping any of the ranges,
+   * comparing the tile MBRs directly, or end+1 if there is none.
+   */
+  template<class T>
+  int64_t scan_tiles(
+      const T* ranges,
+      int range_num,
+      int64_t start,
+      int64_t end) const;
+};
+
+#endif
@@ -37,6 +37,7 @@
 #include "codec.h"
 #include "fragment.h"
 #include "storage_buffer.h"
+#include "storage_write_session.h"
 #include <vector>
 #include <iostream>
 
@@ -95,12 +96,27 @@ class WriteState {
 
 
 
+  /* ********************************* */
+  /*             ACCESSORS             */
+  /* ********************************* */
+
+  /**
+   * Returns the names of the attribute files of the fragment, including the
+   * ones that may not have been created.
+   */
+  std::vector<std::string> files() const;
+
+
+
+
   /* ********************************* */
   /*              MUTATORS             */
   /* ********************************* */
 
   /**
-   * Finalizes the fragment.
+   * Finalizes the fragment. With the TILEDB_IO_WRITE method the attribute
+   * files are not synced, the fragment syncs them with the book-keeping
+   * when it is committed.
    *
    * @return TILEDB_WS_OK for success and TILEDB_WS_ERR for error. 
    */
@@ -210,6 +226,35 @@ class WriteState {
 
   /** The Storage Filesystem */
   StorageFS *fs_;
+  /** 
+   * Holds the attribute files open for the lifetime of the fragment on local
+   * filesystems, NULL otherwise.
+   */
+  WriteSession *write_session_;
+  /** The zone map of the tile currently being populated for each attribute. */
+  std::vector<TileZoneMap> zone_maps_;
+  /** The number of values summarized in the zone map of each attribute. */
+  std::vector<int64_t> zone_map_value_nums_;
+  /** 
+   * The false-positive rate of the coordinates filter of a sparse fragment,
+   * 0 if the filter is disabled.
+   */
+  double coords_filter_fpr_;
+  /** The maximum size in bytes of the coordinates filter. */
+  size_t coords_filter_max_size_;
+  /** 
+   * The hashes of the first coordinates written, see BloomFilter::hash_coords,
+   * kept until they take coords_filter_max_size_ bytes, so that the filter of
+   * a small fragment is sized exactly.
+   */
+  std::vector<uint64_t> coords_hashes_;
+  /** 
+   * The filter of a fragment with more coordinates than coords_hashes_ keeps,
+   * sized for coords_filter_max_size_ bytes and shrunk by flush_coords_filter.
+   */
+  BloomFilter* coords_filter_;
+  /** The number of coordinates hashed. */
+  int64_t coords_hash_num_;
 
 
 
@@ -256,6 +301,33 @@ class WriteState {
    */
   int compress_and_write_tile_var(int attribute_id);
 
+  /**
+   * Records the hash of the coordinates of a written cell for the
+   * coordinates filter, inserting it into the filter once there are too many
+   * hashes to keep.
+   *
+   * @param hash The hash of the coordinates, see BloomFilter::hash_coords.
+   * @return void
+   */
+  void append_coords_hash(uint64_t hash);
+
+  /**
+   * Sends a filter of the coordinates written to the book-keeping, if they
+   * were hashed.
+   *
+   * @return void
+   */
+  void flush_coords_filter();
+
+  /**
+   * Appends the zone map of the current tile of an attribute to the
+   * book-keeping, if it summarizes any values, and starts a new one.
+   *
+   * @param attribute_id The id of the attribute.
+   * @return void
+   */
+  void flush_zone_map(int attribute_id);
+
   /**
    * Expands the current MBR with the input coordinates.
    *
@@ -342,7 +414,41 @@ class WriteState {
   template<class T>
   void update_book_keeping(const void* buffer, size_t buffer_size);
 
-  std::string construct_filename(int attribute_id, bool is_var);
+  /**
+   * Folds the cell values about to be written into the zone map of the
+   * current tile, flushing the zone map of every tile they complete. Only
+   * the fixed-sized numeric attributes of sparse fragments in the sectioned
+   * book-keeping layout have zone maps.
+   *
+   * @param attribute_id The id of the attribute.
+   * @param buffer The buffer storing the cell values.
+   * @param buffer_size The size (in bytes) of *buffer*.
+   * @return void
+   */
+  void update_zone_maps(
+      int attribute_id, 
+      const void* buffer, 
+      size_t buffer_size);
+
+  /**
+   * Folds the cell values about to be written into the zone map of the
+   * current tile, flushing the zone map of every tile they complete.
+   *
+   * @tparam T The attribute type.
+   * @param attribute_id The id of the attribute.
+   * @param values The cell values.
+   * @param value_num The number of values.
+   * @param empty The value marking an empty cell.
+   * @return void
+   */
+  template<class T>
+  void update_zone_maps(
+      int attribute_id, 
+      const T* values, 
+      int64_t value_num,
+      T empty);
+
+  std::string construct_filename(int attribute_id, bool is_var) const;
 
   /**
    * Set up memory buffers to cache bytes to be ultimately written out
@@ -367,6 +473,24 @@ class WriteState {
    */
   int write_segment(int attribute_id, bool is_var, const void *segment, size_t length);
 
+  /**
+   * Syncs an attribute file, through the write session if it holds the file
+   * open.
+   *
+   * @param filename The attribute file.
+   * @return TILEDB_UT_OK on success and TILEDB_UT_ERR on error.
+   */
+  int sync_file(const std::string& filename);
+
+  /**
+   * Sets the size hints of the write session to the sizes of the buffers of
+   * a write, as the files are expected to grow by as much again.
+   *
+   * @param buffer_sizes The sizes of the buffers passed to write().
+   * @return void
+   */
+  void set_write_session_size_hints(const size_t* buffer_sizes);
+
   /**
    * Takes the appropriate actions for writing the very last tile of this write
    * operation, such as updating the book-keeping structures, and compressing
@@ -88,6 +88,12 @@ class Metadata {
   /** Returns the array schema. */
   const ArraySchema* array_schema() const;
 
+  /**
+   * Returns *true* if finalize recorded a written fragment in the fragment
+   * manifest of the underlying array.
+   */
+  bool fragment_manifest_recorded() const;
+
   /**
    * Checks if a read operation for a particular attribute resulted in a
    * buffer overflow.
@@ -236,6 +242,8 @@ class Metadata {
    *    - TILEDB_METADATA_READ 
    */
   int mode_;
+  /** True once finalize recorded a fragment in the fragment manifest. */
+  bool fragment_manifest_recorded_;
 
 
 
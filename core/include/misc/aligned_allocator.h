@@ -0,0 +1,103 @@
+/**
+ * @file   aligned_allocator.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Allocator for std containers whose storage has to be aligned beyond what
+ * malloc guarantees, e.g. buffers for direct I/O.
+ */
+
+#ifndef __ALIGNED_ALLOCATOR_H__
+#define __ALIGNED_ALLOCATOR_H__
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * Allocates storage aligned to Alignment bytes, which must be a power of two
+ * and a multiple of sizeof(void*). Elements are default-initialized, so
+ * resizing a vector of a fundamental type does not zero the new storage.
+ */
+template<class T, size_t Alignment>
+class AlignedAllocator {
+ public:
+  typedef T value_type;
+
+  template<class U>
+  struct rebind {
+    typedef AlignedAllocator<U, Alignment> other;
+  };
+
+  AlignedAllocator() { }
+
+  template<class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) { }
+
+  T* allocate(size_t n) {
+    void* p = NULL;
+    if(posix_memalign(&p, Alignment, n*sizeof(T)))
+      throw std::bad_alloc();
+    return static_cast<T*>(p);
+  }
+
+  void deallocate(T* p, size_t) {
+    free(p);
+  }
+
+  template<class U>
+  void construct(U* p) {
+    ::new(static_cast<void*>(p)) U;
+  }
+
+  template<class U, class... Args>
+  void construct(U* p, Args&&... args) {
+    ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+};
+
+template<class T, class U, size_t Alignment>
+bool operator==(
+    const AlignedAllocator<T, Alignment>&,
+    const AlignedAllocator<U, Alignment>&) {
+  return true;
+}
+
+template<class T, class U, size_t Alignment>
+bool operator!=(
+    const AlignedAllocator<T, Alignment>&,
+    const AlignedAllocator<U, Alignment>&) {
+  return false;
+}
+
+/** A byte buffer aligned to Alignment bytes. */
+template<size_t Alignment>
+using AlignedBuffer = std::vector<char, AlignedAllocator<char, Alignment> >;
+
+#endif /* __ALIGNED_ALLOCATOR_H__ */
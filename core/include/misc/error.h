@@ -39,6 +39,19 @@
 #include <iostream>
 #include <string>
 
+/*
+ * Error messages are kept in one global string per module. The ones of the
+ * filesystems (tiledb_fs_errmsg), utils (tiledb_ut_errmsg), codecs
+ * (tiledb_cd_errmsg) and book-keeping (tiledb_bk_errmsg) are thread_local, as
+ * they are also set by the worker threads below, which hand them over to the
+ * calling thread on failure:
+ *    - the book-keeping load threads of StorageManager::array_load_book_keeping
+ *    - the background uploads of StorageBuffer
+ *    - the vectored read workers of HDFS::read_from_file_v
+ * These workers do not reach any other module, so the remaining messages are
+ * only ever set by the thread calling into the module.
+ */
+
 #ifdef TILEDB_VERBOSE
 #  define PRINT_ERROR(x) std::cerr << x << std::endl
 #else
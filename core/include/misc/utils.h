@@ -73,7 +73,7 @@
 /* ********************************* */
 
 /** Stores potential error messages. */
-extern std::string tiledb_ut_errmsg;
+extern thread_local std::string tiledb_ut_errmsg;
 
 
 /* ********************************* */
@@ -229,6 +229,13 @@ bool is_gcs_path(const std::string& pathURL);
  */
 bool is_hdfs_path(const std::string& pathURL);
 
+/**
+ * Checks if a given pathURL is on the simulated cloud filesystem.
+ * @param pathURL URL to path to be checked.
+ * @return true if pathURL starts with sim://
+ */
+bool is_sim_path(const std::string& pathURL);
+
 /**
  * Checks if the given environment variable is set to true(case ignored) or "1"
  * @param name environment variable name
@@ -236,6 +243,24 @@ bool is_hdfs_path(const std::string& pathURL);
  */
 bool is_env_set(const std::string& name);
 
+/**
+ * Returns the value of the given environment variable as an unsigned integer.
+ * @param name environment variable name
+ * @param default_value the value returned if the variable is not set or is not
+ *     a valid unsigned integer, which is reported
+ * @return the value of the environment variable, or default_value
+ */
+uint64_t get_env_uint64(const std::string& name, uint64_t default_value);
+
+/**
+ * Returns the value of the given environment variable as a double.
+ * @param name environment variable name
+ * @param default_value the value returned if the variable is not set or is not
+ *     a valid finite number, which is reported
+ * @return the value of the environment variable, or default_value
+ */
+double get_env_double(const std::string& name, double default_value);
+
 /**
  * Creates a new directory.
  *
@@ -267,7 +292,8 @@ int delete_file(StorageFS *fs, const std::string& filename);
 
 /**
  * Creates a special file to indicate that the input directory is a
- * TileDB fragment.
+ * TileDB fragment. The directory has to be synced for the file to be
+ * durable.
  *
  * @param fs The storage filesystem type in use. e.g. posix, hdfs, etc.
  * @param dir The name of the fragment directory where the file is created.
@@ -513,6 +539,21 @@ bool is_group(StorageFS *fs, const std::string& dir);
  */
 bool is_metadata(StorageFS *fs, const std::string& dir);
 
+/**
+ * Checks if two ranges overlap, i.e., if they share at least one cell.
+ *
+ * @tparam The domain type
+ * @param range_A The first range.
+ * @param range_B The second range.
+ * @param dim_num The number of dimensions.
+ * @return True if range_A and range_B overlap. 
+ */
+template<class T>
+bool is_overlapping(
+    const T* range_A, 
+    const T* range_B, 
+    int dim_num);
+
 /** Returns *true* if the input string is a positive (>0) integer number. */
 bool is_positive_integer(const char* s);
 
@@ -859,6 +900,16 @@ bool starts_with(const std::string& value, const std::string& prefix);
  */
 int sync_path(StorageFS *fs, const std::string& path);
 
+/** 
+ * Syncs a batch of files or directories, which may be synced concurrently.
+ * Paths that do not exist are ignored.
+ *
+ * @param fs The storage filesystem type in use. e.g. posix, hdfs, etc.
+ * @param paths The files/directories to sync.
+ * @return TILEDB_UT_OK on success, and TILEDB_UT_ERR on error.
+ */
+int sync_paths(StorageFS *fs, const std::vector<std::string>& paths);
+
 /** 
  * Closes any open file handles associated with a file. If the file does not exist,
  * or if there are no open file handles it is a noop).
@@ -890,13 +941,17 @@ int write_to_file(StorageFS *fs,
  * @param filename The name of the file.
  * @param buffer The input buffer.
  * @param buffer_size The size of the input buffer.
+ * @param compression The compression type, only TILEDB_GZIP is supported.
+ * @param sync If false, the file is closed without being synced, for callers
+ *     that sync it later together with other files.
  * @return TILEDB_UT_OK on success, and TILEDB_UT_ERR on error.
  */
 int write_to_file_after_compression(StorageFS *fs,
                                     const std::string& filename,
                                     const void* buffer,
                                     size_t buffer_size,
-                                    const int compression);
+                                    const int compression,
+                                    bool sync=true);
 
 
 /** 
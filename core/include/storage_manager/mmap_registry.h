@@ -0,0 +1,103 @@
+/**
+ * @file mmap_registry.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class MMapRegistry, which maps each attribute file read
+ * with TILEDB_IO_MMAP once and shares the mapping among all the read states
+ * of the arrays opened through a StorageManager.
+ */
+
+#ifndef __MMAP_REGISTRY_H__
+#define __MMAP_REGISTRY_H__
+
+#include "storage_fs.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+
+/** A whole file mapped read-only, it is unmapped with the last reference. */
+class MappedFile {
+ public:
+  MappedFile(void* addr, size_t size, dev_t dev, ino_t ino, time_t mtime);
+  ~MappedFile();
+
+  /** Returns the start of the mapping, NULL for an empty file. */
+  const char* data() const;
+
+  /** Returns the size of the mapped file. */
+  size_t size() const;
+
+  /**
+   * Hints how a byte range of the mapping is going to be accessed with
+   * madvise, one of the TILEDB_FS_ACCESS_* values. A length of 0 extends the
+   * range to the end of the file.
+   *
+   * @return TILEDB_FS_OK for success, and TILEDB_FS_ERR for error.
+   */
+  int advise(off_t offset, size_t length, int advice);
+
+  /** Returns true if the mapping is of the file with the given attributes. */
+  bool is_same_file(size_t size, dev_t dev, ino_t ino, time_t mtime) const;
+
+ private:
+  void* addr_;
+  size_t size_;
+  dev_t dev_;
+  ino_t ino_;
+  time_t mtime_;
+};
+
+class MMapRegistry {
+ public:
+  /**
+   * Returns the mapping of the whole file, which is shared with the other
+   * holders of the file unless it was replaced or modified since.
+   *
+   * @param filename The local file to map.
+   * @return The mapping, NULL if the file could not be opened or mapped.
+   */
+  std::shared_ptr<MappedFile> acquire(const std::string& filename);
+
+  /** Returns the number of files currently mapped. */
+  size_t mapped_files();
+
+  /** Returns the number of times a file had to be mapped. */
+  size_t maps();
+
+ private:
+  std::mutex mtx_;
+  size_t maps_ = 0;
+  /** Expired entries are pruned once the map grows to this size. */
+  size_t prune_size_ = 64;
+  std::unordered_map<std::string, std::weak_ptr<MappedFile>> files_;
+};
+
+#endif /* __MMAP_REGISTRY_H__ */
@@ -72,6 +72,8 @@ class AzureBlob : public StorageFS {
 
   int read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length);
   int write_to_file(const std::string& filename, const void *buffer, size_t buffer_size);
+
+  int read_from_file_v(const std::vector<StorageFSRead>& reads);
   
   int move_path(const std::string& old_path, const std::string& new_path);
     
@@ -95,6 +97,10 @@ class AzureBlob : public StorageFS {
 
   std::vector<std::pair<std::string, std::string>> empty_metadata;
 
+  // Sizes of the files being read, looked up once until the file is closed
+  std::mutex read_size_map_mtx_;
+  std::unordered_map<std::string, ssize_t> read_size_map_;
+
  private:
   struct membuf: std::streambuf {
     membuf(const void *buffer, size_t buffer_size, std::ios_base::openmode mode = std::ios_base::in) {
@@ -142,6 +148,9 @@ class AzureBlob : public StorageFS {
 
   std::string get_path(const std::string& path);
 
+  ssize_t read_file_size(const std::string& filename);
+  void forget_file_size(const std::string& filename);
+
   int commit_file(const std::string& filename);
 
   std::vector<std::string> generate_block_ids(const std::string& path, int num_blocks) {
@@ -35,31 +35,108 @@
 #include "buffer.h"
 #include "storage_fs.h"
 
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 class StorageBuffer : public Buffer {
  public:
-  StorageBuffer(StorageFS *fs, const std::string& filename, bool is_read=false) {
+  /**
+   * Constructor.
+   * @param fs The filesystem holding the file.
+   * @param filename The file to buffer reads from or writes to.
+   * @param is_read True for read-only buffers.
+   * @param file_size The size of the file if already known to the caller,
+   *     otherwise it is looked up once on the first read.
+   */
+  StorageBuffer(StorageFS *fs, const std::string& filename, bool is_read=false, ssize_t file_size=-1) {
     fs_ = fs;
     filename_ = filename;
     read_only_ = is_read;
+    file_size_ = file_size;
   }
 
+  /** Destructor. Waits for any outstanding uploads. */
+  ~StorageBuffer();
+
   /**
-   * Reads the data from the cached buffer from the offset into bytes.
+   * Reads the data from the cached buffer from the offset into bytes. The file
+   * is downloaded in blocks of the filesystem download_buffer_size, blocks
+   * not cached yet are fetched together and up to download_cache_size bytes
+   * of them are kept for subsequent reads, evicting least recently used
+   * blocks first.
    * @param offset The offset from which the data in the buffer will be read from.
    * @param bytes The buffer into which the data will be written.
    * @param length The size of the data to be read from the cached buffer.
    */
   int read_buffer(off_t offset, void *bytes, size_t size);
 
+  /**
+   * Reads a batch of ranges, each from the file of the buffer at the same
+   * position, e.g. the tiles of several attributes. Blocks cached by the
+   * buffers are used as is and the missing blocks of all the buffers are
+   * downloaded together with one vectored read of the filesystem.
+   * @param buffers The read buffers of the files of the ranges.
+   * @param reads The ranges, into their buffers.
+   */
+  static int read_buffers_v(const std::vector<StorageBuffer *>& buffers, const std::vector<StorageFSRead>& reads);
+
+  /** Returns the number of blocks currently cached for reads. */
+  size_t cached_blocks() const;
+
+  /**
+   * Appends bytes to the buffer, uploading the buffer to the file once it
+   * exceeds the filesystem upload_buffer_size. With a non-zero
+   * upload_queue_depth, full buffers are uploaded in the background in order
+   * while appends continue into a fresh buffer.
+   * @param bytes The bytes to append.
+   * @param size The number of bytes to append.
+   */
   int append_buffer(const void *bytes, size_t size);
 
+  /**
+   * Uploads any remaining bytes, waits for the outstanding uploads and closes
+   * the file. Returns TILEDB_BF_ERR if any of the uploads failed.
+   */
   int finalize();
   
  private:
   int write_buffer();
+  int wait_for_uploads(size_t max_pending);
+
+  // Adds the blocks spanned by a read that are not cached yet to the cache
+  // and appends their downloads to reads
+  int add_missing_blocks(off_t offset, size_t size, std::vector<StorageFSRead>& reads);
+  // Removes the blocks of failed downloads from the cache
+  void drop_blocks(const std::vector<StorageFSRead>& reads);
+  // Copies a read from cached blocks
+  void copy_blocks(off_t offset, void *bytes, size_t size);
+  // Evicts least recently used blocks over the download cache size
+  void evict_blocks();
   
   StorageFS *fs_ = NULL;
   std::string filename_;
-  uint32_t num_blocks_ = 0;
-  std::vector<bool> blocks_read_;
+  ssize_t file_size_ = -1;
+
+  // Cached blocks by block index, most recently used at the front
+  typedef std::list<std::pair<size_t, std::vector<char>>> block_list_t;
+  block_list_t blocks_lru_;
+  std::unordered_map<size_t, block_list_t::iterator> blocks_;
+
+  // Background uploads in the order they were issued
+  typedef struct StorageBufferUpload {
+    void *buffer;
+    size_t allocated_size;
+    std::shared_future<int> result;
+    // Error message of a failed upload, set from the background thread
+    std::shared_ptr<std::string> errmsg;
+  } StorageBufferUpload;
+  std::deque<StorageBufferUpload> uploads_;
+  // Buffers of completed uploads, reused for appends
+  std::vector<std::pair<void *, size_t>> spare_buffers_;
+  int upload_rc_ = TILEDB_BF_OK;
 };
@@ -47,6 +47,15 @@
 #define TILEDB_FS_ERR       -1
 /**@}*/
 
+/**@{*/
+/** Expected access to a file, see StorageFS::advise_file(). */
+#define TILEDB_FS_ACCESS_NORMAL       0
+#define TILEDB_FS_ACCESS_SEQUENTIAL   1
+#define TILEDB_FS_ACCESS_RANDOM       2
+#define TILEDB_FS_ACCESS_WILLNEED     3
+#define TILEDB_FS_ACCESS_DONTNEED     4
+/**@}*/
+
 /** Default error message. */
 #define TILEDB_FS_ERRMSG std::string("[TileDB::FileSystem] Error: ")
 
@@ -55,7 +64,15 @@
 /* ********************************* */
 
 /** Stores potential error messages. */
-extern std::string tiledb_fs_errmsg;
+extern thread_local std::string tiledb_fs_errmsg;
+
+/** A read of length bytes at offset of filename into buffer. */
+typedef struct StorageFSRead {
+  std::string filename;
+  off_t offset;
+  void *buffer;
+  size_t length;
+} StorageFSRead;
 
 /** Base Class for Filesystems */
 class StorageFS {
@@ -83,14 +100,34 @@ class StorageFS {
   virtual int read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length) = 0;
   virtual int write_to_file(const std::string& filename, const void *buffer, size_t buffer_size) = 0;
 
+  /**
+   * Vectored read of a batch of byte ranges, possibly from different files.
+   * Filesystems should override this to issue the reads concurrently, the
+   * default implementation calls read_from_file for each range in turn.
+   */
+  virtual int read_from_file_v(const std::vector<StorageFSRead>& reads);
+
   virtual int move_path(const std::string& old_path, const std::string& new_path) = 0;
     
   virtual int sync_path(const std::string& path) = 0;
 
+  /**
+   * Syncs a batch of paths, e.g. all the files of a fragment at commit. The
+   * default implementation syncs them one at a time with sync_path().
+   */
+  virtual int sync_paths(const std::vector<std::string>& paths);
+
   virtual int close_file(const std::string& filename);
 
   virtual bool locking_support();
 
+  /**
+   * Hints how a byte range of a file is going to be accessed, one of the
+   * TILEDB_FS_ACCESS_* values. A length of 0 extends the range to the end of
+   * the file. The default implementation ignores the hint.
+   */
+  virtual int advise_file(const std::string& filename, off_t offset, size_t length, int advice);
+
   size_t get_download_buffer_size() {
     auto env_var = getenv("TILEDB_DOWNLOAD_BUFFER_SIZE");
     if (env_var) {
@@ -100,6 +137,13 @@ class StorageFS {
     }
   }
   
+  /**
+   * Maximum bytes of download_buffer_size blocks cached for random access
+   * reads of each file. Overridden with env TILEDB_DOWNLOAD_CACHE_SIZE, see
+   * override_tuning_from_env.
+   */
+  size_t get_download_cache_size();
+
   size_t get_upload_buffer_size() {
     auto env_var = getenv("TILEDB_UPLOAD_BUFFER_SIZE");
     if (env_var) {
@@ -109,6 +153,27 @@ class StorageFS {
     }
   }
 
+  /**
+   * Number of full upload buffers handed to background uploads that may be
+   * in flight per file while the writer keeps filling a fresh buffer, 0 for
+   * synchronous uploads. Overridden with env TILEDB_UPLOAD_QUEUE_DEPTH, see
+   * override_tuning_from_env.
+   */
+  size_t get_upload_queue_depth();
+
+  /**
+   * Tile reads that are at most this many bytes apart are coalesced into one
+   * read. Overridden with env TILEDB_COALESCE_MAX_GAP, see 
+   * override_tuning_from_env.
+   */
+  size_t get_coalesce_max_gap();
+
+  /**
+   * Maximum size of a coalesced read, 0 disables coalescing. Overridden with
+   * env TILEDB_COALESCE_MAX_SIZE, see override_tuning_from_env.
+   */
+  size_t get_coalesce_max_size();
+
   std::string slashify(const std::string& path) const {
     if (path.empty()) {
       return "/";
@@ -128,8 +193,19 @@ class StorageFS {
   }
 
  protected:
+  /**
+   * Overrides the tuning of the filesystem with the env vars documented by
+   * the getters. Called once by the constructors of the filesystems after
+   * they set their defaults, so that invalid values are reported once.
+   */
+  void override_tuning_from_env();
+
   size_t download_buffer_size_ = 0;
+  size_t download_cache_size_ = 64*1024*1024; // 64M
   size_t upload_buffer_size_ = 0;
+  size_t upload_queue_depth_ = 0;
+  size_t coalesce_max_gap_ = 0;
+  size_t coalesce_max_size_ = 0;
 };
 
 #endif /* __STORAGE_FS_H__ */
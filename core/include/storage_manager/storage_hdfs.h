@@ -71,6 +71,8 @@ class HDFS : public StorageFS {
 
   int read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length);
   int write_to_file(const std::string& filename, const void *buffer, size_t buffer_size);
+
+  int read_from_file_v(const std::vector<StorageFSRead>& reads);
   
   int move_path(const std::string& old_path, const std::string& new_path);
     
@@ -85,6 +87,12 @@ class HDFS : public StorageFS {
   std::mutex read_map_mtx_, write_map_mtx_;
   std::unordered_map<std::string, hdfsFile> read_map_, write_map_;
   std::unordered_map<std::string, int> read_count_;
+  // Sizes of the files being read, looked up once until the file is closed
+  std::unordered_map<std::string, ssize_t> read_size_map_;
+
+  ssize_t read_file_size(const std::string& filename);
+  // Drops the cached sizes of path and of all the files under it
+  void forget_file_size(const std::string& path);
 };
 
 #endif /* USE_HDFS */
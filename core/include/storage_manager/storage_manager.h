@@ -38,10 +38,13 @@
 #include "array_iterator.h"
 #include "array_schema.h"
 #include "array_schema_c.h"
+#include "fragment_manifest.h"
 #include "metadata.h"
 #include "metadata_iterator.h"
 #include "metadata_schema_c.h"
 #include "storage_manager_config.h"
+#include "mmap_registry.h"
+#include "tile_cache.h"
 #include <map>
 #ifdef HAVE_OPENMP
   #include <omp.h>
@@ -68,6 +71,12 @@
 /** Name of the consolidation file lock. */
 #define TILEDB_SM_CONSOLIDATION_FILELOCK_NAME   ".__consolidation_lock"
 
+/**
+ * Maximum number of threads loading fragment book-keeping when opening an
+ * array, overridden with env TILEDB_BOOK_KEEPING_LOAD_THREADS.
+ */
+#define TILEDB_SM_BOOK_KEEPING_LOAD_THREADS                          16
+
 /** Default error message. */
 #define TILEDB_SM_ERRMSG std::string("[TileDB::StorageManager] Error: ")
 
@@ -136,6 +145,18 @@ class StorageManager {
    */
   StorageManagerConfig* get_config();
 
+  /**
+   * Returns the cache of decompressed tiles shared by all the arrays of the
+   * storage manager, NULL if tile caching is disabled.
+   */
+  TileCache* tile_cache() const;
+
+  /**
+   * Returns the attribute files mapped for the arrays of the storage manager,
+   * NULL unless the read method is TILEDB_IO_MMAP.
+   */
+  MMapRegistry* mmap_registry() const;
+
 
   /* ********************************* */
   /*            WORKSPACE              */
@@ -557,6 +578,10 @@ class StorageManager {
   StorageManagerConfig* config_;
   /** The Filesystem associated with this configuration */
   StorageFS* fs_;
+  /** The decompressed tile cache, NULL if disabled. */
+  TileCache* tile_cache_;
+  /** The shared whole file mappings, NULL unless reading with mmap. */
+  MMapRegistry* mmap_registry_;
   /** OpneMP mutex for creating/deleting an OpenArray object. */
 #ifdef HAVE_OPENMP
   omp_lock_t open_array_omp_mtx_;
@@ -597,15 +622,33 @@ class StorageManager {
    */
   int array_delete(const std::string& array) const;
 
+  /**
+   * Folds the shards of the fragment manifest of an array into the manifest
+   * file once there are more than TILEDB_FM_MAX_SHARD_NUM of them, or env
+   * TILEDB_FRAGMENT_MANIFEST_MAX_SHARDS if set, holding the consolidation
+   * lock shared. Errors are not reported, as the written fragments are
+   * committed already. Only called once finalize recorded a fragment in the
+   * manifest, so that arrays without one take no extra requests.
+   *
+   * @param array The array or metadata directory.
+   * @return void
+   */
+  void array_fold_fragment_manifest(const std::string& array);
+
   /** 
-   * Gets the names of the existing fragments of an array.
+   * Gets the names of the existing fragments of an array. The directories
+   * listed in the fragment manifest are taken as fragments, the fragment file
+   * is only checked for the others.
    *
    * @param array The input array.
+   * @param manifest The fragment manifest of the array, loaded for the listed
+   *     directories.
    * @param fragment_names The fragment names to be returned.
    * @return void
    */
   void array_get_fragment_names(
       const std::string& array,
+      FragmentManifest& manifest,
       std::vector<std::string>& fragment_names);
 
   /**
@@ -625,10 +668,16 @@ class StorageManager {
 
   /**
    * Loads the book-keeping structures of all the fragments of an array from the
-   * disk, allocating appropriate memory space for them.
+   * disk, allocating appropriate memory space for them. The fragments are
+   * loaded in parallel by up to TILEDB_SM_BOOK_KEEPING_LOAD_THREADS threads,
+   * so that the per-file latency of cloud stores is paid concurrently. The
+   * fragments in the fragment manifest are loaded from it instead, falling
+   * back to the fragment files if an entry cannot be loaded. On error, no
+   * book-keeping structures are returned.
    *
    * @param array_schema The array schema.
    * @param fragment_names The names of the fragments of the array.
+   * @param manifest The fragment manifest of the array, possibly empty.
    * @param book_keeping The book-keeping structures to be returned.
    * @param mode The array mode
    * @return TILEDB_SM_OK for success, and TILEDB_SM_ERR for error.
@@ -636,6 +685,7 @@ class StorageManager {
   int array_load_book_keeping(
       const ArraySchema* array_schema,
       const std::vector<std::string>& fragment_names,
+      const FragmentManifest& manifest,
       std::vector<BookKeeping*>& book_keeping,
       int mode);
 
@@ -734,6 +784,17 @@ class StorageManager {
       Fragment* new_fragment, 
       const std::vector<std::string>& old_fragment_names);
 
+  /**
+   * Drops the files of the consolidated fragments from the page cache, so
+   * that they do not linger while other readers still hold them open and
+   * evict the pages of interactive queries instead. Best effort, errors are
+   * ignored.
+   *
+   * @param old_fragment_names The names of the consolidated fragments.
+   */
+  void consolidation_drop_cache(
+      const std::vector<std::string>& old_fragment_names) const;
+
   /**
    * Creates a special group file inside the group directory.
    *
@@ -101,6 +101,8 @@ class StorageManagerConfig {
    *          TileDB will use mmap.
    *        - TILEDB_IO_MPI
    *          TileDB will use MPI-IO read. 
+   *        - TILEDB_IO_URING
+   *          TileDB will use batched io_uring reads.
    * @param write_method The method for writing data to a file. 
    *     It can be one of the following: 
    *        - TILEDB_IO_WRITE
@@ -108,6 +110,15 @@ class StorageManagerConfig {
    *        - TILEDB_IO_MPI
    *          TileDB will use MPI-IO write.
    * @param enable_shared_posixfs_optimizations in POSIX fs if set
+   * @param tile_cache_size The size in bytes of the cache of decompressed 
+   *     tiles shared by all arrays, 0 disables the cache.
+   * @param coords_filter_false_positive_rate The false-positive rate of the
+   *     coordinates filters of new sparse fragments in the sectioned 
+   *     book-keeping layout, 0 for the default.
+   * @param coords_filter_max_size The maximum size in bytes of the 
+   *     coordinates filter of a new sparse fragment, 0 for the default.
+   * @param enable_book_keeping_sections If set, new fragments get the 
+   *     sectioned book-keeping layout.
    * @return void. 
    */
   int init(
@@ -115,7 +126,11 @@ class StorageManagerConfig {
       MPI_Comm* mpi_comm,
       int read_method,
       int write_methods,
-      const bool enable_shared_posixfs_optimizations);
+      const bool enable_shared_posixfs_optimizations,
+      size_t tile_cache_size=0,
+      double coords_filter_false_positive_rate=0,
+      size_t coords_filter_max_size=0,
+      bool enable_book_keeping_sections=false);
 #else
   /**
    * Initializes the configuration parameters.
@@ -129,6 +144,8 @@ class StorageManagerConfig {
    *          TileDB will use mmap.
    *        - TILEDB_IO_MPI
    *          TileDB will use MPI-IO read. 
+   *        - TILEDB_IO_URING
+   *          TileDB will use batched io_uring reads.
    * @param write_method The method for writing data to a file. 
    *     It can be one of the following: 
    *        - TILEDB_IO_WRITE
@@ -136,13 +153,26 @@ class StorageManagerConfig {
    *        - TILEDB_IO_MPI
    *          TileDB will use MPI-IO write.
    * @param enable_shared_posixfs_optimizations if set
+   * @param tile_cache_size The size in bytes of the cache of decompressed 
+   *     tiles shared by all arrays, 0 disables the cache.
+   * @param coords_filter_false_positive_rate The false-positive rate of the
+   *     coordinates filters of new sparse fragments in the sectioned 
+   *     book-keeping layout, 0 for the default.
+   * @param coords_filter_max_size The maximum size in bytes of the 
+   *     coordinates filter of a new sparse fragment, 0 for the default.
+   * @param enable_book_keeping_sections If set, new fragments get the 
+   *     sectioned book-keeping layout.
    * @return void. 
    */
   int init(
       const char* home,
       int read_method,
       int write_method,
-      const bool enable_shared_posixfs_optimizations);
+      const bool enable_shared_posixfs_optimizations,
+      size_t tile_cache_size=0,
+      double coords_filter_false_positive_rate=0,
+      size_t coords_filter_max_size=0,
+      bool enable_book_keeping_sections=false);
 #endif
  
   /* ********************************* */
@@ -165,6 +195,27 @@ class StorageManagerConfig {
 
   /** Returns the supporting filesystem */
   StorageFS* get_filesystem() const;
+
+  /** Returns the size in bytes of the shared decompressed tile cache. */
+  size_t tile_cache_size() const;
+
+  /** 
+   * Returns the false-positive rate of the coordinates filters of new sparse
+   * fragments, 0 for the default.
+   */
+  double coords_filter_false_positive_rate() const;
+
+  /** 
+   * Returns the maximum size in bytes of the coordinates filter of a new 
+   * sparse fragment, 0 for the default.
+   */
+  size_t coords_filter_max_size() const;
+
+  /**
+   * Returns true if new fragments get the sectioned book-keeping layout, 
+   * also set with env TILEDB_BOOK_KEEPING_SECTIONS.
+   */
+  bool book_keeping_sections() const;
   
  private:
   /* ********************************* */
@@ -186,6 +237,8 @@ class StorageManagerConfig {
    *      TileDB will use mmap.
    *    - TILEDB_IO_MPI
    *      TileDB will use MPI-IO read. 
+   *    - TILEDB_IO_URING
+   *      TileDB will use batched io_uring reads.
    */
   int read_method_;
   /** 
@@ -197,6 +250,23 @@ class StorageManagerConfig {
    *      TileDB will use MPI-IO write. 
    */
   int write_method_;
+  /** 
+   * The size in bytes of the cache of decompressed tiles shared by all 
+   * arrays, 0 if disabled.
+   */
+  size_t tile_cache_size_;
+  /** 
+   * The false-positive rate of the coordinates filters of new sparse 
+   * fragments, 0 for the default.
+   */
+  double coords_filter_false_positive_rate_;
+  /** 
+   * The maximum size in bytes of the coordinates filter of a new sparse 
+   * fragment, 0 for the default.
+   */
+  size_t coords_filter_max_size_;
+  /** True if new fragments get the sectioned book-keeping layout. */
+  bool enable_book_keeping_sections_;
 
   /** The Filesystem type associated with this configuration */
   StorageFS *fs_ = NULL;
@@ -35,12 +35,30 @@
 #define  __STORAGE_POSIXFS_H__
 
 #include "storage_fs.h"
+#include "storage_uring.h"
 
+#include <atomic>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 
+/** Default maximum number of file descriptors cached for reads. */
+#define TILEDB_MAX_OPEN_READ_FILES 128
+
+/** Maximum number of threads syncing a batch of paths. */
+#define TILEDB_SYNC_PATHS_THREADS 8
+
+/** Offset, length and memory alignment required for direct I/O. */
+#define TILEDB_DIRECT_IO_ALIGNMENT 4096
+/** Default minimum size of reads/writes performed with direct I/O. */
+#define TILEDB_DIRECT_IO_MIN_SIZE 1048576
+/** Size of the aligned buffers used to stage direct I/O. */
+#define TILEDB_DIRECT_IO_CHUNK_SIZE 8388608
+
 class PosixFS : public StorageFS {
  public:
+  PosixFS();
   ~PosixFS();
 
   std::string current_dir();
@@ -63,15 +81,38 @@ class PosixFS : public StorageFS {
 
   int read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length);
   int write_to_file(const std::string& filename, const void *buffer, size_t buffer_size);
+
+  /**
+   * The reads are submitted together with io_uring where supported and are
+   * issued one at a time with pread otherwise.
+   */
+  int read_from_file_v(const std::vector<StorageFSRead>& reads);
+
+  /** Returns the number of reads read_from_file_v completed through io_uring. */
+  uint64_t uring_read_num() const;
   
   int move_path(const std::string& old_path, const std::string& new_path);
     
   int sync_path(const std::string& path);
 
+  /**
+   * Issues fdatasync for files and fsync for directories from up to
+   * TILEDB_SYNC_PATHS_THREADS threads, so the device can service the
+   * flushes together.
+   */
+  int sync_paths(const std::vector<std::string>& paths);
+
   bool locking_support();
 
   int close_file(const std::string& filename);
 
+  /**
+   * Issues posix_fadvise on the cached read descriptor of the file. Access
+   * pattern hints only last while the descriptor stays cached, see
+   * set_max_open_read_files().
+   */
+  int advise_file(const std::string& filename, off_t offset, size_t length, int advice);
+
   void set_keep_write_file_handles_open(const bool val);
 
   bool keep_write_file_handles_open();
@@ -80,6 +121,48 @@ class PosixFS : public StorageFS {
 
   bool disable_file_locking();
 
+  /**
+   * Sets the maximum number of read-only file descriptors kept open across
+   * read_from_file calls, least recently used ones are closed first. A value
+   * of 0 disables caching. The default can also be set with the env
+   * TILEDB_MAX_OPEN_READ_FILES.
+   */
+  void set_max_open_read_files(const size_t val);
+
+  size_t max_open_read_files();
+
+  /** Returns the number of read-only file descriptors currently cached. */
+  size_t open_read_files();
+
+  /**
+   * Enables direct I/O (O_DIRECT) for reads and writes of at least
+   * direct_io_min_size() bytes, so bulk transfers like consolidation and
+   * ingestion bypass the page cache. The aligned part of each transfer is
+   * staged through aligned buffers, unaligned heads/tails of writes are
+   * buffered. Falls back to buffered I/O where O_DIRECT is not supported.
+   * Can also be enabled with the env TILEDB_DIRECT_IO.
+   */
+  void set_direct_io(const bool val);
+
+  bool direct_io();
+
+  /**
+   * Sets the minimum size of reads/writes performed with direct I/O. The
+   * default can also be set with the env TILEDB_DIRECT_IO_MIN_SIZE.
+   */
+  void set_direct_io_min_size(const size_t val);
+
+  size_t direct_io_min_size();
+
+  /**
+   * Returns true if fragments should be written through a WriteSession, i.e.
+   * with one preallocated file descriptor per file synced once at the end.
+   * Enabled by default, except with settings meant for shared filesystems
+   * (disabled file locking or keep write file handles open) and with direct
+   * I/O. Can be disabled with the env TILEDB_DISABLE_WRITE_SESSIONS.
+   */
+  bool write_sessions();
+
   private:
   std::mutex write_map_mtx_;
   std::unordered_map<std::string, int> write_map_;
@@ -90,7 +173,32 @@ class PosixFS : public StorageFS {
   bool is_disable_file_locking_set = false;
   bool disable_file_locking_ = false;
 
+  bool direct_io_ = false;
+  size_t direct_io_min_size_ = TILEDB_DIRECT_IO_MIN_SIZE;
+
+  // LRU of read-only file descriptors, most recently used at the front. The
+  // descriptors are shared so that an eviction never closes an fd still being
+  // read from by another thread.
+  typedef std::list<std::pair<std::string, std::shared_ptr<int>>> read_fd_list_t;
+  std::mutex read_map_mtx_;
+  read_fd_list_t read_fd_lru_;
+  std::unordered_map<std::string, read_fd_list_t::iterator> read_map_;
+
+  size_t max_open_read_files_ = TILEDB_MAX_OPEN_READ_FILES;
+
+  std::shared_ptr<int> get_read_fd(const std::string& filename);
+  void release_read_fd(const std::string& filename);
+  void release_all_read_fds();
+  void trim_read_fds();
+
+  // Idle io_uring instances, each batch of reads checks one out
+  std::mutex uring_mtx_;
+  std::vector<URing *> urings_;
+  std::atomic<uint64_t> uring_read_num_{0};
+
   int write_to_file_keep_file_handles_open(const std::string& filename, const void *buffer, size_t buffer_size);
+  int write_to_file_fd(int fd, const std::string& filename, const void *buffer, size_t buffer_size);
+  int read_from_file_direct(const std::string& filename, off_t offset, void *buffer, size_t length);
 };
 
 #endif /* __STORAGE_POSIXFS_H__ */
@@ -0,0 +1,127 @@
+/**
+ * @file storage_sim.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * SimFS stores files locally like PosixFS but makes every request pay a
+ * configurable latency and bandwidth cost, so that cloud access patterns can
+ * be benchmarked without a cloud account. Homes are specified as
+ * sim:///absolute/path and the costs are set with the environment variables
+ *   TILEDB_SIM_LATENCY_US - microseconds added to every request.
+ *   TILEDB_SIM_BANDWIDTH - bytes per second for reads and writes, 0 for no limit.
+ *   TILEDB_SIM_CONCURRENCY - number of ranges of a read_from_file_v batch in
+ *                            flight together, sharing the latency.
+ */
+
+#ifndef __STORAGE_SIM_H__
+#define  __STORAGE_SIM_H__
+
+#include "storage_fs.h"
+#include "storage_posixfs.h"
+
+#include <string>
+
+/** Default latency in microseconds of every simulated request. */
+#define TILEDB_SIM_LATENCY_US 10000 // 10ms
+/** Default bandwidth in bytes per second of simulated transfers. */
+#define TILEDB_SIM_BANDWIDTH 100*1024*1024 // 100MB/s
+/** Default number of ranges in flight for batched reads. */
+#define TILEDB_SIM_CONCURRENCY 16
+
+/** Requests issued to all SimFS instances in this process. */
+typedef struct SimFSStats {
+  size_t metadata_requests;
+  size_t read_requests;
+  size_t write_requests;
+  size_t bytes_read;
+  size_t bytes_written;
+} SimFSStats;
+
+class SimFS : public StorageFS {
+ public:
+  /**
+   * Constructor. Throws std::system_error if home is not a sim:// URL or
+   * if the local directory it maps to does not exist.
+   *
+   * @param home sim:// URL of the home directory, e.g. sim:///tmp/ws.
+   */
+  SimFS(const std::string& home);
+
+  std::string current_dir();
+  int set_working_dir(const std::string& dir);
+
+  bool is_dir(const std::string& dir);
+  bool is_file(const std::string& file);
+  std::string real_dir(const std::string& dir);
+
+  int create_dir(const std::string& dir);
+  int delete_dir(const std::string& dir);
+
+  std::vector<std::string> get_dirs(const std::string& dir);
+  std::vector<std::string> get_files(const std::string& dir);
+
+  int create_file(const std::string& filename, int flags, mode_t mode);
+  int delete_file(const std::string& filename);
+
+  ssize_t file_size(const std::string& filename);
+
+  int read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length);
+  int write_to_file(const std::string& filename, const void *buffer, size_t buffer_size);
+
+  /**
+   * Ranges are issued TILEDB_SIM_CONCURRENCY at a time, each such round
+   * pays the latency once like the concurrent ranged downloads of AzureBlob.
+   */
+  int read_from_file_v(const std::vector<StorageFSRead>& reads);
+
+  int move_path(const std::string& old_path, const std::string& new_path);
+
+  int sync_path(const std::string& path);
+
+  int close_file(const std::string& filename);
+
+  /** Returns the requests accounted by all SimFS instances so far. */
+  static SimFSStats stats();
+
+  /** Resets the accounting of all SimFS instances. */
+  static void reset_stats();
+
+ private:
+  PosixFS fs_;
+  std::string working_dir_;
+  size_t latency_us_;
+  size_t bandwidth_;
+  size_t concurrency_;
+
+  /** Maps a sim:// URL or a path relative to the working dir to a local path. */
+  std::string get_path(const std::string& path);
+
+  /** Sleeps for rounds latencies and the transfer time of length bytes. */
+  void delay(size_t rounds, size_t length);
+};
+
+#endif /* __STORAGE_SIM_H__ */
@@ -0,0 +1,159 @@
+/**
+ * @file storage_spill_cache.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * SpillCacheFS is a StorageFS decorator that keeps the byte ranges read from
+ * a cloud filesystem in a local directory, so that reopening arrays does not
+ * fetch the same compressed tiles over the network again.
+ *
+ * Cached ranges are validated only against the size of their file, not
+ * against an etag or modification time. Writes, moves and deletes through
+ * this filesystem drop the cached ranges of the file, but a file rewritten
+ * with the same size by another process is served stale from the cache. This
+ * is safe for fragment files, which are never rewritten once committed.
+ */
+
+#ifndef __STORAGE_SPILL_CACHE_H__
+#define  __STORAGE_SPILL_CACHE_H__
+
+#include "storage_fs.h"
+#include "storage_posixfs.h"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/** Default byte budget of the local spill cache. */
+#define TILEDB_SPILL_CACHE_SIZE 1073741824 // 1GB
+
+class SpillCacheFS : public StorageFS {
+ public:
+  /**
+   * Constructor. Cached ranges found in cache_dir from previous runs are
+   * reused, the directory is created if it does not exist. Throws
+   * std::system_error if the cache directory cannot be setup.
+   *
+   * @param fs The filesystem to cache reads from, owned by SpillCacheFS once
+   * constructed. It is left to the caller if the constructor throws.
+   * @param cache_dir A local directory to store the cached ranges in.
+   * @param max_size The maximum number of bytes kept in cache_dir, least
+   * recently used ranges are evicted first.
+   */
+  SpillCacheFS(StorageFS* fs, const std::string& cache_dir, size_t max_size=TILEDB_SPILL_CACHE_SIZE);
+  ~SpillCacheFS();
+
+  std::string current_dir();
+  int set_working_dir(const std::string& dir);
+
+  bool is_dir(const std::string& dir);
+  bool is_file(const std::string& file);
+  std::string real_dir(const std::string& dir);
+
+  int create_dir(const std::string& dir);
+  int delete_dir(const std::string& dir);
+
+  std::vector<std::string> get_dirs(const std::string& dir);
+  std::vector<std::string> get_files(const std::string& dir);
+
+  int create_file(const std::string& filename, int flags, mode_t mode);
+  int delete_file(const std::string& filename);
+
+  ssize_t file_size(const std::string& filename);
+
+  /**
+   * Served from the cache if the range was read before and the file size is
+   * unchanged, otherwise read from the wrapped filesystem and cached. The
+   * file size is fetched from the wrapped filesystem on the first read after
+   * the file is opened.
+   */
+  int read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length);
+  int write_to_file(const std::string& filename, const void *buffer, size_t buffer_size);
+
+  /** Ranges missing from the cache are read with one call to the wrapped filesystem. */
+  int read_from_file_v(const std::vector<StorageFSRead>& reads);
+
+  int move_path(const std::string& old_path, const std::string& new_path);
+
+  int sync_path(const std::string& path);
+
+  /** Also forgets the file size used to validate the cached ranges. */
+  int close_file(const std::string& filename);
+
+  bool locking_support();
+
+  /** Returns the wrapped filesystem. */
+  StorageFS* filesystem() const;
+
+  /** Returns the number of bytes currently cached. */
+  size_t size();
+
+  /** Returns the number of reads served from the cache. */
+  size_t hits();
+
+  /** Returns the number of reads forwarded to the wrapped filesystem. */
+  size_t misses();
+
+ private:
+  /** A cached range, stored in its own file named after the hash of its key. */
+  typedef struct SpillCacheEntry {
+    std::string name;
+    std::string key;
+    ssize_t file_size;
+    size_t length;
+  } SpillCacheEntry;
+  typedef std::list<SpillCacheEntry> entry_list_t;
+
+  StorageFS* fs_;
+  PosixFS local_fs_;
+  std::string cache_dir_;
+  size_t max_size_;
+
+  std::mutex mtx_;
+  size_t size_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+  /** Most recently used entries first. */
+  entry_list_t lru_;
+  std::unordered_map<std::string, entry_list_t::iterator> entries_;
+  /** Size of each open file in the wrapped filesystem, used to validate entries. */
+  std::unordered_map<std::string, ssize_t> file_sizes_;
+
+  std::string key(const std::string& filename, off_t offset, size_t length) const;
+  std::string entry_name(const std::string& key) const;
+  std::string entry_path(const std::string& name) const;
+
+  void load_entries();
+  ssize_t validated_file_size(const std::string& filename);
+  bool get(const std::string& filename, off_t offset, void *buffer, size_t length);
+  void put(const std::string& filename, off_t offset, const void *buffer, size_t length);
+  void invalidate(const std::string& path);
+  void evict(entry_list_t::iterator it);
+};
+
+#endif /* __STORAGE_SPILL_CACHE_H__ */
@@ -0,0 +1,116 @@
+/**
+ * @file storage_uring.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Minimal io_uring wrapper used by PosixFS to submit batches of reads. The
+ * ring is setup with raw syscalls, so there is no dependency on liburing.
+ * Batches are read with pread when io_uring is not available at build time
+ * or is not supported/permitted by the running kernel.
+ */
+
+#ifndef __STORAGE_URING_H__
+#define __STORAGE_URING_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+/** Default number of submission queue entries for each ring. */
+#define TILEDB_URING_QUEUE_DEPTH 64
+
+/** A single read of length bytes at offset of fd into buffer. */
+typedef struct URingRead {
+  int fd;
+  off_t offset;
+  void *buffer;
+  size_t length;
+} URingRead;
+
+/**
+ * A ring can only be used by one thread at a time, PosixFS keeps a pool of
+ * them for concurrent readers.
+ */
+class URing {
+ public:
+  /**
+   * Constructor. Sets up a ring with queue_depth submission entries. Check
+   * is_supported() for success.
+   */
+  URing(unsigned queue_depth=TILEDB_URING_QUEUE_DEPTH);
+
+  ~URing();
+
+  /** Returns true if the ring was setup successfully. */
+  bool is_supported() const;
+
+  /**
+   * Submits all the reads, keeping up to queue depth of them in flight, and
+   * waits for their completion. Short reads are resubmitted for the remaining
+   * bytes. Falls back to pread if the ring is not supported.
+   *
+   * @param reads The reads to perform.
+   * @param failed Set to the index of the first failed read on error.
+   * @return 0 for success, -1 if end of file was reached before length bytes
+   * could be read and the errno of the failed read otherwise.
+   */
+  int read(const std::vector<URingRead>& reads, size_t& failed);
+
+  /**
+   * Returns the number of reads completed through the ring rather than with
+   * pread, counting resubmitted short reads once per completion.
+   */
+  uint64_t ring_read_num() const;
+
+ private:
+  int ring_fd_ = -1;
+  unsigned sq_entries_ = 0;
+
+  void *sq_ptr_ = NULL;
+  size_t sq_ring_size_ = 0;
+  void *cq_ptr_ = NULL;
+  size_t cq_ring_size_ = 0;
+  void *sqes_ = NULL;
+  size_t sqes_size_ = 0;
+
+  unsigned *sq_head_ = NULL;
+  unsigned *sq_tail_ = NULL;
+  unsigned *sq_mask_ = NULL;
+  unsigned *sq_array_ = NULL;
+  unsigned *cq_head_ = NULL;
+  unsigned *cq_tail_ = NULL;
+  unsigned *cq_mask_ = NULL;
+  void *cqes_ = NULL;
+
+  uint64_t ring_read_num_ = 0;
+
+  void teardown();
+  int pread_all(const URingRead& read);
+};
+
+#endif /* __STORAGE_URING_H__ */
@@ -0,0 +1,95 @@
+/**
+ * @file storage_write_session.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Write session used by WriteState to write fragment files on local
+ * filesystems. Each file is opened once for the lifetime of the fragment and
+ * extended with preallocated blocks ahead of the writes. Files are not synced
+ * on close, the fragment syncs all its files together when it is committed.
+ */
+
+#ifndef __STORAGE_WRITE_SESSION_H__
+#define __STORAGE_WRITE_SESSION_H__
+
+#include <string>
+#include <unordered_map>
+#include <sys/types.h>
+
+/** Minimum number of bytes preallocated each time a file is extended. */
+#define TILEDB_WRITE_SESSION_MIN_PREALLOCATE 1048576
+/** Maximum number of bytes preallocated each time a file is extended. */
+#define TILEDB_WRITE_SESSION_MAX_PREALLOCATE 268435456
+
+/**
+ * Not thread-safe, a session belongs to the write state of one fragment.
+ * Errors are reported with TILEDB_FS_ERR and tiledb_fs_errmsg.
+ */
+class WriteSession {
+ public:
+  WriteSession();
+
+  /** Closes the files still open. */
+  ~WriteSession();
+
+  /**
+   * Sets the number of bytes expected to be appended to the file by the next
+   * writes, used to size the preallocation when the file has to be extended.
+   */
+  void set_size_hint(const std::string& filename, size_t size);
+
+  /** Appends to the file, opening it the first time. */
+  int write(const std::string& filename, const void *buffer, size_t length);
+
+  /** Returns true if the file was written to in this session. */
+  bool is_open(const std::string& filename) const;
+
+  /** Syncs the data written to the file, a no-op if it is not open. */
+  int sync(const std::string& filename);
+
+  /** Releases preallocated blocks past the data written and closes every file. */
+  int close();
+
+  /** Returns the number of times files were extended with preallocation. */
+  size_t preallocations() const;
+
+ private:
+  typedef struct File {
+    int fd;
+    off_t size;
+    off_t allocated;
+  } File;
+
+  std::unordered_map<std::string, File> files_;
+  std::unordered_map<std::string, size_t> size_hints_;
+  size_t preallocations_ = 0;
+
+  int open(const std::string& filename, File*& file);
+  void preallocate(const std::string& filename, File& file, size_t length);
+};
+
+#endif /* __STORAGE_WRITE_SESSION_H__ */
@@ -0,0 +1,102 @@
+/**
+ * @file tile_cache.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class TileCache, a memory-bounded LRU cache of
+ * decompressed tiles that is shared by all the arrays opened through a
+ * StorageManager.
+ */
+
+#ifndef __TILE_CACHE_H__
+#define __TILE_CACHE_H__
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class TileCache {
+ public:
+  /** Constructor. The cache holds at most capacity bytes of tiles. */
+  TileCache(size_t capacity);
+
+  /**
+   * Returns the key of the tile at position tile_i of the fixed or variable
+   * sized file of an attribute in a fragment.
+   */
+  static std::string key(const std::string& fragment_name, int attribute_id, int64_t tile_i, bool is_var);
+
+  /**
+   * Copies the tile cached for key into buffer and marks it as most recently
+   * used.
+   *
+   * @param key The tile key.
+   * @param buffer The buffer to copy the tile into.
+   * @param size The expected tile size, a tile of a different size is a miss.
+   * @return true on a hit, false on a miss.
+   */
+  bool get(const std::string& key, void* buffer, size_t size);
+
+  /**
+   * Adds a copy of the tile for key, evicting least recently used tiles to
+   * stay within capacity. Tiles larger than the capacity are not cached.
+   */
+  void put(const std::string& key, const void* buffer, size_t size);
+
+  /** Removes all the cached tiles. */
+  void clear();
+
+  /** Returns the maximum number of bytes cached. */
+  size_t capacity() const;
+
+  /** Returns the number of bytes currently cached. */
+  size_t size();
+
+  /** Returns the number of lookups that found the tile. */
+  size_t hits();
+
+  /** Returns the number of lookups that did not find the tile. */
+  size_t misses();
+
+ private:
+  typedef std::list<std::pair<std::string, std::shared_ptr<std::vector<char>>>> tile_list_t;
+
+  std::mutex mtx_;
+  size_t capacity_;
+  size_t size_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+  /** Most recently used tiles first. */
+  tile_list_t lru_;
+  std::unordered_map<std::string, tile_list_t::iterator> map_;
+};
+
+#endif /* __TILE_CACHE_H__ */
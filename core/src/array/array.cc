@@ -64,6 +64,25 @@ std::string tiledb_ar_errmsg = "";
 
 
 
+/* ****************************** */
+/*        STATIC FUNCTIONS        */
+/* ****************************** */
+
+/** 
+ * Sets hash to the hash of the point of a subarray of a single cell (see
+ * BloomFilter::hash_coords), and returns false for other subarrays.
+ */
+template<class T>
+static bool point_hash(const T* subarray, int dim_num, uint64_t& hash) {
+  if(!is_unary_subarray(subarray, dim_num))
+    return false;
+  hash = BloomFilter::hash_coords(subarray, dim_num, 2);
+  return true;
+}
+
+
+
+
 /* ****************************** */
 /*   CONSTRUCTORS & DESTRUCTORS   */
 /* ****************************** */
@@ -75,8 +94,13 @@ Array::Array() {
   array_schema_ = NULL;
   subarray_ = NULL;
   expression_ = NULL;
+  zone_map_filter_ = NULL;
   aio_thread_created_ = false;
   array_clone_ = NULL;
+  consolidating_ = false;
+  fragment_manifest_recorded_ = false;
+  tile_cache_ = NULL;
+  mmap_registry_ = NULL;
 }
 
 Array::~Array() {
@@ -169,11 +193,13 @@ void Array::aio_handle_requests() {
       return;
     }
 
-    // Handle the next AIO request
+    // Handle the next AIO request, taking its id first as the request may
+    // be freed as soon as its completion is signaled
+    size_t aio_next_request_id = aio_next_request->id_;
     aio_handle_next_request(aio_next_request);
 
     // Set last handled AIO request
-    aio_last_handled_request_ = aio_next_request->id_;
+    aio_last_handled_request_ = aio_next_request_id;
   }
 }
 
@@ -237,6 +263,10 @@ const StorageManagerConfig* Array::config() const {
   return config_;
 }
 
+const Expression* Array::zone_map_filter() const {
+  return zone_map_filter_;
+}
+
 int Array::fragment_num() const {
   return fragments_.size();
 }
@@ -245,15 +275,55 @@ std::vector<Fragment*> Array::fragments() const {
   return fragments_;
 }
 
+std::vector<Fragment*> Array::overlapping_fragments() const {
+  return overlapping_fragments_;
+}
+
+bool Array::overlaps_older_fragment(
+    const Fragment* fragment, 
+    const void* box) const {
+  // Newer fragments come later
+  for(auto older_fragment : overlapping_fragments_) {
+    if(older_fragment == fragment)
+      return false;
+    const void* bounding_domain = 
+        older_fragment->book_keeping()->bounding_domain();
+    if(bounding_domain != NULL && boxes_overlap(bounding_domain, box))
+      return true;
+  }
+
+  return false;
+}
+
 int Array::mode() const {
   return mode_;
 }
 
+bool Array::consolidating() const {
+  return consolidating_;
+}
+
+bool Array::fragment_manifest_recorded() const {
+  return fragment_manifest_recorded_;
+}
+
+TileCache* Array::tile_cache() const {
+  return tile_cache_;
+}
+
+MMapRegistry* Array::mmap_registry() const {
+  return mmap_registry_;
+}
+
 bool Array::overflow() const {
   // Not applicable to writes
   if(!read_mode()) 
     return false;
 
+  // Trivial case
+  if(overlapping_fragments_.size() == 0)
+    return false;
+
   // Check overflow
   if(array_sorted_read_state_ != NULL)
      return array_sorted_read_state_->overflow();
@@ -265,7 +335,7 @@ bool Array::overflow(int attribute_id) const {
   assert(read_mode());
 
   // Trivial case
-  if(fragments_.size() == 0)
+  if(overlapping_fragments_.size() == 0)
     return false;
 
   // Check overflow
@@ -275,6 +345,66 @@ bool Array::overflow(int attribute_id) const {
     return array_read_state_->overflow(attribute_id);
 }
 
+void Array::tile_read_counts(size_t& tile_reads, size_t& tile_io_reads) const {
+  tile_reads = 0;
+  tile_io_reads = 0;
+  for(auto fragment : overlapping_fragments_) {
+    if(fragment->read_state() != NULL) {
+      tile_reads += fragment->read_state()->tile_reads();
+      tile_io_reads += fragment->read_state()->tile_io_reads();
+    }
+  }
+
+  // Sorted reads are performed by the clone
+  if(array_clone_ != NULL) {
+    size_t clone_tile_reads, clone_tile_io_reads;
+    array_clone_->tile_read_counts(clone_tile_reads, clone_tile_io_reads);
+    tile_reads += clone_tile_reads;
+    tile_io_reads += clone_tile_io_reads;
+  }
+}
+
+size_t Array::file_size_lookups() const {
+  size_t lookups = 0;
+  for(auto fragment : overlapping_fragments_) {
+    if(fragment->read_state() != NULL) 
+      lookups += fragment->read_state()->file_size_lookups();
+  }
+
+  // Sorted reads are performed by the clone
+  if(array_clone_ != NULL) 
+    lookups += array_clone_->file_size_lookups();
+
+  return lookups;
+}
+
+void Array::access_hints(
+    size_t& sequential, 
+    size_t& random, 
+    size_t& willneed) const {
+  sequential = 0;
+  random = 0;
+  willneed = 0;
+  for(auto fragment : overlapping_fragments_) {
+    if(fragment->read_state() != NULL) {
+      sequential += 
+          fragment->read_state()->access_hints(TILEDB_FS_ACCESS_SEQUENTIAL);
+      random += fragment->read_state()->access_hints(TILEDB_FS_ACCESS_RANDOM);
+      willneed += 
+          fragment->read_state()->access_hints(TILEDB_FS_ACCESS_WILLNEED);
+    }
+  }
+
+  // Sorted reads are performed by the clone
+  if(array_clone_ != NULL) {
+    size_t clone_sequential, clone_random, clone_willneed;
+    array_clone_->access_hints(clone_sequential, clone_random, clone_willneed);
+    sequential += clone_sequential;
+    random += clone_random;
+    willneed += clone_willneed;
+  }
+}
+
 int Array::read(void** buffers, size_t* buffer_sizes, size_t* skip_counts) {
   // Sanity checks
   if(!read_mode()) {
@@ -284,18 +414,9 @@ int Array::read(void** buffers, size_t* buffer_sizes, size_t* skip_counts) {
     return TILEDB_AR_ERR;
   }
 
-  // Check if there are no fragments 
-  int buffer_i = 0;
-  int attribute_id_num = attribute_ids_.size();
-  if(fragments_.size() == 0) {             
-    for(int i=0; i<attribute_id_num; ++i) {
-      // Update all sizes to 0
-      buffer_sizes[buffer_i] = 0; 
-      if(!array_schema_->var_size(attribute_ids_[i])) 
-        ++buffer_i;
-      else 
-        buffer_i += 2;
-    }
+  // Check if there are no fragments overlapping the subarray
+  if(overlapping_fragments_.size() == 0) {             
+    clear_buffer_sizes(buffer_sizes);
     return TILEDB_AR_OK;
   }
 
@@ -319,6 +440,12 @@ int Array::read(void** buffers, size_t* buffer_sizes, size_t* skip_counts) {
 }
 
 int Array::read_default(void** buffers, size_t* buffer_sizes, size_t* skip_counts) {
+  // Check if there are no fragments overlapping the subarray
+  if(overlapping_fragments_.size() == 0) {             
+    clear_buffer_sizes(buffer_sizes);
+    return TILEDB_AR_OK;
+  }
+
   if(array_read_state_->read(buffers, buffer_sizes, skip_counts) != TILEDB_ARS_OK) {
     tiledb_ar_errmsg = tiledb_ars_errmsg;
     return TILEDB_AR_ERR;
@@ -358,6 +485,9 @@ int Array::consolidate(
   if(fragments_.size() == 1)
     return TILEDB_AR_OK;
 
+  // The fragments are streamed once, read states hint the filesystem
+  consolidating_ = true;
+
   // Get new fragment name
   std::string new_fragment_name = this->new_fragment_name();
   if(new_fragment_name == "") {
@@ -491,9 +621,12 @@ int Array::finalize() {
     rc = fragments_[i]->finalize();
     if(rc != TILEDB_FG_OK)  
       fg_error = true;
+    if(fragments_[i]->manifest_recorded())
+      fragment_manifest_recorded_ = true;
     delete fragments_[i];
   }
   fragments_.clear();
+  overlapping_fragments_.clear();
 
   // Clean the array read state
   if(array_read_state_ != NULL) {
@@ -568,7 +701,9 @@ int Array::init(
     int attribute_num,
     const void* subarray,
     const StorageManagerConfig* config,
-    Array* array_clone) {
+    Array* array_clone,
+    TileCache* tile_cache,
+    MMapRegistry* mmap_registry) {
   // Set mode
   mode_ = mode;
 
@@ -578,6 +713,12 @@ int Array::init(
   // Set array clone
   array_clone_ = array_clone;
 
+  // Set the shared tile cache
+  tile_cache_ = tile_cache;
+
+  // Set the shared file mappings
+  mmap_registry_ = mmap_registry;
+
   // Sanity check on mode
   if(!read_mode() && !write_mode()) {
     std::string errmsg = "Cannot initialize array; Invalid array mode";
@@ -689,6 +830,9 @@ int Array::init(
         array_schema_ = NULL;
         return TILEDB_AR_ERR;
       }
+
+      // Create the read states of the fragments overlapping the subarray
+      prune_fragments();
     
       // Create ArrayReadState
       array_read_state_ = new ArrayReadState(this);
@@ -743,6 +887,11 @@ int Array::apply_filter(const char* filter_expression) {
       attributes_vec.push_back(array_schema_->attribute(*it));
     }
     expression_ = new Expression(filter_expression, attributes_vec, array_schema_);
+
+    // The clone reads the tiles of sorted reads
+    zone_map_filter_ = expression_;
+    if(array_clone_ != NULL)
+      array_clone_->zone_map_filter_ = expression_;
   }
 
   return TILEDB_AR_OK;
@@ -866,9 +1015,8 @@ int Array::reset_subarray(const void* subarray) {
       return TILEDB_AR_ERR;
     }
   } else {           // READ MODE
-    // Re-initialize the read state of the fragments
-    for(int i=0; i<fragment_num; ++i) 
-      fragments_[i]->reset_read_state();
+    // Re-initialize the read state of the fragments overlapping the subarray
+    prune_fragments();
 
     // Re-initialize array read state
     if(array_read_state_ != NULL) {
@@ -927,9 +1075,8 @@ int Array::reset_subarray_soft(const void* subarray) {
   if(write_mode()) {  // WRITE MODE 
     // Do nothing
   } else {            // READ MODE
-    // Re-initialize the read state of the fragments
-    for(int i=0; i<fragment_num; ++i) 
-      fragments_[i]->reset_read_state();
+    // Re-initialize the read state of the fragments overlapping the subarray
+    prune_fragments();
 
     // Re-initialize array read state
     if(array_read_state_ != NULL) {
@@ -1119,13 +1266,11 @@ void Array::aio_handle_next_request(AIO_Request* aio_request) {
 
   if(rc == TILEDB_AR_OK) {      // Success
     // Check for overflow (applicable only to reads)
-    if(aio_request->mode_ == TILEDB_ARRAY_READ && 
-       array_read_state_->overflow()) {
+    if(aio_request->mode_ == TILEDB_ARRAY_READ && overflow()) {
       *aio_request->status_= TILEDB_AIO_OVERFLOW;
       if(aio_request->overflow_ != NULL) {
         for(int i=0; i<int(attribute_ids_.size()); ++i) 
-          aio_request->overflow_[i] = 
-            array_read_state_->overflow(attribute_ids_[i]);
+          aio_request->overflow_[i] = overflow(attribute_ids_[i]);
       }
     } else if((aio_request->mode_ == TILEDB_ARRAY_READ_SORTED_COL ||
                aio_request->mode_ == TILEDB_ARRAY_READ_SORTED_ROW ) && 
@@ -1322,6 +1467,110 @@ int Array::open_fragments(
   return TILEDB_AR_OK;
 }
 
+void Array::clear_buffer_sizes(size_t* buffer_sizes) const {
+  int buffer_i = 0;
+  int attribute_id_num = attribute_ids_.size();
+  for(int i=0; i<attribute_id_num; ++i) {
+    // Update all sizes to 0
+    buffer_sizes[buffer_i] = 0; 
+    if(!array_schema_->var_size(attribute_ids_[i])) 
+      ++buffer_i;
+    else 
+      buffer_i += 2;
+  }
+}
+
+bool Array::boxes_overlap(const void* box_A, const void* box_B) const {
+  // For easy reference
+  int dim_num = array_schema_->dim_num();
+  int coords_type = array_schema_->coords_type();
+
+  // Invoke the proper templated function
+  if(coords_type == TILEDB_INT32) {
+    return is_overlapping<int>(
+               static_cast<const int*>(box_A),
+               static_cast<const int*>(box_B),
+               dim_num);
+  } else if(coords_type == TILEDB_INT64) {
+    return is_overlapping<int64_t>(
+               static_cast<const int64_t*>(box_A),
+               static_cast<const int64_t*>(box_B),
+               dim_num);
+  } else if(coords_type == TILEDB_FLOAT32) {
+    return is_overlapping<float>(
+               static_cast<const float*>(box_A),
+               static_cast<const float*>(box_B),
+               dim_num);
+  } else if(coords_type == TILEDB_FLOAT64) {
+    return is_overlapping<double>(
+               static_cast<const double*>(box_A),
+               static_cast<const double*>(box_B),
+               dim_num);
+  } else {
+    // The code should never reach here
+    assert(0);
+    return true;
+  }
+}
+
+bool Array::overlaps_subarray(const Fragment* fragment) const {
+  // Empty fragment
+  const void* bounding_domain = fragment->book_keeping()->bounding_domain();
+  if(bounding_domain == NULL)
+    return false;
+
+  return boxes_overlap(bounding_domain, subarray_);
+}
+
+void Array::prune_fragments() {
+  // Point lookups also skip the sparse fragments whose coordinates filter
+  // rules the point out
+  uint64_t point_hash;
+  bool point = subarray_point_hash(point_hash);
+
+  overlapping_fragments_.clear();
+  for(auto fragment : fragments_) {
+    if(!overlaps_subarray(fragment))
+      continue;
+    const BloomFilter* coords_filter = 
+        point ? fragment->book_keeping()->coords_filter() : NULL;
+    if(coords_filter != NULL && !coords_filter->may_contain(point_hash))
+      continue;
+    fragment->reset_read_state();
+    overlapping_fragments_.push_back(fragment);
+  }
+
+  // Dense reads fill the subarray with empty cells even if no fragment
+  // overlaps it, which the array read state does given any fragment
+  if(overlapping_fragments_.size() == 0 && 
+     array_schema_->dense() && 
+     fragments_.size() != 0) {
+    fragments_[0]->reset_read_state();
+    overlapping_fragments_.push_back(fragments_[0]);
+  }
+}
+
+bool Array::subarray_point_hash(uint64_t& hash) const {
+  // For easy reference
+  int dim_num = array_schema_->dim_num();
+  int coords_type = array_schema_->coords_type();
+
+  // Invoke the proper templated function
+  if(coords_type == TILEDB_INT32) {
+    return point_hash(static_cast<const int*>(subarray_), dim_num, hash);
+  } else if(coords_type == TILEDB_INT64) {
+    return point_hash(static_cast<const int64_t*>(subarray_), dim_num, hash);
+  } else if(coords_type == TILEDB_FLOAT32) {
+    return point_hash(static_cast<const float*>(subarray_), dim_num, hash);
+  } else if(coords_type == TILEDB_FLOAT64) {
+    return point_hash(static_cast<const double*>(subarray_), dim_num, hash);
+  } else {
+    // The code should never reach here
+    assert(0);
+    return false;
+  }
+}
+
 void Array::free_array_schema()
 {
   if(array_schema_)
@@ -87,8 +87,8 @@ ArrayReadState::ArrayReadState(
     read_round_done_[i] = true;
   }
 
-  // Get fragment read states
-  std::vector<Fragment*> fragments = array_->fragments();
+  // Get the read states of the fragments overlapping the subarray
+  std::vector<Fragment*> fragments = array_->overlapping_fragments();
   fragment_num_ = fragments.size();
   fragment_read_states_.resize(fragment_num_);
   for(int i=0; i<fragment_num_; ++i)
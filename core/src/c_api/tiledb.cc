@@ -114,7 +114,11 @@ int tiledb_ctx_init(
 #endif
         tiledb_config->read_method_, 
         tiledb_config->write_method_,
-        tiledb_config->enable_shared_posixfs_optimizations_) == TILEDB_SMC_ERR) {
+        tiledb_config->enable_shared_posixfs_optimizations_,
+        tiledb_config->tile_cache_size_,
+        tiledb_config->coords_filter_false_positive_rate_,
+        tiledb_config->coords_filter_max_size_,
+        tiledb_config->enable_book_keeping_sections_) == TILEDB_SMC_ERR) {
       strcpy(tiledb_errmsg, tiledb_smc_errmsg.c_str());
       return TILEDB_ERR;
     }
@@ -220,6 +224,31 @@ inline bool sanity_check(const TileDB_MetadataIterator* tiledb_metadata_it) {
 
 
 
+/* ****************************** */
+/*           TILE CACHE           */
+/* ****************************** */
+
+int tiledb_ctx_tile_cache_stats(
+    const TileDB_CTX* tiledb_ctx,
+    size_t* hits,
+    size_t* misses,
+    size_t* size) {
+  // Sanity check
+  if(!sanity_check(tiledb_ctx))
+    return TILEDB_ERR;
+
+  TileCache* tile_cache = tiledb_ctx->storage_manager_->tile_cache();
+  *hits = (tile_cache == NULL) ? 0 : tile_cache->hits();
+  *misses = (tile_cache == NULL) ? 0 : tile_cache->misses();
+  *size = (tile_cache == NULL) ? 0 : tile_cache->size();
+
+  // Success
+  return TILEDB_OK;
+}
+
+
+
+
 /* ****************************** */
 /*            WORKSPACE           */
 /* ****************************** */
@@ -785,6 +814,65 @@ int tiledb_array_overflow(
   return (int) tiledb_array->array_->overflow(attribute_id);
 }
 
+int tiledb_array_tile_read_counts(
+    const TileDB_Array* tiledb_array,
+    size_t* tile_reads,
+    size_t* tile_io_reads) {
+  // Sanity check
+  if(!sanity_check(tiledb_array))
+    return TILEDB_ERR;
+
+  // Get the counts
+  tiledb_array->array_->tile_read_counts(*tile_reads, *tile_io_reads);
+
+  // Success
+  return TILEDB_OK;
+}
+
+int tiledb_array_file_size_lookups(
+    const TileDB_Array* tiledb_array,
+    size_t* file_size_lookups) {
+  // Sanity check
+  if(!sanity_check(tiledb_array))
+    return TILEDB_ERR;
+
+  // Get the count
+  *file_size_lookups = tiledb_array->array_->file_size_lookups();
+
+  // Success
+  return TILEDB_OK;
+}
+
+int tiledb_array_access_hints(
+    const TileDB_Array* tiledb_array,
+    size_t* sequential,
+    size_t* random,
+    size_t* willneed) {
+  // Sanity check
+  if(!sanity_check(tiledb_array))
+    return TILEDB_ERR;
+
+  // Get the counts
+  tiledb_array->array_->access_hints(*sequential, *random, *willneed);
+
+  // Success
+  return TILEDB_OK;
+}
+
+int tiledb_array_overlapping_fragment_num(
+    const TileDB_Array* tiledb_array,
+    int* fragment_num) {
+  // Sanity check
+  if(!sanity_check(tiledb_array))
+    return TILEDB_ERR;
+
+  // Get the count
+  *fragment_num = tiledb_array->array_->overlapping_fragments().size();
+
+  // Success
+  return TILEDB_OK;
+}
+
 int tiledb_array_consolidate(
     const TileDB_CTX* tiledb_ctx,
     const char* array) {
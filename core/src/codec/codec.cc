@@ -60,7 +60,7 @@
 /*        GLOBAL VARIABLES        */
 /* ****************************** */
 
-std::string tiledb_cd_errmsg = "";
+thread_local std::string tiledb_cd_errmsg = "";
 
 /* ****************************** */
 /*        FACTORY METHODS         */
@@ -195,6 +195,21 @@ Codec* Codec::create(const ArraySchema* array_schema, const int attribute_id, co
   return codec;
 }
 
+Codec* Codec::create(const int compression_type, const int compression_level) {
+  switch (compression_type) {
+  case TILEDB_GZIP:
+    return new CodecGzip(compression_level);
+#ifdef ENABLE_ZSTD
+  case TILEDB_ZSTD:
+    return new CodecZStandard(compression_level);
+#endif
+  case TILEDB_LZ4:
+    return new CodecLZ4(compression_level);
+  default:
+    return NULL;
+  }
+}
+
 int Codec::get_default_level(int compression_type) {
   switch(compression_type) {
   case TILEDB_GZIP:
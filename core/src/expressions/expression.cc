@@ -35,7 +35,14 @@
 #include "error.h"
 #include "expression.h"
 #include "tiledb.h"
+#include "utils.h"
 #include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
 
 /* ****************************** */
 /*             MACROS             */
@@ -49,6 +56,147 @@
 
 std::string tiledb_expr_errmsg = "";
 
+/* ****************************** */
+/*        STATIC FUNCTIONS        */
+/* ****************************** */
+
+static bool is_word_char(char c) {
+  return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+}
+
+// Returns true if the token can name a muparserx variable
+static bool is_name(const std::string& token) {
+  if (token.empty() || !(isalpha(static_cast<unsigned char>(token[0])) || token[0] == '_')) {
+    return false;
+  }
+  for (auto c : token) {
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+  }
+  return true;
+}
+
+// Splits the expression into the tokens of the operators compiled expressions
+// support, numbers and names. Returns false on anything else, e.g. string
+// literals or other operators.
+static bool tokenize(const std::string& expression, std::vector<std::string>& tokens) {
+  static const char* operators[] = { "&&", "||", "==", "!=", "<=", ">=", "<", ">", "+", "-", "*", "/", "(", ")" };
+  for (size_t i = 0; i < expression.size();) {
+    char c = expression[i];
+    if (isspace(static_cast<unsigned char>(c))) {
+      i++;
+    } else if (isdigit(static_cast<unsigned char>(c)) || c == '.') {
+      size_t end = i;
+      while (end < expression.size() && (isdigit(static_cast<unsigned char>(expression[end])) || expression[end] == '.')) end++;
+      if (end < expression.size() && (expression[end] == 'e' || expression[end] == 'E')) {
+        end++;
+        if (end < expression.size() && (expression[end] == '+' || expression[end] == '-')) end++;
+        while (end < expression.size() && isdigit(static_cast<unsigned char>(expression[end]))) end++;
+      }
+      if (end < expression.size() && is_word_char(expression[end])) return false;
+      tokens.push_back(expression.substr(i, end-i));
+      i = end;
+    } else if (isalpha(static_cast<unsigned char>(c)) || c == '_') {
+      size_t end = i;
+      while (end < expression.size() && (isalnum(static_cast<unsigned char>(expression[end])) || expression[end] == '_')) end++;
+      if (end < expression.size() && is_word_char(expression[end])) return false;
+      tokens.push_back(expression.substr(i, end-i));
+      i = end;
+    } else {
+      size_t size = 0;
+      for (auto op : operators) {
+        if (expression.compare(i, strlen(op), op) == 0) {
+          size = strlen(op);
+          break;
+        }
+      }
+      if (size == 0) return false;
+      tokens.push_back(expression.substr(i, size));
+      i += size;
+    }
+  }
+  return true;
+}
+
+// The kernel loops below run over contiguous values without branches, so that
+// they are vectorized by the compiler
+
+template<class T>
+static void convert_each(const T* column, int64_t cell_num, double* values) {
+  for (int64_t i = 0; i < cell_num; i++) {
+    values[i] = static_cast<double>(column[i]);
+  }
+}
+
+template<class T, class Combine>
+static void combine_each(T* left, const T* right, int64_t cell_num, Combine combine) {
+  for (int64_t i = 0; i < cell_num; i++) {
+    left[i] = combine(left[i], right[i]);
+  }
+}
+
+// Compares values with a bound of their own type, so that the loop does not
+// widen them to doubles. Integer values all compare the same way with bounds
+// out of their range.
+template<template<class> class Compare, class T>
+static void compare_bound_each(const T* values, double bound, int64_t cell_num, uint8_t* selection) {
+  if (std::numeric_limits<T>::is_integer
+      && (bound < std::numeric_limits<T>::lowest() || bound > std::numeric_limits<T>::max())) {
+    std::fill(selection, selection+cell_num, Compare<double>()(0, bound));
+    return;
+  }
+  T typed_bound = static_cast<T>(bound);
+  Compare<T> compare;
+  for (int64_t i = 0; i < cell_num; i++) {
+    selection[i] = compare(values[i], typed_bound);
+  }
+}
+
+// Rounds the constant to the closest values of type T below and above it,
+// equal if it is one, so that e.g. value > constant if and only if value > low
+template<class T>
+static void round_bounds(double constant, double& low, double& high);
+
+template<>
+void round_bounds<int>(double constant, double& low, double& high) {
+  low = std::floor(constant);
+  high = std::ceil(constant);
+}
+
+template<>
+void round_bounds<float>(double constant, double& low, double& high) {
+  float max = std::numeric_limits<float>::max();
+  float infinity = std::numeric_limits<float>::infinity();
+  if (constant > max) {
+    low = max;
+    high = infinity;
+  } else if (constant < -max) {
+    low = -infinity;
+    high = -max;
+  } else {
+    float rounded = static_cast<float>(constant);
+    low = high = rounded;
+    if (rounded > constant) {
+      low = std::nextafter(rounded, -infinity);
+    } else if (rounded < constant) {
+      high = std::nextafter(rounded, infinity);
+    }
+  }
+}
+
+template<class Compare>
+static void compare_each(const double* left, const double* right, int64_t cell_num, uint8_t* selection, Compare compare) {
+  for (int64_t i = 0; i < cell_num; i++) {
+    selection[i] = compare(left[i], right[i]);
+  }
+}
+
+template<class T>
+static void select_empty(const T* column, T empty, int64_t cell_num, uint8_t* selection) {
+  for (int64_t i = 0; i < cell_num; i++) {
+    selection[i] |= column[i] == empty;
+  }
+}
+
 Expression::Expression(std::string expression, std::vector<std::string> attributes,
                        const ArraySchema *array_schema) :
     expression_(expression), attributes_(attributes), array_schema_(array_schema) {
@@ -65,6 +213,7 @@ Expression::Expression(std::string expression, std::vector<std::string> attribut
       for (mup::var_maptype::iterator item = vmap.begin(); item!=vmap.end(); ++item) {
         add_attribute(item->first);
       }
+      compile();
     } catch (mup::ParserError const &e) {
       EXPRESSION_ERROR("Parser SetExpr error: " + e.GetMsg());
     }
@@ -142,6 +291,17 @@ T get_value(const void *buffer, const uint64_t buffer_index) {
 }
 
 bool Expression::evaluate_cell(void** buffers, size_t* buffer_sizes, std::vector<int64_t>& buffer_indexes) {
+  if (compiled()) {
+    std::vector<const void*> columns(columns_.size());
+    for (auto i = 0u; i < columns_.size(); i++) {
+      columns[i] = static_cast<const char*>(buffers[columns_[i].buffer_index_])
+          + buffer_indexes[columns_[i].attribute_index_]*array_schema_->type_size(columns_[i].attribute_id_);
+    }
+    uint8_t selection;
+    evaluate_batch(columns.data(), 1, &selection);
+    return selection;
+  }
+
   if (expression_.size() == 0 || attributes_.size() == 0 || attribute_map_.size() == 0) {
     return true;
   }
@@ -201,7 +361,7 @@ int get_num_cells(const ArraySchema *array_schema, int attribute_id, size_t* buf
 }
 
 int Expression::evaluate(void** buffers, size_t* buffer_sizes) {
-  if (expression_.size() == 0 || attributes_.size() == 0 || attribute_map_.size() == 0) {
+  if (expression_.size() == 0 || attributes_.size() == 0 || (attribute_map_.size() == 0 && !compiled())) {
     return TILEDB_EXPR_OK;
   }
 
@@ -224,69 +384,419 @@ int Expression::evaluate(void** buffers, size_t* buffer_sizes) {
     return TILEDB_EXPR_OK;
   }
   
-  std::vector<int> cells_to_be_dropped;
+  std::vector<uint8_t> selection(number_of_cells);
+
+  if (compiled()) {
+    std::vector<const void*> columns(columns_.size());
+    for (int64_t start = 0; start < number_of_cells; start += TILEDB_EXPR_BATCH_SIZE) {
+      for (auto i = 0u; i < columns_.size(); i++) {
+        columns[i] = static_cast<const char*>(buffers[columns_[i].buffer_index_])
+            + start*array_schema_->type_size(columns_[i].attribute_id_);
+      }
+      evaluate_batch(columns.data(), std::min<int64_t>(TILEDB_EXPR_BATCH_SIZE, number_of_cells-start), &selection[start]);
+    }
+  } else {
+    print_parser_varmap(parser_);
+    print_parser_expr_varmap(parser_);
 
-  print_parser_varmap(parser_);
-  print_parser_expr_varmap(parser_);
+    for (int i_cell = 0; i_cell < number_of_cells; i_cell++) {
+      try {
+        selection[i_cell] = evaluate_cell(buffers, buffer_sizes, last_processed_buffer_index_);
+      } catch (mup::ParserError const &e) {
+        return TILEDB_EXPR_ERR;
+      }
 
-  for (int i_cell = 0; i_cell < number_of_cells; i_cell++) {
-    try {
-      if (!evaluate_cell(buffers, buffer_sizes, last_processed_buffer_index_)) {
-        cells_to_be_dropped.push_back(i_cell);
+      for (auto i = 0u; i<attributes_.size(); i++) {
+        last_processed_buffer_index_[i]++;
       }
-    } catch (mup::ParserError const &e) {
-      return TILEDB_EXPR_ERR;
-    }
-    
-    for (auto i = 0u; i<attributes_.size(); i++) {
-      last_processed_buffer_index_[i]++;
     }
   }
 
-  fixup_return_buffers(buffers, buffer_sizes, number_of_cells, cells_to_be_dropped);
+  fixup_return_buffers(buffers, buffer_sizes, number_of_cells, selection);
 
   return TILEDB_EXPR_OK;
 }
 
-void Expression::fixup_return_buffers(void** buffers, size_t* buffer_sizes, int number_of_cells, std::vector<int> cells_to_be_dropped) {
-  if (!cells_to_be_dropped.size()) {
+bool Expression::compiled() const {
+  return !kernels_.empty();
+}
+
+bool Expression::excludes_tile(const BookKeeping* book_keeping, int64_t tile_pos) const {
+  if (attribute_ranges_.empty()) {
+    return false;
+  }
+
+  // Cells with an empty value in any attribute pass, see evaluate_cell
+  for (auto attribute_id : zone_map_attribute_ids_) {
+    const TileZoneMap* zone_maps = book_keeping->zone_maps(attribute_id);
+    if (zone_maps == NULL || zone_maps[tile_pos].empty_num_ > 0) {
+      return false;
+    }
+  }
+
+  // A tile is excluded if its values cannot satisfy any one of the comparisons
+  for (auto& range : attribute_ranges_) {
+    const TileZoneMap& zone_map = book_keeping->zone_maps(range.attribute_id_)[tile_pos];
+    if (zone_map.min_ > zone_map.max_
+        || zone_map.max_ < range.low_ || (zone_map.max_ == range.low_ && range.low_open_)
+        || zone_map.min_ > range.high_ || (zone_map.min_ == range.high_ && range.high_open_)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+const std::vector<int>& Expression::zone_map_attribute_ids() const {
+  return zone_map_attribute_ids_;
+}
+
+void Expression::extract_attribute_ranges() {
+  attribute_ranges_.clear();
+  zone_map_attribute_ids_.clear();
+  if (!compiled()) return;
+
+  extract_attribute_ranges(kernels_.size()-1);
+
+  // Cells with empty values in any column pass, see evaluate_batch
+  if (!attribute_ranges_.empty()) {
+    for (auto& column : columns_) {
+      zone_map_attribute_ids_.push_back(column.attribute_id_);
+    }
+  }
+}
+
+void Expression::extract_attribute_ranges(int kernel) {
+  const Kernel& node = kernels_[kernel];
+  if (node.op_ == KERNEL_AND) {
+    extract_attribute_ranges(node.left_);
+    extract_attribute_ranges(node.right_);
+    return;
+  }
+
+  // Comparisons of a column with a constant, which compile_kernel puts right
+  if (node.op_ < KERNEL_LT || node.op_ > KERNEL_EQ
+      || kernels_[node.left_].op_ != KERNEL_COLUMN || kernels_[node.right_].op_ != KERNEL_CONSTANT) {
+    return;
+  }
+  double value = kernels_[node.right_].value_;
+  AttributeRange range = { columns_[kernels_[node.left_].column_].attribute_id_,
+                           -std::numeric_limits<double>::infinity(), false,
+                           std::numeric_limits<double>::infinity(), false };
+  if (node.op_ == KERNEL_LT || node.op_ == KERNEL_LE || node.op_ == KERNEL_EQ) {
+    range.high_ = value;
+    range.high_open_ = node.op_ == KERNEL_LT;
+  }
+  if (node.op_ == KERNEL_GT || node.op_ == KERNEL_GE || node.op_ == KERNEL_EQ) {
+    range.low_ = value;
+    range.low_open_ = node.op_ == KERNEL_GT;
+  }
+  attribute_ranges_.push_back(range);
+}
+
+void Expression::compile() {
+  kernels_.clear();
+  columns_.clear();
+
+  std::vector<std::string> tokens;
+  size_t pos = 0;
+  if (!tokenize(expression_, tokens) || compile_kernel(tokens, pos, 0) < 0 || pos != tokens.size()
+      || !is_selection(kernels_.size()-1) || columns_.empty()) {
+    kernels_.clear();
+    columns_.clear();
+  }
+
+  // The ranges prune tiles however the expression is evaluated. The environment
+  // variable forces evaluation with muparserx, e.g. to compare against it
+  extract_attribute_ranges();
+  if (is_env_set("TILEDB_DISABLE_EXPRESSION_KERNELS")) {
+    kernels_.clear();
+    columns_.clear();
+  }
+
+  kernel_values_.resize(kernels_.size()*TILEDB_EXPR_BATCH_SIZE);
+  kernel_selections_.resize(kernels_.size()*TILEDB_EXPR_BATCH_SIZE);
+}
+
+int Expression::compile_kernel(const std::vector<std::string>& tokens, size_t& pos, int level) {
+  // Binary operators by precedence level, loosest first as in muparserx
+  static const std::vector<std::map<std::string, KernelOp> > operators = {
+    { { "||", KERNEL_OR }, { "or", KERNEL_OR } },
+    { { "&&", KERNEL_AND }, { "and", KERNEL_AND } },
+    { { "==", KERNEL_EQ }, { "!=", KERNEL_NE } },
+    { { "<", KERNEL_LT }, { "<=", KERNEL_LE }, { ">", KERNEL_GT }, { ">=", KERNEL_GE } },
+    { { "+", KERNEL_ADD }, { "-", KERNEL_SUB } },
+    { { "*", KERNEL_MUL }, { "/", KERNEL_DIV } } };
+
+  // Operands
+  if (level == (int)operators.size()) {
+    if (pos == tokens.size()) return -1;
+    const std::string& token = tokens[pos++];
+    if (token == "(") {
+      int kernel = compile_kernel(tokens, pos, 0);
+      if (kernel < 0 || pos == tokens.size() || tokens[pos++] != ")") return -1;
+      return kernel;
+    } else if (token == "-") {
+      int operand = compile_kernel(tokens, pos, level);
+      if (operand < 0 || is_selection(operand)) return -1;
+      if (kernels_[operand].op_ == KERNEL_CONSTANT) {
+        kernels_[operand].value_ = -kernels_[operand].value_;
+        return operand;
+      }
+      // Negated by multiplying with -1, which keeps the sign of zeros as muparserx
+      kernels_.push_back({ KERNEL_CONSTANT, -1, -1.0, -1, -1 });
+      kernels_.push_back({ KERNEL_MUL, -1, 0, (int)kernels_.size()-1, operand });
+      return kernels_.size()-1;
+    } else if (isdigit(static_cast<unsigned char>(token[0])) || token[0] == '.') {
+      char* end;
+      double value = strtod(token.c_str(), &end);
+      if (*end != '\0' || !std::isfinite(value)) return -1;
+      kernels_.push_back({ KERNEL_CONSTANT, -1, value, -1, -1 });
+      return kernels_.size()-1;
+    } else if (is_name(token)) {
+      int column = compile_column(token);
+      if (column < 0) return -1;
+      kernels_.push_back({ KERNEL_COLUMN, column, 0, -1, -1 });
+      return kernels_.size()-1;
+    }
+    return -1;
+  }
+
+  int left = compile_kernel(tokens, pos, level+1);
+  while (left >= 0 && pos < tokens.size()) {
+    auto it = operators[level].find(tokens[pos]);
+    if (it == operators[level].end()) break;
+    pos++;
+    int right = compile_kernel(tokens, pos, level+1);
+    if (right < 0) return -1;
+
+    // Boolean combinators take selections, the other operators values
+    KernelOp op = it->second;
+    bool selections = op == KERNEL_AND || op == KERNEL_OR;
+    if (is_selection(left) != selections || is_selection(right) != selections) return -1;
+
+    // Constants go right of comparisons, which compare columns with them in place
+    if (op >= KERNEL_LT && op <= KERNEL_NE && kernels_[left].op_ == KERNEL_CONSTANT) {
+      std::swap(left, right);
+      if (op == KERNEL_LT) op = KERNEL_GT;
+      else if (op == KERNEL_GT) op = KERNEL_LT;
+      else if (op == KERNEL_LE) op = KERNEL_GE;
+      else if (op == KERNEL_GE) op = KERNEL_LE;
+    }
+    kernels_.push_back({ op, -1, 0, left, right });
+    left = kernels_.size()-1;
+  }
+
+  return left;
+}
+
+int Expression::compile_column(const std::string& name) {
+  for (auto i = 0u; i < columns_.size(); i++) {
+    if (attributes_[columns_[i].attribute_index_] == name) return i;
+  }
+
+  // Only attributes muparserx gets values of in evaluate_cell
+  for (auto i = 0u, j = 0u; i < attributes_.size(); i++, j++) {
+    int attribute_id = array_schema_->attribute_id(attributes_[i]);
+    if (attributes_[i] == name) {
+      int attribute_type = array_schema_->type(attribute_id);
+      if ((attribute_type != TILEDB_INT32 && attribute_type != TILEDB_FLOAT32)
+          || attribute_id == array_schema_->attribute_num()
+          || array_schema_->cell_val_num(attribute_id) != 1) {
+        return -1;
+      }
+      columns_.push_back({ attribute_id, attribute_type, (int)i, (int)j });
+      return columns_.size()-1;
+    }
+
+    // Increment buffer index for variable types
+    if (array_schema_->cell_size(attribute_id) == TILEDB_VAR_SIZE) j++;
+  }
+
+  return -1;
+}
+
+bool Expression::is_selection(int kernel) const {
+  return kernels_[kernel].op_ >= KERNEL_LT;
+}
+
+void Expression::evaluate_batch(const void** columns, int64_t cell_num, uint8_t* selection) {
+  evaluate_selection(kernels_.size()-1, columns, cell_num, selection);
+
+  // Cells with empty values pass, see evaluate_cell
+  for (auto i = 0u; i < columns_.size(); i++) {
+    if (columns_[i].type_ == TILEDB_INT32) {
+      select_empty(static_cast<const int*>(columns[i]), TILEDB_EMPTY_INT32, cell_num, selection);
+    } else {
+      select_empty(static_cast<const float*>(columns[i]), TILEDB_EMPTY_FLOAT32, cell_num, selection);
+    }
+  }
+}
+
+void Expression::evaluate_values(int kernel, const void** columns, int64_t cell_num, double* values) {
+  const Kernel& node = kernels_[kernel];
+  if (node.op_ == KERNEL_COLUMN) {
+    if (columns_[node.column_].type_ == TILEDB_INT32) {
+      convert_each(static_cast<const int*>(columns[node.column_]), cell_num, values);
+    } else {
+      convert_each(static_cast<const float*>(columns[node.column_]), cell_num, values);
+    }
+    return;
+  } else if (node.op_ == KERNEL_CONSTANT) {
+    std::fill(values, values+cell_num, node.value_);
+    return;
+  }
+
+  double* right = &kernel_values_[node.right_*TILEDB_EXPR_BATCH_SIZE];
+  evaluate_values(node.left_, columns, cell_num, values);
+  evaluate_values(node.right_, columns, cell_num, right);
+  switch (node.op_) {
+    case KERNEL_ADD:
+      combine_each(values, right, cell_num, std::plus<double>());
+      break;
+    case KERNEL_SUB:
+      combine_each(values, right, cell_num, std::minus<double>());
+      break;
+    case KERNEL_MUL:
+      combine_each(values, right, cell_num, std::multiplies<double>());
+      break;
+    case KERNEL_DIV:
+      combine_each(values, right, cell_num, std::divides<double>());
+      break;
+    default:
+      assert(0);
+  }
+}
+
+void Expression::evaluate_selection(int kernel, const void** columns, int64_t cell_num, uint8_t* selection) {
+  const Kernel& node = kernels_[kernel];
+  if (node.op_ == KERNEL_AND || node.op_ == KERNEL_OR) {
+    uint8_t* right = &kernel_selections_[node.right_*TILEDB_EXPR_BATCH_SIZE];
+    evaluate_selection(node.left_, columns, cell_num, selection);
+    evaluate_selection(node.right_, columns, cell_num, right);
+    if (node.op_ == KERNEL_AND) {
+      combine_each(selection, right, cell_num, std::bit_and<uint8_t>());
+    } else {
+      combine_each(selection, right, cell_num, std::bit_or<uint8_t>());
+    }
+    return;
+  }
+
+  // Columns are compared with constants in place
+  const Kernel& left = kernels_[node.left_];
+  const Kernel& right = kernels_[node.right_];
+  if (left.op_ == KERNEL_COLUMN && right.op_ == KERNEL_CONSTANT) {
+    if (columns_[left.column_].type_ == TILEDB_INT32) {
+      compare_constant(node.op_, static_cast<const int*>(columns[left.column_]), right.value_, cell_num, selection);
+    } else {
+      compare_constant(node.op_, static_cast<const float*>(columns[left.column_]), right.value_, cell_num, selection);
+    }
     return;
   }
 
-  for (int current_cell=0, next_cell=0; next_cell < number_of_cells; current_cell++, next_cell++) {
-    int reduce_by = 0;
-    bool next_cell_dropped;
-    do {
-      next_cell_dropped = std::find(cells_to_be_dropped.begin(), cells_to_be_dropped.end(), next_cell) != cells_to_be_dropped.end();
-      if (next_cell_dropped && next_cell < number_of_cells) {
-        reduce_by++;
-        next_cell++;
+  double* left_values = &kernel_values_[node.left_*TILEDB_EXPR_BATCH_SIZE];
+  double* right_values = &kernel_values_[node.right_*TILEDB_EXPR_BATCH_SIZE];
+  evaluate_values(node.left_, columns, cell_num, left_values);
+  evaluate_values(node.right_, columns, cell_num, right_values);
+  compare_values(node.op_, left_values, right_values, cell_num, selection);
+}
+
+template<class T>
+void Expression::compare_constant(KernelOp op, const T* values, double constant, int64_t cell_num, uint8_t* selection) {
+  double low, high;
+  round_bounds<T>(constant, low, high);
+  switch (op) {
+    case KERNEL_LT:
+      compare_bound_each<std::less>(values, high, cell_num, selection);
+      break;
+    case KERNEL_LE:
+      compare_bound_each<std::less_equal>(values, low, cell_num, selection);
+      break;
+    case KERNEL_GT:
+      compare_bound_each<std::greater>(values, low, cell_num, selection);
+      break;
+    case KERNEL_GE:
+      compare_bound_each<std::greater_equal>(values, high, cell_num, selection);
+      break;
+    case KERNEL_EQ:
+      if (low == high) {
+        compare_bound_each<std::equal_to>(values, low, cell_num, selection);
+      } else {
+        std::fill(selection, selection+cell_num, 0);
       }
-    } while (next_cell_dropped);
-
-    for (auto i=0u, j=0u; i < attributes_.size(); i++, j++) {
-      int attribute_id = array_schema_->attribute_id(attributes_[i]);
-      int cell_size;
-      int cell_val_num = array_schema_->cell_val_num(attribute_id);
-      if (cell_val_num == TILEDB_VAR_NUM) {
-        cell_size = sizeof(size_t);
-      } else if (attributes_[i].compare(TILEDB_COORDS) == 0) {
-        cell_size =  array_schema_->type_size(attribute_id)*array_schema_->dim_num();
+      break;
+    case KERNEL_NE:
+      if (low == high) {
+        compare_bound_each<std::not_equal_to>(values, low, cell_num, selection);
       } else {
-        cell_size = array_schema_->type_size(attribute_id)*cell_val_num;
+        std::fill(selection, selection+cell_num, 1);
       }
+      break;
+    default:
+      assert(0);
+  }
+}
 
-      if (current_cell !=  next_cell) {
-        // Move next cell contents into current contents
-        void *src = static_cast<char *>(buffers[j])+cell_size*next_cell;
-        void *dest = static_cast<char *>(buffers[j])+cell_size*current_cell;
-        memmove(dest, src, cell_size);
-      }
+void Expression::compare_values(KernelOp op, const double* left, const double* right, int64_t cell_num, uint8_t* selection) {
+  switch (op) {
+    case KERNEL_LT:
+      compare_each(left, right, cell_num, selection, std::less<double>());
+      break;
+    case KERNEL_LE:
+      compare_each(left, right, cell_num, selection, std::less_equal<double>());
+      break;
+    case KERNEL_GT:
+      compare_each(left, right, cell_num, selection, std::greater<double>());
+      break;
+    case KERNEL_GE:
+      compare_each(left, right, cell_num, selection, std::greater_equal<double>());
+      break;
+    case KERNEL_EQ:
+      compare_each(left, right, cell_num, selection, std::equal_to<double>());
+      break;
+    case KERNEL_NE:
+      compare_each(left, right, cell_num, selection, std::not_equal_to<double>());
+      break;
+    default:
+      assert(0);
+  }
+}
 
-      buffer_sizes[j] -= reduce_by*cell_size;
-      
-      // TODO: Ignoring variable types for now
-      if (cell_val_num == TILEDB_VAR_NUM) j++;
+void Expression::fixup_return_buffers(void** buffers, size_t* buffer_sizes, int64_t number_of_cells, const std::vector<uint8_t>& selection) {
+  int64_t selected_num = std::count(selection.begin(), selection.end(), 1);
+  if (selected_num == number_of_cells) {
+    return;
+  }
+
+  for (auto i=0u, j=0u; i < attributes_.size(); i++, j++) {
+    int attribute_id = array_schema_->attribute_id(attributes_[i]);
+    size_t cell_size;
+    int cell_val_num = array_schema_->cell_val_num(attribute_id);
+    if (cell_val_num == TILEDB_VAR_NUM) {
+      cell_size = sizeof(size_t);
+    } else if (attributes_[i].compare(TILEDB_COORDS) == 0) {
+      cell_size =  array_schema_->type_size(attribute_id)*array_schema_->dim_num();
+    } else {
+      cell_size = array_schema_->type_size(attribute_id)*cell_val_num;
     }
-  }  
+
+    // Move the selected cells and the cells past the evaluated ones to the front
+    char* buffer = static_cast<char *>(buffers[j]);
+    int64_t current_cell = 0;
+    for (int64_t next_cell = 0; next_cell < number_of_cells; next_cell++) {
+      if (selection[next_cell]) {
+        if (current_cell != next_cell) {
+          memcpy(buffer+cell_size*current_cell, buffer+cell_size*next_cell, cell_size);
+        }
+        current_cell++;
+      }
+    }
+    if (buffer_sizes[j] > cell_size*number_of_cells) {
+      memmove(buffer+cell_size*current_cell, buffer+cell_size*number_of_cells, buffer_sizes[j]-cell_size*number_of_cells);
+    }
+    buffer_sizes[j] -= (number_of_cells-selected_num)*cell_size;
+
+    // TODO: Ignoring variable types for now
+    if (cell_val_num == TILEDB_VAR_NUM) j++;
+  }
 }
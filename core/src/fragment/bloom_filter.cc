@@ -0,0 +1,183 @@
+/**
+ * @file bloom_filter.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements the BloomFilter class.
+ */
+
+#include "bloom_filter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+
+
+/* ****************************** */
+/*        STATIC FUNCTIONS        */
+/* ****************************** */
+
+/** The 64-bit finalizer of MurmurHash3, which mixes all the input bits. */
+static inline uint64_t mix(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+
+
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+BloomFilter::BloomFilter(
+    int64_t key_num,
+    double false_positive_rate,
+    size_t max_size) {
+  // The optimal number of bits per key is -ln(p)/ln(2)^2
+  double ln2 = std::log(2.0);
+  double bits_per_key = -std::log(false_positive_rate) / (ln2 * ln2);
+  double bit_num = std::ceil(std::max(key_num, int64_t(1)) * bits_per_key);
+  bit_num = std::min(bit_num, double(max_size) * 8);
+  bit_num_ = std::max(int64_t(bit_num) / 64, int64_t(1)) * 64;
+
+  // The optimal number of bits set per key is ln(2) bits per key
+  double hash_num =
+      std::round(double(bit_num_) / std::max(key_num, int64_t(1)) * ln2);
+  hash_num_ =
+      int(std::min(
+              std::max(hash_num, 1.0),
+              double(TILEDB_BLOOM_FILTER_MAX_HASH_NUM)));
+
+  own_words_.assign(bit_num_ / 64, 0);
+  words_ = own_words_.data();
+}
+
+BloomFilter::BloomFilter(int64_t bit_num, int hash_num, const uint64_t* words)
+    : bit_num_(bit_num),
+      hash_num_(hash_num),
+      words_(words) {
+}
+
+
+
+
+/* ****************************** */
+/*            ACCESSORS           */
+/* ****************************** */
+
+int64_t BloomFilter::bit_num() const {
+  return bit_num_;
+}
+
+int64_t BloomFilter::capacity(double false_positive_rate, size_t size) {
+  double ln2 = std::log(2.0);
+  double bits_per_key = -std::log(false_positive_rate) / (ln2 * ln2);
+  return std::max(int64_t(std::ceil(double(size) * 8 / bits_per_key)), int64_t(1));
+}
+
+int BloomFilter::hash_num() const {
+  return hash_num_;
+}
+
+bool BloomFilter::may_contain(uint64_t hash) const {
+  uint64_t step = (hash >> 32 | hash << 32) | 1;
+  for(int i=0; i<hash_num_; ++i, hash += step) {
+    uint64_t bit = hash % uint64_t(bit_num_);
+    if(!(words_[bit / 64] & (uint64_t(1) << (bit % 64))))
+      return false;
+  }
+
+  return true;
+}
+
+const uint64_t* BloomFilter::words() const {
+  return words_;
+}
+
+template<class T>
+uint64_t BloomFilter::hash_coords(const T* coords, int dim_num, int stride) {
+  uint64_t hash = 0;
+  for(int i=0; i<dim_num; ++i) {
+    // Coordinates equal to zero are hashed as 0, which folds -0.0 into 0.0
+    T value = coords[i*stride];
+    uint64_t bits = 0;
+    if(value != 0)
+      memcpy(&bits, &value, sizeof(T));
+    hash = mix(hash ^ (bits + 0x9e3779b97f4a7c15ULL * (i+1)));
+  }
+
+  return hash;
+}
+
+
+
+
+/* ****************************** */
+/*             MUTATORS           */
+/* ****************************** */
+
+void BloomFilter::fold(int64_t key_num, double false_positive_rate) {
+  double ln2 = std::log(2.0);
+  double bits_per_key = -std::log(false_positive_rate) / (ln2 * ln2);
+  double min_bit_num = std::ceil(std::max(key_num, int64_t(1)) * bits_per_key);
+  while(bit_num_ % 128 == 0 && double(bit_num_ / 2) >= min_bit_num) {
+    int64_t word_num = bit_num_ / 128;
+    for(int64_t i=0; i<word_num; ++i)
+      own_words_[i] |= own_words_[word_num + i];
+    own_words_.resize(word_num);
+    bit_num_ /= 2;
+  }
+  own_words_.shrink_to_fit();
+  words_ = own_words_.data();
+}
+
+void BloomFilter::insert(uint64_t hash) {
+  uint64_t step = (hash >> 32 | hash << 32) | 1;
+  for(int i=0; i<hash_num_; ++i, hash += step) {
+    uint64_t bit = hash % uint64_t(bit_num_);
+    own_words_[bit / 64] |= uint64_t(1) << (bit % 64);
+  }
+}
+
+
+
+
+// Explicit template instantiations
+template uint64_t BloomFilter::hash_coords<int>(
+    const int* coords, int dim_num, int stride);
+template uint64_t BloomFilter::hash_coords<int64_t>(
+    const int64_t* coords, int dim_num, int stride);
+template uint64_t BloomFilter::hash_coords<float>(
+    const float* coords, int dim_num, int stride);
+template uint64_t BloomFilter::hash_coords<double>(
+    const double* coords, int dim_num, int stride);
@@ -33,6 +33,7 @@
 
 #include "book_keeping.h"
 #include "utils.h"
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <fcntl.h>
@@ -56,7 +57,70 @@
 /*        GLOBAL VARIABLES        */
 /* ****************************** */
 
-std::string tiledb_bk_errmsg = "";
+thread_local std::string tiledb_bk_errmsg = "";
+
+
+
+
+/* ****************************** */
+/*        STATIC FUNCTIONS        */
+/* ****************************** */
+
+/** 
+ * Returns the compression type of new sectioned book-keeping, set with env
+ * TILEDB_BOOK_KEEPING_COMPRESSION. Invalid values are reported and ignored.
+ */
+static int book_keeping_compression() {
+  auto env_var = getenv("TILEDB_BOOK_KEEPING_COMPRESSION");
+  if(env_var == NULL)
+    return TILEDB_GZIP;
+  std::string name(env_var);
+  if(name == "none")
+    return TILEDB_NO_COMPRESSION;
+  else if(name == "lz4")
+    return TILEDB_LZ4;
+  else if(name == "zstd")
+    return TILEDB_ZSTD;
+  else if(name != "gzip")
+    PRINT_ERROR("Ignoring invalid value \"" + name + "\" of TILEDB_BOOK_KEEPING_COMPRESSION");
+  return TILEDB_GZIP;
+}
+
+/** 
+ * Copies size bytes from the cursor into bytes and advances the cursor,
+ * false if that goes past end.
+ */
+static bool read_section_bytes(
+    const char*& cursor, 
+    const char* end, 
+    void* bytes, 
+    size_t size) {
+  if(size > size_t(end - cursor))
+    return false;
+  memcpy(bytes, cursor, size);
+  cursor += size;
+  return true;
+}
+
+/** 
+ * Points values at the array following the number of its values (int64_t)
+ * at the cursor, and advances the cursor past it. Returns false if that
+ * goes past end.
+ */
+static bool view_section_array(
+    const char*& cursor, 
+    const char* end, 
+    size_t value_size,
+    int64_t& num,
+    const void** values) {
+  if(!read_section_bytes(cursor, end, &num, sizeof(int64_t)) || 
+     num < 0 ||
+     uint64_t(num) > (end - cursor) / value_size)
+    return false;
+  *values = cursor;
+  cursor += num * value_size;
+  return true;
+}
 
 
 
@@ -69,13 +133,24 @@ BookKeeping::BookKeeping(
     const ArraySchema* array_schema,
     bool dense,
     const std::string& fragment_name,
-    int mode)
+    int mode,
+    bool write_sections)
     : array_schema_(array_schema), 
       dense_(dense),
       fragment_name_(fragment_name),
-      mode_(mode) {
+      mode_(mode),
+      write_sections_(write_sections) {
   domain_ = NULL;
   non_empty_domain_ = NULL;
+  attribute_loaded_num_ = 0;
+  section_compression_ = TILEDB_NO_COMPRESSION;
+  section_mbrs_ = NULL;
+  section_bounding_coords_ = NULL;
+  bounding_coords_num_ = 0;
+  mbr_num_ = 0;
+  rtree_ = NULL;
+  coords_filter_ = NULL;
+  coords_filter_loaded_ = false;
 }
 
 BookKeeping::~BookKeeping() {
@@ -85,23 +160,54 @@ BookKeeping::~BookKeeping() {
   if(non_empty_domain_ != NULL)
     free(non_empty_domain_);
 
-  int64_t mbr_num = mbrs_.size(); 
-  for(int64_t i=0; i<mbr_num; ++i)
-    if(mbrs_[i] != NULL)
-      free(mbrs_[i]);
+  if(rtree_ != NULL)
+    delete rtree_;
 
-  int64_t bounding_coords_num = bounding_coords_.size();
-  for(int64_t i=0; i<bounding_coords_num; ++i)
-    if(bounding_coords_[i] != NULL)
-      free(bounding_coords_[i]);
+  if(coords_filter_ != NULL)
+    delete coords_filter_;
+
+  int section_num = section_buffers_.size();
+  for(int i=0; i<section_num; ++i)
+    if(section_buffers_[i] != NULL)
+      free(section_buffers_[i]);
 }
 
 /* ****************************** */
 /*             ACCESSORS          */
 /* ****************************** */
 
-const std::vector<void*>& BookKeeping::bounding_coords() const {
-  return bounding_coords_;
+const void* BookKeeping::bounding_coords(int64_t tile_pos) const {
+  const char* bounding_coords = 
+      (section_bounding_coords_ != NULL) ? section_bounding_coords_ :
+                                           bounding_coords_.data();
+  return bounding_coords + tile_pos*2*array_schema_->coords_size();
+}
+
+const void* BookKeeping::bounding_domain() {
+  // Dense fragments are bounded by their non-empty domain
+  if(dense_ || non_empty_domain_ == NULL || mbr_num_ == 0)
+    return non_empty_domain_;
+
+  std::lock_guard<std::mutex> lock(bounding_domain_mtx_);
+  if(bounding_domain_.empty()) {
+    // Invoke the proper templated function
+    int coords_type = array_schema_->coords_type();
+    if(coords_type == TILEDB_INT32) {
+      compute_bounding_domain<int>();
+    } else if(coords_type == TILEDB_INT64) {
+      compute_bounding_domain<int64_t>();
+    } else if(coords_type == TILEDB_FLOAT32) {
+      compute_bounding_domain<float>();
+    } else if(coords_type == TILEDB_FLOAT64) {
+      compute_bounding_domain<double>();
+    } else {
+      // The code should never reach here
+      assert(0);
+      return non_empty_domain_;
+    }
+  }
+
+  return bounding_domain_.data();
 }
 
 int64_t BookKeeping::cell_num(int64_t tile_pos) const {
@@ -116,6 +222,17 @@ int64_t BookKeeping::cell_num(int64_t tile_pos) const {
   }
 }
 
+const BloomFilter* BookKeeping::coords_filter() {
+  // Written and eagerly loaded fragments have no filter to decode
+  std::lock_guard<std::mutex> lock(attribute_mtx_);
+  if(!coords_filter_loaded_ && !attribute_loaded_.empty()) {
+    coords_filter_loaded_ = true;
+    load_coords_filter();
+  }
+
+  return coords_filter_;
+}
+
 bool BookKeeping::dense() const {
   return dense_;
 }
@@ -128,8 +245,38 @@ int64_t BookKeeping::last_tile_cell_num() const {
   return last_tile_cell_num_;
 }
 
-const std::vector<void*>& BookKeeping::mbrs() const {
-  return mbrs_;
+const void* BookKeeping::mbr(int64_t tile_pos) const {
+  return static_cast<const char*>(mbrs()) + 
+         tile_pos*2*array_schema_->coords_size();
+}
+
+const void* BookKeeping::mbrs() const {
+  return (section_mbrs_ != NULL) ? section_mbrs_ : mbrs_.data();
+}
+
+const void* BookKeeping::mbr_columns() {
+  std::lock_guard<std::mutex> lock(mbr_columns_mtx_);
+
+  // For easy reference
+  int dim_num = array_schema_->dim_num();
+  size_t value_size = array_schema_->coords_size() / dim_num;
+  size_t column_num = 2*dim_num;
+  const char* mbrs = static_cast<const char*>(this->mbrs());
+
+  // Transpose the MBRs on first use
+  if(mbr_columns_.size() != mbr_num_*column_num*value_size) {
+    mbr_columns_.resize(mbr_num_*column_num*value_size);
+    for(size_t j=0; j<column_num; ++j) {
+      char* column = &mbr_columns_[j*mbr_num_*value_size];
+      for(int64_t i=0; i<mbr_num_; ++i) 
+        memcpy(
+            column + i*value_size, 
+            mbrs + (i*column_num + j)*value_size, 
+            value_size);
+    }
+  }
+
+  return mbr_columns_.data();
 }
 
 const void* BookKeeping::non_empty_domain() const {
@@ -141,24 +288,45 @@ bool BookKeeping::read_mode() const {
   return array_read_mode(mode_);
 }
 
+const RTree* BookKeeping::rtree() {
+  // The MBR columns the tree is built over are computed outside the lock
+  const void* mbr_columns = this->mbr_columns();
+
+  std::lock_guard<std::mutex> lock(rtree_mtx_);
+  if(rtree_ == NULL)
+    rtree_ = new RTree(
+                 array_schema_->coords_type(),
+                 array_schema_->dim_num(),
+                 mbr_num_,
+                 mbr_columns);
+
+  return rtree_;
+}
+
 int64_t BookKeeping::tile_num() const {
   if(dense_) {
     return array_schema_->tile_num(domain_);
   } else { 
-    return mbrs_.size();
+    return mbr_num_;
   }
 }
 
-const std::vector<std::vector<off_t> >& BookKeeping::tile_offsets() const {
-  return tile_offsets_;
+const off_t* BookKeeping::tile_offsets(int attribute_id) const {
+  if(!section_tile_offsets_.empty())
+    return section_tile_offsets_[attribute_id];
+  return tile_offsets_[attribute_id].data();
 }
 
-const std::vector<std::vector<off_t> >& BookKeeping::tile_var_offsets() const {
-  return tile_var_offsets_;
+const off_t* BookKeeping::tile_var_offsets(int attribute_id) const {
+  if(!section_tile_var_offsets_.empty())
+    return section_tile_var_offsets_[attribute_id];
+  return tile_var_offsets_[attribute_id].data();
 }
 
-const std::vector<std::vector<size_t> >& BookKeeping::tile_var_sizes() const {
-  return tile_var_sizes_;
+const size_t* BookKeeping::tile_var_sizes(int attribute_id) const {
+  if(!section_tile_var_sizes_.empty())
+    return section_tile_var_sizes_[attribute_id];
+  return tile_var_sizes_[attribute_id].data();
 }
 
 inline
@@ -166,6 +334,26 @@ bool BookKeeping::write_mode() const {
   return array_write_mode(mode_);
 }
 
+std::string BookKeeping::filename() const {
+  std::string filename = fragment_name_ + "/" +
+                         TILEDB_BOOK_KEEPING_FILENAME + 
+                         TILEDB_FILE_SUFFIX;
+  return write_sections() ? filename : filename + TILEDB_GZIP_SUFFIX;
+}
+
+bool BookKeeping::write_sections() const {
+  return write_sections_;
+}
+
+const TileZoneMap* BookKeeping::zone_maps(int attribute_id) const {
+  if(!section_zone_maps_.empty())
+    return section_zone_maps_[attribute_id];
+  if(size_t(attribute_id) >= zone_maps_.size() || 
+     zone_maps_[attribute_id].empty())
+    return NULL;
+  return zone_maps_[attribute_id].data();
+}
+
 
 
 
@@ -177,20 +365,23 @@ void BookKeeping::append_bounding_coords(const void* bounding_coords) {
   // For easy reference
   size_t bounding_coords_size = 2*array_schema_->coords_size();
 
-  // Copy and append MBR
-  void* new_bounding_coords = malloc(bounding_coords_size);
-  memcpy(new_bounding_coords, bounding_coords, bounding_coords_size);
-  bounding_coords_.push_back(new_bounding_coords);
+  // Append bounding coordinates
+  const char* bytes = static_cast<const char*>(bounding_coords);
+  bounding_coords_.insert(
+      bounding_coords_.end(), 
+      bytes, 
+      bytes + bounding_coords_size);
+  ++bounding_coords_num_;
 }
 
 void BookKeeping::append_mbr(const void* mbr) {
   // For easy reference
   size_t mbr_size = 2*array_schema_->coords_size();
 
-  // Copy and append MBR
-  void* new_mbr = malloc(mbr_size);
-  memcpy(new_mbr, mbr, mbr_size);
-  mbrs_.push_back(new_mbr);
+  // Append MBR
+  const char* bytes = static_cast<const char*>(mbr);
+  mbrs_.insert(mbrs_.end(), bytes, bytes + mbr_size);
+  ++mbr_num_;
 }
 
 void BookKeeping::append_tile_offset(
@@ -216,31 +407,57 @@ void BookKeeping::append_tile_var_size(
   tile_var_sizes_[attribute_id].push_back(size);
 }
 
+void BookKeeping::append_zone_map(
+    int attribute_id,
+    const TileZoneMap& zone_map) {
+  zone_maps_[attribute_id].push_back(zone_map);
+}
+
 /* FORMAT:
+ * sectioned(size_t) version(int) section_num(int) compression(int) 
+ *     reserved(int)
+ * section_#0_offset(int64_t) section_#0_compressed_size(int64_t)
+ *     section_#0_size(int64_t)
+ * ...
+ * section_#<section_num-1>_offset(int64_t) 
+ *     section_#<section_num-1>_compressed_size(int64_t)
+ *     section_#<section_num-1>_size(int64_t)
+ * section_#0 padding section_#1 ... padding section_#<section_num-1>
+ * where each section is compressed with the compression type and padded
+ * to start at a multiple of TILEDB_BK_SECTION_ALIGNMENT. The sections hold
+ * arrays of fixed-sized values only, so that uncompressed they can be used
+ * in place.
+ *
+ * Section #0:
  * non_empty_domain_size(size_t) non_empty_domain(void*)  
  * mbr_num(int64_t)
  * mbr_#1(void*) mbr_#2(void*) ... 
  * bounding_coords_num(int64_t)
  * bounding_coords_#1(void*) bounding_coords_#2(void*) ...
- * tile_offsets_attr#0_num(int64_t)
- * tile_offsets_attr#0_#1 (off_t) tile_offsets_attr#0_#2 (off_t) ...
- * ...
- * tile_offsets_attr#<attribute_num>_num(int64_t)
- * tile_offsets_attr#<attribute_num>_#1(off_t) 
- *     tile_offsets_attr#<attribute_num>_#2 (off_t) ...
- * tile_var_offsets_attr#0_num(int64_t)
- * tile_var_offsets_attr#0_#1 (off_t) tile_var_offsets_attr#0_#2 (off_t) ...
- * ...
- * tile_var_offsets_attr#<attribute_num-1>_num(int64_t)
- * tile_var_offsets_attr#<attribute_num-1>_#1 (off_t) 
- *     tile_var_offsets_attr#<attribute_num-1>_#2 (off_t) ...
- * tile_var_sizes_attr#0_num(int64_t)
- * tile_var_sizes_attr#0_#1(size_t) tile_sizes_attr#0_#2 (size_t) ...
- * ...
- * tile_var_sizes_attr#<attribute_num-1>_num(int64_t)
- * tile_var_sizes__attr#<attribute_num-1>_#1(size_t) 
- *     tile_var_sizes_attr#<attribute_num-1>_#2 (size_t) ...
  * last_tile_cell_num(int64_t)
+ *
+ * Section #<attribute_id+1>, for each attribute and the coordinates:
+ * tile_offsets_attr#<attribute_id>_num(int64_t)
+ * tile_offsets_attr#<attribute_id>_#1 (off_t) 
+ *     tile_offsets_attr#<attribute_id>_#2 (off_t) ...
+ * tile_var_offsets_attr#<attribute_id>_num(int64_t)
+ * tile_var_offsets_attr#<attribute_id>_#1 (off_t) 
+ *     tile_var_offsets_attr#<attribute_id>_#2 (off_t) ...
+ * tile_var_sizes_attr#<attribute_id>_num(int64_t)
+ * tile_var_sizes_attr#<attribute_id>_#1(size_t) 
+ *     tile_var_sizes_attr#<attribute_id>_#2 (size_t) ...
+ * zone_maps_attr#<attribute_id>_num(int64_t)
+ * zone_map_attr#<attribute_id>_#1(TileZoneMap)
+ *     zone_map_attr#<attribute_id>_#2(TileZoneMap) ...
+ * where the variable tile offsets and sizes and the zone maps are missing for
+ * the coordinates. The zone maps are missing as well in fragments written
+ * before them.
+ *
+ * Section #<attribute_num+2>, only for sparse fragments with a coordinates 
+ * filter:
+ * hash_num(int64_t)
+ * coords_filter_word_num(int64_t)
+ * coords_filter_word_#1(uint64_t) coords_filter_word_#2(uint64_t) ...
  */
 int BookKeeping::finalize(StorageFS *fs) {
   // Nothing to do in READ mode
@@ -250,50 +467,120 @@ int BookKeeping::finalize(StorageFS *fs) {
   // Do nothing if the fragment directory does not exist (fragment empty) 
   if(!is_dir(fs, fragment_name_))
     return TILEDB_BK_OK;
-  
-  // Write non-empty domain
-  if(flush_non_empty_domain() != TILEDB_BK_OK)
-    return TILEDB_BK_ERR;
-
-  // Write MBRs
-  if(flush_mbrs() != TILEDB_BK_OK)
-    return TILEDB_BK_ERR;
-
-  // Write bounding coordinates
-  if(flush_bounding_coords() != TILEDB_BK_OK)
-    return TILEDB_BK_ERR;
 
-  // Write tile offsets
-  if(flush_tile_offsets() != TILEDB_BK_OK)
-    return TILEDB_BK_ERR;
+  // Readers without the sectioned layout must be able to open the fragment
+  if(!write_sections())
+    return flush_legacy(fs);
 
-  // Write variable tile offsets
-  if(flush_tile_var_offsets() != TILEDB_BK_OK)
-    return TILEDB_BK_ERR;
+  // For easy reference
+  int attribute_num = array_schema_->attribute_num();
+  int section_num = attribute_num + 2 + (coords_filter_ != NULL);
+  std::vector<BookKeepingSection> section_index(section_num);
+  Buffer sections;
+
+  // Get the codec of the sections
+  int compression = book_keeping_compression();
+  Codec* codec = NULL;
+  if(compression != TILEDB_NO_COMPRESSION) {
+    try {
+      codec = Codec::create(compression, Codec::get_default_level(compression));
+    } catch(std::exception& e) {
+      codec = NULL;
+    }
+    if(codec == NULL) {
+      std::string errmsg = 
+          "Cannot finalize book-keeping; Unsupported compression type " + 
+          std::to_string(compression);
+      PRINT_ERROR(errmsg);
+      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+      return TILEDB_BK_ERR;
+    }
+  }
+  
+  // Write non-empty domain, MBRs, bounding coordinates and cell number of 
+  // the last tile as the first section
+  int rc = TILEDB_BK_OK;
+  if(flush_non_empty_domain() != TILEDB_BK_OK ||
+     flush_mbrs() != TILEDB_BK_OK ||
+     flush_bounding_coords() != TILEDB_BK_OK ||
+     flush_last_tile_cell_num() != TILEDB_BK_OK ||
+     compress_section(codec, sections, section_index[0]) != TILEDB_BK_OK)
+    rc = TILEDB_BK_ERR;
+
+  // Write tile offsets and sizes as one section per attribute, so that 
+  // readers decode only the attributes they access
+  for(int i=0; rc == TILEDB_BK_OK && i<attribute_num+1; ++i) {
+    if(flush_tile_offsets(i) != TILEDB_BK_OK ||
+       (i < attribute_num &&
+        (flush_tile_var_offsets(i) != TILEDB_BK_OK ||
+         flush_tile_var_sizes(i) != TILEDB_BK_OK ||
+         flush_zone_maps(i) != TILEDB_BK_OK)) ||
+       compress_section(codec, sections, section_index[i+1]) != TILEDB_BK_OK)
+      rc = TILEDB_BK_ERR;
+  }
 
-  // Write variable tile sizes
-  if(flush_tile_var_sizes() != TILEDB_BK_OK)
+  // Write the coordinates filter as the last section, decoded only for
+  // point lookups
+  if(rc == TILEDB_BK_OK && 
+     coords_filter_ != NULL &&
+     (flush_coords_filter() != TILEDB_BK_OK ||
+      compress_section(
+          codec, 
+          sections, 
+          section_index[attribute_num+2]) != TILEDB_BK_OK))
+    rc = TILEDB_BK_ERR;
+  delete codec;
+  if(rc != TILEDB_BK_OK)
     return TILEDB_BK_ERR;
 
-  // Write cell number of the last tile
-  if(flush_last_tile_cell_num() != TILEDB_BK_OK)
+  // Write the section index followed by the sections
+  size_t sectioned = TILEDB_BK_SECTIONED;
+  int version = TILEDB_BK_VERSION;
+  int reserved = 0;
+  int64_t index_size = 
+      sizeof(size_t) + 4*sizeof(int) + 
+      section_num*3*sizeof(int64_t);
+  assert(index_size % TILEDB_BK_SECTION_ALIGNMENT == 0);
+  bool ok = 
+      buffer_.append_buffer(&sectioned, sizeof(size_t)) == TILEDB_BF_OK &&
+      buffer_.append_buffer(&version, sizeof(int)) == TILEDB_BF_OK &&
+      buffer_.append_buffer(&section_num, sizeof(int)) == TILEDB_BF_OK &&
+      buffer_.append_buffer(&compression, sizeof(int)) == TILEDB_BF_OK &&
+      buffer_.append_buffer(&reserved, sizeof(int)) == TILEDB_BF_OK;
+  for(int i=0; ok && i<section_num; ++i) {
+    int64_t offset = index_size + section_index[i].offset_;
+    ok = 
+        buffer_.append_buffer(&offset, sizeof(int64_t)) == TILEDB_BF_OK &&
+        buffer_.append_buffer(
+            &section_index[i].compressed_size_, 
+            sizeof(int64_t)) == TILEDB_BF_OK &&
+        buffer_.append_buffer(
+            &section_index[i].size_, 
+            sizeof(int64_t)) == TILEDB_BF_OK;
+  }
+  if(!ok || 
+     buffer_.append_buffer(
+         sections.get_buffer(), 
+         sections.get_buffer_size()) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing section index failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
     return TILEDB_BK_ERR;
+  }
 
-  // Prepare file name 
-  std::string filename = fragment_name_ + "/" +
-                         TILEDB_BOOK_KEEPING_FILENAME + 
-                         TILEDB_FILE_SUFFIX + TILEDB_GZIP_SUFFIX;
-
-  if(write_to_file_after_compression(fs, filename.c_str(), buffer_.get_buffer(), buffer_.get_buffer_size(), TILEDB_GZIP) == TILEDB_UT_ERR) {
+  // The file is made durable when the fragment is committed
+  std::string filename = this->filename();
+  if(write_to_file(fs, filename, buffer_.get_buffer(), buffer_.get_buffer_size()) == TILEDB_UT_ERR ||
+     close_file(fs, filename) == TILEDB_UT_ERR) {
     std::string errmsg =
         "Cannot finalize book-keeping; Failure to write to file " + filename;
     PRINT_ERROR(errmsg);
     tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
     return TILEDB_BK_ERR;
-    }
+  }
 
-  // Success
-  buffer_.free_buffer();
+  // Success, the serialized buffer is kept for the fragment manifest
   return TILEDB_BK_OK;  
 }
 
@@ -336,11 +623,16 @@ int BookKeeping::init(const void* non_empty_domain) {
   // Initialize variable tile sizes
   tile_var_sizes_.resize(attribute_num);
 
+  // Initialize zone maps
+  zone_maps_.resize(attribute_num);
+
   // Success
   return TILEDB_BK_OK;
 }
 
 /* FORMAT:
+ * The sectioned layout described for finalize in __book_keeping.tdb, or the
+ * legacy layout in __book_keeping.tdb.gz, a GZIP stream of:
  * non_empty_domain_size(size_t) non_empty_domain(void*)  
  * mbr_num(int64_t)
  * mbr_#1(void*) mbr_#2(void*) ... 
@@ -368,14 +660,34 @@ int BookKeeping::init(const void* non_empty_domain) {
  */
 int BookKeeping::load(StorageFS *fs) {
   // Prepare file name
-  std::string filename = fragment_name_ + "/" +
-                         TILEDB_BOOK_KEEPING_FILENAME + 
-                         TILEDB_FILE_SUFFIX + TILEDB_GZIP_SUFFIX;
-
-  // Open book-keeping file
-  size_t size;
-  void *buf;
-  if (read_from_file_after_decompression(fs, filename, &buf, size, TILEDB_GZIP) == TILEDB_UT_ERR) {
+  std::string sectioned_filename = fragment_name_ + "/" +
+                                   TILEDB_BOOK_KEEPING_FILENAME + 
+                                   TILEDB_FILE_SUFFIX;
+  std::string legacy_filename = sectioned_filename + TILEDB_GZIP_SUFFIX;
+
+  // Open the book-keeping file of the layout new fragments get, or of the
+  // other layout if it does not exist. The existence check reports no error
+  std::string filename = 
+      write_sections_ ? sectioned_filename : legacy_filename;
+  if(!is_file(fs, filename))
+    filename = write_sections_ ? legacy_filename : sectioned_filename;
+  bool sectioned = filename == sectioned_filename;
+  size_t size = 0;
+  void *buf = NULL;
+  int rc;
+  if(!sectioned) {
+    rc = read_from_file_after_decompression(fs, filename, &buf, size, TILEDB_GZIP);
+  } else {
+    ssize_t sectioned_size = file_size(fs, filename);
+    size = sectioned_size > 0 ? sectioned_size : 0;
+    buf = size > 0 ? malloc(size) : NULL;
+    rc = (buf == NULL) ? 
+             TILEDB_UT_ERR : read_from_file(fs, filename, 0, buf, size);
+    close_file(fs, filename);
+    if(rc == TILEDB_UT_ERR)
+      free(buf);
+  }
+  if(rc == TILEDB_UT_ERR) {
     std::string errmsg = "Cannot read book-keeping file; Read failure for " + filename;
     PRINT_ERROR(errmsg);
     tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
@@ -383,39 +695,95 @@ int BookKeeping::load(StorageFS *fs) {
   }
   buffer_.set_buffer(buf, size);
 
-  // Load non-empty domain
-  if(load_non_empty_domain() != TILEDB_BK_OK)
-    return TILEDB_BK_ERR;
+  return load_buffer();
+}
 
-  // Load MBRs
-  if(load_mbrs() != TILEDB_BK_OK)
+int BookKeeping::load(const void* bytes, size_t size) {
+  void* buf = malloc(size);
+  if(buf == NULL) {
+    std::string errmsg = "Cannot load book-keeping; Mem allocation error";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
     return TILEDB_BK_ERR;
+  }
+  memcpy(buf, bytes, size);
+  buffer_.set_buffer(buf, size);
 
-  // Load bounding coordinates
-  if(load_bounding_coords() != TILEDB_BK_OK)
-    return TILEDB_BK_ERR;
+  return load_buffer();
+}
 
-  // Load tile offsets
-  if(load_tile_offsets() != TILEDB_BK_OK)
-    return TILEDB_BK_ERR;
+int BookKeeping::load_attribute(int attribute_id) {
+  std::lock_guard<std::mutex> lock(attribute_mtx_);
 
-  // Load variable tile offsets
-  if(load_tile_var_offsets() != TILEDB_BK_OK)
-    return TILEDB_BK_ERR;
+  // Nothing to do if written, loaded eagerly or already decoded
+  if(attribute_loaded_.empty() || attribute_loaded_[attribute_id])
+    return TILEDB_BK_OK;
 
-  // Load variable tile sizes
-  if(load_tile_var_sizes() != TILEDB_BK_OK)
-    return TILEDB_BK_ERR;
+  // For easy reference
+  int attribute_num = array_schema_->attribute_num();
+  int section = attribute_id + 1;
 
-  // Load cell number of last tile
-  if(load_last_tile_cell_num() != TILEDB_BK_OK)
+  // Point the tile offsets and sizes into the section of the attribute
+  const char* data;
+  if(load_section(section, &data) != TILEDB_BK_OK)
+    return TILEDB_BK_ERR;
+  const char* cursor = data;
+  const char* end = data + section_index_[section].size_;
+  int64_t num;
+  const void* values;
+  bool ok = view_section_array(cursor, end, sizeof(off_t), num, &values);
+  section_tile_offsets_[attribute_id] = static_cast<const off_t*>(values);
+  if(ok && attribute_id < attribute_num) {
+    ok = view_section_array(cursor, end, sizeof(off_t), num, &values);
+    section_tile_var_offsets_[attribute_id] = 
+        static_cast<const off_t*>(values);
+    ok = ok && view_section_array(cursor, end, sizeof(size_t), num, &values);
+    section_tile_var_sizes_[attribute_id] = 
+        static_cast<const size_t*>(values);
+    // Zone maps are optional, and ignored unless there is one per tile
+    if(ok && cursor < end) {
+      ok = view_section_array(cursor, end, sizeof(TileZoneMap), num, &values);
+      if(num == mbr_num_ && num > 0)
+        section_zone_maps_[attribute_id] = 
+            static_cast<const TileZoneMap*>(values);
+    }
+  }
+  if(!ok) {
+    std::string errmsg = 
+        "Cannot load book-keeping; Reading tile offsets of section " + 
+        std::to_string(section) + " failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
     return TILEDB_BK_ERR;
+  }
+  attribute_loaded_[attribute_id] = true;
+
+  // Compressed sections are not needed once every attribute and the
+  // coordinates filter are decompressed
+  if(++attribute_loaded_num_ == attribute_loaded_.size() &&
+     section_compression_ != TILEDB_NO_COMPRESSION &&
+     (coords_filter_loaded_ || 
+      int(section_index_.size()) == array_schema_->attribute_num()+2)) 
+    sections_.free_buffer();
 
   // Success
-  buffer_.free_buffer();
   return TILEDB_BK_OK;
 }
 
+void* BookKeeping::serialized_buffer() {
+  return buffer_.get_buffer();
+}
+
+size_t BookKeeping::serialized_buffer_size() {
+  return buffer_.get_buffer_size();
+}
+
+void BookKeeping::set_coords_filter(BloomFilter* coords_filter) {
+  if(coords_filter_ != NULL)
+    delete coords_filter_;
+  coords_filter_ = coords_filter;
+}
+
 void BookKeeping::set_last_tile_cell_num(int64_t cell_num) {
   last_tile_cell_num_ = cell_num;
 }
@@ -425,14 +793,75 @@ void BookKeeping::set_last_tile_cell_num(int64_t cell_num) {
 /*        PRIVATE METHODS         */
 /* ****************************** */
 
+template<class T>
+void BookKeeping::compute_bounding_domain() {
+  // For easy reference
+  int dim_num = array_schema_->dim_num();
+  const T* mbrs = static_cast<const T*>(this->mbrs());
+
+  // Widen the first MBR by all the others
+  bounding_domain_.resize(2*array_schema_->coords_size());
+  T* bounding_domain = reinterpret_cast<T*>(bounding_domain_.data());
+  memcpy(bounding_domain, mbrs, bounding_domain_.size());
+  for(int64_t i=1; i<mbr_num_; ++i) {
+    const T* mbr = &mbrs[2*dim_num*i];
+    for(int j=0; j<dim_num; ++j) {
+      bounding_domain[2*j] = std::min(bounding_domain[2*j], mbr[2*j]);
+      bounding_domain[2*j+1] = std::max(bounding_domain[2*j+1], mbr[2*j+1]);
+    }
+  }
+}
+
+int BookKeeping::compress_section(
+    Codec* codec,
+    Buffer& sections, 
+    BookKeepingSection& section) {
+  // For easy reference
+  size_t size = buffer_.get_buffer_size();
+  static const char padding[TILEDB_BK_SECTION_ALIGNMENT] = { 0 };
+  size_t padding_size = 
+      (TILEDB_BK_SECTION_ALIGNMENT - 
+       sections.get_buffer_size() % TILEDB_BK_SECTION_ALIGNMENT) % 
+      TILEDB_BK_SECTION_ALIGNMENT;
+
+  // Compress the book-keeping buffer and append it aligned to the sections
+  void* compressed = buffer_.get_buffer();
+  size_t compressed_size = size;
+  int rc = TILEDB_BF_OK;
+  if(codec != NULL &&
+     codec->compress_tile(
+         static_cast<unsigned char*>(buffer_.get_buffer()),
+         size,
+         &compressed,
+         compressed_size) != TILEDB_CD_OK)
+    rc = TILEDB_BF_ERR;
+  if(rc == TILEDB_BF_OK && padding_size > 0)
+    rc = sections.append_buffer(padding, padding_size);
+  section.offset_ = sections.get_buffer_size();
+  section.compressed_size_ = compressed_size;
+  section.size_ = size;
+  if(rc == TILEDB_BF_OK)
+    rc = sections.append_buffer(compressed, compressed_size);
+  buffer_.free_buffer();
+  if(rc != TILEDB_BF_OK) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Compressing section failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
+
+  // Success
+  return TILEDB_BK_OK;
+}
+
 /* FORMAT:
  * bounding_coords_num(int64_t)
  * bounding_coords_#1(void*) bounding_coords_#2(void*) ...
  */
 int BookKeeping::flush_bounding_coords() {
   // For easy reference
-  size_t bounding_coords_size = 2*array_schema_->coords_size();
-  int64_t bounding_coords_num = bounding_coords_.size();
+  int64_t bounding_coords_num = bounding_coords_num_;
 
   // Write number of bounding coordinates
   if(buffer_.append_buffer(&bounding_coords_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
@@ -444,15 +873,40 @@ int BookKeeping::flush_bounding_coords() {
     return TILEDB_BK_ERR;
   }
 
+  if(bounding_coords_num == 0)
+    return TILEDB_BK_OK;
+
   // Write bounding coordinates
-  for(int64_t i=0; i<bounding_coords_num; ++i) {
-    if(buffer_.append_buffer(bounding_coords_[i], bounding_coords_size) == TILEDB_BF_ERR) {
-      std::string errmsg = 
-          "Cannot finalize book-keeping; Writing bounding coordinates failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
+  if(buffer_.append_buffer(bounding_coords_.data(), bounding_coords_.size()) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing bounding coordinates failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
+
+  // Success
+  return TILEDB_BK_OK;
+}
+
+/* FORMAT:
+ * hash_num(int64_t)
+ * coords_filter_word_num(int64_t)
+ * coords_filter_word_#1(uint64_t) coords_filter_word_#2(uint64_t) ...
+ */
+int BookKeeping::flush_coords_filter() {
+  int64_t hash_num = coords_filter_->hash_num();
+  int64_t word_num = coords_filter_->bit_num() / 64;
+  if(buffer_.append_buffer(&hash_num, sizeof(int64_t)) == TILEDB_BF_ERR ||
+     buffer_.append_buffer(&word_num, sizeof(int64_t)) == TILEDB_BF_ERR ||
+     buffer_.append_buffer(
+         coords_filter_->words(), 
+         word_num * sizeof(uint64_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing coordinates filter failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
   }
 
   // Success
@@ -484,14 +938,55 @@ int BookKeeping::flush_last_tile_cell_num() {
   return TILEDB_BK_OK;
 }
 
+/* FORMAT:
+ * The legacy layout described for load, compressed with GZIP.
+ */
+int BookKeeping::flush_legacy(StorageFS *fs) {
+  // For easy reference
+  int attribute_num = array_schema_->attribute_num();
+
+  // Write non-empty domain, MBRs and bounding coordinates
+  if(flush_non_empty_domain() != TILEDB_BK_OK ||
+     flush_mbrs() != TILEDB_BK_OK ||
+     flush_bounding_coords() != TILEDB_BK_OK)
+    return TILEDB_BK_ERR;
+
+  // Write tile offsets, variable tile offsets and variable tile sizes
+  for(int i=0; i<attribute_num+1; ++i)
+    if(flush_tile_offsets(i) != TILEDB_BK_OK)
+      return TILEDB_BK_ERR;
+  for(int i=0; i<attribute_num; ++i)
+    if(flush_tile_var_offsets(i) != TILEDB_BK_OK)
+      return TILEDB_BK_ERR;
+  for(int i=0; i<attribute_num; ++i)
+    if(flush_tile_var_sizes(i) != TILEDB_BK_OK)
+      return TILEDB_BK_ERR;
+
+  // Write cell number of the last tile
+  if(flush_last_tile_cell_num() != TILEDB_BK_OK)
+    return TILEDB_BK_ERR;
+
+  // The file is made durable when the fragment is committed
+  std::string filename = this->filename();
+  if(write_to_file_after_compression(fs, filename.c_str(), buffer_.get_buffer(), buffer_.get_buffer_size(), TILEDB_GZIP, false) == TILEDB_UT_ERR) {
+    std::string errmsg =
+        "Cannot finalize book-keeping; Failure to write to file " + filename;
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
+
+  // Success, the serialized buffer is kept for the fragment manifest
+  return TILEDB_BK_OK;  
+}
+
 /* FORMAT:
  * mbr_num(int64_t)
  * mbr_#1(void*) mbr_#2(void*) ... 
  */
 int BookKeeping::flush_mbrs() {
   // For easy reference
-  size_t mbr_size = 2*array_schema_->coords_size();
-  int64_t mbr_num = mbrs_.size();
+  int64_t mbr_num = mbr_num_;
 
   // Write number of MBRs
   if(buffer_.append_buffer(&mbr_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
@@ -502,15 +997,16 @@ int BookKeeping::flush_mbrs() {
     return TILEDB_BK_ERR;
   }
 
+  if(mbr_num == 0)
+    return TILEDB_BK_OK;
+
   // Write MBRs
-  for(int64_t i=0; i<mbr_num; ++i) {
-    if(buffer_.append_buffer(mbrs_[i], mbr_size) == TILEDB_BF_ERR) {
-      std::string errmsg = "Cannot finalize book-keeping; Writing MBR failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
-  } 
+  if(buffer_.append_buffer(mbrs_.data(), mbrs_.size()) == TILEDB_BF_ERR) {
+    std::string errmsg = "Cannot finalize book-keeping; Writing MBRs failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
 
   // Success
   return TILEDB_BK_OK;
@@ -549,41 +1045,31 @@ int BookKeeping::flush_non_empty_domain() {
 }
 
 /* FORMAT:
- * tile_offsets_attr#0_num(int64_t)
- * tile_offsets_attr#0_#1 (off_t) tile_offsets_attr#0_#2 (off_t) ...
- * ...
- * tile_offsets_attr#<attribute_num>_num(int64_t)
- * tile_offsets_attr#<attribute_num>_#1 (off_t)
- * tile_offsets_attr#<attribute_num>_#2 (off_t) ...
+ * tile_offsets_attr#<attribute_id>_num(int64_t)
+ * tile_offsets_attr#<attribute_id>_#1 (off_t)
+ * tile_offsets_attr#<attribute_id>_#2 (off_t) ...
  */
-int BookKeeping::flush_tile_offsets() {
-  // For easy reference
-  int attribute_num = array_schema_->attribute_num();
-  int64_t tile_offsets_num;
-
-  // Write tile offsets for each attribute
-  for(int i=0; i<attribute_num+1; ++i) {
-    // Write number of tile offsets
-    tile_offsets_num = tile_offsets_[i].size(); 
-    if (buffer_.append_buffer(&tile_offsets_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
-      std::string errmsg = 
-          "Cannot finalize book-keeping; Writing number of tile offsets failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
+int BookKeeping::flush_tile_offsets(int attribute_id) {
+  // Write number of tile offsets
+  int64_t tile_offsets_num = tile_offsets_[attribute_id].size(); 
+  if (buffer_.append_buffer(&tile_offsets_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing number of tile offsets failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
 
-    if(tile_offsets_num == 0)
-      continue;
+  if(tile_offsets_num == 0)
+    return TILEDB_BK_OK;
 
-    // Write tile offsets
-    if(buffer_.append_buffer(&tile_offsets_[i][0], tile_offsets_num * sizeof(off_t)) == TILEDB_BF_ERR) {
-      std::string errmsg = 
-          "Cannot finalize book-keeping; Writing tile offsets failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
+  // Write tile offsets
+  if(buffer_.append_buffer(&tile_offsets_[attribute_id][0], tile_offsets_num * sizeof(off_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing tile offsets failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
   }
 
   // Success
@@ -591,42 +1077,32 @@ int BookKeeping::flush_tile_offsets() {
 }
 
 /* FORMAT:
- * tile_var_offsets_attr#0_num(int64_t)
- * tile_var_offsets_attr#0_#1 (off_t) tile_var_offsets_attr#0_#2 (off_t) ...
- * ...
- * tile_var_offsets_attr#<attribute_num-1>_num(int64_t)
- * tile_var_offsets_attr#<attribute_num-1>_#1 (off_t)
- *     tile_var_offsets_attr#<attribute_num-1>_#2 (off_t) ...
+ * tile_var_offsets_attr#<attribute_id>_num(int64_t)
+ * tile_var_offsets_attr#<attribute_id>_#1 (off_t)
+ *     tile_var_offsets_attr#<attribute_id>_#2 (off_t) ...
  */
-int BookKeeping::flush_tile_var_offsets() {
-  // For easy reference
-  int attribute_num = array_schema_->attribute_num();
-  int64_t tile_var_offsets_num;
-
-  // Write tile offsets for each attribute
-  for(int i=0; i<attribute_num; ++i) {
-    // Write number of offsets
-    tile_var_offsets_num = tile_var_offsets_[i].size(); 
-    if(buffer_.append_buffer(&tile_var_offsets_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
-      std::string errmsg = 
-          "Cannot finalize book-keeping; Writing number of "
-          "variable tile offsets failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
+int BookKeeping::flush_tile_var_offsets(int attribute_id) {
+  // Write number of offsets
+  int64_t tile_var_offsets_num = tile_var_offsets_[attribute_id].size(); 
+  if(buffer_.append_buffer(&tile_var_offsets_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing number of "
+        "variable tile offsets failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
 
-    if(tile_var_offsets_num == 0)
-      continue;
+  if(tile_var_offsets_num == 0)
+    return TILEDB_BK_OK;
 
-    // Write tile offsets
-    if(buffer_.append_buffer(&tile_var_offsets_[i][0], tile_var_offsets_num * sizeof(off_t)) == TILEDB_BF_ERR) {
-      std::string errmsg = 
-          "Cannot finalize book-keeping; Writing variable tile offsets failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
+  // Write tile offsets
+  if(buffer_.append_buffer(&tile_var_offsets_[attribute_id][0], tile_var_offsets_num * sizeof(off_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing variable tile offsets failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
   }
 
   // Success
@@ -634,42 +1110,64 @@ int BookKeeping::flush_tile_var_offsets() {
 }
  
 /* FORMAT:
- * tile_var_sizes_attr#0_num(int64_t)
- * tile_var_sizes_attr#0_#1 (size_t) tile_sizes_attr#0_#2 (size_t) ...
- * ...
- * tile_var_sizes_attr#<attribute_num-1>_num(int64_t)
- * tile_var_sizes__attr#<attribute_num-1>_#1(size_t) 
- *     tile_var_sizes_attr#<attribute_num-1>_#2 (size_t) ...
+ * tile_var_sizes_attr#<attribute_id>_num(int64_t)
+ * tile_var_sizes_attr#<attribute_id>_#1(size_t) 
+ *     tile_var_sizes_attr#<attribute_id>_#2 (size_t) ...
  */
-int BookKeeping::flush_tile_var_sizes() {
-  // For easy reference
-  int attribute_num = array_schema_->attribute_num();
-  int64_t tile_var_sizes_num;
+int BookKeeping::flush_tile_var_sizes(int attribute_id) {
+  // Write number of sizes
+  int64_t tile_var_sizes_num = tile_var_sizes_[attribute_id].size(); 
+  if(buffer_.append_buffer(&tile_var_sizes_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing number of "
+         "variable tile sizes failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
 
-  // Write tile sizes for each attribute
-  for(int i=0; i<attribute_num; ++i) {
-    // Write number of sizes
-    tile_var_sizes_num = tile_var_sizes_[i].size(); 
-    if(buffer_.append_buffer(&tile_var_sizes_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
-      std::string errmsg = 
-          "Cannot finalize book-keeping; Writing number of "
-           "variable tile sizes failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
+  if(tile_var_sizes_num == 0)
+    return TILEDB_BK_OK;
 
-    if(tile_var_sizes_num == 0)
-      continue;
+  // Write tile sizes
+  if(buffer_.append_buffer(&tile_var_sizes_[attribute_id][0], tile_var_sizes_num * sizeof(size_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing variable tile sizes failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
 
-    // Write tile sizes
-    if(buffer_.append_buffer(&tile_var_sizes_[i][0], tile_var_sizes_num * sizeof(size_t)) == TILEDB_BF_ERR) {
-      std::string errmsg = 
-          "Cannot finalize book-keeping; Writing variable tile sizes failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
+  // Success
+  return TILEDB_BK_OK;
+}
+
+/* FORMAT:
+ * zone_maps_attr#<attribute_id>_num(int64_t)
+ * zone_map_attr#<attribute_id>_#1(TileZoneMap) 
+ *     zone_map_attr#<attribute_id>_#2 (TileZoneMap) ...
+ */
+int BookKeeping::flush_zone_maps(int attribute_id) {
+  // Write number of zone maps
+  int64_t zone_map_num = zone_maps_[attribute_id].size(); 
+  if(buffer_.append_buffer(&zone_map_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing number of zone maps failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
+
+  if(zone_map_num == 0)
+    return TILEDB_BK_OK;
+
+  // Write zone maps
+  if(buffer_.append_buffer(zone_maps_[attribute_id].data(), zone_map_num * sizeof(TileZoneMap)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot finalize book-keeping; Writing zone maps failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
   }
 
   // Success
@@ -686,7 +1184,10 @@ int BookKeeping::load_bounding_coords() {
 
   // Get number of bounding coordinates
   int64_t bounding_coords_num;
-  if(buffer_.read_buffer(&bounding_coords_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+  if(buffer_.read_buffer(&bounding_coords_num, sizeof(int64_t)) == TILEDB_BF_ERR ||
+     bounding_coords_num < 0 ||
+     bounding_coords_num > 
+         buffer_.get_buffer_size() / int64_t(bounding_coords_size)) {
     std::string errmsg = 
        "Cannot load book-keeping; Reading number of "
        "bounding coordinates failed";
@@ -696,20 +1197,102 @@ int BookKeeping::load_bounding_coords() {
   }
 
   // Get bounding coordinates
-  void* bounding_coords;
-  bounding_coords_.resize(bounding_coords_num);
-  for(int64_t i=0; i<bounding_coords_num; ++i) {
-    bounding_coords = malloc(bounding_coords_size);
-    if(buffer_.read_buffer(bounding_coords, bounding_coords_size) == TILEDB_BF_ERR) {
-      free(bounding_coords);
-      std::string errmsg = 
-          "Cannot load book-keeping; Reading bounding coordinates failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+  bounding_coords_.resize(bounding_coords_num*bounding_coords_size);
+  if(bounding_coords_num > 0 &&
+     buffer_.read_buffer(
+         bounding_coords_.data(), 
+         bounding_coords_.size()) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot load book-keeping; Reading bounding coordinates failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
+  bounding_coords_num_ = bounding_coords_num;
+
+  // Success
+  return TILEDB_BK_OK;
+}
+
+int BookKeeping::load_buffer() {
+  // The sectioned layout is decoded lazily
+  size_t sectioned = 0;
+  if(buffer_.get_buffer_size() >= int64_t(sizeof(size_t)))
+    memcpy(&sectioned, buffer_.get_buffer(), sizeof(size_t));
+  if(sectioned == TILEDB_BK_SECTIONED)
+    return load_sections();
+
+  // For easy reference
+  int attribute_num = array_schema_->attribute_num();
+
+  // Load non-empty domain
+  if(load_non_empty_domain() != TILEDB_BK_OK)
+    return TILEDB_BK_ERR;
+
+  // Load MBRs
+  if(load_mbrs() != TILEDB_BK_OK)
+    return TILEDB_BK_ERR;
+
+  // Load bounding coordinates
+  if(load_bounding_coords() != TILEDB_BK_OK)
+    return TILEDB_BK_ERR;
+
+  // Load tile offsets
+  tile_offsets_.resize(attribute_num+1);
+  for(int i=0; i<attribute_num+1; ++i)
+    if(load_tile_offsets(i) != TILEDB_BK_OK)
       return TILEDB_BK_ERR;
-    }
-    bounding_coords_[i] = bounding_coords;
+
+  // Load variable tile offsets
+  tile_var_offsets_.resize(attribute_num);
+  for(int i=0; i<attribute_num; ++i)
+    if(load_tile_var_offsets(i) != TILEDB_BK_OK)
+      return TILEDB_BK_ERR;
+
+  // Load variable tile sizes
+  tile_var_sizes_.resize(attribute_num);
+  for(int i=0; i<attribute_num; ++i)
+    if(load_tile_var_sizes(i) != TILEDB_BK_OK)
+      return TILEDB_BK_ERR;
+
+  // Load cell number of last tile
+  if(load_last_tile_cell_num() != TILEDB_BK_OK)
+    return TILEDB_BK_ERR;
+
+  // Success
+  buffer_.free_buffer();
+  return TILEDB_BK_OK;
+}
+
+int BookKeeping::load_coords_filter() {
+  // Fragments without the filter section
+  int section = array_schema_->attribute_num() + 2;
+  if(int(section_index_.size()) <= section)
+    return TILEDB_BK_OK;
+
+  // Point the filter into its section
+  const char* data;
+  if(load_section(section, &data) != TILEDB_BK_OK)
+    return TILEDB_BK_ERR;
+  const char* cursor = data;
+  const char* end = data + section_index_[section].size_;
+  int64_t hash_num, word_num;
+  const void* words;
+  if(!read_section_bytes(cursor, end, &hash_num, sizeof(int64_t)) ||
+     hash_num < 1 || hash_num > TILEDB_BLOOM_FILTER_MAX_HASH_NUM ||
+     !view_section_array(cursor, end, sizeof(uint64_t), word_num, &words) ||
+     word_num == 0) {
+    std::string errmsg = 
+        "Cannot load book-keeping; Reading coordinates filter failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
   }
+  coords_filter_ = 
+      new BloomFilter(
+          word_num * 64, 
+          int(hash_num), 
+          static_cast<const uint64_t*>(words));
 
   // Success
   return TILEDB_BK_OK;
@@ -742,7 +1325,9 @@ int BookKeeping::load_mbrs() {
 
   // Get number of MBRs
   int64_t mbr_num;
-  if(buffer_.read_buffer(&mbr_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+  if(buffer_.read_buffer(&mbr_num, sizeof(int64_t)) == TILEDB_BF_ERR ||
+     mbr_num < 0 ||
+     mbr_num > buffer_.get_buffer_size() / int64_t(mbr_size)) {
     std::string errmsg = 
         "Cannot load book-keeping; Reading number of MBRs failed";
     PRINT_ERROR(errmsg);
@@ -751,20 +1336,16 @@ int BookKeeping::load_mbrs() {
   }
 
   // Get MBRs
-  void* mbr;
-  mbrs_.resize(mbr_num);
-  for(int64_t i=0; i<mbr_num; ++i) {
-    mbr = malloc(mbr_size);
-    if(buffer_.read_buffer(mbr, mbr_size) == TILEDB_BF_ERR) {
-      free(mbr);
-      std::string errmsg = 
-          "Cannot load book-keeping; Reading MBR failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
-    mbrs_[i] = mbr;
+  mbrs_.resize(mbr_num*mbr_size);
+  if(mbr_num > 0 &&
+     buffer_.read_buffer(mbrs_.data(), mbrs_.size()) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot load book-keeping; Reading MBRs failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
   }
+  mbr_num_ = mbr_num;
 
   // Success
   return TILEDB_BK_OK;
@@ -810,91 +1391,209 @@ int BookKeeping::load_non_empty_domain() {
   return TILEDB_BK_OK;
 }
 
-/* FORMAT:
- * tile_offsets_attr#0_num (int64_t)
- * tile_offsets_attr#0_#1 (off_t) tile_offsets_attr#0_#2 (off_t) ...
- * ...
- * tile_offsets_attr#<attribute_num>_num (int64_t)
- * tile_offsets_attr#<attribute_num>_#1 (off_t) 
- * tile_offsets_attr#<attribute_num>_#2 (off_t) ...
- */
-int BookKeeping::load_tile_offsets() {
+int BookKeeping::load_section(int section, const char** data) {
   // For easy reference
-  int attribute_num = array_schema_->attribute_num();
-  int64_t tile_offsets_num;
-
-  // Allocate tile offsets
-  tile_offsets_.resize(attribute_num+1);
-
-  // For all attributes, get the tile offsets
-  for(int i=0; i<attribute_num+1; ++i) {
-    // Get number of tile offsets
-    if(buffer_.read_buffer(&tile_offsets_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+  const BookKeepingSection& section_entry = section_index_[section];
+  const char* section_bytes = 
+      static_cast<const char*>(sections_.get_buffer()) + 
+      section_entry.offset_;
+
+  // Uncompressed sections are used in place
+  if(section_compression_ == TILEDB_NO_COMPRESSION) {
+    if(section_entry.compressed_size_ != section_entry.size_ ||
+       section_entry.offset_ % TILEDB_BK_SECTION_ALIGNMENT != 0) {
       std::string errmsg = 
-          "Cannot load book-keeping; Reading number of tile offsets failed";
+          "Cannot load book-keeping; Section " + std::to_string(section) + 
+          " is malformed";
       PRINT_ERROR(errmsg);
       tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
       return TILEDB_BK_ERR;
     }
- 
-    if(tile_offsets_num == 0)
-      continue;
+    *data = section_bytes;
+    return TILEDB_BK_OK;
+  }
 
-    // Get tile offsets
-    tile_offsets_[i].resize(tile_offsets_num);
-    if(buffer_.read_buffer(&tile_offsets_[i][0], tile_offsets_num * sizeof(off_t)) == TILEDB_BF_ERR) { 
+  // Compressed sections are decompressed once and kept
+  if(section_buffers_[section] == NULL) {
+    void* buf = malloc(section_entry.size_);
+    Codec* codec = NULL;
+    try {
+      codec = Codec::create(
+                  section_compression_, 
+                  Codec::get_default_level(section_compression_));
+    } catch(std::exception& e) {
+      codec = NULL;
+    }
+    if(buf == NULL || 
+       codec == NULL ||
+       codec->decompress_tile(
+           reinterpret_cast<unsigned char*>(
+               const_cast<char*>(section_bytes)),
+           section_entry.compressed_size_,
+           static_cast<unsigned char*>(buf),
+           section_entry.size_) != TILEDB_CD_OK) {
+      free(buf);
+      delete codec;
       std::string errmsg = 
-          "Cannot load book-keeping; Reading tile offsets failed";
+          "Cannot load book-keeping; Decompressing section " + 
+          std::to_string(section) + " failed";
       PRINT_ERROR(errmsg);
       tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
       return TILEDB_BK_ERR;
     }
+    delete codec;
+    section_buffers_[section] = buf;
   }
+  *data = static_cast<const char*>(section_buffers_[section]);
 
   // Success
   return TILEDB_BK_OK;
 }
 
 /* FORMAT:
- * tile_var_offsets_attr#0_num (int64_t)
- * tile_var_offsets_attr#0_#1 (off_t) tile_var_offsets_attr#0_#2 (off_t) ...
+ * sectioned(size_t) version(int) section_num(int) compression(int) 
+ *     reserved(int)
+ * section_#0_offset(int64_t) section_#0_compressed_size(int64_t)
+ *     section_#0_size(int64_t)
  * ...
- * tile_var_offsets_attr#<attribute_num-1>_num(int64_t)
- * tile_var_offsets_attr#<attribute_num-1>_#1 (off_t)
- *     tile_ver_offsets_attr#<attribute_num-1>_#2 (off_t) ...
  */
-int BookKeeping::load_tile_var_offsets() {
+int BookKeeping::load_sections() {
   // For easy reference
   int attribute_num = array_schema_->attribute_num();
-  int64_t tile_var_offsets_num;
-
-  // Allocate tile offsets
-  tile_var_offsets_.resize(attribute_num);
+  size_t coords_size = array_schema_->coords_size();
+  int64_t size = buffer_.get_buffer_size();
+
+  // Keep the sections for load_attribute
+  sections_.set_buffer(buffer_.get_buffer(), size);
+  buffer_.set_buffer(NULL, 0);
+  const char* cursor = static_cast<const char*>(sections_.get_buffer());
+  const char* end = cursor + size;
+
+  // Get version, number of sections and compression
+  size_t sectioned;
+  int version, section_num, reserved;
+  if(!read_section_bytes(cursor, end, &sectioned, sizeof(size_t)) ||
+     !read_section_bytes(cursor, end, &version, sizeof(int)) ||
+     !read_section_bytes(cursor, end, &section_num, sizeof(int))) {
+    std::string errmsg = "Cannot load book-keeping; Reading version failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
+  if(version != TILEDB_BK_VERSION ||
+     !read_section_bytes(cursor, end, &section_compression_, sizeof(int)) ||
+     !read_section_bytes(cursor, end, &reserved, sizeof(int))) {
+    version = -1;
+  }
+  if(version < 0 || 
+     (section_num != attribute_num+2 && section_num != attribute_num+3)) {
+    std::string errmsg = 
+        "Cannot load book-keeping; Unsupported version " + 
+        std::to_string(version);
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
 
-  // For all attributes, get the variable tile offsets
-  for(int i=0; i<attribute_num; ++i) {
-    // Get number of tile offsets
-    if(buffer_.read_buffer(&tile_var_offsets_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+  // Get section index
+  section_index_.resize(section_num);
+  for(int i=0; i<section_num; ++i) {
+    BookKeepingSection& section = section_index_[i];
+    if(!read_section_bytes(cursor, end, &section.offset_, sizeof(int64_t)) ||
+       !read_section_bytes(
+           cursor, end, &section.compressed_size_, sizeof(int64_t)) ||
+       !read_section_bytes(cursor, end, &section.size_, sizeof(int64_t)) ||
+       section.offset_ < 0 || section.compressed_size_ <= 0 || 
+       section.size_ <= 0 || section.offset_ > size ||
+       section.compressed_size_ > size - section.offset_) {
       std::string errmsg = 
-          "Cannot load book-keeping; Reading number of variable tile "
-          "offsets failed";
+          "Cannot load book-keeping; Reading section index failed";
       PRINT_ERROR(errmsg);
       tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
       return TILEDB_BK_ERR;
     }
+  }
+  section_buffers_.assign(section_num, NULL);
+
+  // Get non-empty domain, MBRs, bounding coordinates and cell number of 
+  // the last tile from the first section, pointing the MBRs and bounding
+  // coordinates into it
+  const char* data;
+  if(load_section(0, &data) != TILEDB_BK_OK)
+    return TILEDB_BK_ERR;
+  cursor = data;
+  end = data + section_index_[0].size_;
+  size_t domain_size;
+  int64_t mbr_num, bounding_coords_num;
+  const void *mbrs, *bounding_coords;
+  if(!read_section_bytes(cursor, end, &domain_size, sizeof(size_t)) ||
+     (domain_size != 0 && domain_size != 2*coords_size) ||
+     (domain_size != 0 && 
+      (non_empty_domain_ = malloc(domain_size)) == NULL) ||
+     (domain_size != 0 && 
+      !read_section_bytes(cursor, end, non_empty_domain_, domain_size)) ||
+     !view_section_array(
+         cursor, end, 2*coords_size, mbr_num, &mbrs) ||
+     !view_section_array(
+         cursor, end, 2*coords_size, bounding_coords_num, &bounding_coords) ||
+     !read_section_bytes(
+         cursor, end, &last_tile_cell_num_, sizeof(int64_t))) {
+    std::string errmsg = 
+        "Cannot load book-keeping; Reading MBRs and bounding coordinates "
+        "failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
+  if(non_empty_domain_ != NULL) {
+    domain_ = malloc(domain_size);
+    memcpy(domain_, non_empty_domain_, domain_size);
+    array_schema_->expand_domain(domain_);
+  }
+  section_mbrs_ = static_cast<const char*>(mbrs);
+  mbr_num_ = mbr_num;
+  section_bounding_coords_ = static_cast<const char*>(bounding_coords);
+  bounding_coords_num_ = bounding_coords_num;
+
+  // Tile offsets and sizes are pointed into their sections by load_attribute
+  section_tile_offsets_.assign(attribute_num+1, NULL);
+  section_tile_var_offsets_.assign(attribute_num, NULL);
+  section_tile_var_sizes_.assign(attribute_num, NULL);
+  section_zone_maps_.assign(attribute_num, NULL);
+  attribute_loaded_.assign(attribute_num+1, false);
+  attribute_loaded_num_ = 0;
+
+  // Success
+  return TILEDB_BK_OK;
+}
+
+/* FORMAT:
+ * tile_offsets_attr#<attribute_id>_num (int64_t)
+ * tile_offsets_attr#<attribute_id>_#1 (off_t) 
+ * tile_offsets_attr#<attribute_id>_#2 (off_t) ...
+ */
+int BookKeeping::load_tile_offsets(int attribute_id) {
+  // Get number of tile offsets
+  int64_t tile_offsets_num;
+  if(buffer_.read_buffer(&tile_offsets_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot load book-keeping; Reading number of tile offsets failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
  
-    if(tile_var_offsets_num == 0)
-      continue;
+  if(tile_offsets_num == 0)
+    return TILEDB_BK_OK;
 
-    // Get variable tile offsets
-    tile_var_offsets_[i].resize(tile_var_offsets_num);
-    if(buffer_.read_buffer(&tile_var_offsets_[i][0], tile_var_offsets_num * sizeof(off_t)) == TILEDB_BF_ERR) {
-      std::string errmsg = 
-      "Cannot load book-keeping; Reading variable tile offsets failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
+  // Get tile offsets
+  tile_offsets_[attribute_id].resize(tile_offsets_num);
+  if(buffer_.read_buffer(&tile_offsets_[attribute_id][0], tile_offsets_num * sizeof(off_t)) == TILEDB_BF_ERR) { 
+    std::string errmsg = 
+        "Cannot load book-keeping; Reading tile offsets failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
   }
 
   // Success
@@ -902,45 +1601,67 @@ int BookKeeping::load_tile_var_offsets() {
 }
 
 /* FORMAT:
- * tile_var_sizes_attr#0_num (int64_t)
- * tile_var_sizes_attr#0_#1 (size_t) tile_sizes_attr#0_#2 (size_t) ...
- * ...
- * tile_var_sizes_attr#<attribute_num-1>_num( int64_t)
- * tile_var_sizes__attr#<attribute_num-1>_#1 (size_t) 
- *     tile_var_sizes_attr#<attribute_num-1>_#2 (size_t) ...
+ * tile_var_offsets_attr#<attribute_id>_num(int64_t)
+ * tile_var_offsets_attr#<attribute_id>_#1 (off_t)
+ *     tile_ver_offsets_attr#<attribute_id>_#2 (off_t) ...
  */
-int BookKeeping::load_tile_var_sizes() {
-  // For easy reference
-  int attribute_num = array_schema_->attribute_num();
-  int64_t tile_var_sizes_num;
+int BookKeeping::load_tile_var_offsets(int attribute_id) {
+  // Get number of tile offsets
+  int64_t tile_var_offsets_num;
+  if(buffer_.read_buffer(&tile_var_offsets_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot load book-keeping; Reading number of variable tile "
+        "offsets failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
+ 
+  if(tile_var_offsets_num == 0)
+    return TILEDB_BK_OK;
 
-  // Allocate tile sizes
-  tile_var_sizes_.resize(attribute_num);
+  // Get variable tile offsets
+  tile_var_offsets_[attribute_id].resize(tile_var_offsets_num);
+  if(buffer_.read_buffer(&tile_var_offsets_[attribute_id][0], tile_var_offsets_num * sizeof(off_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+    "Cannot load book-keeping; Reading variable tile offsets failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
 
-  // For all attributes, get the variable tile sizes
-  for(int i=0; i<attribute_num; ++i) {
-    // Get number of tile sizes
-    if(buffer_.read_buffer(&tile_var_sizes_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
-      std::string errmsg = 
-          "Cannot load book-keeping; Reading number of variable tile "
-           "sizes failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
+  // Success
+  return TILEDB_BK_OK;
+}
+
+/* FORMAT:
+ * tile_var_sizes_attr#<attribute_id>_num( int64_t)
+ * tile_var_sizes__attr#<attribute_id>_#1 (size_t) 
+ *     tile_var_sizes_attr#<attribute_id>_#2 (size_t) ...
+ */
+int BookKeeping::load_tile_var_sizes(int attribute_id) {
+  // Get number of tile sizes
+  int64_t tile_var_sizes_num;
+  if(buffer_.read_buffer(&tile_var_sizes_num, sizeof(int64_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot load book-keeping; Reading number of variable tile "
+         "sizes failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
+  }
  
-    if(tile_var_sizes_num == 0)
-      continue;
+  if(tile_var_sizes_num == 0)
+    return TILEDB_BK_OK;
 
-    // Get variable tile sizes
-    tile_var_sizes_[i].resize(tile_var_sizes_num);
-    if(buffer_.read_buffer(&tile_var_sizes_[i][0], tile_var_sizes_num * sizeof(size_t)) == TILEDB_BF_ERR) {
-      std::string errmsg = 
-          "Cannot load book-keeping; Reading variable tile sizes failed";
-      PRINT_ERROR(errmsg);
-      tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
-      return TILEDB_BK_ERR;
-    }
+  // Get variable tile sizes
+  tile_var_sizes_[attribute_id].resize(tile_var_sizes_num);
+  if(buffer_.read_buffer(&tile_var_sizes_[attribute_id][0], tile_var_sizes_num * sizeof(size_t)) == TILEDB_BF_ERR) {
+    std::string errmsg = 
+        "Cannot load book-keeping; Reading variable tile sizes failed";
+    PRINT_ERROR(errmsg);
+    tiledb_bk_errmsg = TILEDB_BK_ERRMSG + errmsg;
+    return TILEDB_BK_ERR;
   }
 
   // Success
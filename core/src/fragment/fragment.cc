@@ -32,6 +32,7 @@
  */
 
 #include "fragment.h"
+#include "fragment_manifest.h"
 #include "tiledb_constants.h"
 #include "utils.h"
 #include <cassert>
@@ -71,6 +72,7 @@ std::string tiledb_fg_errmsg = "";
 
 Fragment::Fragment(const Array* array)
     : array_(array) {
+  manifest_recorded_ = false;
   read_state_ = NULL;
   write_state_ = NULL;
   book_keeping_ = NULL;
@@ -98,6 +100,10 @@ const Array* Fragment::array() const {
   return array_;
 }
 
+BookKeeping* Fragment::book_keeping() const {
+  return book_keeping_;
+}
+
 int64_t Fragment::cell_num_per_tile() const {
   return (dense_) ? array_->array_schema()->cell_num_per_tile() : 
                     array_->array_schema()->capacity(); 
@@ -111,6 +117,10 @@ const std::string& Fragment::fragment_name() const {
   return fragment_name_;
 }
 
+bool Fragment::manifest_recorded() const {
+  return manifest_recorded_;
+}
+
 int Fragment::mode() const {
   return mode_;
 }
@@ -156,12 +166,9 @@ int Fragment::finalize() {
     assert(book_keeping_ != NULL);  
     int rc_ws = write_state_->finalize();
     int rc_bk = book_keeping_->finalize(fs);
-    int rc_rn = TILEDB_FG_OK;
-    int rc_cf = TILEDB_UT_OK;
-    if(is_dir(fs, fragment_name_)) {
-      rc_rn = rename_fragment();
-      rc_cf = create_fragment_file(fs, fragment_name_);
-    }
+    int rc_cm = TILEDB_FG_OK;
+    if(is_dir(fs, fragment_name_))
+      rc_cm = commit();
     // Errors
     if(rc_ws != TILEDB_WS_OK) {
       tiledb_fg_errmsg = tiledb_ws_errmsg;
@@ -171,17 +178,13 @@ int Fragment::finalize() {
       tiledb_fg_errmsg = tiledb_bk_errmsg;
       return TILEDB_FG_ERR;
     } 
-    if(rc_cf != TILEDB_UT_OK) {
-      tiledb_fg_errmsg = tiledb_ut_errmsg;
-      return TILEDB_FG_ERR;
-    }
-    if(rc_rn != TILEDB_FG_OK)
+    if(rc_cm != TILEDB_FG_OK)
       return TILEDB_FG_ERR;
 
     // Success
     return TILEDB_FG_OK;
   } else {                    // READ
-    return read_state_->finalize();
+    return (read_state_ != NULL) ? read_state_->finalize() : TILEDB_FG_OK;
   } 
 }
 
@@ -219,7 +222,8 @@ int Fragment::init(
           array_->array_schema(),
           dense_,
           fragment_name,
-          mode_);
+          mode_,
+          array_->config()->book_keeping_sections());
   read_state_ = NULL;
   if(book_keeping_->init(subarray) != TILEDB_BK_OK) {
     delete book_keeping_;
@@ -243,14 +247,17 @@ int Fragment::init(
   book_keeping_ = book_keeping;
   dense_ = book_keeping_->dense();
   write_state_ = NULL;
-  read_state_ = new ReadState(this, book_keeping_);
+  read_state_ = NULL;
 
   // Success
   return TILEDB_FG_OK;
 }
 
 void Fragment::reset_read_state() {
-  read_state_->reset();
+  if(read_state_ == NULL)
+    read_state_ = new ReadState(this, book_keeping_);
+  else
+    read_state_->reset();
 }
 
 int Fragment::sync() {
@@ -300,6 +307,52 @@ int Fragment::write(const void** buffers, const size_t* buffer_sizes) {
 /*         PRIVATE METHODS        */
 /* ****************************** */
 
+int Fragment::commit() {
+  StorageFS *fs = array_->config()->get_filesystem();
+
+  // Make all the fragment files durable with one batch of syncs
+  std::vector<std::string> files = write_state_->files();
+  files.push_back(book_keeping_->filename());
+  if(sync_paths(fs, files) != TILEDB_UT_OK ||
+     sync_path(fs, fragment_name_) != TILEDB_UT_OK) {
+    tiledb_fg_errmsg = tiledb_ut_errmsg;
+    return TILEDB_FG_ERR;
+  }
+
+  // Make the fragment visible
+  if(rename_fragment() != TILEDB_FG_OK)
+    return TILEDB_FG_ERR;
+  if(create_fragment_file(fs, fragment_name_) != TILEDB_UT_OK ||
+     sync_path(fs, fragment_name_) != TILEDB_UT_OK ||
+     sync_path(fs, ::parent_dir(fs, fragment_name_)) != TILEDB_UT_OK) {
+    tiledb_fg_errmsg = tiledb_ut_errmsg;
+    return TILEDB_FG_ERR;
+  }
+
+  // Record the visible fragment in the manifest of the array, if any. The
+  // fragment is committed already, so on error it is only found through its
+  // directory instead
+  FragmentManifestEntry entry;
+  const char* non_empty_domain = 
+      static_cast<const char*>(book_keeping_->non_empty_domain());
+  const char* serialized_book_keeping = 
+      static_cast<const char*>(book_keeping_->serialized_buffer());
+  entry.dense_ = dense_;
+  entry.non_empty_domain_.assign(
+      non_empty_domain, 
+      non_empty_domain + 2*array_->array_schema()->coords_size());
+  entry.book_keeping_.assign(
+      serialized_book_keeping, 
+      serialized_book_keeping + book_keeping_->serialized_buffer_size());
+  FragmentManifest(fs, ::parent_dir(fs, fragment_name_)).add(
+      fragment_name_, 
+      entry,
+      &manifest_recorded_);
+
+  // Success
+  return TILEDB_FG_OK;
+}
+
 int Fragment::rename_fragment() {
   // Do nothing in READ mode
   if(read_mode())
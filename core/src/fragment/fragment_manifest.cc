@@ -0,0 +1,449 @@
+/**
+ * @file fragment_manifest.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements the FragmentManifest class.
+ */
+
+#include "fragment_manifest.h"
+#include "utils.h"
+
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <unistd.h>
+
+
+
+
+/* ****************************** */
+/*             MACROS             */
+/* ****************************** */
+
+#ifdef TILEDB_VERBOSE
+#  define PRINT_ERROR(x) std::cerr << TILEDB_FM_ERRMSG << x << ".\n" 
+#else
+#  define PRINT_ERROR(x) do { } while(0) 
+#endif
+
+
+
+
+/* ****************************** */
+/*        GLOBAL VARIABLES        */
+/* ****************************** */
+
+std::string tiledb_fm_errmsg = "";
+
+/** Returns the last path component of a fragment directory. */
+static std::string fragment_basename(const std::string& fragment_name) {
+  size_t end = fragment_name.size();
+  if(end > 0 && fragment_name[end-1] == '/')
+    --end;
+  size_t pos = fragment_name.rfind('/', end-1);
+  if(pos == std::string::npos)
+    return fragment_name.substr(0, end);
+  return fragment_name.substr(pos+1, end-pos-1);
+}
+
+/** Returns true if the input file name is that of a manifest shard. */
+static bool is_shard(const std::string& name) {
+  std::string prefix = std::string(TILEDB_FRAGMENT_MANIFEST_FILENAME) + ".";
+  std::string suffix = std::string(TILEDB_FILE_SUFFIX) + TILEDB_GZIP_SUFFIX;
+  return name.size() > prefix.size() + suffix.size() &&
+         starts_with(name, prefix) &&
+         name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+
+
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+FragmentManifest::FragmentManifest(StorageFS* fs, const std::string& dir)
+    : dir_(dir),
+      fs_(fs) {
+}
+
+
+
+
+/* ****************************** */
+/*           ACCESSORS            */
+/* ****************************** */
+
+const FragmentManifestEntry* FragmentManifest::entry(
+    const std::string& fragment_name) const {
+  auto it = entries_.find(fragment_basename(fragment_name));
+  if(it == entries_.end())
+    return NULL;
+  return &it->second;
+}
+
+size_t FragmentManifest::fragment_num() const {
+  return entries_.size();
+}
+
+std::string FragmentManifest::filename() const {
+  return dir_ + "/" + TILEDB_FRAGMENT_MANIFEST_FILENAME + 
+         TILEDB_FILE_SUFFIX + TILEDB_GZIP_SUFFIX;
+}
+
+std::string FragmentManifest::shard_filename(
+    const std::string& fragment_name) const {
+  return dir_ + "/" + TILEDB_FRAGMENT_MANIFEST_FILENAME + "." + 
+         fragment_basename(fragment_name) + 
+         TILEDB_FILE_SUFFIX + TILEDB_GZIP_SUFFIX;
+}
+
+size_t FragmentManifest::shard_num() const {
+  if(!is_file(fs_, filename()))
+    return 0;
+  size_t shard_num = 0;
+  for(auto& file : get_files(fs_, dir_)) {
+    if(is_shard(fragment_basename(file)))
+      ++shard_num;
+  }
+  return shard_num;
+}
+
+
+
+
+/* ****************************** */
+/*            MUTATORS            */
+/* ****************************** */
+
+bool FragmentManifest::load() {
+  entries_.clear();
+  shard_filenames_.clear();
+
+  // List the array directory once for the manifest and its shards
+  std::string filename = this->filename();
+  bool has_base = false;
+  std::vector<std::string> shards;
+  for(auto& file : get_files(fs_, dir_)) {
+    std::string name = fragment_basename(file);
+    if(name == fragment_basename(filename))
+      has_base = true;
+    else if(is_shard(name))
+      shards.push_back(dir_ + "/" + name);
+  }
+
+  // Shards override the manifest file, unreadable ones are skipped
+  bool loaded = has_base && load_file(filename);
+  for(auto& shard : shards) {
+    if(load_file(shard)) {
+      shard_filenames_.push_back(shard);
+      loaded = true;
+    }
+  }
+
+  return loaded;
+}
+
+bool FragmentManifest::load(const std::vector<std::string>& fragment_dirs) {
+  entries_.clear();
+  shard_filenames_.clear();
+
+  // Leftover shards are only trusted along with the manifest file
+  if(!load_file(filename()))
+    return false;
+
+  // Only the directories missing from the manifest file can have a shard
+  std::vector<std::string> shards;
+  for(auto& fragment_dir : fragment_dirs) {
+    if(entry(fragment_dir) == NULL)
+      shards.push_back(fragment_basename(shard_filename(fragment_dir)));
+  }
+  if(shards.empty())
+    return true;
+
+  // List the shards once rather than probing for each of them, as the
+  // directories of fragments written before the manifest have none
+  std::set<std::string> listed;
+  for(auto& file : get_files(fs_, dir_))
+    listed.insert(fragment_basename(file));
+  for(auto& shard : shards) {
+    if(listed.count(shard) != 0 && load_file(dir_ + "/" + shard))
+      shard_filenames_.push_back(dir_ + "/" + shard);
+  }
+
+  return true;
+}
+
+int FragmentManifest::add(
+    const std::string& fragment_name, 
+    const FragmentManifestEntry& entry,
+    bool* recorded) {
+  if(recorded != NULL)
+    *recorded = false;
+  std::string filename = this->filename();
+  if(!is_file(fs_, filename)) {
+    if(!is_env_set("TILEDB_FRAGMENT_MANIFEST"))
+      return TILEDB_FM_OK;
+    entries_.clear();
+    if(store(filename) != TILEDB_FM_OK)
+      return TILEDB_FM_ERR;
+  }
+
+  entries_.clear();
+  entries_[fragment_basename(fragment_name)] = entry;
+  std::string shard = shard_filename(fragment_name);
+  if(store(shard) != TILEDB_FM_OK) {
+    if(is_file(fs_, shard))
+      delete_file(fs_, shard);
+    return TILEDB_FM_ERR;
+  }
+  if(recorded != NULL)
+    *recorded = true;
+
+  return TILEDB_FM_OK;
+}
+
+int FragmentManifest::compact(const std::vector<std::string>& removed) {
+  std::string filename = this->filename();
+  if(!is_file(fs_, filename))
+    return TILEDB_FM_OK;
+  load();
+
+  // Drop the entries of deleted and removed fragments
+  std::set<std::string> dirs;
+  for(auto& dir : get_dirs(fs_, dir_))
+    dirs.insert(fragment_basename(dir));
+  for(auto& fragment_name : removed)
+    dirs.erase(fragment_basename(fragment_name));
+  for(auto it = entries_.begin(); it != entries_.end(); ) {
+    if(dirs.count(it->first) == 0)
+      it = entries_.erase(it);
+    else
+      ++it;
+  }
+
+  if(store(filename) != TILEDB_FM_OK) {
+    // Readers must not trust the previous manifest any more
+    if(is_file(fs_, filename) && delete_file(fs_, filename) != TILEDB_UT_OK) {
+      std::string errmsg = 
+          "Cannot compact fragment manifest; Stale manifest could not be deleted";
+      PRINT_ERROR(errmsg);
+      tiledb_fm_errmsg = TILEDB_FM_ERRMSG + errmsg;
+    }
+    return TILEDB_FM_ERR;
+  }
+
+  // The folded shards are not needed any more, a concurrent fold may have
+  // deleted them already. Leftover shards could bring back the entries of
+  // removed fragments, so the new manifest is not trusted with them
+  for(auto& shard : shard_filenames_) {
+    if(is_file(fs_, shard) && delete_file(fs_, shard) != TILEDB_UT_OK) {
+      std::string errmsg = "Cannot delete fragment manifest shard " + shard;
+      PRINT_ERROR(errmsg);
+      tiledb_fm_errmsg = TILEDB_FM_ERRMSG + errmsg;
+      if(is_file(fs_, filename))
+        delete_file(fs_, filename);
+      return TILEDB_FM_ERR;
+    }
+  }
+  shard_filenames_.clear();
+
+  return TILEDB_FM_OK;
+}
+
+int FragmentManifest::clear() {
+  std::string filename = this->filename();
+  for(auto& file : get_files(fs_, dir_)) {
+    std::string name = fragment_basename(file);
+    if(name != fragment_basename(filename) && !is_shard(name))
+      continue;
+    if(delete_file(fs_, dir_ + "/" + name) != TILEDB_UT_OK) {
+      std::string errmsg = "Cannot clear fragment manifest; " + tiledb_ut_errmsg;
+      PRINT_ERROR(errmsg);
+      tiledb_fm_errmsg = TILEDB_FM_ERRMSG + errmsg;
+      return TILEDB_FM_ERR;
+    }
+  }
+  entries_.clear();
+  shard_filenames_.clear();
+
+  return TILEDB_FM_OK;
+}
+
+
+
+
+/* ****************************** */
+/*         PRIVATE METHODS        */
+/* ****************************** */
+
+bool FragmentManifest::load_file(const std::string& filename) {
+  void* buffer;
+  size_t buffer_size;
+  if(read_from_file_after_decompression(fs_, filename, &buffer, buffer_size, TILEDB_GZIP) != TILEDB_UT_OK)
+    return false;
+
+  // Parse aside, so that a corrupt file leaves no partial entries behind
+  std::map<std::string, FragmentManifestEntry> entries;
+  entries_.swap(entries);
+  int rc = deserialize(static_cast<char*>(buffer), buffer_size);
+  free(buffer);
+  entries_.swap(entries);
+  if(rc != TILEDB_FM_OK)
+    return false;
+  for(auto& it : entries)
+    entries_[it.first] = std::move(it.second);
+
+  return true;
+}
+
+int FragmentManifest::deserialize(const char* buffer, size_t buffer_size) {
+  size_t offset = 0;
+  auto read = [&](void* bytes, size_t size) {
+    if(offset + size > buffer_size)
+      return false;
+    memcpy(bytes, buffer + offset, size);
+    offset += size;
+    return true;
+  };
+  auto read_vector = [&](std::vector<char>& bytes) {
+    size_t size;
+    if(!read(&size, sizeof(size_t)) || offset + size > buffer_size)
+      return false;
+    bytes.assign(buffer + offset, buffer + offset + size);
+    offset += size;
+    return true;
+  };
+
+  int32_t version;
+  int64_t fragment_num;
+  if(!read(&version, sizeof(int32_t)) || version != TILEDB_FM_VERSION ||
+     !read(&fragment_num, sizeof(int64_t)) || fragment_num < 0) {
+    std::string errmsg = "Cannot load fragment manifest; Unsupported version or corrupt header";
+    PRINT_ERROR(errmsg);
+    tiledb_fm_errmsg = TILEDB_FM_ERRMSG + errmsg;
+    return TILEDB_FM_ERR;
+  }
+
+  for(int64_t i=0; i<fragment_num; ++i) {
+    int32_t fragment_name_size;
+    char dense;
+    FragmentManifestEntry entry;
+    if(!read(&fragment_name_size, sizeof(int32_t)) || fragment_name_size < 0 ||
+       offset + fragment_name_size > buffer_size) {
+      std::string errmsg = "Cannot load fragment manifest; Corrupt fragment name";
+      PRINT_ERROR(errmsg);
+      tiledb_fm_errmsg = TILEDB_FM_ERRMSG + errmsg;
+      return TILEDB_FM_ERR;
+    }
+    std::string fragment_name(buffer + offset, fragment_name_size);
+    offset += fragment_name_size;
+    if(!read(&dense, sizeof(char)) ||
+       !read_vector(entry.non_empty_domain_) ||
+       !read_vector(entry.book_keeping_)) {
+      std::string errmsg = "Cannot load fragment manifest; Corrupt entry for " + fragment_name;
+      PRINT_ERROR(errmsg);
+      tiledb_fm_errmsg = TILEDB_FM_ERRMSG + errmsg;
+      return TILEDB_FM_ERR;
+    }
+    entry.dense_ = dense;
+    entries_[fragment_name] = std::move(entry);
+  }
+
+  return TILEDB_FM_OK;
+}
+
+/* FORMAT:
+ * version(int32_t)
+ * fragment_num(int64_t)
+ * fragment_name_size#1(int32_t) fragment_name#1(char*) dense#1(char)
+ *     non_empty_domain_size#1(size_t) non_empty_domain#1(void*)
+ *     book_keeping_size#1(size_t) book_keeping#1(void*)
+ * fragment_name_size#2(int32_t) ...
+ * ...
+ */
+void FragmentManifest::serialize(std::vector<char>& buffer) const {
+  auto append = [&](const void* bytes, size_t size) {
+    buffer.insert(buffer.end(), static_cast<const char*>(bytes), static_cast<const char*>(bytes) + size);
+  };
+
+  int32_t version = TILEDB_FM_VERSION;
+  int64_t fragment_num = entries_.size();
+  append(&version, sizeof(int32_t));
+  append(&fragment_num, sizeof(int64_t));
+  for(auto& it : entries_) {
+    int32_t fragment_name_size = it.first.size();
+    char dense = it.second.dense_;
+    size_t non_empty_domain_size = it.second.non_empty_domain_.size();
+    size_t book_keeping_size = it.second.book_keeping_.size();
+    append(&fragment_name_size, sizeof(int32_t));
+    append(it.first.data(), fragment_name_size);
+    append(&dense, sizeof(char));
+    append(&non_empty_domain_size, sizeof(size_t));
+    append(it.second.non_empty_domain_.data(), non_empty_domain_size);
+    append(&book_keeping_size, sizeof(size_t));
+    append(it.second.book_keeping_.data(), book_keeping_size);
+  }
+}
+
+int FragmentManifest::store(const std::string& filename) {
+  std::vector<char> buffer;
+  serialize(buffer);
+
+  if(fs_->locking_support()) {
+    // Write aside and rename over the old manifest
+    std::string tmp_filename = dir_ + "/." + TILEDB_FRAGMENT_MANIFEST_FILENAME + "." + 
+        std::to_string(getpid()) + "." + 
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    if(is_file(fs_, tmp_filename))
+      delete_file(fs_, tmp_filename);
+    if(write_to_file_after_compression(fs_, tmp_filename, buffer.data(), buffer.size(), TILEDB_GZIP) != TILEDB_UT_OK ||
+       move_path(fs_, tmp_filename, filename) != TILEDB_UT_OK ||
+       sync_path(fs_, dir_) != TILEDB_UT_OK) {
+      if(is_file(fs_, tmp_filename))
+        delete_file(fs_, tmp_filename);
+      std::string errmsg = "Cannot store fragment manifest; " + tiledb_ut_errmsg;
+      PRINT_ERROR(errmsg);
+      tiledb_fm_errmsg = TILEDB_FM_ERRMSG + errmsg;
+      return TILEDB_FM_ERR;
+    }
+  } else {
+    // Readers fall back to the fragment directories while it is missing
+    if((is_file(fs_, filename) && delete_file(fs_, filename) != TILEDB_UT_OK) ||
+       write_to_file_after_compression(fs_, filename, buffer.data(), buffer.size(), TILEDB_GZIP) != TILEDB_UT_OK) {
+      std::string errmsg = "Cannot store fragment manifest; " + tiledb_ut_errmsg;
+      PRINT_ERROR(errmsg);
+      tiledb_fm_errmsg = TILEDB_FM_ERRMSG + errmsg;
+      return TILEDB_FM_ERR;
+    }
+  }
+
+  return TILEDB_FM_OK;
+}
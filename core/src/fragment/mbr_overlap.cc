@@ -0,0 +1,126 @@
+/**
+ * @file mbr_overlap.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements the scan of the MBRs of a fragment for the tiles that
+ * overlap a subarray.
+ */
+
+#include "mbr_overlap.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+
+
+/* ****************************** */
+/*           CONSTANTS            */
+/* ****************************** */
+
+/** 
+ * The first block of tiles compared by a scan. Blocks double up to
+ * TILEDB_MBR_OVERLAP_MAX_BLOCK tiles, so that scans stopping at the first
+ * tiles stay cheap.
+ */
+#define TILEDB_MBR_OVERLAP_MIN_BLOCK 8
+
+/** The largest block of tiles compared by a scan. */
+#define TILEDB_MBR_OVERLAP_MAX_BLOCK 256
+
+
+
+
+/* ****************************** */
+/*           FUNCTIONS            */
+/* ****************************** */
+
+template<class T>
+int64_t next_overlapping_mbr(
+    const T* mbr_columns,
+    int64_t tile_num,
+    int dim_num,
+    const T* subarray,
+    int64_t start,
+    int64_t end) {
+  unsigned char overlaps[TILEDB_MBR_OVERLAP_MAX_BLOCK];
+  int64_t block = TILEDB_MBR_OVERLAP_MIN_BLOCK;
+  for(int64_t block_start=start; block_start<=end; block_start+=block) {
+    if(block_start > start)
+      block = std::min<int64_t>(2*block, TILEDB_MBR_OVERLAP_MAX_BLOCK);
+    int64_t n = std::min<int64_t>(block, end-block_start+1);
+
+    // Compare the block one dimension at a time, without branches so that
+    // the comparisons are vectorized
+    memset(overlaps, 1, n);
+    for(int i=0; i<dim_num; ++i) {
+      const T* lows = mbr_columns + 2*i*tile_num + block_start;
+      const T* highs = lows + tile_num;
+      T low = subarray[2*i];
+      T high = subarray[2*i+1];
+      for(int64_t j=0; j<n; ++j)
+        overlaps[j] &= (lows[j] <= high) & (highs[j] >= low);
+    }
+
+    const void* found = memchr(overlaps, 1, n);
+    if(found != NULL)
+      return block_start + (static_cast<const unsigned char*>(found) - overlaps);
+  }
+
+  return end+1;
+}
+
+// Explicit template instantiations
+template int64_t next_overlapping_mbr<int>(
+    const int* mbr_columns,
+    int64_t tile_num,
+    int dim_num,
+    const int* subarray,
+    int64_t start,
+    int64_t end);
+template int64_t next_overlapping_mbr<int64_t>(
+    const int64_t* mbr_columns,
+    int64_t tile_num,
+    int dim_num,
+    const int64_t* subarray,
+    int64_t start,
+    int64_t end);
+template int64_t next_overlapping_mbr<float>(
+    const float* mbr_columns,
+    int64_t tile_num,
+    int dim_num,
+    const float* subarray,
+    int64_t start,
+    int64_t end);
+template int64_t next_overlapping_mbr<double>(
+    const double* mbr_columns,
+    int64_t tile_num,
+    int dim_num,
+    const double* subarray,
+    int64_t start,
+    int64_t end);
@@ -32,6 +32,7 @@
  */
 
 #include "read_state.h"
+#include "storage_posixfs.h"
 #include "utils.h"
 
 #include <algorithm>
@@ -92,8 +93,42 @@ ReadState::ReadState(
   map_addr_var_lengths_.resize(attribute_num_);
   search_tile_overlap_subarray_ = malloc(2*coords_size_);
   search_tile_pos_ = -1;
+  rtree_ = NULL;
+  zone_map_expression_ = NULL;
   tile_compressed_ = NULL;
   tile_compressed_allocated_size_ = 0;
+  StorageFS* fs = array_->config()->get_filesystem();
+  int read_method = array_->config()->read_method();
+  batch_attribute_reads_ = 
+      read_method == TILEDB_IO_URING ||
+      (read_method == TILEDB_IO_READ && dynamic_cast<PosixFS*>(fs) == NULL);
+  coalesce_max_gap_ = fs->get_coalesce_max_gap();
+  coalesce_max_size_ = fragment_->dense() ? 0 : fs->get_coalesce_max_size();
+  batch_tile_reads_ = 
+      batch_attribute_reads_ ||
+      (read_method == TILEDB_IO_READ && coalesce_max_size_ > 0);
+  use_mapped_files_ = 
+      read_method == TILEDB_IO_MMAP && 
+      array_->mmap_registry() != NULL &&
+      dynamic_cast<PosixFS*>(fs) != NULL;
+  mapped_files_.resize(attribute_num_+1);
+  mapped_var_files_.resize(attribute_num_);
+  tiles_mapped_.resize(attribute_num_+2, false);
+  tiles_var_mapped_.resize(attribute_num_, false);
+  access_pattern_ = -1;
+  advised_.resize(attribute_num_+1, false);
+  advised_var_.resize(attribute_num_+1, false);
+  access_hints_.resize(TILEDB_FS_ACCESS_DONTNEED+1, 0);
+  tile_reads_ = 0;
+  tile_io_reads_ = 0;
+  file_sizes_.resize(attribute_num_+1, -1);
+  file_var_sizes_.resize(attribute_num_+1, -1);
+  file_size_lookups_ = 0;
+  tiles_compressed_.resize(attribute_num_+2);
+  tiles_compressed_allocated_size_.resize(attribute_num_+2);
+  tiles_var_compressed_.resize(attribute_num_);
+  tiles_var_compressed_allocated_size_.resize(attribute_num_);
+  prefetched_tiles_.resize(attribute_num_+2);
   tiles_.resize(attribute_num_+2);
   tiles_offsets_.resize(attribute_num_+2);
   tiles_file_offsets_.resize(attribute_num_+2);
@@ -112,6 +147,8 @@ ReadState::ReadState(
     tiles_var_offsets_[i] = 0;
     tiles_var_sizes_[i] = 0;
     tiles_var_allocated_size_[i] = 0;
+    tiles_var_compressed_[i] = NULL;
+    tiles_var_compressed_allocated_size_[i] = 0;
   }
 
   for(int i=0; i<attribute_num_+1; ++i) {
@@ -120,6 +157,9 @@ ReadState::ReadState(
 
   for(int i=0; i<attribute_num_+2; ++i) {
     fetched_tile_[i] = -1;
+    prefetched_tiles_[i] = std::make_pair(-1, -1);
+    tiles_compressed_[i] = NULL;
+    tiles_compressed_allocated_size_[i] = 0;
     map_addr_[i] = NULL;
     map_addr_lengths_[i] = 0;
     tiles_[i] = NULL;
@@ -130,15 +170,9 @@ ReadState::ReadState(
 
   compute_tile_search_range();
 
-  std::string fragment_name = fragment_->fragment_name();
-  std::string filename;
-  // Check empty attributes
+  // Empty attributes are checked on first use
   is_empty_attribute_.resize(attribute_num_+1);
-  for(int i=0; i<attribute_num_+1; ++i) {
-    filename = 
-        fragment_name + "/" + array_schema_->attribute(i) + TILEDB_FILE_SUFFIX;
-    is_empty_attribute_[i] = !is_file(array_->config()->get_filesystem(), filename);
-  }
+  is_empty_attribute_checked_.resize(attribute_num_+1, false);
 
   file_buffer_.resize(attribute_num_+1);
   file_var_buffer_.resize(attribute_num_+1);
@@ -179,18 +213,30 @@ ReadState::~ReadState() {
     free(last_tile_coords_);
 
   for(int i=0; i<int(tiles_.size()); ++i) {
-    if(map_addr_[i] == NULL && tiles_[i] != NULL)
+    if(map_addr_[i] == NULL && !tiles_mapped_[i] && tiles_[i] != NULL)
       free(tiles_[i]);
   }
 
   for(int i=0; i<int(tiles_var_.size()); ++i) {
-    if(map_addr_var_[i] == NULL && tiles_var_[i] != NULL)
+    if(map_addr_var_[i] == NULL && !tiles_var_mapped_[i] && 
+       tiles_var_[i] != NULL)
       free(tiles_var_[i]);
   }
 
-  if(map_addr_compressed_ == NULL && tile_compressed_ != NULL)
+  if(map_addr_compressed_ == NULL && !use_mapped_files_ && 
+     tile_compressed_ != NULL)
     free(tile_compressed_);
 
+  for(int i=0; i<int(tiles_compressed_.size()); ++i) {
+    if(tiles_compressed_[i] != NULL)
+      free(tiles_compressed_[i]);
+  }
+
+  for(int i=0; i<int(tiles_var_compressed_.size()); ++i) {
+    if(tiles_var_compressed_[i] != NULL)
+      free(tiles_var_compressed_[i]);
+  }
+
   for(int i=0; i<int(map_addr_.size()); ++i) {
     if(map_addr_[i] != NULL && munmap(map_addr_[i], map_addr_lengths_[i])) {
       std::string errmsg = 
@@ -257,7 +303,7 @@ void ReadState::get_bounding_coords(void* bounding_coords) const {
   assert(pos != -1);
   memcpy(
       bounding_coords, 
-      book_keeping_->bounding_coords()[pos], 
+      book_keeping_->bounding_coords(pos), 
       2*coords_size_);
 }
 
@@ -273,6 +319,22 @@ bool ReadState::subarray_area_covered() const {
   return subarray_area_covered_;
 }
 
+size_t ReadState::tile_reads() const {
+  return tile_reads_;
+}
+
+size_t ReadState::tile_io_reads() const {
+  return tile_io_reads_;
+}
+
+size_t ReadState::file_size_lookups() const {
+  return file_size_lookups_;
+}
+
+size_t ReadState::access_hints(int advice) const {
+  return access_hints_[advice];
+}
+
 
 
 
@@ -293,6 +355,11 @@ void ReadState::reset() {
   search_tile_pos_ = -1;
   compute_tile_search_range();
 
+  // The new subarray may have a different access pattern
+  access_pattern_ = -1;
+  advised_.assign(attribute_num_+1, false);
+  advised_var_.assign(attribute_num_+1, false);
+
   for(int i=0; i<attribute_num_+2; ++i)
     tiles_offsets_[i] = 0;
 
@@ -1033,8 +1100,9 @@ void ReadState::get_next_overlapping_tile_sparse() {
     return;
 
   // For easy reference
-  const std::vector<void*>& mbrs = book_keeping_->mbrs();
   const T* subarray = static_cast<const T*>(array_->subarray());
+  if(rtree_ == NULL)
+    rtree_ = book_keeping_->rtree();
 
   // Update the search tile position
   if(search_tile_pos_ == -1)
@@ -1042,26 +1110,33 @@ void ReadState::get_next_overlapping_tile_sparse() {
   else
     ++search_tile_pos_;
 
-  // Find the position to the next overlapping tile with the query range
+  // Find the position to the next overlapping tile with the query range,
+  // skipping the tiles the filter excludes
   for(;;) {
-    // No overlap - exit
-    if(search_tile_pos_ > tile_search_range_[1]) {
-      done_ = true;
-      return;
-    }
-
-    const T* mbr = static_cast<const T*>(mbrs[search_tile_pos_]);
-    search_tile_overlap_ = 
-        array_schema_->subarray_overlap(
+    search_tile_pos_ = 
+        rtree_->next_overlapping_tile(
             subarray,
-            mbr, 
-            static_cast<T*>(search_tile_overlap_subarray_));
+            1,
+            search_tile_pos_,
+            tile_search_range_[1]);
+    if(search_tile_pos_ > tile_search_range_[1] || 
+       !tile_filtered_out(search_tile_pos_))
+      break;
+    ++search_tile_pos_;
+  }
 
-    if(!search_tile_overlap_)
-      ++search_tile_pos_;
-    else
-      return;
+  // No overlap - exit
+  if(search_tile_pos_ > tile_search_range_[1]) {
+    done_ = true;
+    return;
   }
+
+  const T* mbr = static_cast<const T*>(book_keeping_->mbr(search_tile_pos_));
+  search_tile_overlap_ = 
+      array_schema_->subarray_overlap(
+          subarray,
+          mbr, 
+          static_cast<T*>(search_tile_overlap_subarray_));
 }
 
 template<class T> 
@@ -1073,7 +1148,6 @@ void ReadState::get_next_overlapping_tile_sparse(
 
   // For easy reference
   int dim_num = array_schema_->dim_num();
-  const std::vector<void*>& mbrs = book_keeping_->mbrs();
   const T* subarray = static_cast<const T*>(array_->subarray());
 
   // Compute the tile subarray
@@ -1101,7 +1175,7 @@ void ReadState::get_next_overlapping_tile_sparse(
       // Advance only if the MBR does not exceed the tile
       const T* bounding_coords = 
           static_cast<const T*>(
-              book_keeping_->bounding_coords()[search_tile_pos_]);
+              book_keeping_->bounding_coords(search_tile_pos_));
       if(array_schema_->tile_cell_order_cmp(
              &bounding_coords[dim_num], 
              tile_subarray_end) <= 0) {
@@ -1123,7 +1197,8 @@ void ReadState::get_next_overlapping_tile_sparse(
     }
 
     // Get overlap between MBR and tile subarray
-    const T* mbr = static_cast<const T*>(mbrs[search_tile_pos_]);
+    const T* mbr = 
+        static_cast<const T*>(book_keeping_->mbr(search_tile_pos_));
     mbr_tile_overlap_ = 
         array_schema_->subarray_overlap(
             tile_subarray,
@@ -1135,7 +1210,7 @@ void ReadState::get_next_overlapping_tile_sparse(
       // Check if we need to break or continue
       const T* bounding_coords = 
           static_cast<const T*>(
-              book_keeping_->bounding_coords()[search_tile_pos_]);
+              book_keeping_->bounding_coords(search_tile_pos_));
       if(array_schema_->tile_cell_order_cmp(
              &bounding_coords[dim_num], 
              tile_subarray_end) > 0) {
@@ -1179,6 +1254,106 @@ void ReadState::get_next_overlapping_tile_sparse(
 /*         PRIVATE METHODS        */
 /* ****************************** */
 
+int ReadState::access_pattern() {
+  if(access_pattern_ != -1)
+    return access_pattern_;
+
+  // Consolidation reads every tile of the fragment once
+  if(array_->consolidating()) {
+    access_pattern_ = TILEDB_FS_ACCESS_SEQUENTIAL;
+    return access_pattern_;
+  }
+
+  // Count the tiles the query overlaps
+  int64_t tile_num = 0;
+  if(!fragment_->dense()) {
+    if(!done_)
+      tile_num = tile_search_range_[1] - tile_search_range_[0] + 1;
+  } else {
+    int coords_type = array_schema_->coords_type();
+    if(coords_type == TILEDB_INT32)
+      tile_num = overlapping_tile_num<int>();
+    else if(coords_type == TILEDB_INT64)
+      tile_num = overlapping_tile_num<int64_t>();
+    else
+      tile_num = book_keeping_->tile_num();
+  }
+
+  access_pattern_ = 
+      (tile_num > TILEDB_RS_RANDOM_ACCESS_MAX_TILES) ? 
+          TILEDB_FS_ACCESS_SEQUENTIAL : TILEDB_FS_ACCESS_RANDOM;
+  return access_pattern_;
+}
+
+void ReadState::advise_access(int attribute_id, bool is_var) {
+  // Special case for coords
+  if(attribute_id == attribute_num_+1)
+    attribute_id = attribute_num_;
+
+  // Hint only once per file
+  std::vector<bool>::reference advised = 
+      is_var ? advised_var_[attribute_id] : advised_[attribute_id];
+  if(advised || is_empty_attribute(attribute_id))
+    return;
+  advised = true;
+
+  // Hint the access pattern for the whole file
+  int advice = access_pattern();
+  StorageFS* fs = array_->config()->get_filesystem();
+  std::string filename = construct_filename(attribute_id, is_var);
+  std::shared_ptr<MappedFile> mapped_file;
+  if(use_mapped_files_) {
+    const char* data;
+    if(get_mapped_range(attribute_id, is_var, 0, 0, data) != TILEDB_RS_OK)
+      return;
+    mapped_file = 
+        is_var ? mapped_var_files_[attribute_id] : mapped_files_[attribute_id];
+    mapped_file->advise(0, 0, advice);
+  } else {
+    fs->advise_file(filename, 0, 0, advice);
+  }
+  ++access_hints_[advice];
+
+  // Only sparse scans know upfront which tiles will be read next
+  if(fragment_->dense() || 
+     advice != TILEDB_FS_ACCESS_SEQUENTIAL ||
+     array_->consolidating() ||
+     done_)
+    return;
+
+  // Find the span of the file holding the tiles in the search range
+  int64_t tile_num = book_keeping_->tile_num();
+  off_t start, end;
+  if(array_schema_->compression(attribute_id) != TILEDB_NO_COMPRESSION) {
+    const off_t* tile_offsets = 
+        is_var ? book_keeping_->tile_var_offsets(attribute_id) :
+                 book_keeping_->tile_offsets(attribute_id);
+    start = tile_offsets[tile_search_range_[0]];
+    if(tile_search_range_[1] < tile_num - 1)
+      end = tile_offsets[tile_search_range_[1]+1];
+    else
+      end = get_file_size(attribute_id, is_var);
+  } else if(!is_var) {
+    size_t full_tile_size = fragment_->tile_size(attribute_id);
+    start = tile_search_range_[0] * full_tile_size;
+    end = (tile_search_range_[1] + 1) * full_tile_size;
+    off_t file_size = get_file_size(attribute_id, false);
+    if(file_size != TILEDB_FS_ERR && end > file_size)
+      end = file_size;
+  } else {
+    // Variable tile offsets are only known after reading the offsets tile
+    return;
+  }
+  if(end <= start)
+    return;
+
+  if(mapped_file != NULL)
+    mapped_file->advise(start, end - start, TILEDB_FS_ACCESS_WILLNEED);
+  else
+    fs->advise_file(filename, start, end - start, TILEDB_FS_ACCESS_WILLNEED);
+  ++access_hints_[TILEDB_FS_ACCESS_WILLNEED];
+}
+
 std::string ReadState::construct_filename(int attribute_id, bool is_var) {
   std::string filename;
   if (attribute_id == attribute_num_) {
@@ -1189,6 +1364,35 @@ std::string ReadState::construct_filename(int attribute_id, bool is_var) {
   return filename;
 }
 
+off_t ReadState::get_file_size(int attribute_id, bool is_var) {
+  // Special case for coords
+  if(attribute_id == attribute_num_+1)
+    attribute_id = attribute_num_;
+
+  off_t& file_size = is_var ? file_var_sizes_[attribute_id] : file_sizes_[attribute_id];
+  if(file_size == -1) {
+    ++file_size_lookups_;
+    file_size = ::file_size(array_->config()->get_filesystem(), construct_filename(attribute_id, is_var));
+  }
+  return file_size;
+}
+
+StorageBuffer* ReadState::get_file_buffer(int attribute_id, bool is_var) {
+  StorageFS *fs = array_->config()->get_filesystem();
+  if (is_var) {
+    assert((attribute_id < attribute_num_) && "Coords attribute cannot be variable");
+    if (file_var_buffer_[attribute_id] == NULL) {
+      file_var_buffer_[attribute_id] = new StorageBuffer(fs, construct_filename(attribute_id, true), true, get_file_size(attribute_id, true));
+    }
+    return file_var_buffer_[attribute_id];
+  } else {
+    if (file_buffer_[attribute_id] == NULL) {
+      file_buffer_[attribute_id] = new StorageBuffer(fs, construct_filename(attribute_id, false), true, get_file_size(attribute_id, false));
+    }
+    return file_buffer_[attribute_id];
+  }
+}
+
 void ReadState::reset_file_buffers() {
   for(int i=0; i<attribute_num_+1; ++i) {
     if (file_buffer_[i] != NULL) {
@@ -1215,24 +1419,22 @@ int ReadState::read_segment(int attribute_num, bool is_var, off_t offset, void *
     attribute_num = attribute_num_;
   }
 
+  // Copy straight from the whole file mapping
+  if (use_mapped_files_) {
+    const char* data;
+    if (get_mapped_range(attribute_num, is_var, offset, length, data) != TILEDB_RS_OK) {
+      return TILEDB_RS_ERR;
+    }
+    memcpy(segment, data, length);
+    return rc;
+  }
+
   // Construct the attribute file name
   std::string filename = construct_filename(attribute_num, is_var);
 
   // Buffered reading to help with distributed filesystem and cloud performance
   if (fs->get_download_buffer_size() > 0) {
-    StorageBuffer *file_buffer;
-    if (is_var) {
-      assert((attribute_num < attribute_num_) && "Coords attribute cannot be variable");
-      if (file_var_buffer_[attribute_num] == NULL) {
-        file_var_buffer_[attribute_num]= new StorageBuffer(fs, filename);
-      }
-      file_buffer = file_var_buffer_[attribute_num];
-    } else {
-      if (file_buffer_[attribute_num] == NULL) {
-        file_buffer_[attribute_num] = new StorageBuffer(fs, filename);
-      }
-      file_buffer = file_buffer_[attribute_num];
-    }
+    StorageBuffer *file_buffer = get_file_buffer(attribute_num, is_var);
 
     // Read from file buffers if possible
     if (file_buffer != NULL) {
@@ -1252,7 +1454,8 @@ int ReadState::read_segment(int attribute_num, bool is_var, off_t offset, void *
   MPI_Comm* mpi_comm = array_->config()->mpi_comm();
 #endif
 
-  if(read_method == TILEDB_IO_READ || read_method == TILEDB_IO_MMAP) {
+  if(read_method == TILEDB_IO_READ || read_method == TILEDB_IO_MMAP ||
+     read_method == TILEDB_IO_URING) {
     rc = read_from_file(fs, filename, offset, segment, length);
   } else if(read_method == TILEDB_IO_MPI) {
 #ifdef HAVE_MPI
@@ -1441,8 +1644,8 @@ void ReadState::compute_tile_search_range_col_or_row() {
   int dim_num = array_schema_->dim_num();
   const T* subarray = static_cast<const T*>(array_->subarray());
   int64_t tile_num = book_keeping_->tile_num();
-  const std::vector<void*>& bounding_coords = 
-      book_keeping_->bounding_coords();
+  const T* bounding_coords = 
+      static_cast<const T*>(book_keeping_->bounding_coords(0));
 
   // Calculate subarray coordinates
   T* subarray_min_coords = new T[dim_num];
@@ -1464,8 +1667,8 @@ void ReadState::compute_tile_search_range_col_or_row() {
     med = min + ((max - min) / 2);
 
     // Get info for bounding coordinates
-    tile_start_coords = static_cast<const T*>(bounding_coords[med]);
-    tile_end_coords = &(static_cast<const T*>(bounding_coords[med])[dim_num]);
+    tile_start_coords = &bounding_coords[2*dim_num*med];
+    tile_end_coords = &bounding_coords[2*dim_num*med + dim_num];
 
     // Calculate precedence
     if(array_schema_->tile_cell_order_cmp(
@@ -1502,8 +1705,8 @@ void ReadState::compute_tile_search_range_col_or_row() {
       med = min + ((max - min) / 2);
 
       // Get info for bounding coordinates
-      tile_start_coords = static_cast<const T*>(bounding_coords[med]);
-      tile_end_coords = &(static_cast<const T*>(bounding_coords[med])[dim_num]);
+      tile_start_coords = &bounding_coords[2*dim_num*med];
+      tile_end_coords = &bounding_coords[2*dim_num*med + dim_num];
      
       // Calculate precedence
       if(array_schema_->tile_cell_order_cmp(
@@ -1546,8 +1749,8 @@ void ReadState::compute_tile_search_range_hil() {
 
   if(is_unary_subarray(subarray, dim_num)) {  // Unary range
     // For easy reference
-    const std::vector<void*>& bounding_coords = 
-        book_keeping_->bounding_coords();
+    const T* bounding_coords = 
+        static_cast<const T*>(book_keeping_->bounding_coords(0));
 
     // Calculate range coordinates
     T* subarray_coords = new T[dim_num];
@@ -1564,8 +1767,8 @@ void ReadState::compute_tile_search_range_hil() {
       med = min + ((max - min) / 2);
 
       // Get info for bounding coordinates
-      tile_start_coords = static_cast<const T*>(bounding_coords[med]);
-      tile_end_coords = &(static_cast<const T*>(bounding_coords[med])[dim_num]);
+      tile_start_coords = &bounding_coords[2*dim_num*med];
+      tile_end_coords = &bounding_coords[2*dim_num*med + dim_num];
      
       // Calculate precedence
       if(array_schema_->tile_cell_order_cmp(
@@ -1593,9 +1796,14 @@ void ReadState::compute_tile_search_range_hil() {
     // Clean up
     delete [] subarray_coords;
   }  else {                            // Non-unary range
-    if(book_keeping_->tile_num() > 0) {
-      tile_search_range_[0] = 0;
-      tile_search_range_[1] = book_keeping_->tile_num() - 1;
+    // The tiles are not ordered along the subarray bounds, so the range
+    // starts at the first tile the R-tree finds overlapping
+    if(rtree_ == NULL)
+      rtree_ = book_keeping_->rtree();
+    int64_t first = rtree_->next_overlapping_tile(subarray, 1, 0, tile_num-1);
+    if(first < tile_num) {
+      tile_search_range_[0] = first;
+      tile_search_range_[1] = tile_num - 1;
     } else {
       tile_search_range_[0] = -1;
       tile_search_range_[1] = -1;
@@ -1792,14 +2000,137 @@ int ReadState::GET_CELL_PTR_FROM_OFFSET_TILE(
   return TILEDB_RS_OK;
 }
 
-bool ReadState::is_empty_attribute(int attribute_id) const {
+bool ReadState::is_empty_attribute(int attribute_id) {
   // Special case for search coordinate tiles
   if(attribute_id == attribute_num_ + 1) 
     attribute_id = attribute_num_;
 
+  // Check the attribute file once
+  if(!is_empty_attribute_checked_[attribute_id]) {
+    std::string filename = 
+        fragment_->fragment_name() + "/" + 
+        array_schema_->attribute(attribute_id) + TILEDB_FILE_SUFFIX;
+    is_empty_attribute_[attribute_id] = 
+        !is_file(array_->config()->get_filesystem(), filename);
+    is_empty_attribute_checked_[attribute_id] = true;
+  }
+
   return is_empty_attribute_[attribute_id];
 }
 
+int ReadState::load_attribute(int attribute_id) {
+  // Special case for search coordinate tiles
+  if(attribute_id == attribute_num_ + 1) 
+    attribute_id = attribute_num_;
+
+  if(book_keeping_->load_attribute(attribute_id) != TILEDB_BK_OK) {
+    tiledb_rs_errmsg = tiledb_bk_errmsg;
+    return TILEDB_RS_ERR;
+  }
+
+  // Success
+  return TILEDB_RS_OK;
+}
+
+bool ReadState::mbr_overlaps_subarray(int64_t tile_i) const {
+  // For easy reference
+  int coords_type = array_schema_->coords_type();
+
+  // Invoke the proper templated function
+  if(coords_type == TILEDB_INT32) {
+    return mbr_overlaps_subarray<int>(tile_i);
+  } else if(coords_type == TILEDB_INT64) {
+    return mbr_overlaps_subarray<int64_t>(tile_i);
+  } else if(coords_type == TILEDB_FLOAT32) {
+    return mbr_overlaps_subarray<float>(tile_i);
+  } else if(coords_type == TILEDB_FLOAT64) {
+    return mbr_overlaps_subarray<double>(tile_i);
+  } else {
+    // The code should never reach here
+    assert(0);
+    return false;
+  } 
+}
+
+template<class T>
+int64_t ReadState::overlapping_tile_num() const {
+  // For easy reference
+  int dim_num = array_schema_->dim_num();
+  const T* domain = static_cast<const T*>(array_schema_->domain());
+  const T* tile_extents = static_cast<const T*>(array_schema_->tile_extents());
+  const T* non_empty_domain = 
+      static_cast<const T*>(book_keeping_->non_empty_domain());
+  const T* subarray = static_cast<const T*>(array_->subarray());
+
+  // Multiply the number of overlapping tiles across the dimensions
+  int64_t tile_num = 1;
+  for(int i=0; i<dim_num; ++i) {
+    T low = std::max(subarray[2*i], non_empty_domain[2*i]);
+    T high = std::min(subarray[2*i+1], non_empty_domain[2*i+1]);
+    if(low > high)
+      return 0;
+    tile_num *= 
+        (high - domain[2*i]) / tile_extents[i] - 
+        (low - domain[2*i]) / tile_extents[i] + 1;
+  }
+
+  return tile_num;
+}
+
+template<class T>
+bool ReadState::mbr_overlaps_subarray(int64_t tile_i) const {
+  // For easy reference
+  int dim_num = array_schema_->dim_num();
+  const T* mbr = static_cast<const T*>(book_keeping_->mbr(tile_i));
+  const T* subarray = static_cast<const T*>(array_->subarray());
+
+  for(int i=0; i<dim_num; ++i) {
+    if(mbr[2*i] > subarray[2*i+1] || mbr[2*i+1] < subarray[2*i])
+      return false;
+  }
+
+  return true;
+}
+
+int ReadState::get_mapped_range(
+    int attribute_id,
+    bool is_var,
+    off_t offset,
+    size_t length,
+    const char*& data) {
+  // Special case for coords
+  if(attribute_id == attribute_num_+1)
+    attribute_id = attribute_num_;
+
+  // Map the whole file, or share the mapping of another read state
+  std::shared_ptr<MappedFile>& mapped_file = 
+      is_var ? mapped_var_files_[attribute_id] : mapped_files_[attribute_id];
+  if(mapped_file == NULL) {
+    mapped_file = 
+        array_->mmap_registry()->acquire(
+            construct_filename(attribute_id, is_var));
+    if(mapped_file == NULL) {
+      std::string errmsg = "Cannot read tile from file; Memory map error";
+      PRINT_ERROR(errmsg);
+      tiledb_rs_errmsg = TILEDB_RS_ERRMSG + errmsg;
+      return TILEDB_RS_ERR;
+    }
+  }
+
+  if(offset + length > mapped_file->size()) {
+    std::string errmsg = 
+        "Cannot read tile from file; Tile exceeds the mapped file size";
+    PRINT_ERROR(errmsg);
+    tiledb_rs_errmsg = TILEDB_RS_ERRMSG + errmsg;
+    return TILEDB_RS_ERR;
+  }
+
+  data = 
+      (mapped_file->data() == NULL) ? NULL : mapped_file->data() + offset;
+
+  return TILEDB_RS_OK;
+}
+
 int ReadState::map_tile_from_file_cmp(
     int attribute_id,
     off_t offset,
@@ -1809,6 +2140,22 @@ int ReadState::map_tile_from_file_cmp(
   int attribute_id_real = 
       (attribute_id == attribute_num_+1) ? attribute_num_ : attribute_id;
 
+  // Point into the whole file mapping
+  if(use_mapped_files_) {
+    const char* data;
+    if(get_mapped_range(
+           attribute_id_real, 
+           false, 
+           offset, 
+           tile_size, 
+           data) != TILEDB_RS_OK) {
+      tile_compressed_ = NULL;
+      return TILEDB_RS_ERR;
+    }
+    tile_compressed_ = const_cast<char*>(data);
+    return TILEDB_RS_OK;
+  }
+
   // Unmap
   if(map_addr_compressed_ != NULL) {
     if(munmap(map_addr_compressed_, map_addr_compressed_length_)) {
@@ -1887,6 +2234,22 @@ int ReadState::map_tile_from_file_var_cmp(
     int attribute_id,
     off_t offset,
     size_t tile_size) {
+  // Point into the whole file mapping
+  if(use_mapped_files_) {
+    const char* data;
+    if(get_mapped_range(
+           attribute_id, 
+           true, 
+           offset, 
+           tile_size, 
+           data) != TILEDB_RS_OK) {
+      tile_compressed_ = NULL;
+      return TILEDB_RS_ERR;
+    }
+    tile_compressed_ = const_cast<char*>(data);
+    return TILEDB_RS_OK;
+  }
+
   // Unmap
   if(map_addr_compressed_ != NULL) {
     if(munmap(map_addr_compressed_, map_addr_compressed_length_)) {
@@ -1976,6 +2339,28 @@ int ReadState::map_tile_from_file_cmp_none(
   int attribute_id_real = 
       (attribute_id == attribute_num_+1) ? attribute_num_ : attribute_id;
 
+  // Point into the whole file mapping
+  if(use_mapped_files_) {
+    const char* data;
+    if(get_mapped_range(
+           attribute_id_real, 
+           false, 
+           offset, 
+           tile_size, 
+           data) != TILEDB_RS_OK) 
+      return TILEDB_RS_ERR;
+    if(array_schema_->var_size(attribute_id_real)) {
+      // The cell offsets are shifted in place, copy them
+      if(tiles_[attribute_id] == NULL) 
+        tiles_[attribute_id] = malloc(fragment_->tile_size(attribute_id_real));
+      memcpy(tiles_[attribute_id], data, tile_size);
+    } else {
+      tiles_[attribute_id] = const_cast<char*>(data);
+      tiles_mapped_[attribute_id] = true;
+    }
+    return TILEDB_RS_OK;
+  }
+
   // Unmap
   if(map_addr_[attribute_id] != NULL) {
     if(munmap(map_addr_[attribute_id], map_addr_lengths_[attribute_id])) {
@@ -2054,6 +2439,22 @@ int ReadState::map_tile_from_file_var_cmp_none(
     int attribute_id,
     off_t offset,
     size_t tile_size) {
+  // Point into the whole file mapping
+  if(use_mapped_files_) {
+    const char* data;
+    if(get_mapped_range(
+           attribute_id, 
+           true, 
+           offset, 
+           tile_size, 
+           data) != TILEDB_RS_OK) 
+      return TILEDB_RS_ERR;
+    tiles_var_[attribute_id] = const_cast<char*>(data);
+    tiles_var_mapped_[attribute_id] = true;
+    tiles_var_sizes_[attribute_id] = tile_size; 
+    return TILEDB_RS_OK;
+  }
+
   // Unmap
   if(map_addr_var_[attribute_id] != NULL) {
     if(munmap(
@@ -2230,6 +2631,13 @@ int ReadState::prepare_tile_for_reading(
   // For easy reference
   int compression = array_schema_->compression(attribute_id);
 
+  // Decode the tile offsets of the attribute on its first use
+  if(load_attribute(attribute_id) != TILEDB_RS_OK)
+    return TILEDB_RS_ERR;
+
+  // Hint the filesystem the first time the attribute file is read
+  advise_access(attribute_id, false);
+
   // Invoke the proper function based on the compression type
   if(compression == TILEDB_NO_COMPRESSION)
     return prepare_tile_for_reading_cmp_none(attribute_id, tile_i);
@@ -2243,6 +2651,14 @@ int ReadState::prepare_tile_for_reading_var(
   // For easy reference
   int compression = array_schema_->compression(attribute_id);
 
+  // Decode the tile offsets and sizes of the attribute on its first use
+  if(load_attribute(attribute_id) != TILEDB_RS_OK)
+    return TILEDB_RS_ERR;
+
+  // Hint the filesystem the first time the attribute files are read
+  advise_access(attribute_id, false);
+  advise_access(attribute_id, true);
+
   // Invoke the proper function based on the compression type
   if(compression == TILEDB_NO_COMPRESSION)
     return prepare_tile_for_reading_var_cmp_none(attribute_id, tile_i);
@@ -2267,32 +2683,48 @@ int ReadState::prepare_tile_for_reading_cmp(
   size_t full_tile_size = fragment_->tile_size(attribute_id_real);
   int64_t cell_num = book_keeping_->cell_num(tile_i);  
   size_t tile_size = cell_num * cell_size; 
-  const std::vector<std::vector<off_t> >& tile_offsets = 
-      book_keeping_->tile_offsets(); 
+  const off_t* tile_offsets = book_keeping_->tile_offsets(attribute_id_real);
   int64_t tile_num = book_keeping_->tile_num();
 
   // Allocate space for the tile if needed
   if(tiles_[attribute_id] == NULL) 
     tiles_[attribute_id] = malloc(full_tile_size);
 
+  // Check the shared cache for the decompressed tile
+  TileCache* tile_cache = array_->tile_cache();
+  std::string tile_key;
+  if(tile_cache != NULL) {
+    tile_key = TileCache::key(
+                   fragment_->fragment_name(), 
+                   attribute_id_real, 
+                   tile_i, 
+                   false);
+    if(tile_cache->get(tile_key, tiles_[attribute_id], tile_size)) {
+      tiles_sizes_[attribute_id] = tile_size;
+      tiles_offsets_[attribute_id] = 0;
+      fetched_tile_[attribute_id] = tile_i;
+      return TILEDB_RS_OK;
+    }
+  }
+
   // Prepare attribute file name
   std::string filename = fragment_->fragment_name() + "/" +
                          array_schema_->attribute(attribute_id_real) +
                          TILEDB_FILE_SUFFIX;
 
   // Find file offset where the tile begins
-  off_t file_offset = tile_offsets[attribute_id_real][tile_i];
-  auto file_size = ::file_size(array_->config()->get_filesystem(), filename);
+  off_t file_offset = tile_offsets[tile_i];
   size_t tile_compressed_size = 
       (tile_i == tile_num-1) 
-          ? file_size - tile_offsets[attribute_id_real][tile_i] 
-          : tile_offsets[attribute_id_real][tile_i+1] - 
-            tile_offsets[attribute_id_real][tile_i];
+          ? get_file_size(attribute_id_real, false) - tile_offsets[tile_i] 
+          : tile_offsets[tile_i+1] - tile_offsets[tile_i];
 
   // Read tile from file
   int rc = TILEDB_RS_OK;
   int read_method = array_->config()->read_method();
-  if(read_method ==  TILEDB_IO_READ) {
+  if(batch_tile_reads_) {
+    rc = read_tiles_from_file_v(attribute_id, tile_i);
+  } else if(read_method ==  TILEDB_IO_READ) {
     rc = read_tile_from_file_cmp(
          attribute_id, 
          file_offset, 
@@ -2322,14 +2754,24 @@ int ReadState::prepare_tile_for_reading_cmp(
   if(rc != TILEDB_RS_OK)
     return TILEDB_RS_ERR;
 
-  // Decompress tile
+  // Decompress tile, read in a run of tiles starting at the prefetched one
+  void* tile_compressed = 
+      batch_tile_reads_
+          ? static_cast<char*>(tiles_compressed_[attribute_id]) + 
+                (file_offset - 
+                 tile_offsets[prefetched_tiles_[attribute_id].first])
+          : tile_compressed_;
   if(decompress_tile(
          attribute_id, 
-         static_cast<unsigned char*>(tile_compressed_), 
+         static_cast<unsigned char*>(tile_compressed), 
          tile_compressed_size, 
          static_cast<unsigned char*>(tiles_[attribute_id]),
          full_tile_size) != TILEDB_RS_OK)
     return TILEDB_RS_ERR;
+
+  // Share the decompressed tile
+  if(tile_cache != NULL)
+    tile_cache->put(tile_key, tiles_[attribute_id], tile_size);
          
   // Set the tile size
   tiles_sizes_[attribute_id] = tile_size;
@@ -2369,7 +2811,8 @@ int ReadState::prepare_tile_for_reading_cmp_none(
   int rc = TILEDB_RS_OK;
   int read_method = array_->config()->read_method();
   if(read_method ==  TILEDB_IO_READ || 
-     read_method == TILEDB_IO_MPI)
+     read_method == TILEDB_IO_MPI ||
+     read_method == TILEDB_IO_URING)
     rc = set_tile_file_offset(
          attribute_id, 
          file_offset);
@@ -2413,12 +2856,48 @@ int ReadState::prepare_tile_for_reading_var_cmp(
   size_t full_tile_size = fragment_->tile_size(attribute_id);
   int64_t cell_num = book_keeping_->cell_num(tile_i); 
   size_t tile_size = cell_num * cell_size;
-  const std::vector<std::vector<off_t> >& tile_offsets = 
-      book_keeping_->tile_offsets(); 
-  const std::vector<std::vector<off_t> >& tile_var_offsets = 
-      book_keeping_->tile_var_offsets(); 
+  const off_t* tile_offsets = book_keeping_->tile_offsets(attribute_id);
+  const off_t* tile_var_offsets = 
+      book_keeping_->tile_var_offsets(attribute_id);
   int64_t tile_num = book_keeping_->tile_num();
 
+  // Check the shared cache for both decompressed tiles
+  TileCache* tile_cache = array_->tile_cache();
+  std::string tile_key, tile_var_key;
+  size_t tile_var_size = book_keeping_->tile_var_sizes(attribute_id)[tile_i];
+  if(tile_cache != NULL) {
+    tile_key = TileCache::key(
+                   fragment_->fragment_name(), 
+                   attribute_id, 
+                   tile_i, 
+                   false);
+    tile_var_key = TileCache::key(
+                       fragment_->fragment_name(), 
+                       attribute_id, 
+                       tile_i, 
+                       true);
+    if(tiles_[attribute_id] == NULL) 
+      tiles_[attribute_id] = malloc(full_tile_size);
+    if(tile_var_size > tiles_var_allocated_size_[attribute_id]) {
+      tiles_var_[attribute_id] = 
+          realloc(tiles_var_[attribute_id], tile_var_size);
+      tiles_var_allocated_size_[attribute_id] = tile_var_size;
+    }
+    if(tile_cache->get(tile_key, tiles_[attribute_id], tile_size) &&
+       (tile_var_size == 0u ||
+        tile_cache->get(
+            tile_var_key, 
+            tiles_var_[attribute_id], 
+            tile_var_size))) {
+      tiles_sizes_[attribute_id] = tile_size;
+      tiles_offsets_[attribute_id] = 0;
+      tiles_var_sizes_[attribute_id] = tile_var_size; 
+      tiles_var_offsets_[attribute_id] = 0;
+      fetched_tile_[attribute_id] = tile_i;
+      return TILEDB_RS_OK;
+    }
+  }
+
   // ========== Get tile with variable cell offsets ========== //
 
   // Prepare attribute file name
@@ -2427,12 +2906,10 @@ int ReadState::prepare_tile_for_reading_var_cmp(
              TILEDB_FILE_SUFFIX;
 
   // Find file offset where the tile begins
-  off_t file_offset = tile_offsets[attribute_id][tile_i];
-  auto file_size = ::file_size(array_->config()->get_filesystem(), filename);
+  off_t file_offset = tile_offsets[tile_i];
   size_t tile_compressed_size = 
-      (tile_i == tile_num-1) ? file_size - tile_offsets[attribute_id][tile_i]
-                             : tile_offsets[attribute_id][tile_i+1] - 
-                               tile_offsets[attribute_id][tile_i];
+      (tile_i == tile_num-1) ? get_file_size(attribute_id, false) - tile_offsets[tile_i]
+                             : tile_offsets[tile_i+1] - tile_offsets[tile_i];
 
   // Allocate space for the tile if needed
   if(tiles_[attribute_id] == NULL) 
@@ -2441,7 +2918,10 @@ int ReadState::prepare_tile_for_reading_var_cmp(
   // Read tile from file
   int rc = TILEDB_RS_OK;
   int read_method = array_->config()->read_method();
-  if(read_method ==  TILEDB_IO_READ) {
+  if(batch_tile_reads_) {
+    // Also reads the variable tile
+    rc = read_tiles_from_file_v(attribute_id, tile_i);
+  } else if(read_method ==  TILEDB_IO_READ) {
     rc = read_tile_from_file_cmp(
          attribute_id, 
          file_offset, 
@@ -2471,10 +2951,16 @@ int ReadState::prepare_tile_for_reading_var_cmp(
   if(rc != TILEDB_RS_OK)
     return TILEDB_RS_ERR;
 
-  // Decompress tile
+  // Decompress tile, read in a run of tiles starting at the prefetched one
+  void* tile_compressed = 
+      batch_tile_reads_
+          ? static_cast<char*>(tiles_compressed_[attribute_id]) + 
+                (file_offset - 
+                 tile_offsets[prefetched_tiles_[attribute_id].first])
+          : tile_compressed_;
   if(decompress_tile(
          attribute_id, 
-         static_cast<unsigned char*>(tile_compressed_), 
+         static_cast<unsigned char*>(tile_compressed), 
          tile_compressed_size, 
          static_cast<unsigned char*>(tiles_[attribute_id]),
          tile_size,
@@ -2495,15 +2981,10 @@ int ReadState::prepare_tile_for_reading_var_cmp(
              TILEDB_FILE_SUFFIX;
 
   // Calculate offset and compressed tile size
-  file_offset = tile_var_offsets[attribute_id][tile_i];
-  file_size = ::file_size(array_->config()->get_filesystem(), filename);
+  file_offset = tile_var_offsets[tile_i];
   tile_compressed_size = 
-      (tile_i == tile_num-1) ? file_size-tile_var_offsets[attribute_id][tile_i]
-                          : tile_var_offsets[attribute_id][tile_i+1] - 
-                            tile_var_offsets[attribute_id][tile_i];
-
-  // Get size of decompressed tile
-  size_t tile_var_size = book_keeping_->tile_var_sizes()[attribute_id][tile_i];
+      (tile_i == tile_num-1) ? get_file_size(attribute_id, true)-tile_var_offsets[tile_i]
+                          : tile_var_offsets[tile_i+1] - tile_var_offsets[tile_i];
 
   //Non-empty tile, decompress
   if(tile_var_size > 0u) {
@@ -2523,7 +3004,12 @@ int ReadState::prepare_tile_for_reading_var_cmp(
     // Read tile from file
     int rc = TILEDB_RS_OK;
     int read_method = array_->config()->read_method();
-    if(read_method ==  TILEDB_IO_READ) {
+    if(batch_tile_reads_) {
+      tile_compressed = 
+          static_cast<char*>(tiles_var_compressed_[attribute_id]) + 
+          (file_offset - 
+           tile_var_offsets[prefetched_tiles_[attribute_id].first]);
+    } else if(read_method ==  TILEDB_IO_READ) {
       rc = read_tile_from_file_var_cmp(
                attribute_id, 
                file_offset, 
@@ -2554,9 +3040,11 @@ int ReadState::prepare_tile_for_reading_var_cmp(
       return TILEDB_RS_ERR;
 
     // Decompress tile
+    if(!batch_tile_reads_)
+      tile_compressed = tile_compressed_;
     if(decompress_tile(
            attribute_id, 
-           static_cast<unsigned char*>(tile_compressed_), 
+           static_cast<unsigned char*>(tile_compressed), 
            tile_compressed_size, 
            static_cast<unsigned char*>(tiles_var_[attribute_id]),
            tile_var_size) != TILEDB_RS_OK)
@@ -2572,6 +3060,13 @@ int ReadState::prepare_tile_for_reading_var_cmp(
   // Shift variable cell offsets
   shift_var_offsets(attribute_id);
 
+  // Share the decompressed tiles
+  if(tile_cache != NULL) {
+    tile_cache->put(tile_key, tiles_[attribute_id], tile_size);
+    if(tile_var_size > 0u)
+      tile_cache->put(tile_var_key, tiles_var_[attribute_id], tile_var_size);
+  }
+
   // Mark as fetched
   fetched_tile_[attribute_id] = tile_i;
 
@@ -2602,7 +3097,8 @@ int ReadState::prepare_tile_for_reading_var_cmp_none(
   int rc = TILEDB_RS_OK;
   int read_method = array_->config()->read_method();
   if(read_method ==  TILEDB_IO_READ || 
-     read_method == TILEDB_IO_MPI)
+     read_method == TILEDB_IO_MPI ||
+     read_method == TILEDB_IO_URING)
     rc = set_tile_file_offset(
          attribute_id, 
          file_offset);
@@ -2638,14 +3134,13 @@ int ReadState::prepare_tile_for_reading_var_cmp_none(
     }
     tile_var_size = end_tile_var_offset - tile_s[0];
   } else {                  // Last tile
-    // Prepare variable attribute file name
-    std::string filename = fragment_->fragment_name() + "/" + array_schema_->attribute(attribute_id) + "_var" + TILEDB_FILE_SUFFIX;
-    tile_var_size = file_size(array_->config()->get_filesystem(), filename) - tile_s[0];
+    tile_var_size = get_file_size(attribute_id, true) - tile_s[0];
   }
 
   // Read tile from file
   if(read_method ==  TILEDB_IO_READ || 
-     read_method == TILEDB_IO_MPI)
+     read_method == TILEDB_IO_MPI ||
+     read_method == TILEDB_IO_URING)
     rc = set_tile_var_file_offset(
          attribute_id, 
          start_tile_var_offset);
@@ -2732,9 +3227,170 @@ int ReadState::read_tile_from_file_cmp(
   }
 
   // Read from file
+  ++tile_reads_;
+  ++tile_io_reads_;
   return read_segment(attribute_id_real, false, offset, tile_compressed_, tile_size);
 }
 
+int ReadState::read_tiles_from_file_v(int attribute_id, int64_t tile_i) {
+  // Return if the tile was already read in an earlier batch
+  if(tile_i >= prefetched_tiles_[attribute_id].first &&
+     tile_i <= prefetched_tiles_[attribute_id].second)
+    return TILEDB_RS_OK;
+
+  // For easy reference
+  StorageFS* fs = array_->config()->get_filesystem();
+  int64_t tile_num = book_keeping_->tile_num();
+
+  // Batch the requested tile with the same tile of the other compressed
+  // attributes in the query that are likely to be fetched next
+  std::vector<int> attribute_ids;
+  if(batch_attribute_reads_)
+    attribute_ids = array_->attribute_ids();
+  if(std::find(attribute_ids.begin(), attribute_ids.end(), attribute_id) == 
+     attribute_ids.end())
+    attribute_ids.push_back(attribute_id);
+  std::vector<StorageFSRead> reads;
+  std::vector<std::pair<int, bool> > read_files;
+  std::vector<std::pair<int, int64_t> > batched_ids;
+  for(auto id : attribute_ids) {
+    int id_real = (id == attribute_num_+1) ? attribute_num_ : id;
+    if(id != attribute_id && 
+       (tile_i == fetched_tile_[id] || 
+        (tile_i >= prefetched_tiles_[id].first && 
+         tile_i <= prefetched_tiles_[id].second) ||
+        array_schema_->compression(id_real) == TILEDB_NO_COMPRESSION ||
+        is_empty_attribute(id_real)))
+      continue;
+    if(load_attribute(id_real) != TILEDB_RS_OK)
+      return TILEDB_RS_ERR;
+
+    // The end of the last tile is given by the file size
+    bool var = id_real < attribute_num_ && array_schema_->var_size(id_real);
+    const off_t* tile_offsets = book_keeping_->tile_offsets(id_real);
+    const off_t* tile_var_offsets = 
+        var ? book_keeping_->tile_var_offsets(id_real) : NULL;
+    const size_t* tile_var_sizes = 
+        var ? book_keeping_->tile_var_sizes(id_real) : NULL;
+    std::string filename = construct_filename(id_real, false);
+    std::string filename_var = var ? construct_filename(id_real, true) : "";
+    auto tile_end = [&](int64_t tile) -> off_t {
+      if(tile < tile_num-1)
+        return tile_offsets[tile+1];
+      return get_file_size(id_real, false);
+    };
+    auto tile_var_end = [&](int64_t tile) -> off_t {
+      if(!var)
+        return 0;
+      if(tile < tile_num-1)
+        return tile_var_offsets[tile+1];
+      return get_file_size(id_real, true);
+    };
+    auto tile_var_start = [&](int64_t tile) -> off_t {
+      return var ? tile_var_offsets[tile] : 0;
+    };
+
+    // Coalesce the reads of the next tiles overlapping the query subarray
+    int64_t last_tile = tile_i;
+    tile_reads_ += 1 + (var && tile_var_sizes[tile_i] > 0u);
+    for(int64_t next = tile_i+1;
+        coalesce_max_size_ > 0 && next <= tile_search_range_[1]; 
+        ++next) {
+      size_t gap = 
+          (tile_offsets[next] - tile_end(last_tile)) + 
+          (tile_var_start(next) - tile_var_end(last_tile));
+      size_t size = 
+          (tile_end(next) - tile_offsets[tile_i]) + 
+          (tile_var_end(next) - tile_var_start(tile_i));
+      if(gap > coalesce_max_gap_ || size > coalesce_max_size_)
+        break;
+      if(!mbr_overlaps_subarray(next))
+        continue;
+      last_tile = next;
+      tile_reads_ += 1 + (var && tile_var_sizes[next] > 0u);
+    }
+
+    off_t file_offset = tile_offsets[tile_i];
+    size_t tiles_compressed_size = tile_end(last_tile) - file_offset;
+    if(tiles_compressed_allocated_size_[id] < tiles_compressed_size) {
+      tiles_compressed_[id] = 
+          realloc(tiles_compressed_[id], tiles_compressed_size);
+      tiles_compressed_allocated_size_[id] = tiles_compressed_size;
+    }
+    reads.push_back(
+        {filename, file_offset, tiles_compressed_[id], tiles_compressed_size});
+    read_files.push_back(std::make_pair(id_real, false));
+
+    file_offset = tile_var_start(tile_i);
+    tiles_compressed_size = tile_var_end(last_tile) - file_offset;
+    if(var && tiles_compressed_size > 0u) {
+      if(tiles_var_compressed_allocated_size_[id] < tiles_compressed_size) {
+        tiles_var_compressed_[id] = 
+            realloc(tiles_var_compressed_[id], tiles_compressed_size);
+        tiles_var_compressed_allocated_size_[id] = tiles_compressed_size;
+      }
+      reads.push_back(
+          {filename_var, file_offset, tiles_var_compressed_[id], 
+           tiles_compressed_size});
+      read_files.push_back(std::make_pair(id_real, true));
+    }
+
+    batched_ids.push_back(std::make_pair(id, last_tile));
+  }
+  tile_io_reads_ += reads.size();
+
+  // Read all tiles with one vectored call. With download buffers, it is a
+  // call for the blocks missing from the buffers of all the files
+  int rc = TILEDB_RS_OK;
+  bool buffered = batch_attribute_reads_ && fs->get_download_buffer_size() > 0;
+  if(buffered) {
+    std::vector<StorageBuffer*> file_buffers;
+    for(auto& read_file : read_files)
+      file_buffers.push_back(
+          get_file_buffer(read_file.first, read_file.second));
+    if(StorageBuffer::read_buffers_v(file_buffers, reads) != TILEDB_BF_OK) {
+      std::string errmsg = 
+          "Cannot read tiles of fragment " + fragment_->fragment_name() + 
+          " from memory. Will try read directly from files";
+      PRINT_ERROR(errmsg);
+      tiledb_rs_errmsg = TILEDB_RS_ERRMSG + errmsg;
+      buffered = false;
+    }
+  }
+  if(batch_attribute_reads_ && !buffered) {
+    if(fs->read_from_file_v(reads) != TILEDB_FS_OK) {
+      std::string errmsg = 
+          "Cannot read tiles from fragment " + fragment_->fragment_name() + 
+          "; " + tiledb_fs_errmsg;
+      PRINT_ERROR(errmsg);
+      tiledb_rs_errmsg = TILEDB_RS_ERRMSG + errmsg;
+      rc = TILEDB_RS_ERR;
+    }
+  } else if(!batch_attribute_reads_) {
+    for(auto i=0ul; i<reads.size() && rc == TILEDB_RS_OK; ++i)
+      rc = read_segment(
+               read_files[i].first, 
+               read_files[i].second, 
+               reads[i].offset, 
+               reads[i].buffer, 
+               reads[i].length);
+  }
+
+  // Error
+  if(rc != TILEDB_RS_OK) {
+    for(auto& batched_id : batched_ids)
+      prefetched_tiles_[batched_id.first] = std::make_pair(-1, -1);
+    return TILEDB_RS_ERR;
+  }
+
+  for(auto& batched_id : batched_ids)
+    prefetched_tiles_[batched_id.first] = 
+        std::make_pair(tile_i, batched_id.second);
+
+  // Success
+  return TILEDB_RS_OK;
+}
+
 int ReadState::read_tile_from_file_var_cmp(
     int attribute_id,
     off_t offset,
@@ -2751,6 +3407,8 @@ int ReadState::read_tile_from_file_var_cmp(
     tile_compressed_allocated_size_ = tile_size;
   }
 
+  ++tile_reads_;
+  ++tile_io_reads_;
   return read_segment(attribute_id, true, offset, tile_compressed_, tile_size);
 }
 
@@ -2801,6 +3459,28 @@ void ReadState::shift_var_offsets(
       buffer_s[i] = buffer_s[i] - start_offset + new_start_offset;
 }
 
+bool ReadState::tile_filtered_out(int64_t tile_i) {
+  // For easy reference
+  const Expression* expression = array_->zone_map_filter();
+
+  // No filter, or none the zone maps can tell anything about
+  if(expression == NULL || expression->zone_map_attribute_ids().empty())
+    return false;
+
+  // Load the zone maps of the filter attributes on first use
+  if(zone_map_expression_ != expression) {
+    for(auto attribute_id : expression->zone_map_attribute_ids())
+      if(book_keeping_->load_attribute(attribute_id) != TILEDB_BK_OK)
+        return false;
+    zone_map_expression_ = expression;
+  }
+
+  return expression->excludes_tile(book_keeping_, tile_i) &&
+         !array_->overlaps_older_fragment(
+              fragment_, 
+              book_keeping_->mbr(tile_i));
+}
+
 
 
 
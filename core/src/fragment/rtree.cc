@@ -0,0 +1,266 @@
+/**
+ * @file rtree.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements the RTree class.
+ */
+
+#include "rtree.h"
+#include "mbr_overlap.h"
+#include "tiledb_constants.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+
+
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+RTree::RTree(
+    int coords_type,
+    int dim_num,
+    int64_t tile_num,
+    const void* mbr_columns,
+    int fanout)
+    : dim_num_(dim_num),
+      fanout_(fanout),
+      mbr_columns_(mbr_columns) {
+  level_offsets_.push_back(0);
+  level_sizes_.push_back(tile_num);
+  level_spans_.push_back(1);
+
+  // Invoke the proper templated function
+  if(coords_type == TILEDB_INT32) {
+    build<int>();
+  } else if(coords_type == TILEDB_INT64) {
+    build<int64_t>();
+  } else if(coords_type == TILEDB_FLOAT32) {
+    build<float>();
+  } else if(coords_type == TILEDB_FLOAT64) {
+    build<double>();
+  } else {
+    // The code should never reach here
+    assert(0);
+  } 
+}
+
+
+
+
+/* ****************************** */
+/*           ACCESSORS            */
+/* ****************************** */
+
+int RTree::level_num() const {
+  return level_sizes_.size() - 1;
+}
+
+template<class T>
+int64_t RTree::next_overlapping_tile(
+    const T* ranges,
+    int range_num,
+    int64_t start,
+    int64_t end) const {
+  // Trivial case
+  int64_t last = std::min(end, level_sizes_[0]-1);
+  if(start > last)
+    return end+1;
+
+  // Consecutive calls mostly continue in the same leaf node, so finish it
+  // before descending from the root 
+  int64_t node_end = (start/fanout_ + 1)*fanout_ - 1;
+  int64_t pos = scan_tiles(ranges, range_num, start, std::min(node_end, last));
+  if(pos <= std::min(node_end, last))
+    return pos;
+  if(node_end >= last)
+    return end+1;
+
+  pos = search(level_num(), 0, ranges, range_num, node_end+1, last);
+  return (pos <= last) ? pos : end+1;
+}
+
+
+
+
+/* ****************************** */
+/*        PRIVATE METHODS         */
+/* ****************************** */
+
+template<class T>
+void RTree::build() {
+  // For easy reference
+  size_t mbr_size = 2*dim_num_*sizeof(T);
+  int64_t tile_num = level_sizes_[0];
+  const T* mbr_columns = static_cast<const T*>(mbr_columns_);
+
+  // Levels are added until a single root bounds all the tiles
+  int64_t size = tile_num;
+  int64_t node_num = 0;
+  while(size > 1 || level_sizes_.size() == 1) {
+    if(size == 0)
+      return;
+    size = (size + fanout_ - 1) / fanout_;
+    level_offsets_.push_back(node_num);
+    level_sizes_.push_back(size);
+    level_spans_.push_back(level_spans_.back()*fanout_);
+    node_num += size;
+  }
+  nodes_.resize(node_num*mbr_size);
+
+  // The first level bounds the tile MBRs
+  T* nodes = reinterpret_cast<T*>(nodes_.data());
+  for(int64_t node=0; node<level_sizes_[1]; ++node) {
+    int64_t first = node*fanout_;
+    int64_t last = std::min(first+fanout_, tile_num);
+    T* mbr = &nodes[2*dim_num_*node];
+    for(int i=0; i<dim_num_; ++i) {
+      const T* lows = mbr_columns + 2*i*tile_num;
+      const T* highs = lows + tile_num;
+      mbr[2*i] = *std::min_element(lows+first, lows+last); 
+      mbr[2*i+1] = *std::max_element(highs+first, highs+last); 
+    }
+  }
+
+  // Every other level bounds the level below 
+  for(int level=2; level<=level_num(); ++level) {
+    for(int64_t node=0; node<level_sizes_[level]; ++node) {
+      int64_t first = node*fanout_;
+      int64_t last = std::min<int64_t>(first+fanout_, level_sizes_[level-1]);
+      T* mbr = &nodes[2*dim_num_*(level_offsets_[level] + node)];
+      memcpy(mbr, node_mbr<T>(level-1, first), mbr_size);
+      for(int64_t child=first+1; child<last; ++child) {
+        const T* child_mbr = node_mbr<T>(level-1, child);
+        for(int i=0; i<dim_num_; ++i) {
+          mbr[2*i] = std::min(mbr[2*i], child_mbr[2*i]);
+          mbr[2*i+1] = std::max(mbr[2*i+1], child_mbr[2*i+1]);
+        }
+      }
+    }
+  }
+}
+
+template<class T>
+inline
+const T* RTree::node_mbr(int level, int64_t node) const {
+  const T* nodes = reinterpret_cast<const T*>(nodes_.data());
+  return &nodes[2*dim_num_*(level_offsets_[level] + node)];
+}
+
+template<class T>
+inline
+bool RTree::overlaps(const T* mbr, const T* ranges, int range_num) const {
+  for(int r=0; r<range_num; ++r) {
+    const T* range = &ranges[2*dim_num_*r];
+    int i = 0;
+    while(i<dim_num_ && mbr[2*i] <= range[2*i+1] && mbr[2*i+1] >= range[2*i])
+      ++i;
+    if(i == dim_num_)
+      return true;
+  }
+
+  return false;
+}
+
+template<class T>
+int64_t RTree::search(
+    int level,
+    int64_t node,
+    const T* ranges,
+    int range_num,
+    int64_t start,
+    int64_t end) const {
+  // The children of the first level are the tiles
+  int64_t first = node*fanout_;
+  if(level == 1) {
+    int64_t tile_end = std::min(end, first+fanout_-1);
+    int64_t pos = 
+        scan_tiles(ranges, range_num, std::max(start, first), tile_end);
+    return (pos <= tile_end) ? pos : end+1;
+  }
+
+  // Descend into the children that overlap the ranges, in order
+  int64_t last = std::min<int64_t>(first+fanout_, level_sizes_[level-1]) - 1;
+  int64_t span = level_spans_[level-1];
+  for(int64_t child=first; child<=last; ++child) {
+    if((child+1)*span - 1 < start) 
+      continue;
+    if(child*span > end)
+      break;
+    if(!overlaps(node_mbr<T>(level-1, child), ranges, range_num))
+      continue;
+    int64_t pos = search(level-1, child, ranges, range_num, start, end);
+    if(pos <= end)
+      return pos;
+  }
+
+  return end+1;
+}
+
+template<class T>
+int64_t RTree::scan_tiles(
+    const T* ranges,
+    int range_num,
+    int64_t start,
+    int64_t end) const {
+  int64_t pos = end+1;
+  for(int r=0; r<range_num && start<pos; ++r)
+    pos = next_overlapping_mbr(
+              static_cast<const T*>(mbr_columns_),
+              level_sizes_[0],
+              dim_num_,
+              &ranges[2*dim_num_*r],
+              start,
+              pos-1);
+
+  return pos;
+}
+
+// Explicit template instantiations
+template int64_t RTree::next_overlapping_tile<int>(
+    const int* ranges,
+    int range_num,
+    int64_t start,
+    int64_t end) const;
+template int64_t RTree::next_overlapping_tile<int64_t>(
+    const int64_t* ranges,
+    int range_num,
+    int64_t start,
+    int64_t end) const;
+template int64_t RTree::next_overlapping_tile<float>(
+    const float* ranges,
+    int range_num,
+    int64_t start,
+    int64_t end) const;
+template int64_t RTree::next_overlapping_tile<double>(
+    const double* ranges,
+    int range_num,
+    int64_t start,
+    int64_t end) const;
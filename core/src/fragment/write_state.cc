@@ -33,6 +33,7 @@
 
 #include "comparators.h"
 #include "storage_buffer.h"
+#include "storage_posixfs.h"
 #include "tiledb_constants.h"
 #include "utils.h"
 #include "write_state.h"
@@ -41,6 +42,7 @@
 #include <cstring>
 #include <fcntl.h>
 #include <iostream>
+#include <limits>
 #include <unistd.h>
 
 
@@ -74,6 +76,59 @@ std::string tiledb_ws_errmsg = "";
 
 
 
+/* ****************************** */
+/*        STATIC FUNCTIONS        */
+/* ****************************** */
+
+/** 
+ * Returns the false-positive rate of the coordinates filters of new sparse
+ * fragments, set with coords_filter_false_positive_rate_ of TileDB_Config
+ * or env TILEDB_BLOOM_FILTER_FPR. Rates outside (0, 1) disable the filters.
+ */
+static double coords_filter_false_positive_rate(
+    const StorageManagerConfig* config) {
+  double false_positive_rate = 
+      config->coords_filter_false_positive_rate() != 0 ?
+          config->coords_filter_false_positive_rate() : 
+          TILEDB_BLOOM_FILTER_FPR;
+  false_positive_rate = 
+      get_env_double("TILEDB_BLOOM_FILTER_FPR", false_positive_rate);
+  if(false_positive_rate <= 0 || false_positive_rate >= 1)
+    return 0;
+  return false_positive_rate;
+}
+
+/** 
+ * Returns a double no larger than the input value. Only 64-bit integers may
+ * be rounded up when converted to double.
+ */
+template<class T>
+static double lower_bound_double(T value) {
+  double bound = static_cast<double>(value);
+  if(sizeof(T) == 8 && std::numeric_limits<T>::is_integer &&
+     (bound >= std::ldexp(1.0, std::numeric_limits<T>::digits) ||
+      static_cast<T>(bound) > value))
+    bound = std::nextafter(bound, -HUGE_VAL);
+  return bound;
+}
+
+/** 
+ * Returns a double no smaller than the input value. Only 64-bit integers may
+ * be rounded down when converted to double.
+ */
+template<class T>
+static double upper_bound_double(T value) {
+  double bound = static_cast<double>(value);
+  if(sizeof(T) == 8 && std::numeric_limits<T>::is_integer &&
+     bound < std::ldexp(1.0, std::numeric_limits<T>::digits) &&
+     static_cast<T>(bound) < value)
+    bound = std::nextafter(bound, HUGE_VAL);
+  return bound;
+}
+
+
+
+
 /* ****************************** */
 /*   CONSTRUCTORS & DESTRUCTORS   */
 /* ****************************** */
@@ -124,6 +179,26 @@ WriteState::WriteState(
   for(int i=0; i<attribute_num_; ++i)
     buffer_var_offsets_[i] = 0;
 
+  // Initialize the zone maps of the current tiles
+  zone_maps_.resize(attribute_num_);
+  zone_map_value_nums_.resize(attribute_num_);
+  for(int i=0; i<attribute_num_; ++i)
+    flush_zone_map(i);
+
+  // Hash the coordinates of sparse fragments for their filter, which only
+  // the sectioned book-keeping layout holds
+  coords_filter_fpr_ = 
+      fragment_->dense() || !book_keeping_->write_sections() ? 
+          0 : coords_filter_false_positive_rate(array_->config());
+  coords_filter_max_size_ = 
+      array_->config()->coords_filter_max_size() != 0 ?
+          array_->config()->coords_filter_max_size() :
+          TILEDB_BLOOM_FILTER_MAX_SIZE;
+  coords_filter_max_size_ = 
+      get_env_uint64("TILEDB_BLOOM_FILTER_MAX_SIZE", coords_filter_max_size_);
+  coords_filter_ = NULL;
+  coords_hash_num_ = 0;
+
   // Initialize current MBR
   mbr_ = malloc(2*coords_size);
 
@@ -134,6 +209,15 @@ WriteState::WriteState(
   
   init_file_buffers();
 
+  // Keep files open with preallocation on local filesystems
+  PosixFS* posix_fs = dynamic_cast<PosixFS*>(fs_);
+  if(posix_fs != NULL && 
+     posix_fs->write_sessions() &&
+     array_->config()->write_method() == TILEDB_IO_WRITE)
+    write_session_ = new WriteSession();
+  else
+    write_session_ = NULL;
+
   // Intialize compression for tiles per attribute
   codec_.resize(attribute_num_+1);
   for(int i=0; i<attribute_num_+1; ++i) {
@@ -150,6 +234,10 @@ WriteState::WriteState(
 }
 
 WriteState::~WriteState() {
+  // Close files left open by errors
+  if(write_session_ != NULL)
+    delete write_session_;
+
   // Delete codec instances
   for(auto i=0u; i<codec_.size(); ++i) {
     if (codec_[i]) {
@@ -181,6 +269,31 @@ WriteState::~WriteState() {
   // Free current bounding coordinates
   if(bounding_coords_ != NULL)
     free(bounding_coords_);
+
+  // Delete the coordinates filter not sent to book-keeping
+  if(coords_filter_ != NULL)
+    delete coords_filter_;
+}
+
+
+
+
+/* ****************************** */
+/*           ACCESSORS            */
+/* ****************************** */
+
+std::vector<std::string> WriteState::files() const {
+  // For easy reference
+  const std::vector<int>& attribute_ids = fragment_->array()->attribute_ids();
+
+  std::vector<std::string> files;
+  for(int i=0; i<(int)attribute_ids.size(); ++i) {
+    files.push_back(construct_filename(attribute_ids[i], false));
+    if(array_schema_->var_size(attribute_ids[i]))
+      files.push_back(construct_filename(attribute_ids[i], true));
+  }
+
+  return files;
 }
 
 
@@ -202,12 +315,27 @@ int WriteState::finalize() {
     tile_cell_num_[attribute_num] = 0;
   }
 
+  // Send the coordinates filter to book-keeping
+  flush_coords_filter();
+
   if (write_file_buffers() != TILEDB_WS_OK) {
     return TILEDB_WS_ERR;
   }
 
-  // Sync all attributes 
-  if(sync() != TILEDB_WS_OK) 
+  if(write_session_ != NULL) {
+    int rc = write_session_->close();
+    delete write_session_;
+    write_session_ = NULL;
+    if(rc != TILEDB_FS_OK) {
+      tiledb_ws_errmsg = tiledb_fs_errmsg;
+      return TILEDB_WS_ERR;
+    }
+  }
+
+  // Sync all attributes, the fragment syncs its files together on commit
+  // with the TILEDB_IO_WRITE method
+  if(array_->config()->write_method() != TILEDB_IO_WRITE &&
+     sync() != TILEDB_WS_OK) 
     return TILEDB_WS_ERR;
 
   // Success
@@ -232,7 +360,7 @@ int WriteState::sync() {
         fragment_->fragment_name() + "/" + 
         array_schema->attribute(attribute_ids[i]) + TILEDB_FILE_SUFFIX;
     if(write_method == TILEDB_IO_WRITE) {
-      rc = ::sync_path(fs_, filename);
+      rc = sync_file(filename);
       // Handle error
       if(rc != TILEDB_UT_OK) {
         tiledb_ws_errmsg = tiledb_ut_errmsg;
@@ -264,7 +392,7 @@ int WriteState::sync() {
           array_schema->attribute(attribute_ids[i]) + "_var" + 
           TILEDB_FILE_SUFFIX;
       if(write_method == TILEDB_IO_WRITE) {
-        rc = ::sync_path(fs_, filename);
+        rc = sync_file(filename);
         // Handle error
         if(rc != TILEDB_UT_OK) {
           tiledb_ws_errmsg = tiledb_ut_errmsg;
@@ -339,7 +467,7 @@ int WriteState::sync_attribute(const std::string& attribute) {
   // Sync attribute
   filename = fragment_->fragment_name() + "/" + attribute + TILEDB_FILE_SUFFIX;
   if(write_method == TILEDB_IO_WRITE) {
-    rc = ::sync_path(fs_, filename);
+    rc = sync_file(filename);
   } else if(write_method == TILEDB_IO_MPI) {
 #ifdef HAVE_MPI
     rc = mpi_io_sync(mpi_comm, filename.c_str());
@@ -366,7 +494,7 @@ int WriteState::sync_attribute(const std::string& attribute) {
         fragment_->fragment_name() + "/" + 
         attribute + "_var" + TILEDB_FILE_SUFFIX;
     if(write_method == TILEDB_IO_WRITE) {
-      rc = ::sync_path(fs_, filename);
+      rc = sync_file(filename);
     } else if(write_method == TILEDB_IO_MPI) {
 #ifdef HAVE_MPI
       rc = mpi_io_sync(mpi_comm, filename.c_str());
@@ -426,7 +554,7 @@ void WriteState::init_file_buffers() {
   }
 }
 
-std::string WriteState::construct_filename(int attribute_id, bool is_var) {
+std::string WriteState::construct_filename(int attribute_id, bool is_var) const {
   std::string filename;
   if (attribute_id == attribute_num_) {
     filename = fragment_->fragment_name() + "/" + TILEDB_COORDS + TILEDB_FILE_SUFFIX;
@@ -467,7 +595,7 @@ int WriteState::write_file_buffers() {
     if(!rc && array_schema_->var_size(i) && is_file(fs_, construct_filename(i, false))) {
       std::string filename = construct_filename(i, true);
       if (!is_file(fs_, filename)) {
-        rc = create_file(fs_, filename.c_str(), O_WRONLY | O_CREAT | O_SYNC, S_IRWXU) == TILEDB_UT_ERR;
+        rc = create_file(fs_, filename.c_str(), O_WRONLY | O_CREAT, S_IRWXU) == TILEDB_UT_ERR;
         if (rc) {
           std::string errmsg = "Cannot create file " + filename;
           PRINT_ERROR(errmsg);
@@ -481,6 +609,34 @@ int WriteState::write_file_buffers() {
   return rc;
 }
 
+int WriteState::sync_file(const std::string& filename) {
+  if(write_session_ != NULL && write_session_->is_open(filename)) {
+    if(write_session_->sync(filename) != TILEDB_FS_OK) {
+      tiledb_ut_errmsg = tiledb_fs_errmsg;
+      return TILEDB_UT_ERR;
+    }
+    return TILEDB_UT_OK;
+  }
+  return ::sync_path(fs_, filename);
+}
+
+void WriteState::set_write_session_size_hints(const size_t* buffer_sizes) {
+  // For easy reference
+  const std::vector<int>& attribute_ids = fragment_->array()->attribute_ids();
+  int attribute_id_num = attribute_ids.size(); 
+
+  int buffer_i = 0;
+  for(int i=0; i<attribute_id_num; ++i) {
+    write_session_->set_size_hint(
+        construct_filename(attribute_ids[i], false), 
+        buffer_sizes[buffer_i++]);
+    if(array_schema_->var_size(attribute_ids[i]))
+      write_session_->set_size_hint(
+          construct_filename(attribute_ids[i], true), 
+          buffer_sizes[buffer_i++]);
+  }
+}
+
 int WriteState::write_segment(int attribute_id, bool is_var, const void *segment, size_t length) {
   // Construct the attribute file name
   std::string filename = construct_filename(attribute_id, is_var);
@@ -517,7 +673,14 @@ int WriteState::write_segment(int attribute_id, bool is_var, const void *segment
   // Write_segment directly
   int rc = TILEDB_WS_OK;
   int write_method = array_->config()->write_method();
-  if(write_method == TILEDB_IO_WRITE) {
+  if(write_method == TILEDB_IO_WRITE && write_session_ != NULL) {
+    if(write_session_->write(filename, segment, length) != TILEDB_FS_OK) {
+      std::string errmsg = "Cannot write segment to file";
+      PRINT_ERROR(errmsg);
+      tiledb_ws_errmsg = TILEDB_WS_ERRMSG + errmsg + '\n' + tiledb_fs_errmsg;
+      return TILEDB_WS_ERR;
+    }
+  } else if(write_method == TILEDB_IO_WRITE) {
     rc = write_to_file(fs_, filename.c_str(), segment, length);
   } else if(write_method == TILEDB_IO_MPI) {
 #ifdef HAVE_MPI
@@ -551,6 +714,9 @@ int WriteState::write(const void** buffers, const size_t* buffer_sizes) {
     }
   }
 
+  if(write_session_ != NULL)
+    set_write_session_size_hints(buffer_sizes);
+
   // Dispatch the proper write command
   if(fragment_->mode() == TILEDB_ARRAY_WRITE ||
      fragment_->mode() == TILEDB_ARRAY_WRITE_SORTED_COL ||
@@ -679,6 +845,69 @@ int WriteState::compress_and_write_tile_var(int attribute_id) {
   return TILEDB_WS_OK;
 }
 
+void WriteState::append_coords_hash(uint64_t hash) {
+  ++coords_hash_num_;
+  if(coords_filter_ != NULL) {
+    coords_filter_->insert(hash);
+    return;
+  }
+
+  // Insert as the cells arrive once the hashes would outgrow the filter,
+  // sized a power of two bytes so that it can be folded to the cells written
+  coords_hashes_.push_back(hash);
+  if(coords_hashes_.size() * sizeof(uint64_t) >= coords_filter_max_size_) {
+    size_t size = sizeof(uint64_t);
+    while(size <= coords_filter_max_size_ / 2)
+      size *= 2;
+    coords_filter_ = 
+        new BloomFilter(
+            BloomFilter::capacity(coords_filter_fpr_, size), 
+            coords_filter_fpr_, 
+            size);
+    for(auto coords_hash : coords_hashes_)
+      coords_filter_->insert(coords_hash);
+    std::vector<uint64_t>().swap(coords_hashes_);
+  }
+}
+
+void WriteState::flush_coords_filter() {
+  if(coords_hash_num_ == 0)
+    return;
+
+  // Size the filter of a small fragment exactly, and shrink the filter of a
+  // large one to its number of coordinates
+  if(coords_filter_ == NULL) {
+    coords_filter_ = 
+        new BloomFilter(
+            coords_hashes_.size(), 
+            coords_filter_fpr_, 
+            coords_filter_max_size_);
+    for(auto hash : coords_hashes_)
+      coords_filter_->insert(hash);
+    std::vector<uint64_t>().swap(coords_hashes_);
+  } else {
+    coords_filter_->fold(coords_hash_num_, coords_filter_fpr_);
+  }
+  book_keeping_->set_coords_filter(coords_filter_);
+  coords_filter_ = NULL;
+  coords_hash_num_ = 0;
+}
+
+void WriteState::flush_zone_map(int attribute_id) {
+  // For easy reference
+  TileZoneMap& zone_map = zone_maps_[attribute_id];
+  int64_t& zone_map_value_num = zone_map_value_nums_[attribute_id];
+
+  if(zone_map_value_num > 0)
+    book_keeping_->append_zone_map(attribute_id, zone_map);
+
+  // Start the zone map of the next tile
+  zone_map.min_ = std::numeric_limits<double>::infinity();
+  zone_map.max_ = -std::numeric_limits<double>::infinity();
+  zone_map.empty_num_ = 0;
+  zone_map_value_num = 0;
+}
+
 template<class T>
 void WriteState::expand_mbr(const T* coords) {
   // For easy reference
@@ -828,6 +1057,109 @@ void WriteState::update_book_keeping(
     update_book_keeping<double>(buffer, buffer_size);
 }
 
+void WriteState::update_zone_maps(
+    int attribute_id,
+    const void* buffer,
+    size_t buffer_size) {
+  // Only fixed-sized numeric attributes of sparse fragments, in the sectioned
+  // book-keeping layout which holds them
+  if(fragment_->dense() || 
+     !book_keeping_->write_sections() ||
+     attribute_id == attribute_num_ ||
+     array_schema_->var_size(attribute_id))
+    return;
+
+  // For easy reference
+  int type = array_schema_->type(attribute_id);
+  int64_t value_num = buffer_size / array_schema_->type_size(attribute_id);
+
+  // Invoke the proper templated function
+  if(type == TILEDB_INT32)
+    update_zone_maps<int>(
+        attribute_id, static_cast<const int*>(buffer), 
+        value_num, TILEDB_EMPTY_INT32);
+  else if(type == TILEDB_INT64)
+    update_zone_maps<int64_t>(
+        attribute_id, static_cast<const int64_t*>(buffer), 
+        value_num, TILEDB_EMPTY_INT64);
+  else if(type == TILEDB_FLOAT32)
+    update_zone_maps<float>(
+        attribute_id, static_cast<const float*>(buffer), 
+        value_num, TILEDB_EMPTY_FLOAT32);
+  else if(type == TILEDB_FLOAT64)
+    update_zone_maps<double>(
+        attribute_id, static_cast<const double*>(buffer), 
+        value_num, TILEDB_EMPTY_FLOAT64);
+  else if(type == TILEDB_INT8)
+    update_zone_maps<int8_t>(
+        attribute_id, static_cast<const int8_t*>(buffer), 
+        value_num, TILEDB_EMPTY_INT8);
+  else if(type == TILEDB_UINT8)
+    update_zone_maps<uint8_t>(
+        attribute_id, static_cast<const uint8_t*>(buffer), 
+        value_num, TILEDB_EMPTY_UINT8);
+  else if(type == TILEDB_INT16)
+    update_zone_maps<int16_t>(
+        attribute_id, static_cast<const int16_t*>(buffer), 
+        value_num, TILEDB_EMPTY_INT16);
+  else if(type == TILEDB_UINT16)
+    update_zone_maps<uint16_t>(
+        attribute_id, static_cast<const uint16_t*>(buffer), 
+        value_num, TILEDB_EMPTY_UINT16);
+  else if(type == TILEDB_UINT32)
+    update_zone_maps<uint32_t>(
+        attribute_id, static_cast<const uint32_t*>(buffer), 
+        value_num, TILEDB_EMPTY_UINT32);
+  else if(type == TILEDB_UINT64)
+    update_zone_maps<uint64_t>(
+        attribute_id, static_cast<const uint64_t*>(buffer), 
+        value_num, TILEDB_EMPTY_UINT64);
+}
+
+template<class T>
+void WriteState::update_zone_maps(
+    int attribute_id,
+    const T* values,
+    int64_t value_num,
+    T empty) {
+  // For easy reference
+  int64_t tile_value_num = 
+      array_schema_->capacity() * array_schema_->cell_val_num(attribute_id);
+  TileZoneMap& zone_map = zone_maps_[attribute_id];
+  int64_t& zone_map_value_num = zone_map_value_nums_[attribute_id];
+
+  // Fold the values one tile at a time
+  int64_t i = 0;
+  while(i < value_num) {
+    int64_t end = std::min(value_num, i + tile_value_num - zone_map_value_num);
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+    int64_t empty_num = 0;
+    for(int64_t j=i; j<end; ++j) {
+      if(values[j] == empty) {
+        ++empty_num;
+      } else {
+        min = std::min(min, values[j]);
+        max = std::max(max, values[j]);
+      }
+    }
+
+    // Empty and NaN values are left out of the range, NaN never satisfies
+    // a filter
+    if(min <= max) {
+      zone_map.min_ = std::min(zone_map.min_, lower_bound_double(min));
+      zone_map.max_ = std::max(zone_map.max_, upper_bound_double(max));
+    }
+    zone_map.empty_num_ += empty_num;
+    zone_map_value_num += end - i;
+    i = end;
+
+    // Send the zone map of a complete tile to book-keeping
+    if(zone_map_value_num == tile_value_num)
+      flush_zone_map(attribute_id);
+  }
+}
+
 template<class T>
 void WriteState::update_book_keeping(
     const void* buffer,
@@ -861,6 +1193,11 @@ void WriteState::update_book_keeping(
     // Expand MBR
     expand_mbr(&buffer_T[i*dim_num]);
 
+    // Hash the coordinates for the filter
+    if(coords_filter_fpr_ != 0)
+      append_coords_hash(
+          BloomFilter::hash_coords(&buffer_T[i*dim_num], dim_num));
+
     // Advance a cell
     ++tile_cell_num;
 
@@ -882,6 +1219,8 @@ int WriteState::write_last_tile() {
   book_keeping_->append_mbr(mbr_);
   book_keeping_->append_bounding_coords(bounding_coords_);
   book_keeping_->set_last_tile_cell_num(tile_cell_num_[attribute_num]);
+  for(int i=0; i<attribute_num; ++i)
+    flush_zone_map(i);
 
   // Flush the last tile for each compressed attribute (it is still in main
   // memory
@@ -1352,6 +1691,8 @@ int WriteState::write_sparse_attr_cmp_none(
   // Update book-keeping
   if(attribute_id == attribute_num) 
     update_book_keeping(buffer, buffer_size);
+  else
+    update_zone_maps(attribute_id, buffer, buffer_size);
 
   // Write buffer to file 
   int rc = write_segment(attribute_id, false, buffer, buffer_size);
@@ -1377,6 +1718,8 @@ int WriteState::write_sparse_attr_cmp(
   // Update book-keeping
   if(attribute_id == attribute_num) 
     update_book_keeping(buffer, buffer_size);
+  else
+    update_zone_maps(attribute_id, buffer, buffer_size);
 
   // Initialize local tile buffer if needed
   if(tiles_[attribute_id] == NULL)
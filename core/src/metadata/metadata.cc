@@ -66,6 +66,7 @@ std::string tiledb_mt_errmsg = "";
 
 Metadata::Metadata() {
   array_ = NULL;
+  fragment_manifest_recorded_ = false;
 }
 
 Metadata::~Metadata() {
@@ -86,6 +87,10 @@ const ArraySchema* Metadata::array_schema() const {
   return array_->array_schema();
 }
 
+bool Metadata::fragment_manifest_recorded() const {
+  return fragment_manifest_recorded_;
+}
+
 bool Metadata::overflow(int attribute_id) const {
   return array_->overflow(attribute_id);
 }
@@ -147,6 +152,7 @@ int Metadata::consolidate(
 
 int Metadata::finalize() {
   int rc = array_->finalize();
+  fragment_manifest_recorded_ = array_->fragment_manifest_recorded();
 
   array_->free_array_schema(); //~Array() doesn't free schema because clone == NULL inside array_
 
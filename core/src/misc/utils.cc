@@ -38,6 +38,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
 #include <cstring>
 #include <cstdio>
 #include <dirent.h>
@@ -83,7 +86,7 @@
 /*        GLOBAL VARIABLES        */
 /* ****************************** */
 
-std::string tiledb_ut_errmsg = "";
+thread_local std::string tiledb_ut_errmsg = "";
 
 
 
@@ -227,7 +230,8 @@ int cmp_row_order(
 }
 
 bool is_supported_cloud_path(const std::string& pathURL) {
-  return is_hdfs_path(pathURL) || is_gcs_path(pathURL) || is_azure_path(pathURL) || is_azure_blob_storage_path(pathURL);
+  return is_hdfs_path(pathURL) || is_gcs_path(pathURL) || is_azure_path(pathURL) || is_azure_blob_storage_path(pathURL)
+      || is_sim_path(pathURL);
 }
 
 bool is_azure_path(const std::string& pathURL) {
@@ -264,6 +268,14 @@ bool is_hdfs_path(const std::string& pathURL) {
   }
 }
 
+bool is_sim_path(const std::string& pathURL) {
+  if (!pathURL.empty() && starts_with(pathURL, "sim:")) {
+    return true;
+  } else {
+    return false;
+  }
+}
+
 bool is_env_set(const std::string& name) {
   auto env_var = getenv(name.c_str());
   if(env_var && ((strcasecmp(env_var, "true") == 0) || (strcmp(env_var, "1") == 0))) {
@@ -273,6 +285,39 @@ bool is_env_set(const std::string& name) {
   }
 }
 
+uint64_t get_env_uint64(const std::string& name, uint64_t default_value) {
+  auto env_var = getenv(name.c_str());
+  if(env_var == NULL)
+    return default_value;
+
+  char* end;
+  errno = 0;
+  unsigned long long value = strtoull(env_var, &end, 10);
+  if(!isdigit(static_cast<unsigned char>(env_var[0])) || *end != '\0' || errno == ERANGE) {
+    PRINT_ERROR(TILEDB_UT_ERRMSG + "Ignoring invalid value \"" + env_var + "\" of " + name);
+    return default_value;
+  }
+
+  return value;
+}
+
+double get_env_double(const std::string& name, double default_value) {
+  auto env_var = getenv(name.c_str());
+  if(env_var == NULL)
+    return default_value;
+
+  char* end;
+  errno = 0;
+  double value = strtod(env_var, &end);
+  if(env_var[0] == '\0' || isspace(static_cast<unsigned char>(env_var[0])) ||
+     *end != '\0' || errno == ERANGE || !std::isfinite(value)) {
+    PRINT_ERROR(TILEDB_UT_ERRMSG + "Ignoring invalid value \"" + env_var + "\" of " + name);
+    return default_value;
+  }
+
+  return value;
+}
+
 int create_dir(StorageFS *fs, const std::string& dir) {
   if (fs->create_dir(dir)) {
     tiledb_ut_errmsg = tiledb_fs_errmsg;
@@ -300,7 +345,7 @@ int delete_file(StorageFS *fs, const std::string& filename) {
 int create_fragment_file(StorageFS *fs, const std::string& dir) {
   // Create the special fragment file
   std::string filename = std::string(dir) + "/" + TILEDB_FRAGMENT_FILENAME;
-  if (fs->create_file(filename, O_WRONLY | O_CREAT | O_SYNC,  S_IRWXU) == TILEDB_UT_ERR) {
+  if (fs->create_file(filename, O_WRONLY | O_CREAT,  S_IRWXU) == TILEDB_UT_ERR) {
     UTILS_PATH_ERROR("Failed to create fragment file", dir);
     return TILEDB_UT_ERR;
   }
@@ -647,6 +692,18 @@ bool is_metadata(StorageFS *fs, const std::string& dir) {
   return fs->is_file(dir + '/' + TILEDB_METADATA_SCHEMA_FILENAME);
 }
 
+template<class T>
+bool is_overlapping(
+    const T* range_A, 
+    const T* range_B, 
+    int dim_num) {
+  for(int i=0; i<dim_num; ++i) 
+    if(range_A[2*i] > range_B[2*i+1] || range_A[2*i+1] < range_B[2*i])
+      return false;
+
+  return true;
+}
+
 bool is_positive_integer(const char* s) {
   int i=0;
 
@@ -1614,6 +1671,14 @@ int sync_path(StorageFS *fs, const std::string& path) {
   return TILEDB_UT_OK;
 }
 
+int sync_paths(StorageFS *fs, const std::vector<std::string>& paths) {
+  if (fs->sync_paths(paths)) {
+    tiledb_ut_errmsg = tiledb_fs_errmsg;
+    return TILEDB_UT_ERR;
+  }
+  return TILEDB_UT_OK;
+}
+
 int close_file(StorageFS *fs, const std::string& filename) {
   if (fs->close_file(filename)) {
     tiledb_ut_errmsg = tiledb_fs_errmsg;
@@ -1634,7 +1699,7 @@ int write_to_file(
   return TILEDB_UT_OK;
 }
 
-int write_to_file_after_compression(StorageFS *fs, const std::string& filename, const void* buffer, size_t buffer_size, const int compression) {
+int write_to_file_after_compression(StorageFS *fs, const std::string& filename, const void* buffer, size_t buffer_size, const int compression, bool sync) {
     int rc;
   switch (compression) {
     case TILEDB_GZIP:
@@ -1705,7 +1770,9 @@ int write_to_file_after_compression(StorageFS *fs, const std::string& filename,
 
   delete gzip_buffer;
 
-  sync_path(fs, filename);
+  if (sync) {
+    sync_path(fs, filename);
+  }
   close_file(fs, filename);
 
   return TILEDB_UT_OK;
@@ -1900,6 +1967,23 @@ template bool is_contained<double>(
     const double* range_B, 
     int dim_num);
 
+template bool is_overlapping<int>(
+    const int* range_A, 
+    const int* range_B, 
+    int dim_num);
+template bool is_overlapping<int64_t>(
+    const int64_t* range_A, 
+    const int64_t* range_B, 
+    int dim_num);
+template bool is_overlapping<float>(
+    const float* range_A, 
+    const float* range_B, 
+    int dim_num);
+template bool is_overlapping<double>(
+    const double* range_A, 
+    const double* range_B, 
+    int dim_num);
+
 template bool is_unary_subarray<int>(const int* subarray, int dim_num);
 template bool is_unary_subarray<int64_t>(const int64_t* subarray, int dim_num);
 template bool is_unary_subarray<float>(const float* subarray, int dim_num);
@@ -0,0 +1,155 @@
+/**
+ * @file mmap_registry.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class MMapRegistry.
+ */
+
+#include "mmap_registry.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(void* addr, size_t size, dev_t dev, ino_t ino, time_t mtime)
+    : addr_(addr), size_(size), dev_(dev), ino_(ino), mtime_(mtime) {
+}
+
+MappedFile::~MappedFile() {
+  if (addr_ != NULL) {
+    munmap(addr_, size_);
+  }
+}
+
+const char* MappedFile::data() const {
+  return static_cast<const char*>(addr_);
+}
+
+size_t MappedFile::size() const {
+  return size_;
+}
+
+int MappedFile::advise(off_t offset, size_t length, int advice) {
+  if (addr_ == NULL || (size_t)offset >= size_) {
+    return TILEDB_FS_OK;
+  }
+  if (length == 0 || offset + length > size_) {
+    length = size_ - offset;
+  }
+
+  int madvice;
+  switch (advice) {
+    case TILEDB_FS_ACCESS_SEQUENTIAL:
+      madvice = MADV_SEQUENTIAL;
+      break;
+    case TILEDB_FS_ACCESS_RANDOM:
+      madvice = MADV_RANDOM;
+      break;
+    case TILEDB_FS_ACCESS_WILLNEED:
+      madvice = MADV_WILLNEED;
+      break;
+    case TILEDB_FS_ACCESS_DONTNEED:
+      madvice = MADV_DONTNEED;
+      break;
+    default:
+      madvice = MADV_NORMAL;
+  }
+
+  // madvise needs a page aligned start
+  size_t page_size = sysconf(_SC_PAGE_SIZE);
+  size_t start = (offset / page_size) * page_size;
+  length += offset - start;
+  if (madvise(static_cast<char*>(addr_) + start, length, madvice)) {
+    return TILEDB_FS_ERR;
+  }
+  return TILEDB_FS_OK;
+}
+
+bool MappedFile::is_same_file(size_t size, dev_t dev, ino_t ino, time_t mtime) const {
+  return size_ == size && dev_ == dev && ino_ == ino && mtime_ == mtime;
+}
+
+std::shared_ptr<MappedFile> MMapRegistry::acquire(const std::string& filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st)) {
+    close(fd);
+    return NULL;
+  }
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto mapped_file = files_[filename].lock();
+  if (mapped_file == NULL || !mapped_file->is_same_file(st.st_size, st.st_dev, st.st_ino, st.st_mtime)) {
+    // mmap fails for empty files, they have nothing to map
+    void* addr = NULL;
+    if (st.st_size > 0) {
+      addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (addr == MAP_FAILED) {
+        close(fd);
+        return NULL;
+      }
+    }
+    mapped_file = std::make_shared<MappedFile>(addr, st.st_size, st.st_dev, st.st_ino, st.st_mtime);
+    files_[filename] = mapped_file;
+    maps_++;
+
+    if (files_.size() >= prune_size_) {
+      for (auto it = files_.begin(); it != files_.end(); ) {
+        if (it->second.expired()) {
+          it = files_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      prune_size_ = std::max(prune_size_, 2*files_.size());
+    }
+  }
+  close(fd);
+  return mapped_file;
+}
+
+size_t MMapRegistry::mapped_files() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  size_t count = 0;
+  for (auto& file : files_) {
+    if (!file.second.expired()) {
+      count++;
+    }
+  }
+  return count;
+}
+
+size_t MMapRegistry::maps() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return maps_;
+}
@@ -199,6 +199,12 @@ AzureBlob::AzureBlob(const std::string& home) {
   // Set default buffer sizes, overridden with env vars TILEDB_DOWNLOAD_BUFFER_SIZE and TILEDB_UPLOAD_BUFFER_SIZE
   download_buffer_size_ = constants::default_block_size; // 8M
   upload_buffer_size_ = constants::max_block_size; // 100M
+  upload_queue_depth_ = 1; // Double buffered uploads, overridden with env var TILEDB_UPLOAD_QUEUE_DEPTH
+
+  // Set default coalescing of tile reads, overridden with env vars TILEDB_COALESCE_MAX_GAP and TILEDB_COALESCE_MAX_SIZE
+  coalesce_max_gap_ = 1024*1024; // 1M
+  coalesce_max_size_ = constants::default_block_size; // 8M
+  override_tuning_from_env();
 }
 
 std::string AzureBlob::current_dir() {
@@ -272,6 +278,11 @@ int AzureBlob::delete_dir(const std::string& dir) {
     return TILEDB_FS_ERR;
   }
 
+  {
+    const std::lock_guard<std::mutex> lock(read_size_map_mtx_);
+    read_size_map_.clear();
+  }
+
   int rc = TILEDB_FS_OK;
   std::string continuation_token = "";
   auto response = bc->list_blobs_segmented(container_name, "/",  continuation_token, slashify(get_path(dir)), INT_MAX);
@@ -337,6 +348,7 @@ int AzureBlob::delete_file(const std::string& filename) {
     AZ_BLOB_ERROR("Cannot delete non-existent or non-file path", filename);
     return TILEDB_FS_ERR;
   }
+  forget_file_size(filename);
   bc->delete_blob(container_name, get_path(filename));
   return TILEDB_FS_OK;
 }
@@ -354,14 +366,31 @@ ssize_t AzureBlob::file_size(const std::string& filename) {
 
 #define GRAIN_SIZE (4*1024*1024)
 
-int AzureBlob::read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length) {
-  if (!is_file(filename)) {
-    AZ_BLOB_ERROR("File does not exist", filename);
-    return TILEDB_FS_ERR;
+ssize_t AzureBlob::read_file_size(const std::string& filename) {
+  {
+    const std::lock_guard<std::mutex> lock(read_size_map_mtx_);
+    auto search = read_size_map_.find(filename);
+    if (search != read_size_map_.end()) {
+      return search->second;
+    }
   }
+  auto filesize = file_size(filename);
+  if (filesize != TILEDB_FS_ERR) {
+    const std::lock_guard<std::mutex> lock(read_size_map_mtx_);
+    read_size_map_[filename] = filesize;
+  }
+  return filesize;
+}
+
+void AzureBlob::forget_file_size(const std::string& filename) {
+  const std::lock_guard<std::mutex> lock(read_size_map_mtx_);
+  read_size_map_.erase(filename);
+}
+
+int AzureBlob::read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length) {
   std::string path = get_path(filename);
   auto bclient = reinterpret_cast<blob_client *>(bC.get());
-  auto filesize = file_size(filename);
+  auto filesize = read_file_size(filename);
   if (filesize == TILEDB_FS_ERR) {
     AZ_BLOB_ERROR("File does not exist", filename);
     return TILEDB_FS_ERR;
@@ -387,6 +416,50 @@ int AzureBlob::read_from_file(const std::string& filename, off_t offset, void *b
   }
 }
 
+int AzureBlob::read_from_file_v(const std::vector<StorageFSRead>& reads) {
+  auto bclient = reinterpret_cast<blob_client *>(bC.get());
+
+  // Validate the ranges against the file sizes, fetching each size only once
+  for (auto& read : reads) {
+    auto filesize = read_file_size(read.filename);
+    if (filesize == TILEDB_FS_ERR) {
+      AZ_BLOB_ERROR("File does not exist", read.filename);
+      return TILEDB_FS_ERR;
+    } else if (filesize < (ssize_t)read.length + read.offset) {
+      AZ_BLOB_ERROR("Cannot read past the file size", read.filename);
+      return TILEDB_FS_ERR;
+    }
+  }
+
+  // Issue ranged downloads concurrently, at most concurrency() of them at a time
+  size_t window = std::max(1u, bclient->concurrency());
+  for (auto start = 0ul; start < reads.size(); start += window) {
+    auto end = std::min(start+window, reads.size());
+    std::vector<std::unique_ptr<omemstream>> streams;
+    std::vector<std::pair<size_t, std::future<storage_outcome<void>>>> results;
+    for (auto i = start; i < end; i++) {
+      if (reads[i].length == 0) continue; // Nothing to read
+      streams.emplace_back(new omemstream(reads[i].buffer, reads[i].length));
+      results.emplace_back(i, bclient->download_blob_to_stream(container_name, get_path(reads[i].filename),
+                                                               reads[i].offset, reads[i].length, *streams.back()));
+    }
+    // Wait on all outstanding downloads before returning as they write into the streams
+    int rc = TILEDB_FS_OK;
+    for (auto& result : results) {
+      auto read_result = result.second.get();
+      if (!read_result.success() && rc == TILEDB_FS_OK) {
+        AZ_BLOB_ERROR(read_result.error().message, reads[result.first].filename);
+        rc = TILEDB_FS_ERR;
+      }
+    }
+    if (rc) {
+      return rc;
+    }
+  }
+
+  return TILEDB_FS_OK;
+}
+
 // This method is based on upload_block_blob_from_buffer from the SDK except for the put_block_list stage which happens in commit_path() now
 std::future<storage_outcome<void>> AzureBlob::upload_block_blob(const std::string &blob, uint64_t block_size, int num_blocks, std::vector<std::string> block_ids,
                                                                 const char* buffer, uint64_t bufferlen, uint parallelism) {
@@ -444,6 +517,7 @@ std::future<storage_outcome<void>> AzureBlob::upload_block_blob(const std::strin
 }
 
 int AzureBlob::write_to_file(const std::string& filename, const void *buffer, size_t buffer_size) {
+  forget_file_size(filename);
   std::string path = get_path(filename);
   auto bclient = reinterpret_cast<blob_client *>(bC.get());
   if (buffer_size == 0) {
@@ -486,6 +560,8 @@ int AzureBlob::write_to_file(const std::string& filename, const void *buffer, si
 }
 
 int AzureBlob::move_path(const std::string& old_path, const std::string& new_path) {
+  forget_file_size(old_path);
+  forget_file_size(new_path);
   throw std::system_error(EPROTONOSUPPORT, std::generic_category(), "TBD: No support for moving path");
 }
 
@@ -514,6 +590,7 @@ int AzureBlob::sync_path(const std::string& path) {
 }
 
 int AzureBlob::close_file(const std::string& filename) {
+  forget_file_size(filename);
   return commit_file(filename);
 }
 
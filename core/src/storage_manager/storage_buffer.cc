@@ -33,6 +33,7 @@
 #include "error.h"
 #include "storage_buffer.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <iostream>
 #include <string>
@@ -42,57 +43,140 @@
 #define BUFFER_ERROR_WITH_ERRNO(MSG) TILEDB_ERROR_WITH_ERRNO(TILEDB_FS_ERRMSG, MSG, tiledb_fs_errmsg)
 #define BUFFER_ERROR(MSG) TILEDB_ERROR(TILEDB_FS_ERRMSG, MSG, tiledb_fs_errmsg)
 
+StorageBuffer::~StorageBuffer() {
+  wait_for_uploads(0);
+  for (auto& spare_buffer : spare_buffers_) {
+    free(spare_buffer.first);
+  }
+}
+
 int StorageBuffer::read_buffer(off_t offset, void *bytes, size_t size) {
-  // Nothing to do
-  if (bytes == NULL || size == 0) {
-    return TILEDB_BF_OK;
+  return read_buffers_v({this}, {{filename_, offset, bytes, size}});
+}
+
+int StorageBuffer::read_buffers_v(const std::vector<StorageBuffer *>& buffers, const std::vector<StorageFSRead>& reads) {
+  assert(buffers.size() == reads.size());
+
+  // Gather the missing blocks spanned by all the reads
+  std::vector<std::vector<StorageFSRead>> block_reads(reads.size());
+  std::vector<StorageFSRead> all_block_reads;
+  int rc = TILEDB_BF_OK;
+  for (auto i = 0ul; i < reads.size() && rc == TILEDB_BF_OK; i++) {
+    // Nothing to do
+    if (reads[i].buffer == NULL || reads[i].length == 0) {
+      continue;
+    }
+    rc = buffers[i]->add_missing_blocks(reads[i].offset, reads[i].length, block_reads[i]);
+    all_block_reads.insert(all_block_reads.end(), block_reads[i].begin(), block_reads[i].end());
   }
 
-  size_t filesize = fs_->file_size(filename_);
-  size_t chunk_size = fs_->get_download_buffer_size();
+  // Download them together
+  if (rc == TILEDB_BF_OK && all_block_reads.size() && buffers[0]->fs_->read_from_file_v(all_block_reads)) {
+    BUFFER_PATH_ERROR("Cannot read to buffer", all_block_reads[0].filename);
+    rc = TILEDB_BF_ERR;
+  }
+  if (rc != TILEDB_BF_OK) {
+    for (auto i = 0ul; i < reads.size(); i++) {
+      buffers[i]->drop_blocks(block_reads[i]);
+    }
+    return TILEDB_BF_ERR;
+  }
+
+  // Stitch the reads together from the blocks, evicting only once all are
+  // done as buffers may be shared by reads
+  for (auto i = 0ul; i < reads.size(); i++) {
+    if (reads[i].buffer != NULL && reads[i].length > 0) {
+      buffers[i]->copy_blocks(reads[i].offset, reads[i].buffer, reads[i].length);
+    }
+  }
+  for (auto i = 0ul; i < reads.size(); i++) {
+    buffers[i]->evict_blocks();
+  }
+
+  return TILEDB_BF_OK;
+}
+
+int StorageBuffer::add_missing_blocks(off_t offset, size_t size, std::vector<StorageFSRead>& reads) {
+  if (file_size_ < 0) {
+    file_size_ = fs_->file_size(filename_);
+    if (file_size_ < 0) {
+      BUFFER_PATH_ERROR("Cannot get file size for buffer", filename_);
+      return TILEDB_BF_ERR;
+    }
+  }
+  size_t filesize = file_size_;
   if (offset + size > filesize) {
     BUFFER_PATH_ERROR("Cannot read past the filesize from buffer", filename_);
     return TILEDB_BF_ERR;  
   }
 
-  if (buffer_ == NULL) {
-    num_blocks_ = filesize/chunk_size+1;
-    blocks_read_.resize(num_blocks_);
-    std::fill(blocks_read_.begin(), blocks_read_.end(), false);
+  size_t chunk_size = fs_->get_download_buffer_size();
+  if (chunk_size == 0) {
+    BUFFER_ERROR("Cannot read to buffer; download buffer size is not set");
+    return TILEDB_BF_ERR;
   }
+  size_t first_block = offset/chunk_size;
+  size_t last_block = (offset+size-1)/chunk_size;
 
-  if (buffer_ == NULL || !(offset>=buffer_offset_ && size<=buffer_size_)) {
-    buffer_offset_ = offset - offset%chunk_size;
-    buffer_size_ = ((buffer_offset_%chunk_size+size)/chunk_size+1)*chunk_size;
-    // Factor in last chunk
-    if (buffer_offset_+buffer_size_ > filesize) {
-      buffer_size_ = filesize-buffer_offset_;
-    }
-    if (buffer_size_ > allocated_buffer_size_) {
-      buffer_ = realloc(buffer_, buffer_size_);
-      if (buffer_ == NULL) {
-	BUFFER_ERROR_WITH_ERRNO("Cannot read to buffer; Mem allocation error");
-	return TILEDB_BF_ERR;
-      }
-      allocated_buffer_size_ = buffer_size_;
-    }
-    
-    if (fs_->read_from_file(filename_, buffer_offset_, (char *)buffer_, buffer_size_)) {
-      free_buffer();
-      BUFFER_PATH_ERROR("Cannot read to buffer", filename_);
-      return TILEDB_BF_ERR;
+  for (auto block = first_block; block <= last_block; block++) {
+    if (blocks_.find(block) == blocks_.end()) {
+      size_t block_offset = block*chunk_size;
+      size_t block_size = std::min(chunk_size, filesize-block_offset);
+      blocks_lru_.emplace_front(block, std::vector<char>(block_size));
+      blocks_[block] = blocks_lru_.begin();
+      reads.push_back({filename_, (off_t)block_offset, blocks_lru_.front().second.data(), block_size});
     }
   }
-  
-  assert(offset >= buffer_offset_);
-  assert(size <= buffer_size_);
-  
-  void *pmem = memcpy(bytes, (char *)buffer_+offset-buffer_offset_, size);
-  assert(pmem == bytes);
 
   return TILEDB_BF_OK;
 }
 
+void StorageBuffer::drop_blocks(const std::vector<StorageFSRead>& reads) {
+  size_t chunk_size = fs_->get_download_buffer_size();
+  for (auto& read : reads) {
+    auto search = blocks_.find(read.offset/chunk_size);
+    if (search != blocks_.end()) {
+      blocks_lru_.erase(search->second);
+      blocks_.erase(search);
+    }
+  }
+}
+
+void StorageBuffer::copy_blocks(off_t offset, void *bytes, size_t size) {
+  size_t chunk_size = fs_->get_download_buffer_size();
+  size_t first_block = offset/chunk_size;
+  size_t last_block = (offset+size-1)/chunk_size;
+
+  char *pbytes = reinterpret_cast<char *>(bytes);
+  for (auto block = first_block; block <= last_block; block++) {
+    auto it = blocks_[block];
+    blocks_lru_.splice(blocks_lru_.begin(), blocks_lru_, it);
+    size_t block_offset = block*chunk_size;
+    size_t start = std::max((size_t)offset, block_offset) - block_offset;
+    size_t end = std::min(offset+size, block_offset+it->second.size()) - block_offset;
+    assert(end <= it->second.size());
+    memcpy(pbytes, it->second.data()+start, end-start);
+    pbytes += end-start;
+  }
+  assert(pbytes == reinterpret_cast<char *>(bytes)+size);
+}
+
+void StorageBuffer::evict_blocks() {
+  size_t chunk_size = fs_->get_download_buffer_size();
+  if (chunk_size == 0) {
+    return;
+  }
+  size_t max_blocks = std::max(1ul, fs_->get_download_cache_size()/chunk_size);
+  while (blocks_.size() > max_blocks) {
+    blocks_.erase(blocks_lru_.back().first);
+    blocks_lru_.pop_back();
+  }
+}
+
+size_t StorageBuffer::cached_blocks() const {
+  return blocks_.size();
+}
+
 #define CHUNK 1024
 int StorageBuffer::append_buffer(const void *bytes, size_t size) {
   if (read_only_) {
@@ -135,6 +219,56 @@ int StorageBuffer::append_buffer(const void *bytes, size_t size) {
 }
 
 int StorageBuffer::write_buffer() {
+  size_t queue_depth = fs_->get_upload_queue_depth();
+  if (buffer_size_ > 0 && queue_depth > 0) {
+    // Make room in the queue, an earlier upload failure fails this write too
+    if (wait_for_uploads(queue_depth-1)) {
+      wait_for_uploads(0);
+      free_buffer();
+      return TILEDB_BF_ERR;
+    }
+
+    // Upload in the background after the previous upload to keep the file in order
+    StorageFS *fs = fs_;
+    std::string filename = filename_;
+    void *buffer = buffer_;
+    size_t buffer_size = buffer_size_;
+    std::shared_future<int> previous;
+    if (!uploads_.empty()) {
+      previous = uploads_.back().result;
+    }
+    StorageBufferUpload upload;
+    upload.buffer = buffer_;
+    upload.allocated_size = allocated_buffer_size_;
+    upload.errmsg = std::make_shared<std::string>();
+    std::shared_ptr<std::string> errmsg = upload.errmsg;
+    upload.result = std::async(std::launch::async, [fs, filename, buffer, buffer_size, previous, errmsg]() {
+      if (previous.valid() && previous.get()) {
+        return TILEDB_BF_ERR;
+      }
+      if (fs->write_to_file(filename, buffer, buffer_size)) {
+        BUFFER_PATH_ERROR("Cannot write bytes", filename);
+        // Error messages are per thread, hand it over to the writer
+        *errmsg = tiledb_fs_errmsg;
+        return TILEDB_BF_ERR;
+      }
+      return TILEDB_BF_OK;
+    }).share();
+    uploads_.push_back(upload);
+
+    // Continue appending to a spare buffer
+    if (spare_buffers_.empty()) {
+      buffer_ = NULL;
+      allocated_buffer_size_ = 0;
+    } else {
+      buffer_ = spare_buffers_.back().first;
+      allocated_buffer_size_ = spare_buffers_.back().second;
+      spare_buffers_.pop_back();
+    }
+    buffer_size_ = 0;
+    return TILEDB_BF_OK;
+  }
+
   if (buffer_size_ > 0) {
     if (fs_->write_to_file(filename_, buffer_, buffer_size_)) {
       free_buffer();
@@ -146,10 +280,25 @@ int StorageBuffer::write_buffer() {
   return TILEDB_BF_OK;
 }
 
+int StorageBuffer::wait_for_uploads(size_t max_pending) {
+  while (uploads_.size() > max_pending) {
+    if (uploads_.front().result.get()) {
+      upload_rc_ = TILEDB_BF_ERR;
+      if (!uploads_.front().errmsg->empty()) {
+        tiledb_fs_errmsg = *uploads_.front().errmsg;
+      }
+    }
+    spare_buffers_.push_back(std::make_pair(uploads_.front().buffer, uploads_.front().allocated_size));
+    uploads_.pop_front();
+  }
+  return upload_rc_;
+}
+
 int StorageBuffer::finalize() {
   int rc = TILEDB_BF_OK;
   if (!read_only_) {
     rc =  write_buffer();
+    rc = wait_for_uploads(0) || rc;
   }
   rc = fs_->close_file(filename_) || rc;
   if (rc) {
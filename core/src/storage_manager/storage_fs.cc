@@ -32,6 +32,8 @@
  */
 
 #include "storage_fs.h"
+#include "utils.h"
+
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
@@ -40,12 +42,21 @@
 /*        GLOBAL VARIABLES        */
 /* ****************************** */
 
-std::string tiledb_fs_errmsg = "";
+thread_local std::string tiledb_fs_errmsg = "";
 
 StorageFS::~StorageFS() {
   // Default
 }
 
+int StorageFS::read_from_file_v(const std::vector<StorageFSRead>& reads) {
+  for (auto& read : reads) {
+    if (read_from_file(read.filename, read.offset, read.buffer, read.length)) {
+      return TILEDB_FS_ERR;
+    }
+  }
+  return TILEDB_FS_OK;
+}
+
 int StorageFS::close_file(const std::string& filename) {
   return TILEDB_FS_OK;
 }
@@ -54,3 +65,39 @@ bool StorageFS::locking_support() {
   return false;
 }
 
+int StorageFS::sync_paths(const std::vector<std::string>& paths) {
+  for (auto& path : paths) {
+    if (sync_path(path)) {
+      return TILEDB_FS_ERR;
+    }
+  }
+  return TILEDB_FS_OK;
+}
+
+int StorageFS::advise_file(const std::string& filename, off_t offset, size_t length, int advice) {
+  return TILEDB_FS_OK;
+}
+
+
+size_t StorageFS::get_download_cache_size() {
+  return download_cache_size_;
+}
+
+size_t StorageFS::get_upload_queue_depth() {
+  return upload_queue_depth_;
+}
+
+size_t StorageFS::get_coalesce_max_gap() {
+  return coalesce_max_gap_;
+}
+
+size_t StorageFS::get_coalesce_max_size() {
+  return coalesce_max_size_;
+}
+
+void StorageFS::override_tuning_from_env() {
+  download_cache_size_ = get_env_uint64("TILEDB_DOWNLOAD_CACHE_SIZE", download_cache_size_);
+  upload_queue_depth_ = get_env_uint64("TILEDB_UPLOAD_QUEUE_DEPTH", upload_queue_depth_);
+  coalesce_max_gap_ = get_env_uint64("TILEDB_COALESCE_MAX_GAP", coalesce_max_gap_);
+  coalesce_max_size_ = get_env_uint64("TILEDB_COALESCE_MAX_SIZE", coalesce_max_size_);
+}
@@ -38,14 +38,17 @@
 #include "uri.h"
 #include "utils.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <cerrno>
 #include <clocale>
 #include <cstdlib>
 #include <cstring>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <stdlib.h>
+#include <thread>
 #include <unistd.h>
 
 #ifdef __APPLE__
@@ -152,6 +155,14 @@ HDFS::HDFS(const std::string& home) {
 
   // Maximize open file handle limits
   //maximize_rlimits();
+
+  // Double buffer uploads when TILEDB_UPLOAD_BUFFER_SIZE is set, overridden with env var TILEDB_UPLOAD_QUEUE_DEPTH
+  upload_queue_depth_ = 1;
+
+  // Set default coalescing of tile reads, overridden with env vars TILEDB_COALESCE_MAX_GAP and TILEDB_COALESCE_MAX_SIZE
+  coalesce_max_gap_ = 1024*1024; // 1M
+  coalesce_max_size_ = 16*1024*1024; // 16M
+  override_tuning_from_env();
 }
 
 HDFS::~HDFS() {
@@ -303,6 +314,7 @@ int HDFS::create_dir(const std::string& dir) {
 }
 
 int HDFS::delete_dir(const std::string& dir) {
+  forget_file_size(dir);
   if (is_dir(dir)) {
     if (hdfsDelete(hdfs_handle_, dir.c_str(), 1) < 0) {
       return print_errmsg(std::string("Cannot delete directory ") + dir);
@@ -368,6 +380,7 @@ int HDFS::delete_file(const std::string& filename) {
     return print_errmsg(std::string("Cannot delete file ") + filename + " as it is open in this context");
   }
   
+  forget_file_size(filename);
   if (is_file(filename)) {
     if (hdfsDelete(hdfs_handle_, filename.c_str(), 0) < 0) {
       return print_errmsg(std::string("Cannot delete file ") + filename);
@@ -459,6 +472,34 @@ static int read_count(const std::string& filename, std::unordered_map<std::strin
   return count;
 }
 
+ssize_t HDFS::read_file_size(const std::string& filename) {
+  {
+    std::lock_guard<std::mutex> lock(read_map_mtx_);
+    auto search = read_size_map_.find(filename);
+    if (search != read_size_map_.end()) {
+      return search->second;
+    }
+  }
+  ssize_t size = file_size(filename);
+  if (size != TILEDB_FS_ERR) {
+    std::lock_guard<std::mutex> lock(read_map_mtx_);
+    read_size_map_[filename] = size;
+  }
+  return size;
+}
+
+void HDFS::forget_file_size(const std::string& path) {
+  std::string dir = slashify(path);
+  std::lock_guard<std::mutex> lock(read_map_mtx_);
+  for (auto it = read_size_map_.begin(); it != read_size_map_.end();) {
+    if (it->first == path || it->first.compare(0, dir.size(), dir) == 0) {
+      it = read_size_map_.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
 int HDFS::read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length) {
   // Not supporting simultaneous read/writes.
   if (get_hdfsFile(filename, write_map_)) {
@@ -466,7 +507,7 @@ int HDFS::read_from_file(const std::string& filename, off_t offset, void *buffer
     assert(false && "No support for simultaneous reads/writes");
   }
 
-  ssize_t size = file_size(filename);
+  ssize_t size = read_file_size(filename);
   if (size == TILEDB_FS_ERR) {
     return print_errmsg(std::string("File=") + filename + " does not seem to exist");
   }
@@ -499,6 +540,105 @@ int HDFS::read_from_file(const std::string& filename, off_t offset, void *buffer
   return rc;
 }
 
+static int pread_from_file_kernel(hdfsFS hdfs_handle, hdfsFile file, void* buffer, size_t length, off_t offset) {
+  size_t max_bytes = max_tsize();
+  if (max_bytes == 0) {
+    return TILEDB_FS_ERR;
+  }
+
+  // Positional reads do not move the file pointer and can share the handle
+  size_t nbytes = 0;
+  char *pbuf = (char *)buffer;
+  while (nbytes < length) {
+    tSize bytes_read = hdfsPread(hdfs_handle, file, (tOffset)(offset+nbytes), (void *)pbuf, (length - nbytes) > max_bytes ? max_bytes : length - nbytes);
+    if (bytes_read < 0) {
+      return print_errmsg(std::string("Error reading file. ") + std::strerror(errno));
+    } else if (bytes_read == 0) {
+      return print_errmsg(std::string("Error reading file. EOF reached"));
+    }
+    nbytes += bytes_read;
+    pbuf += bytes_read;
+  }
+
+  return TILEDB_FS_OK;
+}
+
+int HDFS::read_from_file_v(const std::vector<StorageFSRead>& reads) {
+  // Open each file once for the batch
+  std::unordered_map<std::string, std::pair<hdfsFile, ssize_t>> files;
+  int rc = TILEDB_FS_OK;
+  for (auto& read : reads) {
+    if (files.find(read.filename) != files.end()) {
+      continue;
+    }
+    // Not supporting simultaneous read/writes.
+    if (get_hdfsFile(read.filename, write_map_)) {
+      print_errmsg(std::string("File=") + read.filename + " is open simultaneously for reads/writes");
+      assert(false && "No support for simultaneous reads/writes");
+    }
+    ssize_t size = read_file_size(read.filename);
+    if (size == TILEDB_FS_ERR) {
+      rc = print_errmsg(std::string("File=") + read.filename + " does not seem to exist");
+      break;
+    }
+    read_map_mtx_.lock();
+    hdfsFile file = get_hdfsFile(read.filename, read_map_);
+    if (!file) {
+      file = hdfs_open_file_for_read(hdfs_handle_, read.filename, size>MAX_SIZE?MAX_SIZE:((size/getpagesize())+1)*getpagesize());
+      if (file) {
+        read_map_.emplace(read.filename, file);
+      }
+    }
+    if (file) {
+      int count = read_count(read.filename, read_count_, true);
+      assert(count > 0 && "Read File Count cannot be less than 1");
+    }
+    read_map_mtx_.unlock();
+    if (!file) {
+      rc = print_errmsg(std::string("Cannot open file ") + read.filename + " for read");
+      break;
+    }
+    files.emplace(read.filename, std::make_pair(file, size));
+  }
+
+  // Reads past the end of their file would leave the rest of their buffers unset
+  for (auto i = 0ul; rc == TILEDB_FS_OK && i < reads.size(); i++) {
+    ssize_t size = files[reads[i].filename].second;
+    if (reads[i].offset < 0 || reads[i].offset > size || reads[i].length > (size_t)(size-reads[i].offset)) {
+      rc = print_errmsg(std::string("Cannot read past the end of file ") + reads[i].filename);
+    }
+  }
+
+  // Issue the reads concurrently, hardware_concurrency() of them at a time
+  size_t window = std::max(1u, std::thread::hardware_concurrency());
+  for (auto start = 0ul; rc == TILEDB_FS_OK && start < reads.size(); start += window) {
+    std::vector<std::future<int>> results;
+    for (auto i = start; i < std::min(start+window, reads.size()); i++) {
+      results.emplace_back(std::async(std::launch::async, pread_from_file_kernel, hdfs_handle_,
+                                      files[reads[i].filename].first, reads[i].buffer, reads[i].length,
+                                      reads[i].offset));
+    }
+    for (auto& result : results) {
+      if (result.get() != TILEDB_FS_OK) {
+        rc = TILEDB_FS_ERR;
+      }
+    }
+    // The reads set their error messages in their own threads
+    if (rc != TILEDB_FS_OK) {
+      print_errmsg(std::string("Cannot read ranges from ") + reads[start].filename);
+    }
+  }
+
+  read_map_mtx_.lock();
+  for (auto& file : files) {
+    int count = read_count(file.first, read_count_, false);
+    assert(count >= 0 && "Read File Count cannot be negative");
+  }
+  read_map_mtx_.unlock();
+
+  return rc;
+}
+
 static int write_to_file_kernel(hdfsFS hdfs_handle, hdfsFile file, const void* buffer, size_t buffer_size, size_t max_bytes) {
   size_t nbytes = 0;
   char *pbuf = (char *)buffer; 
@@ -519,28 +659,32 @@ static int write_to_file_kernel(hdfsFS hdfs_handle, hdfsFile file, const void* b
 }
 
 int HDFS::write_to_file(const std::string& filename, const void *buffer, size_t buffer_size) {
+  forget_file_size(filename);
   size_t max_bytes = max_tsize();
   if (max_bytes == 0) {
     return TILEDB_FS_ERR;
   }
 
+  // Files may be written concurrently by background uploads
+  write_map_mtx_.lock();
   hdfsFile file = get_hdfsFile(filename, write_map_);
   if (!file) {
-    write_map_mtx_.lock();
     file = hdfsOpenFile(hdfs_handle_, filename.c_str(), O_WRONLY, max_bytes, 0, 0);
     if (file) {
       write_map_.emplace(filename, file);
     }
-    write_map_mtx_.unlock();
-    if (!file) {
-      return  print_errmsg(std::string("Cannot open file " + filename + " for write"));
-    }
+  }
+  write_map_mtx_.unlock();
+  if (!file) {
+    return  print_errmsg(std::string("Cannot open file " + filename + " for write"));
   }
 
   return write_to_file_kernel(hdfs_handle_, file, buffer, buffer_size, max_bytes);
 }
 
 int HDFS::move_path(const std::string& old_path, const std::string& new_path) {
+  forget_file_size(old_path);
+  forget_file_size(new_path);
   if (!hdfsExists(hdfs_handle_, new_path.c_str())) {
     return print_errmsg(std::string("Cannot move path ") + old_path + " to " + new_path + " as it exists");
   }
@@ -581,6 +725,9 @@ static int close_kernel(hdfsFS hdfs_handle, hdfsFile hdfs_file_handle, const std
 int HDFS::close_file(const std::string& filename) {
   int rc_close_read = TILEDB_FS_OK, rc_close_write=TILEDB_FS_OK;
   rc_close_read = close_read_hdfsFile(hdfs_handle_, filename, read_map_, read_count_, read_map_mtx_);
+  read_map_mtx_.lock();
+  read_size_map_.erase(filename);
+  read_map_mtx_.unlock();
   rc_close_write = close_write_hdfsFile(hdfs_handle_, filename, write_map_, write_map_mtx_);
 
   if (rc_close_read) {
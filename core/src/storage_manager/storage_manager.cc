@@ -37,6 +37,7 @@
 #include "utils.h"
 #include "storage_fs.h"
 
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <dirent.h>
@@ -44,6 +45,7 @@
 #include <iostream>
 #include <string>
 #include <sys/stat.h>
+#include <thread>
 #include <unistd.h>
 
 /* ****************************** */
@@ -86,9 +88,15 @@ std::string tiledb_sm_errmsg = "";
 /* ****************************** */
 
 StorageManager::StorageManager() {
+  tile_cache_ = NULL;
+  mmap_registry_ = NULL;
 }
 
 StorageManager::~StorageManager() {
+  if (tile_cache_ != NULL)
+     delete tile_cache_;
+  if (mmap_registry_ != NULL)
+     delete mmap_registry_;
   if (config_ != NULL)
      delete config_;
 }
@@ -117,6 +125,14 @@ StorageManagerConfig* StorageManager::get_config() {
   return config_;
 }
 
+TileCache* StorageManager::tile_cache() const {
+  return tile_cache_;
+}
+
+MMapRegistry* StorageManager::mmap_registry() const {
+  return mmap_registry_;
+}
+
 /* ****************************** */
 /*            WORKSPACE           */
 /* ****************************** */
@@ -301,6 +317,7 @@ int StorageManager::array_consolidate(const char* array_dir) {
   int rc_array_finalize = array->finalize();
   delete array;
 
+  consolidation_drop_cache(old_fragment_names);
   int rc_delete = delete_directories(fs_, old_fragment_names);
 
   // Errors 
@@ -384,12 +401,40 @@ int StorageManager::array_create(const ArraySchema* array_schema) const {
   return TILEDB_SM_OK;
 }
 
+void StorageManager::array_fold_fragment_manifest(const std::string& array) {
+  // Fold the shards once there are too many to read on every open. Errors
+  // only leave the shards in place or invalidate the manifest
+  FragmentManifest manifest(fs_, real_dir(fs_, array));
+  size_t max_shard_num = get_env_uint64(
+      "TILEDB_FRAGMENT_MANIFEST_MAX_SHARDS", 
+      TILEDB_FM_MAX_SHARD_NUM);
+  if(manifest.shard_num() <= max_shard_num)
+    return;
+
+  // The shared lock keeps consolidation from deleting fragments meanwhile
+  int fd;
+  if(consolidation_filelock_lock(array, fd, TILEDB_SM_SHARED_LOCK) != TILEDB_SM_OK)
+    return;
+  manifest.compact(std::vector<std::string>());
+  consolidation_filelock_unlock(fd);
+}
+
 void StorageManager::array_get_fragment_names(
     const std::string& array,
+    FragmentManifest& manifest,
     std::vector<std::string>& fragment_names) {
 
   // Get directory names in the array folder
-  fragment_names = get_fragment_dirs(fs_, real_dir(fs_, array)); 
+  std::vector<std::string> dirs = get_dirs(fs_, real_dir(fs_, array));
+
+  // The directories in the manifest are committed fragments, only the others
+  // need their fragment file checked
+  manifest.load(dirs);
+  fragment_names.clear();
+  for(auto& dir : dirs) {
+    if(manifest.entry(dir) != NULL || is_fragment(fs_, dir))
+      fragment_names.push_back(dir);
+  }
 
   // Sort the fragment names
   sort_fragment_names(fragment_names);
@@ -398,37 +443,91 @@ void StorageManager::array_get_fragment_names(
 int StorageManager::array_load_book_keeping(
     const ArraySchema* array_schema,
     const std::vector<std::string>& fragment_names,
+    const FragmentManifest& manifest,
     std::vector<BookKeeping*>& book_keeping,
     int mode) {
   // For easy reference
-  int fragment_num = fragment_names.size(); 
+  size_t fragment_num = fragment_names.size(); 
 
   // Initialization
-  book_keeping.resize(fragment_num);
+  book_keeping.assign(fragment_num, NULL);
+
+  // Load the book-keeping for each fragment, including the dense check, from
+  // a bounded pool of threads. A failure stops the remaining loads, its error
+  // message is kept per fragment as error messages are per thread.
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+  std::vector<std::string> errmsgs(fragment_num);
+  bool write_sections = config_->book_keeping_sections();
+  auto load_next_book_keeping = [&]() {
+    for (size_t i = next++; i < fragment_num && !failed; i = next++) {
+      // Load the book-keeping from the manifest entry, if any
+      const FragmentManifestEntry* entry = manifest.entry(fragment_names[i]);
+      BookKeeping* f_book_keeping = NULL;
+      int rc = TILEDB_BK_ERR;
+      if(entry != NULL) {
+        f_book_keeping = 
+            new BookKeeping(
+                array_schema, 
+                entry->dense_, 
+                fragment_names[i], 
+                mode,
+                write_sections);
+        rc = f_book_keeping->load(entry->book_keeping_.data(), entry->book_keeping_.size());
+        if(rc != TILEDB_BK_OK)
+          delete f_book_keeping;
+      }
 
-  // Load the book-keeping for each fragment
-  for(int i=0; i<fragment_num; ++i) {
-    // For easy reference
-    int dense = 
-        !is_file(fs_, fragment_names[i] + "/" + TILEDB_COORDS + TILEDB_FILE_SUFFIX);
-
-    // Create new book-keeping structure for the fragment
-    BookKeeping* f_book_keeping = 
-        new BookKeeping(
-            array_schema, 
-            dense, 
-            fragment_names[i], 
-            mode);
-
-    // Load book-keeping
-    if(f_book_keeping->load(fs_) != TILEDB_BK_OK) {
-      delete f_book_keeping;
-      tiledb_sm_errmsg = tiledb_bk_errmsg;
-      return TILEDB_SM_ERR;
+      // Otherwise, or if the entry does not match, load it from the fragment
+      if(rc != TILEDB_BK_OK) {
+        int dense = 
+            !is_file(fs_, fragment_names[i] + "/" + TILEDB_COORDS + TILEDB_FILE_SUFFIX);
+        f_book_keeping = 
+            new BookKeeping(
+                array_schema, 
+                dense, 
+                fragment_names[i], 
+                mode,
+                write_sections);
+        rc = f_book_keeping->load(fs_);
+      }
+      if(rc != TILEDB_BK_OK) {
+        delete f_book_keeping;
+        errmsgs[i] = tiledb_bk_errmsg;
+        failed = true;
+        return;
+      }
+
+      // Append to the open array entry
+      book_keeping[i] = f_book_keeping;
     }
+  };
 
-    // Append to the open array entry
-    book_keeping[i] = f_book_keeping;
+  size_t max_threads = std::max((uint64_t)1, get_env_uint64(
+      "TILEDB_BOOK_KEEPING_LOAD_THREADS", 
+      TILEDB_SM_BOOK_KEEPING_LOAD_THREADS));
+  std::vector<std::thread> threads;
+  size_t num_threads = std::min(fragment_num, max_threads);
+  for (auto i=1ul; i<num_threads; i++) {
+    threads.emplace_back(load_next_book_keeping);
+  }
+  load_next_book_keeping();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (failed) {
+    for (auto f_book_keeping : book_keeping) {
+      delete f_book_keeping;
+    }
+    book_keeping.clear();
+    for (auto& errmsg : errmsgs) {
+      if (!errmsg.empty()) {
+        tiledb_sm_errmsg = errmsg;
+        break;
+      }
+    }
+    return TILEDB_SM_ERR;
   }
 
   // Success
@@ -541,7 +640,10 @@ int StorageManager::array_init(
                      attributes, 
                      attribute_num, 
                      subarray,
-                     config_);
+                     config_,
+                     NULL,
+                     tile_cache_,
+                     mmap_registry_);
 
   // Handle error
   if(rc_clone != TILEDB_AR_OK) {
@@ -566,7 +668,9 @@ int StorageManager::array_init(
                attribute_num, 
                subarray,
                config_,
-               array_clone);
+               array_clone,
+               tile_cache_,
+               mmap_registry_);
 
   // Handle error
   if(rc != TILEDB_AR_OK) {
@@ -593,6 +697,8 @@ int StorageManager::array_finalize(Array* array) {
   int rc_close = TILEDB_SM_OK;
   if(array->read_mode())
     rc_close = array_close(array->get_array_path_used());
+  else if(rc_finalize == TILEDB_AR_OK && array->fragment_manifest_recorded())
+    array_fold_fragment_manifest(array->get_array_path_used());
 
   // Clean up
   delete array;
@@ -766,6 +872,7 @@ int StorageManager::metadata_consolidate(const char* metadata_dir) {
   int rc_metadata_finalize = metadata->finalize();
   delete metadata;
 
+  consolidation_drop_cache(old_fragment_names);
   int rc_delete = delete_directories(fs_, old_fragment_names);
 
   // Errors 
@@ -993,6 +1100,8 @@ int StorageManager::metadata_finalize(Metadata* metadata) {
   int rc_close = TILEDB_SM_OK;
   if(mode == TILEDB_METADATA_READ)
     rc_close = array_close(array_name);
+  else if(rc_finalize == TILEDB_MT_OK && metadata->fragment_manifest_recorded())
+    array_fold_fragment_manifest(array_name);
 
   // Clean up
   delete metadata;
@@ -1232,6 +1341,12 @@ int StorageManager::array_clear(
       return TILEDB_SM_ERR;
     }
   }
+
+  // Delete the fragment manifest
+  if(FragmentManifest(fs_, array_real).clear() != TILEDB_FM_OK) {
+    tiledb_sm_errmsg = tiledb_fm_errmsg;
+    return TILEDB_SM_ERR;
+  }
   
   // Success
   return TILEDB_SM_OK;
@@ -1451,8 +1566,9 @@ int StorageManager::array_open(
       return TILEDB_SM_ERR;
     }
 
-    // Get the fragment names
-    array_get_fragment_names(array_name, open_array->fragment_names_);
+    // Get the fragment names, along with the fragment manifest if there is one
+    FragmentManifest manifest(fs_, real_dir(fs_, array_name));
+    array_get_fragment_names(array_name, manifest, open_array->fragment_names_);
 
     // Get array schema
     if(is_array(fs_, array_name)) { // Array
@@ -1471,6 +1587,7 @@ int StorageManager::array_open(
     if(array_load_book_keeping(
            open_array->array_schema_, 
            open_array->fragment_names_, 
+           manifest,
            open_array->book_keeping_,
            mode) != TILEDB_SM_OK) {
       delete open_array->array_schema_;
@@ -1537,6 +1654,14 @@ int StorageManager::config_set(StorageManagerConfig* config) {
   config_ = config;
   fs_ = config_->get_filesystem();
 
+  // Create the shared tile cache
+  if(config_->tile_cache_size() > 0)
+    tile_cache_ = new TileCache(config_->tile_cache_size());
+
+  // Map each attribute file once for all the arrays
+  if(config_->read_method() == TILEDB_IO_MMAP)
+    mmap_registry_ = new MMapRegistry();
+
   // Success
   return TILEDB_SM_OK;
 } 
@@ -1657,6 +1782,7 @@ int StorageManager::consolidation_finalize(
   }
 
   // Finalize new fragment - makes the new fragment visible to new reads
+  std::string array_real = real_dir(fs_, new_fragment->array()->get_array_path_used());
   int rc = new_fragment->finalize(); 
   delete new_fragment;
   if(rc != TILEDB_FG_OK) { 
@@ -1664,6 +1790,11 @@ int StorageManager::consolidation_finalize(
     return TILEDB_SM_ERR;
   }
 
+  // Drop the old fragments from the fragment manifest before they disappear.
+  // On error the manifest is invalidated, readers then check the fragment
+  // directories instead
+  FragmentManifest(fs_, array_real).compact(old_fragment_names);
+
   // Make old fragments invisible to new reads
   int fragment_num = old_fragment_names.size();
   for(int i=0; i<fragment_num; ++i) {
@@ -1689,6 +1820,14 @@ int StorageManager::consolidation_finalize(
   return TILEDB_SM_OK;
 }
 
+void StorageManager::consolidation_drop_cache(
+    const std::vector<std::string>& old_fragment_names) const {
+  for(auto& old_fragment_name : old_fragment_names) {
+    for(auto& filename : get_files(fs_, old_fragment_name)) 
+      fs_->advise_file(filename, 0, 0, TILEDB_FS_ACCESS_DONTNEED);
+  }
+}
+
 int StorageManager::create_group_file(const std::string& group) const {
   // Create file
   std::string filename = group + "/" + TILEDB_GROUP_FILENAME;
@@ -33,6 +33,8 @@
 
 #include "storage_azure_blob.h"
 #include "storage_manager_config.h"
+#include "storage_sim.h"
+#include "storage_spill_cache.h"
 #include "tiledb_constants.h"
 #include "utils.h"
 
@@ -65,6 +67,10 @@ StorageManagerConfig::StorageManagerConfig() {
   home_ = "";
   read_method_ = TILEDB_IO_MMAP;
   write_method_ = TILEDB_IO_WRITE;
+  tile_cache_size_ = 0;
+  coords_filter_false_positive_rate_ = 0;
+  coords_filter_max_size_ = 0;
+  enable_book_keeping_sections_ = false;
 #ifdef HAVE_MPI
   mpi_comm_ = NULL;
 #endif
@@ -87,7 +93,17 @@ int StorageManagerConfig::init(
 #endif
     int read_method,
     int write_method,
-    const bool enable_shared_posixfs_optimizations) {
+    const bool enable_shared_posixfs_optimizations,
+    size_t tile_cache_size,
+    double coords_filter_false_positive_rate,
+    size_t coords_filter_max_size,
+    bool enable_book_keeping_sections) {
+  // Initialize tile cache size, coordinates filters and book-keeping layout
+  tile_cache_size_ = tile_cache_size;
+  coords_filter_false_positive_rate_ = coords_filter_false_positive_rate;
+  coords_filter_max_size_ = coords_filter_max_size;
+  enable_book_keeping_sections_ = enable_book_keeping_sections;
+
   // Initialize home
   if (home !=  NULL && strstr(home, "://")) {
      if (fs_ != NULL)
@@ -101,6 +117,14 @@ int StorageManagerConfig::init(
 	 tiledb_smc_errmsg = "Azure Storage Blob intialization failed for home=" + home_;
 	 return TILEDB_SMC_ERR;
        }
+     } else if (is_sim_path(home_)) {
+       try {
+         fs_ = new SimFS(home_);
+       } catch(std::system_error& ex) {
+         PRINT_ERROR(ex.what());
+         tiledb_smc_errmsg = "Simulated cloud storage initialization failed for home=" + home_;
+         return TILEDB_SMC_ERR;
+       }
      } else if (is_supported_cloud_path(home_)) {
        try {
 #ifdef USE_HDFS
@@ -119,6 +143,20 @@ int StorageManagerConfig::init(
        return TILEDB_SMC_ERR;
      }
 
+     // Optionally keep the ranges read in a local spill cache
+     auto spill_cache_dir = getenv("TILEDB_SPILL_CACHE_DIR");
+     if (spill_cache_dir && strlen(spill_cache_dir)) {
+       try {
+         fs_ = new SpillCacheFS(fs_, spill_cache_dir, get_env_uint64("TILEDB_SPILL_CACHE_SIZE", TILEDB_SPILL_CACHE_SIZE));
+       } catch(std::system_error& ex) {
+         delete fs_;
+         fs_ = NULL;
+         PRINT_ERROR(ex.what());
+         tiledb_smc_errmsg = "Spill cache initialization failed for dir=" + std::string(spill_cache_dir);
+         return TILEDB_SMC_ERR;
+       }
+     }
+
      read_method_ = TILEDB_IO_READ;
      write_method_ = TILEDB_IO_WRITE;
      return TILEDB_SMC_OK;
@@ -144,7 +182,8 @@ int StorageManagerConfig::init(
   read_method_ = read_method;
   if(read_method_ != TILEDB_IO_READ &&
      read_method_ != TILEDB_IO_MMAP &&
-     read_method_ != TILEDB_IO_MPI)
+     read_method_ != TILEDB_IO_MPI &&
+     read_method_ != TILEDB_IO_URING)
     read_method_ = TILEDB_IO_MMAP;  // Use default 
 
   // Initialize write method
@@ -181,3 +220,20 @@ int StorageManagerConfig::write_method() const {
 StorageFS* StorageManagerConfig::get_filesystem() const {
   return fs_;
 }
+
+size_t StorageManagerConfig::tile_cache_size() const {
+  return tile_cache_size_;
+}
+
+double StorageManagerConfig::coords_filter_false_positive_rate() const {
+  return coords_filter_false_positive_rate_;
+}
+
+size_t StorageManagerConfig::coords_filter_max_size() const {
+  return coords_filter_max_size_;
+}
+
+bool StorageManagerConfig::book_keeping_sections() const {
+  return enable_book_keeping_sections_ || 
+         is_env_set("TILEDB_BOOK_KEEPING_SECTIONS");
+}
@@ -30,11 +30,13 @@
  * Default Posix Filesystem Implementation for StorageFS
  */
 
+#include "aligned_allocator.h"
 #include "error.h"
 #include "storage_posixfs.h"
 #include "utils.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -43,13 +45,26 @@
 #include <ftw.h>
 #include <iostream>
 #include <sys/stat.h>
+#include <thread>
 #include <unistd.h>
 
 #define POSIX_ERROR(MSG, PATH) SYSTEM_ERROR(TILEDB_FS_ERRMSG, MSG, PATH, tiledb_fs_errmsg)
 
 static int sync_kernel(int fd, bool locking_support, std::string filename);
 
+PosixFS::PosixFS() {
+  max_open_read_files_ = get_env_uint64("TILEDB_MAX_OPEN_READ_FILES", max_open_read_files_);
+  direct_io_ = is_env_set("TILEDB_DIRECT_IO");
+  direct_io_min_size_ = get_env_uint64("TILEDB_DIRECT_IO_MIN_SIZE", direct_io_min_size_);
+  override_tuning_from_env();
+}
+
 PosixFS::~PosixFS() {
+  release_all_read_fds();
+  for (auto uring : urings_) {
+    delete uring;
+  }
+
   for (auto it = write_map_.begin(); it != write_map_.end(); ++it) {
     std::string filename = it->first;
     int fd = it->second;
@@ -217,6 +232,8 @@ static int delete_file_nftw_cb(const char *filepath, const struct stat *ptr, int
 int PosixFS::delete_dir(const std::string& dirname) {
   reset_errno();
 
+  release_all_read_fds();
+
   // Get real path
   std::string dirname_real = this->real_dir(dirname); 
 
@@ -306,6 +323,8 @@ int PosixFS::create_file(const std::string& filename, int flags, mode_t mode) {
 int PosixFS::delete_file(const std::string& filename) {
   reset_errno();
 
+  release_all_read_fds();
+
   if(remove(filename.c_str())) {
     POSIX_ERROR("Cannot remove file", filename);
     return TILEDB_FS_ERR;
@@ -360,6 +379,85 @@ static void remove_fd(const std::string& filename, std::unordered_map<std::strin
   map.erase(filename);
 }
 
+std::shared_ptr<int> PosixFS::get_read_fd(const std::string& filename) {
+  {
+    std::lock_guard<std::mutex> lock(read_map_mtx_);
+    auto search = read_map_.find(filename);
+    if (search != read_map_.end()) {
+      read_fd_lru_.splice(read_fd_lru_.begin(), read_fd_lru_, search->second);
+      return search->second->second;
+    }
+  }
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return nullptr;
+  }
+  std::shared_ptr<int> read_fd(new int(fd), [](int *fd) { close(*fd); delete fd; });
+
+  std::lock_guard<std::mutex> lock(read_map_mtx_);
+  if (max_open_read_files_ == 0) {
+    return read_fd;
+  }
+  auto search = read_map_.find(filename);
+  if (search != read_map_.end()) {
+    // Another thread opened the same file concurrently, use that one instead
+    read_fd_lru_.splice(read_fd_lru_.begin(), read_fd_lru_, search->second);
+    return search->second->second;
+  }
+  read_fd_lru_.emplace_front(filename, read_fd);
+  read_map_.emplace(filename, read_fd_lru_.begin());
+  trim_read_fds();
+  return read_fd;
+}
+
+// Expects read_map_mtx_ to be locked by the caller
+void PosixFS::trim_read_fds() {
+  while (read_map_.size() > max_open_read_files_) {
+    read_map_.erase(read_fd_lru_.back().first);
+    read_fd_lru_.pop_back();
+  }
+}
+
+void PosixFS::release_read_fd(const std::string& filename) {
+  std::lock_guard<std::mutex> lock(read_map_mtx_);
+  auto search = read_map_.find(filename);
+  if (search != read_map_.end()) {
+    read_fd_lru_.erase(search->second);
+    read_map_.erase(search);
+  }
+}
+
+// Paths can be spelled in relative or absolute forms, so namespace changes
+// like delete/move, which are rare compared to reads, drop all cached fds.
+void PosixFS::release_all_read_fds() {
+  std::lock_guard<std::mutex> lock(read_map_mtx_);
+  read_map_.clear();
+  read_fd_lru_.clear();
+}
+
+static int read_from_file_kernel(int fd, const std::string& filename, off_t offset, void *buffer, size_t length) {
+  // Read in batches of TILEDB_UT_MAX_WRITE_COUNT
+  size_t nbytes = 0;
+  char *pbuf = reinterpret_cast<char *>(buffer);
+  int rc = TILEDB_FS_OK;
+  do {
+    ssize_t bytes_read = pread(fd, reinterpret_cast<void *>(pbuf), (length - nbytes) > TILEDB_UT_MAX_WRITE_COUNT?TILEDB_UT_MAX_WRITE_COUNT : length-nbytes, offset + nbytes);
+    if (bytes_read < 0) {
+      POSIX_ERROR("Cannot read from file; File reading error", filename);
+      rc = TILEDB_FS_ERR;
+    } else if (bytes_read == 0) {
+      POSIX_ERROR("EOF reached; File reading error", filename);
+      rc = TILEDB_FS_ERR;
+    } else {
+      nbytes += bytes_read;
+      pbuf += bytes_read;
+    }
+  } while (nbytes < length && rc == TILEDB_FS_OK);
+
+  return rc;
+}
+
 int PosixFS::read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length) {
   reset_errno();
 
@@ -372,39 +470,157 @@ int PosixFS::read_from_file(const std::string& filename, off_t offset, void *buf
     POSIX_ERROR("Cannot open simultaneously for reads/writes", filename);
     return TILEDB_FS_ERR;
   }
+
+  if (direct_io() && length >= direct_io_min_size()) {
+    return read_from_file_direct(filename, offset, buffer, length);
+  }
   
-  // Open file
-  int fd = open(filename.c_str(), O_RDONLY);
-  if (fd == -1) {
+  // Open file or reuse a cached descriptor. The descriptor is closed when the
+  // last reference is released, so concurrent evictions are harmless
+  std::shared_ptr<int> read_fd = get_read_fd(filename);
+  if (!read_fd) {
     POSIX_ERROR("Cannot read from file; File opening error", filename);
     return TILEDB_FS_ERR;
   }
 
-  // Read in batches of TILEDB_UT_MAX_WRITE_COUNT
-  size_t nbytes = 0;
+  return read_from_file_kernel(*read_fd, filename, offset, buffer, length);
+}
+
+int PosixFS::read_from_file_direct(const std::string& filename, off_t offset, void *buffer, size_t length) {
+  const size_t alignment = TILEDB_DIRECT_IO_ALIGNMENT;
+  int fd = -1;
+#ifdef O_DIRECT
+  fd = open(filename.c_str(), O_RDONLY | O_DIRECT);
+#endif
+  if (fd == -1) {
+    // O_DIRECT is not supported by the filesystem, read through the page cache
+    std::shared_ptr<int> read_fd = get_read_fd(filename);
+    if (!read_fd) {
+      POSIX_ERROR("Cannot read from file; File opening error", filename);
+      return TILEDB_FS_ERR;
+    }
+    return read_from_file_kernel(*read_fd, filename, offset, buffer, length);
+  }
+
+  // Read the aligned range covering the requested one. Aligned parts of the
+  // destination are read into directly, the rest is staged
   char *pbuf = reinterpret_cast<char *>(buffer);
+  off_t end = offset + length;
+  off_t pos = offset - offset%alignment;
+  AlignedBuffer<TILEDB_DIRECT_IO_ALIGNMENT> staging;
   int rc = TILEDB_FS_OK;
-  do {
-    ssize_t bytes_read = pread(fd, reinterpret_cast<void *>(pbuf), (length - nbytes) > TILEDB_UT_MAX_WRITE_COUNT?TILEDB_UT_MAX_WRITE_COUNT : length-nbytes, offset + nbytes);
-    if (bytes_read < 0) {
+  while (pos < end && rc == TILEDB_FS_OK) {
+    size_t remaining = end - pos;
+    char *dest;
+    size_t count;
+    if (pos >= offset && reinterpret_cast<uintptr_t>(pbuf + (pos-offset))%alignment == 0 && remaining >= alignment) {
+      dest = pbuf + (pos-offset);
+      count = std::min(remaining - remaining%alignment, (size_t)TILEDB_DIRECT_IO_CHUNK_SIZE);
+    } else {
+      count = std::min((remaining + alignment - 1)/alignment*alignment, (size_t)TILEDB_DIRECT_IO_CHUNK_SIZE);
+      if (staging.size() < count) {
+        staging.resize(count);
+      }
+      dest = staging.data();
+    }
+
+    ssize_t bytes_read = pread(fd, dest, count, pos);
+    if (bytes_read < 0 && errno == EINTR) {
+      continue;
+    } else if (bytes_read < 0 && errno == EINVAL && pos <= offset) {
+      // Device does not accept this alignment, read through the page cache
+      reset_errno();
+      std::shared_ptr<int> read_fd = get_read_fd(filename);
+      if (!read_fd) {
+        POSIX_ERROR("Cannot read from file; File opening error", filename);
+        rc = TILEDB_FS_ERR;
+      } else {
+        rc = read_from_file_kernel(*read_fd, filename, offset, buffer, length);
+      }
+      break;
+    } else if (bytes_read < 0) {
       POSIX_ERROR("Cannot read from file; File reading error", filename);
       rc = TILEDB_FS_ERR;
-    } else if (bytes_read == 0) {
+    } else if (bytes_read == 0 || (bytes_read%alignment && pos + bytes_read < end)) {
+      // Direct reads are only short at the end of the file
       POSIX_ERROR("EOF reached; File reading error", filename);
       rc = TILEDB_FS_ERR;
     } else {
-      nbytes += bytes_read;
-      pbuf += bytes_read;
+      if (dest == staging.data()) {
+        off_t from = std::max(pos, offset);
+        off_t to = std::min(pos + bytes_read, end);
+        memcpy(pbuf + (from-offset), dest + (from-pos), to-from);
+      }
+      pos += bytes_read;
     }
-  } while (nbytes < length && rc == TILEDB_FS_OK);
-  
-  // Close file
+  }
+
   if (close(fd)) {
     POSIX_ERROR("Cannot read from file; File closing error", filename);
+  }
+  return rc;
+}
+
+uint64_t PosixFS::uring_read_num() const {
+  return uring_read_num_;
+}
+
+int PosixFS::read_from_file_v(const std::vector<StorageFSRead>& reads) {
+  reset_errno();
+
+  // Resolve file descriptors, holding on to them until all reads complete
+  std::unordered_map<std::string, std::shared_ptr<int>> read_fds;
+  std::vector<URingRead> uring_reads(reads.size());
+  for (auto i=0ul; i<reads.size(); i++) {
+    const std::string& filename = reads[i].filename;
+    if (keep_write_file_handles_open() && get_fd(filename, write_map_, write_map_mtx_) >= 0) {
+      POSIX_ERROR("Cannot open simultaneously for reads/writes", filename);
+      return TILEDB_FS_ERR;
+    }
+    auto search = read_fds.find(filename);
+    if (search == read_fds.end()) {
+      std::shared_ptr<int> read_fd = get_read_fd(filename);
+      if (!read_fd) {
+        POSIX_ERROR("Cannot read from file; File opening error", filename);
+        return TILEDB_FS_ERR;
+      }
+      search = read_fds.emplace(filename, read_fd).first;
+    }
+    uring_reads[i] = { *search->second, reads[i].offset, reads[i].buffer, reads[i].length };
+  }
+
+  URing *uring = NULL;
+  {
+    std::lock_guard<std::mutex> lock(uring_mtx_);
+    if (!urings_.empty()) {
+      uring = urings_.back();
+      urings_.pop_back();
+    }
+  }
+  if (uring == NULL) {
+    uring = new URing();
+  }
+
+  size_t failed = 0;
+  uint64_t ring_read_num = uring->ring_read_num();
+  int rc = uring->read(uring_reads, failed);
+  uring_read_num_ += uring->ring_read_num() - ring_read_num;
+
+  {
+    std::lock_guard<std::mutex> lock(uring_mtx_);
+    urings_.push_back(uring);
+  }
+
+  if (rc == -1) {
+    POSIX_ERROR("EOF reached; File reading error", reads[failed].filename);
+    return TILEDB_FS_ERR;
+  } else if (rc) {
+    errno = rc;
+    POSIX_ERROR("Cannot read from file; File reading error", reads[failed].filename);
     return TILEDB_FS_ERR;
   }
 
-  return rc;
+  return TILEDB_FS_OK;
 }
 
 static int write_to_file_kernel(int fd, const void *buffer, size_t buffer_size) {
@@ -425,6 +641,79 @@ static int write_to_file_kernel(int fd, const void *buffer, size_t buffer_size)
   return TILEDB_FS_OK;
 }
 
+// Writes the aligned middle of the buffer with O_DIRECT. The unaligned head
+// and tail are appended through the buffered descriptor fd, as is everything
+// if direct I/O is not supported or fails.
+static int write_to_file_direct(int fd, const std::string& filename, const void *buffer, size_t buffer_size) {
+  const size_t alignment = TILEDB_DIRECT_IO_ALIGNMENT;
+  const char *pbuf = reinterpret_cast<const char *>(buffer);
+
+  struct stat st;
+  if (fstat(fd, &st)) {
+    return TILEDB_FS_ERR;
+  }
+  off_t offset = st.st_size;
+  size_t head = std::min((alignment - offset%alignment)%alignment, buffer_size);
+  size_t middle = (buffer_size - head)/alignment*alignment;
+
+  int direct_fd = -1;
+#ifdef O_DIRECT
+  if (middle > 0) {
+    direct_fd = open(filename.c_str(), O_WRONLY | O_DIRECT);
+  }
+#endif
+  if (direct_fd == -1) {
+    reset_errno();
+    return write_to_file_kernel(fd, buffer, buffer_size);
+  }
+
+  if (head && write_to_file_kernel(fd, pbuf, head)) {
+    close(direct_fd);
+    return TILEDB_FS_ERR;
+  }
+
+  // Stage through an aligned buffer unless the source is aligned already
+  bool aligned = reinterpret_cast<uintptr_t>(pbuf + head)%alignment == 0;
+  AlignedBuffer<TILEDB_DIRECT_IO_ALIGNMENT> staging;
+  if (!aligned) {
+    staging.resize(std::min(middle, (size_t)TILEDB_DIRECT_IO_CHUNK_SIZE));
+  }
+  size_t nbytes = head;
+  while (nbytes < head + middle) {
+    size_t count = std::min(head + middle - nbytes, (size_t)TILEDB_DIRECT_IO_CHUNK_SIZE);
+    const char *src = pbuf + nbytes;
+    if (!aligned) {
+      memcpy(staging.data(), src, count);
+      src = staging.data();
+    }
+    ssize_t bytes_written = pwrite(direct_fd, src, count, offset + nbytes);
+    if (bytes_written < 0 && errno == EINTR) {
+      continue;
+    } else if (bytes_written < 0 || bytes_written%alignment) {
+      // Append whatever is left through the page cache
+      if (bytes_written > 0) {
+        nbytes += bytes_written;
+      }
+      reset_errno();
+      break;
+    }
+    nbytes += bytes_written;
+  }
+  close(direct_fd);
+
+  if (nbytes < buffer_size) {
+    return write_to_file_kernel(fd, pbuf + nbytes, buffer_size - nbytes);
+  }
+  return TILEDB_FS_OK;
+}
+
+int PosixFS::write_to_file_fd(int fd, const std::string& filename, const void *buffer, size_t buffer_size) {
+  if (direct_io() && buffer_size >= direct_io_min_size()) {
+    return write_to_file_direct(fd, filename, buffer, buffer_size);
+  }
+  return write_to_file_kernel(fd, buffer, buffer_size);
+}
+
 int PosixFS::write_to_file_keep_file_handles_open(const std::string& filename, const void *buffer, size_t buffer_size) {
   int fd = get_fd(filename, write_map_, write_map_mtx_);
   if (fd == -1) {
@@ -437,7 +726,7 @@ int PosixFS::write_to_file_keep_file_handles_open(const std::string& filename, c
     set_fd(filename, fd, write_map_, write_map_mtx_);
   }
 
-  if (write_to_file_kernel(fd, buffer, buffer_size)) {
+  if (write_to_file_fd(fd, filename, buffer, buffer_size)) {
     POSIX_ERROR("Cannot write to file; File writing error", filename);
     close(fd);
     return TILEDB_FS_ERR;
@@ -464,7 +753,7 @@ int PosixFS::write_to_file(const std::string& filename, const void *buffer, size
     return TILEDB_FS_ERR;
   }
 
-  if (write_to_file_kernel(fd, buffer, buffer_size)) {
+  if (write_to_file_fd(fd, filename, buffer, buffer_size)) {
     POSIX_ERROR("Cannot write to file; File writing error", filename);
     close(fd);
     return TILEDB_FS_ERR;
@@ -482,6 +771,8 @@ int PosixFS::write_to_file(const std::string& filename, const void *buffer, size
 
 int PosixFS::move_path(const std::string& old_path, const std::string& new_path) {
   reset_errno();
+
+  release_all_read_fds();
   
   if(rename(old_path.c_str(), new_path.c_str())) {
     POSIX_ERROR("Cannot rename path", old_path);
@@ -539,7 +830,98 @@ int PosixFS::sync_path(const std::string& filename) {
   return TILEDB_FS_OK;
 }
 
+// Returns 0 on success and the errno of the failure otherwise, so that errors
+// can be reported from the calling thread
+static int sync_path_data(const std::string& path) {
+  struct stat st;
+  if (stat(path.c_str(), &st)) {
+    return 0; // If path does not exist, ignore
+  }
+  int fd = open(path.c_str(), S_ISDIR(st.st_mode) ? O_RDONLY : O_WRONLY | O_APPEND);
+  if (fd == -1) {
+    return errno;
+  }
+  int rc = 0;
+#ifdef __APPLE__
+  if (fsync(fd)) {
+#else
+  if (S_ISDIR(st.st_mode) ? fsync(fd) : fdatasync(fd)) {
+#endif
+    rc = errno;
+  }
+  close(fd);
+  return rc;
+}
+
+int PosixFS::sync_paths(const std::vector<std::string>& paths) {
+  reset_errno();
+
+  std::vector<int> errnos(paths.size(), 0);
+  std::atomic<size_t> next(0);
+  auto sync_next_paths = [&]() {
+    for (size_t i = next++; i < paths.size(); i = next++) {
+      errnos[i] = sync_path_data(paths[i]);
+    }
+  };
+  std::vector<std::thread> threads;
+  size_t num_threads = std::min(paths.size(), (size_t)TILEDB_SYNC_PATHS_THREADS);
+  for (auto i=1ul; i<num_threads; i++) {
+    threads.emplace_back(sync_next_paths);
+  }
+  sync_next_paths();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (auto i=0ul; i<paths.size(); i++) {
+    // Ignoring EINVAL errors on fsync that can show up on NFS/CIFS
+    if (errnos[i] && errnos[i] != EINVAL && locking_support()) {
+      errno = errnos[i];
+      POSIX_ERROR("Cannot sync file; File syncing error", paths[i]);
+      return TILEDB_FS_ERR;
+    }
+  }
+  return TILEDB_FS_OK;
+}
+
+int PosixFS::advise_file(const std::string& filename, off_t offset, size_t length, int advice) {
+  reset_errno();
+#ifdef POSIX_FADV_NORMAL
+  int fadvice;
+  switch (advice) {
+    case TILEDB_FS_ACCESS_SEQUENTIAL:
+      fadvice = POSIX_FADV_SEQUENTIAL;
+      break;
+    case TILEDB_FS_ACCESS_RANDOM:
+      fadvice = POSIX_FADV_RANDOM;
+      break;
+    case TILEDB_FS_ACCESS_WILLNEED:
+      fadvice = POSIX_FADV_WILLNEED;
+      break;
+    case TILEDB_FS_ACCESS_DONTNEED:
+      fadvice = POSIX_FADV_DONTNEED;
+      break;
+    default:
+      fadvice = POSIX_FADV_NORMAL;
+  }
+
+  std::shared_ptr<int> read_fd = get_read_fd(filename);
+  if (!read_fd) {
+    POSIX_ERROR("Cannot advise file; File opening error", filename);
+    return TILEDB_FS_ERR;
+  }
+  int rc = posix_fadvise(*read_fd, offset, length, fadvice);
+  if (rc) {
+    errno = rc;
+    POSIX_ERROR("Cannot advise file", filename);
+    return TILEDB_FS_ERR;
+  }
+#endif
+  return TILEDB_FS_OK;
+}
+
 int PosixFS::close_file(const std::string& filename) {
+  release_read_fd(filename);
   if (keep_write_file_handles_open()) {
     int fd = get_fd(filename, write_map_, write_map_mtx_);
     if (fd >= 0) {
@@ -587,3 +969,40 @@ bool PosixFS::disable_file_locking() {
   is_disable_file_locking_set = true;
   return disable_file_locking_;
 }
+
+void PosixFS::set_max_open_read_files(const size_t val) {
+  std::lock_guard<std::mutex> lock(read_map_mtx_);
+  max_open_read_files_ = val;
+  trim_read_fds();
+}
+
+size_t PosixFS::max_open_read_files() {
+  std::lock_guard<std::mutex> lock(read_map_mtx_);
+  return max_open_read_files_;
+}
+
+size_t PosixFS::open_read_files() {
+  std::lock_guard<std::mutex> lock(read_map_mtx_);
+  return read_map_.size();
+}
+
+void PosixFS::set_direct_io(const bool val) {
+  direct_io_ = val;
+}
+
+bool PosixFS::direct_io() {
+  return direct_io_;
+}
+
+void PosixFS::set_direct_io_min_size(const size_t val) {
+  direct_io_min_size_ = val;
+}
+
+size_t PosixFS::direct_io_min_size() {
+  return direct_io_min_size_;
+}
+
+bool PosixFS::write_sessions() {
+  return !is_env_set("TILEDB_DISABLE_WRITE_SESSIONS") && locking_support() &&
+      !keep_write_file_handles_open() && !direct_io();
+}
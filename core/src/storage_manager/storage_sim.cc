@@ -0,0 +1,214 @@
+/**
+ * @file storage_sim.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements the SimFS class.
+ */
+
+#include "storage_sim.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <system_error>
+#include <thread>
+
+#define SIM_PREFIX "sim://"
+
+static std::atomic<size_t> metadata_requests(0);
+static std::atomic<size_t> read_requests(0);
+static std::atomic<size_t> write_requests(0);
+static std::atomic<size_t> bytes_read(0);
+static std::atomic<size_t> bytes_written(0);
+
+SimFS::SimFS(const std::string& home) {
+  if (!starts_with(home, SIM_PREFIX)) {
+    throw std::system_error(EINVAL, std::generic_category(), "Home " + home + " is not a sim:// URL");
+  }
+  working_dir_ = fs_.current_dir();
+  working_dir_ = get_path(home);
+
+  latency_us_ = get_env_uint64("TILEDB_SIM_LATENCY_US", TILEDB_SIM_LATENCY_US);
+  bandwidth_ = get_env_uint64("TILEDB_SIM_BANDWIDTH", TILEDB_SIM_BANDWIDTH);
+  concurrency_ = std::max((uint64_t)1, get_env_uint64("TILEDB_SIM_CONCURRENCY", TILEDB_SIM_CONCURRENCY));
+
+  // Same tuning as AzureBlob so that buffering and coalescing are exercised
+  download_buffer_size_ = 8*1024*1024; // 8M
+  upload_buffer_size_ = 8*1024*1024; // 8M
+  upload_queue_depth_ = 1;
+  coalesce_max_gap_ = 1024*1024; // 1M
+  coalesce_max_size_ = 8*1024*1024; // 8M
+  override_tuning_from_env();
+}
+
+std::string SimFS::get_path(const std::string& path) {
+  std::string pathname(path);
+  if (starts_with(pathname, SIM_PREFIX)) {
+    pathname = pathname.substr(strlen(SIM_PREFIX));
+  }
+  if (pathname.empty()) {
+    return working_dir_;
+  } else if (pathname[0] == '/') {
+    return fs_.real_dir(pathname);
+  } else {
+    return fs_.real_dir(working_dir_ + '/' + pathname);
+  }
+}
+
+void SimFS::delay(size_t rounds, size_t length) {
+  size_t delay_us = rounds*latency_us_;
+  if (bandwidth_) {
+    delay_us += (length*1000000ul)/bandwidth_;
+  }
+  if (delay_us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+  }
+}
+
+std::string SimFS::current_dir() {
+  return working_dir_;
+}
+
+int SimFS::set_working_dir(const std::string& dir) {
+  working_dir_ = get_path(dir);
+  return TILEDB_FS_OK;
+}
+
+bool SimFS::is_dir(const std::string& dir) {
+  metadata_requests++;
+  delay(1, 0);
+  return fs_.is_dir(get_path(dir));
+}
+
+bool SimFS::is_file(const std::string& file) {
+  metadata_requests++;
+  delay(1, 0);
+  return fs_.is_file(get_path(file));
+}
+
+std::string SimFS::real_dir(const std::string& dir) {
+  return get_path(dir);
+}
+
+int SimFS::create_dir(const std::string& dir) {
+  metadata_requests++;
+  delay(1, 0);
+  return fs_.create_dir(get_path(dir));
+}
+
+int SimFS::delete_dir(const std::string& dir) {
+  metadata_requests++;
+  delay(1, 0);
+  return fs_.delete_dir(get_path(dir));
+}
+
+std::vector<std::string> SimFS::get_dirs(const std::string& dir) {
+  metadata_requests++;
+  delay(1, 0);
+  return fs_.get_dirs(get_path(dir));
+}
+
+std::vector<std::string> SimFS::get_files(const std::string& dir) {
+  metadata_requests++;
+  delay(1, 0);
+  return fs_.get_files(get_path(dir));
+}
+
+int SimFS::create_file(const std::string& filename, int flags, mode_t mode) {
+  metadata_requests++;
+  delay(1, 0);
+  return fs_.create_file(get_path(filename), flags, mode);
+}
+
+int SimFS::delete_file(const std::string& filename) {
+  metadata_requests++;
+  delay(1, 0);
+  return fs_.delete_file(get_path(filename));
+}
+
+ssize_t SimFS::file_size(const std::string& filename) {
+  metadata_requests++;
+  delay(1, 0);
+  return fs_.file_size(get_path(filename));
+}
+
+int SimFS::read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length) {
+  read_requests++;
+  bytes_read += length;
+  delay(1, length);
+  return fs_.read_from_file(get_path(filename), offset, buffer, length);
+}
+
+int SimFS::write_to_file(const std::string& filename, const void *buffer, size_t buffer_size) {
+  write_requests++;
+  bytes_written += buffer_size;
+  delay(1, buffer_size);
+  return fs_.write_to_file(get_path(filename), buffer, buffer_size);
+}
+
+int SimFS::read_from_file_v(const std::vector<StorageFSRead>& reads) {
+  std::vector<StorageFSRead> local_reads;
+  size_t length = 0;
+  for (auto& read : reads) {
+    if (read.length == 0) continue; // Nothing to read
+    local_reads.push_back({get_path(read.filename), read.offset, read.buffer, read.length});
+    length += read.length;
+  }
+  read_requests += local_reads.size();
+  bytes_read += length;
+  delay((local_reads.size()+concurrency_-1)/concurrency_, length);
+  return fs_.read_from_file_v(local_reads);
+}
+
+int SimFS::move_path(const std::string& old_path, const std::string& new_path) {
+  metadata_requests++;
+  delay(1, 0);
+  return fs_.move_path(get_path(old_path), get_path(new_path));
+}
+
+int SimFS::sync_path(const std::string& path) {
+  return fs_.sync_path(get_path(path));
+}
+
+int SimFS::close_file(const std::string& filename) {
+  return fs_.close_file(get_path(filename));
+}
+
+SimFSStats SimFS::stats() {
+  return {metadata_requests, read_requests, write_requests, bytes_read, bytes_written};
+}
+
+void SimFS::reset_stats() {
+  metadata_requests = 0;
+  read_requests = 0;
+  write_requests = 0;
+  bytes_read = 0;
+  bytes_written = 0;
+}
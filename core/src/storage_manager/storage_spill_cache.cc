@@ -0,0 +1,461 @@
+/**
+ * @file storage_spill_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements the SpillCacheFS class.
+ */
+
+#include "storage_spill_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <sstream>
+#include <sys/stat.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+/** Identifies the layout of a cache entry file. */
+#define SPILL_CACHE_MAGIC "TDBSPIL1"
+
+/**
+ * Each cache entry file starts with this header followed by the key and the
+ * cached bytes.
+ */
+typedef struct SpillCacheHeader {
+  char magic[8];
+  int64_t file_size;
+  uint64_t length;
+  uint32_t key_length;
+} SpillCacheHeader;
+
+static int write_all(int fd, const void *buffer, size_t length) {
+  const char *pbuf = static_cast<const char *>(buffer);
+  while (length) {
+    ssize_t bytes_written = write(fd, pbuf, length);
+    if (bytes_written < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+    pbuf += bytes_written;
+    length -= bytes_written;
+  }
+  return 0;
+}
+
+static int pread_all(int fd, void *buffer, size_t length, off_t offset) {
+  char *pbuf = static_cast<char *>(buffer);
+  while (length) {
+    ssize_t bytes_read = pread(fd, pbuf, length, offset);
+    if (bytes_read < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    } else if (bytes_read == 0) {
+      return -1;
+    }
+    pbuf += bytes_read;
+    length -= bytes_read;
+    offset += bytes_read;
+  }
+  return 0;
+}
+
+SpillCacheFS::SpillCacheFS(StorageFS* fs, const std::string& cache_dir, size_t max_size) {
+  fs_ = fs;
+  cache_dir_ = local_fs_.real_dir(cache_dir);
+  max_size_ = max_size;
+
+  if (!local_fs_.is_dir(cache_dir_) && local_fs_.create_dir(cache_dir_)) {
+    throw std::system_error(EIO, std::generic_category(), "Could not create spill cache dir " + cache_dir_);
+  }
+
+  // Keep the tuning of the wrapped filesystem
+  download_buffer_size_ = fs_->get_download_buffer_size();
+  download_cache_size_ = fs_->get_download_cache_size();
+  upload_buffer_size_ = fs_->get_upload_buffer_size();
+  upload_queue_depth_ = fs_->get_upload_queue_depth();
+  coalesce_max_gap_ = fs_->get_coalesce_max_gap();
+  coalesce_max_size_ = fs_->get_coalesce_max_size();
+
+  load_entries();
+}
+
+SpillCacheFS::~SpillCacheFS() {
+  delete fs_;
+}
+
+std::string SpillCacheFS::current_dir() {
+  return fs_->current_dir();
+}
+
+int SpillCacheFS::set_working_dir(const std::string& dir) {
+  return fs_->set_working_dir(dir);
+}
+
+bool SpillCacheFS::is_dir(const std::string& dir) {
+  return fs_->is_dir(dir);
+}
+
+bool SpillCacheFS::is_file(const std::string& file) {
+  return fs_->is_file(file);
+}
+
+std::string SpillCacheFS::real_dir(const std::string& dir) {
+  return fs_->real_dir(dir);
+}
+
+int SpillCacheFS::create_dir(const std::string& dir) {
+  return fs_->create_dir(dir);
+}
+
+int SpillCacheFS::delete_dir(const std::string& dir) {
+  invalidate(slashify(dir));
+  return fs_->delete_dir(dir);
+}
+
+std::vector<std::string> SpillCacheFS::get_dirs(const std::string& dir) {
+  return fs_->get_dirs(dir);
+}
+
+std::vector<std::string> SpillCacheFS::get_files(const std::string& dir) {
+  return fs_->get_files(dir);
+}
+
+int SpillCacheFS::create_file(const std::string& filename, int flags, mode_t mode) {
+  invalidate(filename);
+  return fs_->create_file(filename, flags, mode);
+}
+
+int SpillCacheFS::delete_file(const std::string& filename) {
+  invalidate(filename);
+  return fs_->delete_file(filename);
+}
+
+ssize_t SpillCacheFS::file_size(const std::string& filename) {
+  return fs_->file_size(filename);
+}
+
+int SpillCacheFS::read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length) {
+  if (length == 0 || get(filename, offset, buffer, length)) {
+    return TILEDB_FS_OK;
+  }
+  int rc = fs_->read_from_file(filename, offset, buffer, length);
+  if (rc == TILEDB_FS_OK) {
+    put(filename, offset, buffer, length);
+  }
+  return rc;
+}
+
+int SpillCacheFS::write_to_file(const std::string& filename, const void *buffer, size_t buffer_size) {
+  invalidate(filename);
+  return fs_->write_to_file(filename, buffer, buffer_size);
+}
+
+int SpillCacheFS::read_from_file_v(const std::vector<StorageFSRead>& reads) {
+  std::vector<StorageFSRead> missed;
+  for (auto& read : reads) {
+    if (read.length && !get(read.filename, read.offset, read.buffer, read.length)) {
+      missed.push_back(read);
+    }
+  }
+  if (missed.empty()) {
+    return TILEDB_FS_OK;
+  }
+  int rc = fs_->read_from_file_v(missed);
+  if (rc == TILEDB_FS_OK) {
+    for (auto& read : missed) {
+      put(read.filename, read.offset, read.buffer, read.length);
+    }
+  }
+  return rc;
+}
+
+int SpillCacheFS::move_path(const std::string& old_path, const std::string& new_path) {
+  invalidate(old_path);
+  invalidate(new_path);
+  return fs_->move_path(old_path, new_path);
+}
+
+int SpillCacheFS::sync_path(const std::string& path) {
+  return fs_->sync_path(path);
+}
+
+int SpillCacheFS::close_file(const std::string& filename) {
+  // Validate the cached ranges against the wrapped filesystem again when the
+  // file is next opened, it may have been rewritten by others meanwhile
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    file_sizes_.erase(filename);
+  }
+  return fs_->close_file(filename);
+}
+
+bool SpillCacheFS::locking_support() {
+  return fs_->locking_support();
+}
+
+StorageFS* SpillCacheFS::filesystem() const {
+  return fs_;
+}
+
+size_t SpillCacheFS::size() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return size_;
+}
+
+size_t SpillCacheFS::hits() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return hits_;
+}
+
+size_t SpillCacheFS::misses() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return misses_;
+}
+
+/* ****************************** */
+/*         PRIVATE METHODS        */
+/* ****************************** */
+
+std::string SpillCacheFS::key(const std::string& filename, off_t offset, size_t length) const {
+  return filename + "@" + std::to_string(offset) + "+" + std::to_string(length);
+}
+
+std::string SpillCacheFS::entry_name(const std::string& key) const {
+  std::stringstream ss;
+  ss << std::hex << std::hash<std::string>()(key);
+  return ss.str();
+}
+
+std::string SpillCacheFS::entry_path(const std::string& name) const {
+  return cache_dir_ + "/" + name;
+}
+
+void SpillCacheFS::load_entries() {
+  std::vector<std::pair<time_t, SpillCacheEntry>> entries;
+  for (auto& path : local_fs_.get_files(cache_dir_)) {
+    std::string name = path.substr(path.find_last_of('/')+1);
+    if (name.find('.') != std::string::npos) {
+      // Skip entries still being written by others
+      continue;
+    }
+    SpillCacheHeader header;
+    struct stat st;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      continue;
+    }
+    bool valid = fstat(fd, &st) == 0
+        && pread_all(fd, &header, sizeof(SpillCacheHeader), 0) == 0
+        && memcmp(header.magic, SPILL_CACHE_MAGIC, sizeof(header.magic)) == 0
+        && (size_t)st.st_size == sizeof(SpillCacheHeader) + header.key_length + header.length;
+    SpillCacheEntry entry;
+    if (valid) {
+      entry.key.resize(header.key_length);
+      valid = pread_all(fd, &entry.key[0], header.key_length, sizeof(SpillCacheHeader)) == 0
+          && entry_name(entry.key) == name;
+    }
+    close(fd);
+    if (!valid) {
+      unlink(path.c_str());
+      continue;
+    }
+    entry.name = name;
+    entry.file_size = header.file_size;
+    entry.length = header.length;
+    entries.push_back(std::make_pair(st.st_mtime, entry));
+  }
+
+  // Most recently written entries first
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const std::pair<time_t, SpillCacheEntry>& a, const std::pair<time_t, SpillCacheEntry>& b) {
+                     return a.first > b.first;
+                   });
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (auto& entry : entries) {
+    lru_.push_back(entry.second);
+    entries_[entry.second.name] = std::prev(lru_.end());
+    size_ += entry.second.length;
+  }
+  while (size_ > max_size_) {
+    evict(std::prev(lru_.end()));
+  }
+}
+
+ssize_t SpillCacheFS::validated_file_size(const std::string& filename) {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto search = file_sizes_.find(filename);
+    if (search != file_sizes_.end()) {
+      return search->second;
+    }
+  }
+  ssize_t size = fs_->file_size(filename);
+  if (size >= 0) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    file_sizes_[filename] = size;
+  }
+  return size;
+}
+
+bool SpillCacheFS::get(const std::string& filename, off_t offset, void *buffer, size_t length) {
+  std::string key = this->key(filename, offset, length);
+  std::string name = entry_name(key);
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto search = entries_.find(name);
+    if (search == entries_.end() || search->second->key != key) {
+      misses_++;
+      return false;
+    }
+  }
+
+  // Only validate files with cached ranges against the wrapped filesystem
+  ssize_t file_size = validated_file_size(filename);
+
+  size_t header_size = 0;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto search = entries_.find(name);
+    if (search == entries_.end() || search->second->key != key) {
+      misses_++;
+      return false;
+    }
+    if (search->second->file_size != file_size) {
+      evict(search->second);
+      misses_++;
+      return false;
+    }
+    lru_.splice(lru_.begin(), lru_, search->second);
+    header_size = sizeof(SpillCacheHeader) + key.size();
+  }
+
+  int fd = open(entry_path(name).c_str(), O_RDONLY);
+  bool found = fd >= 0 && pread_all(fd, buffer, length, header_size) == 0;
+  if (fd >= 0) {
+    close(fd);
+  }
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (found) {
+    hits_++;
+  } else {
+    // Evicted meanwhile, possibly by another process sharing cache_dir
+    auto search = entries_.find(name);
+    if (search != entries_.end() && search->second->key == key) {
+      evict(search->second);
+    }
+    misses_++;
+  }
+  return found;
+}
+
+void SpillCacheFS::put(const std::string& filename, off_t offset, const void *buffer, size_t length) {
+  if (length > max_size_) {
+    return;
+  }
+  ssize_t file_size = validated_file_size(filename);
+  if (file_size < 0) {
+    return;
+  }
+
+  SpillCacheEntry entry;
+  entry.key = key(filename, offset, length);
+  entry.name = entry_name(entry.key);
+  entry.file_size = file_size;
+  entry.length = length;
+
+  SpillCacheHeader header;
+  memcpy(header.magic, SPILL_CACHE_MAGIC, sizeof(header.magic));
+  header.file_size = file_size;
+  header.length = length;
+  header.key_length = entry.key.size();
+
+  // Write to a temporary file first, so readers never see a partial entry
+  std::stringstream tmp_name;
+  tmp_name << entry.name << "." << getpid() << "." << std::hash<std::thread::id>()(std::this_thread::get_id());
+  std::string tmp_path = entry_path(tmp_name.str());
+  int fd = open(tmp_path.c_str(), O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR);
+  if (fd < 0) {
+    return;
+  }
+  bool written = write_all(fd, &header, sizeof(SpillCacheHeader)) == 0
+      && write_all(fd, entry.key.data(), entry.key.size()) == 0
+      && write_all(fd, buffer, length) == 0;
+  if (close(fd) || !written || rename(tmp_path.c_str(), entry_path(entry.name).c_str())) {
+    unlink(tmp_path.c_str());
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto search = entries_.find(entry.name);
+  if (search != entries_.end()) {
+    // The entry file was just replaced, only drop it from the index
+    size_ -= search->second->length;
+    lru_.erase(search->second);
+    entries_.erase(search);
+  }
+  lru_.push_front(entry);
+  entries_[entry.name] = lru_.begin();
+  size_ += length;
+  while (size_ > max_size_) {
+    evict(std::prev(lru_.end()));
+  }
+}
+
+void SpillCacheFS::invalidate(const std::string& path) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto matches = [&path](const std::string& filename) {
+    return filename.compare(0, path.size(), path) == 0
+        && (filename.size() == path.size() || path.back() == '/' || filename[path.size()] == '/' || filename[path.size()] == '@');
+  };
+  for (auto it = file_sizes_.begin(); it != file_sizes_.end();) {
+    if (matches(it->first)) {
+      it = file_sizes_.erase(it);
+    } else {
+      it++;
+    }
+  }
+  for (auto it = lru_.begin(); it != lru_.end();) {
+    auto next = std::next(it);
+    if (matches(it->key)) {
+      evict(it);
+    }
+    it = next;
+  }
+}
+
+void SpillCacheFS::evict(entry_list_t::iterator it) {
+  // Called with mtx_ held
+  unlink(entry_path(it->name).c_str());
+  size_ -= it->length;
+  entries_.erase(it->name);
+  lru_.erase(it);
+}
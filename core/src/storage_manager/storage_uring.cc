@@ -0,0 +1,281 @@
+/**
+ * @file storage_uring.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements the URing class.
+ */
+
+#include "storage_uring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <unistd.h>
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+URing::URing(unsigned queue_depth) {
+#ifdef HAVE_IO_URING
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(struct io_uring_params));
+  ring_fd_ = syscall(__NR_io_uring_setup, queue_depth, &params);
+  if (ring_fd_ < 0) {
+    // Kernel is too old or io_uring is disabled, e.g. by seccomp
+    ring_fd_ = -1;
+    return;
+  }
+  sq_entries_ = params.sq_entries;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries*sizeof(struct io_uring_cqe);
+  bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+  single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+#endif
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+
+  sq_ptr_ = mmap(NULL, sq_ring_size_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ptr_ == MAP_FAILED) {
+    sq_ptr_ = NULL;
+    teardown();
+    return;
+  }
+  if (single_mmap) {
+    cq_ptr_ = sq_ptr_;
+  } else {
+    cq_ptr_ = mmap(NULL, cq_ring_size_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ptr_ == MAP_FAILED) {
+      cq_ptr_ = NULL;
+      teardown();
+      return;
+    }
+  }
+  sqes_size_ = params.sq_entries*sizeof(struct io_uring_sqe);
+  sqes_ = mmap(NULL, sqes_size_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = NULL;
+    teardown();
+    return;
+  }
+
+  char *sq = static_cast<char *>(sq_ptr_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  char *cq = static_cast<char *>(cq_ptr_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+#endif
+}
+
+URing::~URing() {
+  teardown();
+}
+
+void URing::teardown() {
+#ifdef HAVE_IO_URING
+  if (sqes_) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = NULL;
+  }
+  if (cq_ptr_ && cq_ptr_ != sq_ptr_) {
+    munmap(cq_ptr_, cq_ring_size_);
+  }
+  cq_ptr_ = NULL;
+  if (sq_ptr_) {
+    munmap(sq_ptr_, sq_ring_size_);
+    sq_ptr_ = NULL;
+  }
+#endif
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+    ring_fd_ = -1;
+  }
+}
+
+bool URing::is_supported() const {
+  return ring_fd_ >= 0;
+}
+
+uint64_t URing::ring_read_num() const {
+  return ring_read_num_;
+}
+
+int URing::pread_all(const URingRead& read) {
+  size_t nbytes = 0;
+  char *pbuf = reinterpret_cast<char *>(read.buffer);
+  while (nbytes < read.length) {
+    ssize_t bytes_read = pread(read.fd, pbuf+nbytes, read.length-nbytes, read.offset+nbytes);
+    if (bytes_read < 0) {
+      if (errno == EINTR) continue;
+      return errno;
+    } else if (bytes_read == 0) {
+      return -1;
+    }
+    nbytes += bytes_read;
+  }
+  return 0;
+}
+
+int URing::read(const std::vector<URingRead>& reads, size_t& failed) {
+  std::deque<size_t> queue;
+  for (auto i=0ul; i<reads.size(); i++) {
+    if (reads[i].length) queue.push_back(i);
+  }
+
+  int rc = 0;
+#ifdef HAVE_IO_URING
+  std::vector<size_t> nbytes(reads.size(), 0);
+  std::vector<struct iovec> iovecs(reads.size());
+  struct io_uring_sqe *sqes = static_cast<struct io_uring_sqe *>(sqes_);
+  struct io_uring_cqe *cqes = static_cast<struct io_uring_cqe *>(cqes_);
+  unsigned in_flight = 0;
+
+  // Reaps the completions, queueing interrupted and short reads again
+  auto reap = [&]() {
+    unsigned head = *cq_head_;
+    while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      struct io_uring_cqe *cqe = &cqes[head & *cq_mask_];
+      size_t i = cqe->user_data;
+      int res = cqe->res;
+      head++;
+      in_flight--;
+      if (res == -EINTR || res == -EAGAIN) {
+        queue.push_front(i);
+      } else if (res < 0) {
+        if (rc == 0) {
+          rc = -res;
+          failed = i;
+        }
+      } else if (res == 0) {
+        if (rc == 0) {
+          rc = -1;
+          failed = i;
+        }
+      } else {
+        ring_read_num_++;
+        nbytes[i] += res;
+        if (nbytes[i] < reads[i].length) queue.push_front(i);
+      }
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  };
+
+  while (is_supported()) {
+    // Fill the submission queue, only this thread produces entries
+    unsigned tail = *sq_tail_;
+    unsigned unsubmitted = tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    while (rc == 0 && !queue.empty() && in_flight+unsubmitted < sq_entries_) {
+      size_t i = queue.front();
+      queue.pop_front();
+      iovecs[i].iov_base = static_cast<char *>(reads[i].buffer) + nbytes[i];
+      iovecs[i].iov_len = reads[i].length - nbytes[i];
+      unsigned index = tail & *sq_mask_;
+      struct io_uring_sqe *sqe = &sqes[index];
+      memset(sqe, 0, sizeof(struct io_uring_sqe));
+      sqe->opcode = IORING_OP_READV;
+      sqe->fd = reads[i].fd;
+      sqe->off = reads[i].offset + nbytes[i];
+      sqe->addr = reinterpret_cast<unsigned long>(&iovecs[i]);
+      sqe->len = 1;
+      sqe->user_data = i;
+      sq_array_[index] = index;
+      tail++;
+      unsubmitted++;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    if (in_flight+unsubmitted == 0) {
+      break;
+    }
+
+    // Submit and wait for at least one completion
+    int submitted = syscall(__NR_io_uring_enter, ring_fd_, unsubmitted, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+    if (submitted < 0) {
+      if (errno == EINTR || ((errno == EAGAIN || errno == EBUSY) && in_flight)) {
+        continue;
+      }
+
+      // Cannot use this ring, take back the unsubmitted entries for pread
+      unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+      for (unsigned j=head; j!=tail; j++) {
+        size_t i = sqes[j & *sq_mask_].user_data;
+        queue.push_front(i);
+      }
+      __atomic_store_n(sq_tail_, head, __ATOMIC_RELEASE);
+
+      // The kernel owns the buffers and iovecs of the reads in flight until
+      // they complete, so wait for them. Poll the completion queue if even
+      // waiting fails.
+      while (in_flight) {
+        if (syscall(__NR_io_uring_enter, ring_fd_, 0, in_flight, IORING_ENTER_GETEVENTS, NULL, 0) < 0
+            && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+          usleep(100);
+        }
+        reap();
+      }
+
+      teardown();
+      for (auto& i : queue) {
+        URingRead remaining = reads[i];
+        remaining.buffer = static_cast<char *>(remaining.buffer) + nbytes[i];
+        remaining.offset += nbytes[i];
+        remaining.length -= nbytes[i];
+        if (rc == 0 && (rc = pread_all(remaining))) failed = i;
+      }
+      return rc;
+    }
+    in_flight += submitted;
+
+    reap();
+  }
+
+  if (is_supported()) {
+    return rc;
+  }
+#endif
+
+  for (auto i : queue) {
+    if ((rc = pread_all(reads[i]))) {
+      failed = i;
+      return rc;
+    }
+  }
+  return rc;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file storage_write_session.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements the WriteSession class.
+ */
+
+#include "storage_write_session.h"
+#include "error.h"
+#include "storage_fs.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <fcntl.h>
+#include <limits>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SESSION_ERROR(MSG, PATH) SYSTEM_ERROR(TILEDB_FS_ERRMSG, MSG, PATH, tiledb_fs_errmsg)
+
+static int sync_data(int fd) {
+#ifdef __APPLE__
+  return fsync(fd);
+#else
+  return fdatasync(fd);
+#endif
+}
+
+WriteSession::WriteSession() {
+}
+
+WriteSession::~WriteSession() {
+  for (auto& it : files_) {
+    ::close(it.second.fd);
+  }
+}
+
+void WriteSession::set_size_hint(const std::string& filename, size_t size) {
+  size_hints_[filename] = size;
+}
+
+int WriteSession::open(const std::string& filename, File*& file) {
+  auto search = files_.find(filename);
+  if (search != files_.end()) {
+    file = &search->second;
+    return TILEDB_FS_OK;
+  }
+
+  reset_errno();
+  int fd = ::open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT, S_IRWXU);
+  if (fd == -1) {
+    SESSION_ERROR("Cannot write to file; File opening error", filename);
+    return TILEDB_FS_ERR;
+  }
+  struct stat st;
+  if (fstat(fd, &st)) {
+    SESSION_ERROR("Cannot write to file; File stat error", filename);
+    ::close(fd);
+    return TILEDB_FS_ERR;
+  }
+  file = &files_.emplace(filename, File{ fd, st.st_size, st.st_size }).first->second;
+  return TILEDB_FS_OK;
+}
+
+void WriteSession::preallocate(const std::string& filename, File& file, size_t length) {
+  if (file.size + (off_t)length <= file.allocated) {
+    return;
+  }
+#ifdef FALLOC_FL_KEEP_SIZE
+  // Grow by the expected size of the next writes, at least doubling
+  size_t size_hint = 0;
+  auto search = size_hints_.find(filename);
+  if (search != size_hints_.end()) {
+    size_hint = search->second;
+  }
+  size_t extend = std::max(std::max(length, size_hint), (size_t)file.allocated);
+  extend = std::min(std::max(extend, (size_t)TILEDB_WRITE_SESSION_MIN_PREALLOCATE), 
+                    (size_t)TILEDB_WRITE_SESSION_MAX_PREALLOCATE);
+  extend = std::max(extend, file.size + length - file.allocated);
+  // Keep the file size unchanged, so the file only ever shows written data
+  if (fallocate(file.fd, FALLOC_FL_KEEP_SIZE, file.allocated, extend) == 0) {
+    file.allocated += extend;
+    ++preallocations_;
+    return;
+  }
+  reset_errno();
+#endif
+  // Preallocation is not supported, do not try again for this file
+  file.allocated = std::numeric_limits<off_t>::max();
+}
+
+int WriteSession::write(const std::string& filename, const void *buffer, size_t length) {
+  if (length == 0) {
+    return TILEDB_FS_OK;
+  }
+
+  File *file;
+  if (open(filename, file) != TILEDB_FS_OK) {
+    return TILEDB_FS_ERR;
+  }
+  preallocate(filename, *file, length);
+
+  // Write in batches of TILEDB_UT_MAX_WRITE_COUNT
+  reset_errno();
+  size_t nbytes = 0;
+  const char *pbuf = reinterpret_cast<const char *>(buffer);
+  while (nbytes < length) {
+    size_t count = std::min(length - nbytes, (size_t)TILEDB_UT_MAX_WRITE_COUNT);
+    ssize_t bytes_written = ::write(file->fd, pbuf + nbytes, count);
+    if (bytes_written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      SESSION_ERROR("Cannot write to file; File writing error", filename);
+      return TILEDB_FS_ERR;
+    }
+    nbytes += bytes_written;
+  }
+  file->size += length;
+
+  return TILEDB_FS_OK;
+}
+
+bool WriteSession::is_open(const std::string& filename) const {
+  return files_.find(filename) != files_.end();
+}
+
+int WriteSession::sync(const std::string& filename) {
+  auto search = files_.find(filename);
+  if (search == files_.end()) {
+    return TILEDB_FS_OK;
+  }
+  reset_errno();
+  if (sync_data(search->second.fd) && errno != EINVAL) {
+    SESSION_ERROR("Cannot sync file; File syncing error", filename);
+    return TILEDB_FS_ERR;
+  }
+  return TILEDB_FS_OK;
+}
+
+int WriteSession::close() {
+  int rc = TILEDB_FS_OK;
+  for (auto& it : files_) {
+    const std::string& filename = it.first;
+    File& file = it.second;
+    reset_errno();
+    if (file.allocated > file.size && file.allocated != std::numeric_limits<off_t>::max() &&
+        ftruncate(file.fd, file.size)) {
+      SESSION_ERROR("Cannot release preallocated blocks of file", filename);
+      rc = TILEDB_FS_ERR;
+    }
+    if (::close(file.fd)) {
+      SESSION_ERROR("Cannot close file; File closing error", filename);
+      rc = TILEDB_FS_ERR;
+    }
+  }
+  files_.clear();
+  return rc;
+}
+
+size_t WriteSession::preallocations() const {
+  return preallocations_;
+}
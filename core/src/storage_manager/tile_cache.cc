@@ -0,0 +1,110 @@
+/**
+ * @file tile_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class TileCache.
+ */
+
+#include "tile_cache.h"
+
+#include <cstring>
+
+TileCache::TileCache(size_t capacity) {
+  capacity_ = capacity;
+}
+
+std::string TileCache::key(const std::string& fragment_name, int attribute_id, int64_t tile_i, bool is_var) {
+  return fragment_name + (is_var ? "/v" : "/f") + std::to_string(attribute_id) + "/" + std::to_string(tile_i);
+}
+
+bool TileCache::get(const std::string& key, void* buffer, size_t size) {
+  std::shared_ptr<std::vector<char>> tile;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto search = map_.find(key);
+    if (search == map_.end() || search->second->second->size() != size) {
+      misses_++;
+      return false;
+    }
+    lru_.splice(lru_.begin(), lru_, search->second);
+    tile = search->second->second;
+    hits_++;
+  }
+  // Copy outside the lock, the tile stays alive even if evicted meanwhile
+  memcpy(buffer, tile->data(), size);
+  return true;
+}
+
+void TileCache::put(const std::string& key, const void* buffer, size_t size) {
+  if (size > capacity_) {
+    return;
+  }
+  auto tile = std::make_shared<std::vector<char>>(static_cast<const char*>(buffer), static_cast<const char*>(buffer)+size);
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto search = map_.find(key);
+  if (search != map_.end()) {
+    size_ -= search->second->second->size();
+    lru_.erase(search->second);
+    map_.erase(search);
+  }
+  while (size_+size > capacity_ && !lru_.empty()) {
+    size_ -= lru_.back().second->size();
+    map_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+  lru_.emplace_front(key, tile);
+  map_[key] = lru_.begin();
+  size_ += size;
+}
+
+void TileCache::clear() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  lru_.clear();
+  map_.clear();
+  size_ = 0;
+}
+
+size_t TileCache::capacity() const {
+  return capacity_;
+}
+
+size_t TileCache::size() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return size_;
+}
+
+size_t TileCache::hits() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return hits_;
+}
+
+size_t TileCache::misses() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return misses_;
+}
@@ -35,6 +35,7 @@
 #define TILEDB_TESTS_H
 
 #include "array_schema.h"
+#include "storage_sim.h"
 #include "tiledb.h"
 #include "tiledb_constants.h"
 #include "tiledb_storage.h"
@@ -68,6 +69,9 @@ class BenchmarkConfig: public TempDir {
           }
         }
       }
+      for (auto& array_name : array_names_) {
+        array_name = workspace_+"/"+array_name;
+      }
       CHECK(attributes_.size() == attribute_cell_val_nums_.size());
       CHECK(attributes_.size() == attribute_data_types_.size());
       // Add data and compression for coords
@@ -165,9 +169,12 @@ class BenchmarkConfig: public TempDir {
 
   bool do_benchmark_ = false;
   
+  std::string home_ = get_temp_dir();
   std::string workspace_ = get_temp_dir() + "/WORKSPACE";
+  bool simulate_cloud_ = false;
   std::vector<std::string> array_names_;
   int io_read_mode_ = TILEDB_IO_MMAP;
+  std::vector<int> compare_io_read_modes_;
   int io_write_mode_ = TILEDB_IO_WRITE;
   int array_read_mode_ = TILEDB_ARRAY_READ;
   int array_write_mode_ = TILEDB_ARRAY_WRITE;
@@ -204,10 +211,24 @@ class BenchmarkConfig: public TempDir {
       std::string token;
       if (name == "Array_Names") {
         parse_array_names(value);
+      } else if (name == "Simulate_Cloud") {
+        simulate_cloud_ = (std::stoi(value) != 0);
+        if (simulate_cloud_) {
+          home_ = "sim://" + get_temp_dir();
+          workspace_ = home_ + "/WORKSPACE";
+        }
+      } else if (name == "Sim_Latency_US") {
+        setenv("TILEDB_SIM_LATENCY_US", value.c_str(), 1);
+      } else if (name == "Sim_Bandwidth") {
+        setenv("TILEDB_SIM_BANDWIDTH", value.c_str(), 1);
+      } else if (name == "Sim_Concurrency") {
+        setenv("TILEDB_SIM_CONCURRENCY", value.c_str(), 1);
       } else if (name == "IO_Write_Mode") {
         io_write_mode_ = std::stoi(value);
       } else if (name == "IO_Read_Mode") {
         io_read_mode_ = std::stoi(value);
+      } else if (name == "Compare_IO_Read_Modes") {
+        parse_compression(compare_io_read_modes_, value);
       } else if (name == "Array_Write_Mode") {
         array_write_mode_ = std::stoi(value);
       } else if (name == "Array_Read_Mode") {
@@ -269,7 +290,7 @@ class BenchmarkConfig: public TempDir {
     std::stringstream value_stream(value);
     std::string token;
     while (getline(value_stream, token, ',')) {
-      array_names_.push_back(workspace_+"/"+token);
+      array_names_.push_back(token);
     }
   }
 
@@ -328,7 +349,7 @@ void create_workspace(BenchmarkConfig* config) {
   TileDB_CTX* tiledb_ctx;
   TileDB_Config tiledb_config;
   memset(&tiledb_config, 0, sizeof(TileDB_Config));
-  tiledb_config.home_ = config->get_temp_dir().c_str();
+  tiledb_config.home_ = config->home_.c_str();
   REQUIRE(tiledb_ctx_init(&tiledb_ctx, &tiledb_config) == TILEDB_OK);
   REQUIRE(tiledb_workspace_create(tiledb_ctx, config->workspace_.c_str()) == TILEDB_OK);
   std::cerr << "Workspace: " << config->workspace_ << "\n\n";
@@ -339,7 +360,7 @@ void delete_arrays(BenchmarkConfig* config) {
   TileDB_CTX* tiledb_ctx;
   TileDB_Config tiledb_config;
   memset(&tiledb_config, 0, sizeof(TileDB_Config));
-  tiledb_config.home_ = config->get_temp_dir().c_str();
+  tiledb_config.home_ = config->home_.c_str();
   REQUIRE(tiledb_ctx_init(&tiledb_ctx, &tiledb_config) == TILEDB_OK);
   for(auto dir : get_dirs(tiledb_ctx, config->workspace_)) {
     std::cerr<<"deleting "<< dir<<"\n";
@@ -374,7 +395,7 @@ void create_arrays(BenchmarkConfig* config, int i) {
   TileDB_CTX* tiledb_ctx;
   TileDB_Config tiledb_config;
   memset(&tiledb_config, 0, sizeof(TileDB_Config));
-  tiledb_config.home_ = config->get_temp_dir().c_str();
+  tiledb_config.home_ = config->home_.c_str();
   REQUIRE(tiledb_ctx_init(&tiledb_ctx, &tiledb_config) == TILEDB_OK);
   REQUIRE(tiledb_array_create(tiledb_ctx, &array_schema) == TILEDB_OK);
   CHECK(tiledb_array_free_schema(&array_schema) == TILEDB_OK);
@@ -385,7 +406,7 @@ void write_arrays(BenchmarkConfig* config, int i) {
   TileDB_CTX* tiledb_ctx;
   TileDB_Config tiledb_config;
   memset(&tiledb_config, 0, sizeof(TileDB_Config));
-  tiledb_config.home_ = config->get_temp_dir().c_str();
+  tiledb_config.home_ = config->home_.c_str();
   tiledb_config.write_method_ = config->io_write_mode_;
   REQUIRE(tiledb_ctx_init(&tiledb_ctx, &tiledb_config) == TILEDB_OK);
  
@@ -408,7 +429,7 @@ void read_arrays(BenchmarkConfig* config, int i) {
   TileDB_CTX* tiledb_ctx;
   TileDB_Config tiledb_config;
   memset(&tiledb_config, 0, sizeof(TileDB_Config));
-  tiledb_config.home_ = config->get_temp_dir().c_str();
+  tiledb_config.home_ = config->home_.c_str();
   tiledb_config.read_method_ = config->io_read_mode_;
   REQUIRE(tiledb_ctx_init(&tiledb_ctx, &tiledb_config) == TILEDB_OK);
  
@@ -431,6 +452,18 @@ void read_arrays(BenchmarkConfig* config, int i) {
   CHECK(tiledb_ctx_finalize(tiledb_ctx) == TILEDB_OK);
 }
 
+// Requests issued to the simulated cloud storage since the last call
+void print_sim_stats(BenchmarkConfig* config, const std::string& phase) {
+  if (!config->simulate_cloud_) {
+    return;
+  }
+  auto stats = SimFS::stats();
+  std::cerr << phase << " simulated cloud requests: metadata=" << stats.metadata_requests
+            << " read=" << stats.read_requests << " write=" << stats.write_requests
+            << " bytes_read=" << stats.bytes_read << " bytes_written=" << stats.bytes_written << std::endl;
+  SimFS::reset_stats();
+}
+
 // Benchmark Filesystem Stat Utils
 std::string get_io_write_mode(int mode) {
   switch(mode) {
@@ -448,6 +481,10 @@ std::string get_io_read_mode(int mode) {
       return "TILEDB_IO_MMAP";
     case 1:
       return "TILEDB_IO_READ";
+    case 2:
+      return "TILEDB_IO_MPI";
+    case 3:
+      return "TILEDB_IO_URING";
     default:
       std::cerr << "TILEDB_IO_MODE=" << std::to_string(mode) << "not recognized\n";
       return "";
@@ -557,7 +594,7 @@ void print_fragment_sizes(BenchmarkConfig* config, bool human_readable_sizes) {
   TileDB_CTX* tiledb_ctx;
   TileDB_Config tiledb_config;
   memset(&tiledb_config, 0, sizeof(TileDB_Config));
-  tiledb_config.home_ = config->get_temp_dir().c_str();
+  tiledb_config.home_ = config->home_.c_str();
   REQUIRE(tiledb_ctx_init(&tiledb_ctx, &tiledb_config) == TILEDB_OK);
 
   bool is_printed = false;
@@ -146,6 +146,21 @@ class SparseArrayTestFixture : TempDir {
       const int64_t domain_size_0,
       const int64_t domain_size_1);
 
+  /**
+   * Same cell values as write_sparse_array_unsorted_2D, but every row is
+   * written as a separate fragment.
+   * 
+   * @param domain_size_0 The domain size of the first dimension.
+   * @param domain_size_1 The domain size of the second dimension.
+   * @param fragment_num If positive, row i is written to fragment
+   *     i%fragment_num instead, so that the fragments interleave.
+   * @return TILEDB_OK on success and TILEDB_ERR on error.
+   */
+  int write_sparse_array_fragments_2D(
+      const int64_t domain_size_0,
+      const int64_t domain_size_1,
+      const int64_t fragment_num = 0);
+
 
 
 
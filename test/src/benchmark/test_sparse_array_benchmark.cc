@@ -61,6 +61,7 @@ TEST_CASE_METHOD(BenchmarkConfig, "Benchmark sparse array", "[benchmark_sparse]"
     threads[i].join();
   }
   std::cout << "Create arrays elapsed time = " << t.getElapsedMilliseconds() << "ms" << std::endl;
+  print_sim_stats(this, "Create");
 
   // Write Arrays
   std::cout << "\nNumber of cells to write= " << std::to_string(num_cells_to_write_) << std::endl;
@@ -86,6 +87,7 @@ TEST_CASE_METHOD(BenchmarkConfig, "Benchmark sparse array", "[benchmark_sparse]"
   if (fragments_per_array_ > 1) {
     std::cout << "             mean time = " << total_elapsed_time/fragments_per_array_ << "ms" << std::endl;
   }
+  print_sim_stats(this, "Write");
 
   // Read Arrays
   std::cout << "\nNumber of cells to write= " << std::to_string(num_cells_to_read_) << std::endl;
@@ -101,7 +103,27 @@ TEST_CASE_METHOD(BenchmarkConfig, "Benchmark sparse array", "[benchmark_sparse]"
   std::cerr << "Read I/O Mode=" << get_io_read_mode(io_read_mode_) << std::endl;
   std::cerr << "Read Mode=" << get_array_mode(array_read_mode_) << std::endl;
   std::cout << "Read arrays elapsed time = " << t.getElapsedMilliseconds() << "ms" << std::endl;
+  print_sim_stats(this, "Read");
   free_buffers();
+
+  // Compare read methods, e.g. TILEDB_IO_READ vs TILEDB_IO_URING
+  for (auto io_read_mode : compare_io_read_modes_) {
+    io_read_mode_ = io_read_mode;
+    threads.clear();
+    create_buffers(false);
+    t.start();
+    for (auto i=0ul; i<array_names_.size(); i++) {
+      std::thread thread_object(read_arrays, this, i);
+      threads.push_back(std::move(thread_object));
+    }
+    for (auto i=0ul; i<threads.size(); i++) {
+      threads[i].join();
+    }
+    std::cout << "Read arrays with I/O Mode=" << get_io_read_mode(io_read_mode_)
+              << " elapsed time = " << t.getElapsedMilliseconds() << "ms" << std::endl;
+    print_sim_stats(this, "Read");
+    free_buffers();
+  }
   
   print_fragment_sizes(this, human_readable_sizes_);
 }
@@ -34,11 +34,13 @@
 #include "catch.h"
 
 #include "c_api_sparse_array_spec.h"
+#include "book_keeping.h"
 #include "progress_bar.h"
 #include "storage_manager.h"
 #include "storage_posixfs.h"
 #include "utils.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <map>
@@ -495,6 +497,42 @@ int SparseArrayTestFixture::write_sparse_array_unsorted_2D(
   return TILEDB_OK;
 } 
 
+int SparseArrayTestFixture::write_sparse_array_fragments_2D(
+    const int64_t domain_size_0,
+    const int64_t domain_size_1,
+    const int64_t fragment_num) {
+  int64_t row_num = fragment_num > 0 ? (domain_size_0+fragment_num-1)/fragment_num : 1;
+  std::vector<int> buffer_a1(row_num*domain_size_1);
+  std::vector<int64_t> buffer_coords(2*row_num*domain_size_1);
+  for (int64_t f = 0; f < (fragment_num > 0 ? fragment_num : domain_size_0); ++f) {
+    // One fragment per row, or every fragment_num-th row per fragment
+    int64_t cell_num = 0;
+    for (int64_t i = f; i < domain_size_0; i += (fragment_num > 0 ? fragment_num : domain_size_0)) {
+      for (int64_t j = 0; j < domain_size_1; ++j) {
+        buffer_a1[cell_num] = i*domain_size_1+j;
+        buffer_coords[2*cell_num] = i;
+        buffer_coords[2*cell_num+1] = j;
+        ++cell_num;
+      }
+    }
+
+    TileDB_Array* tiledb_array;
+    if(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), TILEDB_ARRAY_WRITE_UNSORTED, NULL, NULL, 0) != TILEDB_OK)
+      return TILEDB_ERR;
+    const void* buffers[] = { buffer_a1.data(), buffer_coords.data() };
+    size_t buffer_sizes[] = { cell_num*sizeof(int), 2*cell_num*sizeof(int64_t) };
+    if(tiledb_array_write(tiledb_array, buffers, buffer_sizes) != TILEDB_OK) {
+      tiledb_array_finalize(tiledb_array);
+      return TILEDB_ERR;
+    }
+    if(tiledb_array_finalize(tiledb_array) != TILEDB_OK)
+      return TILEDB_ERR;
+  }
+
+  // Success
+  return TILEDB_OK;
+}
+
 TEST_CASE_METHOD(SparseArrayTestFixture, "Test sparse write with attribute types", "[test_sparse_1D_array]") {
   int rc;
 
@@ -642,6 +680,847 @@ TEST_CASE_METHOD(SparseArrayTestFixture, "Test random read subregions", "[test_r
   delete progress_bar;
 }
 
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test reading with io_uring", "[test_sparse_read_io_uring]") {
+  // Reinitialize context to read with TILEDB_IO_URING
+  CHECK_RC(tiledb_ctx_finalize(tiledb_ctx_), TILEDB_OK);
+  TileDB_Config tiledb_config;
+  memset(&tiledb_config, 0, sizeof(TileDB_Config));
+  tiledb_config.read_method_ = TILEDB_IO_URING;
+  CHECK_RC(tiledb_ctx_init(&tiledb_ctx_, &tiledb_config), TILEDB_OK);
+
+  int64_t domain_size_0 = 500;
+  int64_t domain_size_1 = 100;
+  set_array_name("sparse_test_io_uring_500x100_10x10");
+  CHECK_RC(create_sparse_array_2D(10, 10, 0, domain_size_0-1, 0, domain_size_1-1, 100, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK_RC(write_sparse_array_unsorted_2D(domain_size_0, domain_size_1), TILEDB_OK);
+
+  int64_t subarrays[][4] = { {0, domain_size_0-1, 0, domain_size_1-1}, {4, 123, 7, 58}, {250, 251, 99, 99} };
+  for(auto subarray : subarrays) {
+    int *buffer = read_sparse_array_2D(subarray[0], subarray[1], subarray[2], subarray[3], TILEDB_ARRAY_READ_SORTED_ROW);
+    REQUIRE(buffer != NULL);
+    int64_t index = 0;
+    for(int64_t i = subarray[0]; i <= subarray[1]; ++i) {
+      for(int64_t j = subarray[2]; j <= subarray[3]; ++j) {
+        CHECK(buffer[index++] == i*domain_size_1+j);
+      }
+    }
+    delete [] buffer;
+  }
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test coalescing tile reads", "[test_sparse_read_coalesced]") {
+  // Reinitialize context to read with TILEDB_IO_READ
+  CHECK_RC(tiledb_ctx_finalize(tiledb_ctx_), TILEDB_OK);
+  TileDB_Config tiledb_config;
+  memset(&tiledb_config, 0, sizeof(TileDB_Config));
+  tiledb_config.read_method_ = TILEDB_IO_READ;
+  CHECK_RC(tiledb_ctx_init(&tiledb_ctx_, &tiledb_config), TILEDB_OK);
+
+  int64_t domain_size_0 = 500;
+  int64_t domain_size_1 = 100;
+  set_array_name("sparse_test_coalesced_500x100_10x10");
+  CHECK_RC(create_sparse_array_2D(10, 10, 0, domain_size_0-1, 0, domain_size_1-1, 100, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK_RC(write_sparse_array_unsorted_2D(domain_size_0, domain_size_1), TILEDB_OK);
+
+  const int64_t subarray[] = { 4, 123, 7, 58 };
+  const char* attributes[] = { "ATTR_INT32" };
+  int64_t cell_num = (subarray[1]-subarray[0]+1)*(subarray[3]-subarray[2]+1);
+  std::vector<int> buffer_a1(cell_num);
+
+  for (auto coalesce : { false, true }) {
+    if (coalesce) {
+      CHECK(setenv("TILEDB_COALESCE_MAX_SIZE", "1048576", 1) == 0);
+    } else {
+      unsetenv("TILEDB_COALESCE_MAX_SIZE");
+    }
+
+    TileDB_Array* tiledb_array;
+    CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), TILEDB_ARRAY_READ_SORTED_ROW, subarray, attributes, 1), TILEDB_OK);
+    void* buffers[] = { buffer_a1.data() };
+    size_t buffer_sizes[] = { cell_num*sizeof(int) };
+    CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+    CHECK(buffer_sizes[0] == cell_num*sizeof(int));
+    int64_t index = 0;
+    for(int64_t i = subarray[0]; i <= subarray[1]; ++i) {
+      for(int64_t j = subarray[2]; j <= subarray[3]; ++j) {
+        CHECK(buffer_a1[index++] == i*domain_size_1+j);
+      }
+    }
+
+    size_t tile_reads, tile_io_reads;
+    CHECK_RC(tiledb_array_tile_read_counts(tiledb_array, &tile_reads, &tile_io_reads), TILEDB_OK);
+    CHECK(tile_reads > 0);
+    if (coalesce) {
+      CHECK(tile_io_reads < tile_reads);
+    } else {
+      CHECK(tile_io_reads == tile_reads);
+    }
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+  }
+
+  unsetenv("TILEDB_COALESCE_MAX_SIZE");
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test file size lookups are per file", "[test_sparse_read_file_size_lookups]") {
+  // Reinitialize context to read with TILEDB_IO_READ
+  CHECK_RC(tiledb_ctx_finalize(tiledb_ctx_), TILEDB_OK);
+  TileDB_Config tiledb_config;
+  memset(&tiledb_config, 0, sizeof(TileDB_Config));
+  tiledb_config.read_method_ = TILEDB_IO_READ;
+  CHECK_RC(tiledb_ctx_init(&tiledb_ctx_, &tiledb_config), TILEDB_OK);
+
+  int64_t domain_size_0 = 500;
+  int64_t domain_size_1 = 100;
+  set_array_name("sparse_test_file_size_lookups_500x100_10x10");
+  CHECK_RC(create_sparse_array_2D(10, 10, 0, domain_size_0-1, 0, domain_size_1-1, 100, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK_RC(write_sparse_array_unsorted_2D(domain_size_0, domain_size_1), TILEDB_OK);
+
+  const int64_t subarray[] = { 0, domain_size_0-1, 0, domain_size_1-1 };
+  const char* attributes[] = { "ATTR_INT32" };
+  int64_t cell_num = domain_size_0*domain_size_1;
+  std::vector<int> buffer_a1(cell_num);
+
+  for (auto mode : { TILEDB_ARRAY_READ, TILEDB_ARRAY_READ_SORTED_ROW }) {
+    TileDB_Array* tiledb_array;
+    CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), mode, subarray, attributes, 1), TILEDB_OK);
+    void* buffers[] = { buffer_a1.data() };
+    size_t buffer_sizes[] = { cell_num*sizeof(int) };
+    CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+    CHECK(buffer_sizes[0] == cell_num*sizeof(int));
+
+    // One fragment with an attribute and a coordinates file, read by the
+    // array and by its clone for sorted reads
+    size_t tile_reads, tile_io_reads, file_size_lookups;
+    CHECK_RC(tiledb_array_tile_read_counts(tiledb_array, &tile_reads, &tile_io_reads), TILEDB_OK);
+    CHECK_RC(tiledb_array_file_size_lookups(tiledb_array, &file_size_lookups), TILEDB_OK);
+    CHECK(tile_reads >= 500);
+    CHECK(file_size_lookups > 0);
+    CHECK(file_size_lookups <= 4);
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+  }
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test access pattern hints", "[test_sparse_read_access_hints]") {
+  // Reinitialize context to read with TILEDB_IO_READ
+  CHECK_RC(tiledb_ctx_finalize(tiledb_ctx_), TILEDB_OK);
+  TileDB_Config tiledb_config;
+  memset(&tiledb_config, 0, sizeof(TileDB_Config));
+  tiledb_config.read_method_ = TILEDB_IO_READ;
+  CHECK_RC(tiledb_ctx_init(&tiledb_ctx_, &tiledb_config), TILEDB_OK);
+
+  int64_t domain_size_0 = 500;
+  int64_t domain_size_1 = 100;
+  set_array_name("sparse_test_access_hints_500x100_10x10");
+  CHECK_RC(create_sparse_array_2D(10, 10, 0, domain_size_0-1, 0, domain_size_1-1, 100, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK_RC(write_sparse_array_unsorted_2D(domain_size_0, domain_size_1), TILEDB_OK);
+
+  const char* attributes[] = { "ATTR_INT32" };
+  std::vector<int> buffer_a1(domain_size_0*domain_size_1);
+
+  // Scans over many tiles are sequential and prefetch the tiles to be read,
+  // point lookups are random
+  const int64_t scan[] = { 0, domain_size_0-1, 0, domain_size_1-1 };
+  const int64_t lookup[] = { 4, 4, 7, 7 };
+  for (auto subarray : { scan, lookup }) {
+    bool is_scan = subarray == scan;
+    TileDB_Array* tiledb_array;
+    CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), TILEDB_ARRAY_READ, subarray, attributes, 1), TILEDB_OK);
+    void* buffers[] = { buffer_a1.data() };
+    size_t buffer_sizes[] = { buffer_a1.size()*sizeof(int) };
+    CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+    if (is_scan) {
+      CHECK(buffer_sizes[0] == buffer_a1.size()*sizeof(int));
+    } else {
+      CHECK(buffer_sizes[0] == sizeof(int));
+      CHECK(buffer_a1[0] == 4*domain_size_1+7);
+    }
+
+    size_t sequential, random, willneed;
+    CHECK_RC(tiledb_array_access_hints(tiledb_array, &sequential, &random, &willneed), TILEDB_OK);
+    if (is_scan) {
+      CHECK(sequential > 0);
+      CHECK(random == 0);
+      CHECK(willneed == sequential);
+    } else {
+      CHECK(sequential == 0);
+      CHECK(random > 0);
+      CHECK(willneed == 0);
+    }
+
+    // The attribute and coordinates files are hinted once per query
+    CHECK(sequential + random <= 2);
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+  }
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test reading with a shared tile cache", "[test_sparse_read_tile_cache]") {
+  // Reinitialize context with a tile cache
+  CHECK_RC(tiledb_ctx_finalize(tiledb_ctx_), TILEDB_OK);
+  TileDB_Config tiledb_config;
+  memset(&tiledb_config, 0, sizeof(TileDB_Config));
+  tiledb_config.read_method_ = TILEDB_IO_READ;
+  tiledb_config.tile_cache_size_ = 64*1024*1024;
+  CHECK_RC(tiledb_ctx_init(&tiledb_ctx_, &tiledb_config), TILEDB_OK);
+
+  int64_t domain_size_0 = 500;
+  int64_t domain_size_1 = 100;
+  set_array_name("sparse_test_tile_cache_500x100_10x10");
+  CHECK_RC(create_sparse_array_2D(10, 10, 0, domain_size_0-1, 0, domain_size_1-1, 100, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK_RC(write_sparse_array_unsorted_2D(domain_size_0, domain_size_1), TILEDB_OK);
+
+  const int64_t subarray[] = { 4, 123, 7, 58 };
+  const char* attributes[] = { "ATTR_INT32" };
+  int64_t cell_num = (subarray[1]-subarray[0]+1)*(subarray[3]-subarray[2]+1);
+  std::vector<int> buffer_a1(cell_num);
+
+  size_t hits, misses, size;
+  CHECK_RC(tiledb_ctx_tile_cache_stats(tiledb_ctx_, &hits, &misses, &size), TILEDB_OK);
+  CHECK(hits == 0);
+  CHECK(size == 0);
+
+  // The second array instance is served from the tiles cached by the first
+  size_t first_hits = 0, first_misses = 0;
+  for (auto i=0; i<2; i++) {
+    TileDB_Array* tiledb_array;
+    CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), TILEDB_ARRAY_READ_SORTED_ROW, subarray, attributes, 1), TILEDB_OK);
+    void* buffers[] = { buffer_a1.data() };
+    size_t buffer_sizes[] = { cell_num*sizeof(int) };
+    CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+    CHECK(buffer_sizes[0] == cell_num*sizeof(int));
+    int64_t index = 0;
+    for(int64_t i = subarray[0]; i <= subarray[1]; ++i) {
+      for(int64_t j = subarray[2]; j <= subarray[3]; ++j) {
+        CHECK(buffer_a1[index++] == i*domain_size_1+j);
+      }
+    }
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+
+    CHECK_RC(tiledb_ctx_tile_cache_stats(tiledb_ctx_, &hits, &misses, &size), TILEDB_OK);
+    CHECK(size > 0);
+    CHECK(misses > 0);
+    if (i == 0) {
+      first_hits = hits;
+      first_misses = misses;
+    } else {
+      CHECK(hits > first_hits);
+      CHECK(misses == first_misses);
+    }
+  }
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test loading book-keeping of many fragments", "[test_sparse_read_many_fragments]") {
+  int64_t domain_size_0 = 40;
+  int64_t domain_size_1 = 10;
+  set_array_name("sparse_test_many_fragments_40x10");
+  // Book-keeping is read from each fragment
+  unsetenv("TILEDB_FRAGMENT_MANIFEST");
+  CHECK_RC(create_sparse_array_2D(4, 4, 0, domain_size_0-1, 0, domain_size_1-1, 16, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1), TILEDB_OK);
+
+  // Serial and parallel loads see the same fragments in the same order
+  for (auto threads : { "1", "3", "", "many" }) {
+    if (strlen(threads)) {
+      CHECK(setenv("TILEDB_BOOK_KEEPING_LOAD_THREADS", threads, 1) == 0);
+    } else {
+      unsetenv("TILEDB_BOOK_KEEPING_LOAD_THREADS");
+    }
+    int *buffer = read_sparse_array_2D(0, domain_size_0-1, 0, domain_size_1-1, TILEDB_ARRAY_READ_SORTED_ROW);
+    REQUIRE(buffer != NULL);
+    for (int64_t i = 0; i < domain_size_0*domain_size_1; ++i) {
+      CHECK(buffer[i] == i);
+    }
+    delete [] buffer;
+  }
+  unsetenv("TILEDB_BOOK_KEEPING_LOAD_THREADS");
+
+  // A corrupt book-keeping file in one fragment fails the open
+  PosixFS fs;
+  auto fragments = fs.get_dirs(array_name_);
+  REQUIRE(fragments.size() == (size_t)domain_size_0);
+  for (auto i : { domain_size_0/2, domain_size_0/2+1 }) {
+    std::string book_keeping = fragments[i] + "/" + TILEDB_BOOK_KEEPING_FILENAME + TILEDB_FILE_SUFFIX + TILEDB_GZIP_SUFFIX;
+    REQUIRE(fs.delete_file(book_keeping) == TILEDB_FS_OK);
+    REQUIRE(fs.write_to_file(book_keeping, "garbage", 7) == TILEDB_FS_OK);
+    REQUIRE(fs.close_file(book_keeping) == TILEDB_FS_OK);
+  }
+  CHECK(read_sparse_array_2D(0, domain_size_0-1, 0, domain_size_1-1, TILEDB_ARRAY_READ) == NULL);
+  // The error of a load from another thread is reported
+  CHECK(std::string(tiledb_errmsg).find("book-keeping") != std::string::npos);
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test pruning fragments by subarray", "[test_sparse_read_prune_fragments]") {
+  int64_t domain_size_0 = 40;
+  int64_t domain_size_1 = 10;
+  set_array_name("sparse_test_prune_fragments_40x10");
+  CHECK_RC(create_sparse_array_2D(4, 4, 0, domain_size_0-1, 0, domain_size_1-1, 16, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1), TILEDB_OK);
+
+  // One fragment per row, so a subarray over rows [first, last] is read from
+  // last-first+1 fragments
+  const char* attributes[] = { "ATTR_INT32" };
+  std::vector<int> buffer_a1(domain_size_0*domain_size_1);
+  auto rows = { std::make_pair(5, 7), std::make_pair(10, 19), std::make_pair(0, 39), std::make_pair(39, 39) };
+  for (auto row_range : rows) {
+    int64_t subarray[] = { row_range.first, row_range.second, 2, 4 };
+    TileDB_Array* tiledb_array;
+    CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), TILEDB_ARRAY_READ_SORTED_ROW, subarray, attributes, 1), TILEDB_OK);
+    int fragment_num;
+    CHECK_RC(tiledb_array_overlapping_fragment_num(tiledb_array, &fragment_num), TILEDB_OK);
+    CHECK(fragment_num == row_range.second-row_range.first+1);
+
+    void* buffers[] = { buffer_a1.data() };
+    size_t buffer_sizes[] = { buffer_a1.size()*sizeof(int) };
+    CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+    REQUIRE(buffer_sizes[0] == (row_range.second-row_range.first+1)*3*sizeof(int));
+    int64_t k = 0;
+    for (int64_t i = row_range.first; i <= row_range.second; ++i) {
+      for (int64_t j = 2; j <= 4; ++j) {
+        CHECK(buffer_a1[k++] == i*domain_size_1+j);
+      }
+    }
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+  }
+
+  // Resetting the subarray prunes the fragments again
+  for (auto mode : { TILEDB_ARRAY_READ, TILEDB_ARRAY_READ_SORTED_ROW }) {
+    int64_t subarray[] = { 0, 0, 0, domain_size_1-1 };
+    TileDB_Array* tiledb_array;
+    CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), mode, subarray, attributes, 1), TILEDB_OK);
+    for (auto row_range : rows) {
+      subarray[0] = row_range.first;
+      subarray[1] = row_range.second;
+      CHECK_RC(tiledb_array_reset_subarray(tiledb_array, subarray), TILEDB_OK);
+      int fragment_num;
+      CHECK_RC(tiledb_array_overlapping_fragment_num(tiledb_array, &fragment_num), TILEDB_OK);
+      CHECK(fragment_num == row_range.second-row_range.first+1);
+    }
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+  }
+
+  // No fragment overlaps a subarray in a region never written to
+  set_array_name("sparse_test_prune_fragments_sparse_rows_40x10");
+  CHECK_RC(create_sparse_array_2D(4, 4, 0, 2*domain_size_0-1, 0, domain_size_1-1, 16, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1), TILEDB_OK);
+  int64_t subarray[] = { domain_size_0, 2*domain_size_0-1, 0, domain_size_1-1 };
+  TileDB_Array* tiledb_array;
+  CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), TILEDB_ARRAY_READ, subarray, attributes, 1), TILEDB_OK);
+  int fragment_num;
+  CHECK_RC(tiledb_array_overlapping_fragment_num(tiledb_array, &fragment_num), TILEDB_OK);
+  CHECK(fragment_num == 0);
+  void* buffers[] = { buffer_a1.data() };
+  size_t buffer_sizes[] = { buffer_a1.size()*sizeof(int) };
+  CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+  CHECK(buffer_sizes[0] == 0);
+  CHECK(tiledb_array_overflow(tiledb_array, 0) == 0);
+  CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test skipping tiles by zone maps", "[test_sparse_read_zone_maps]") {
+  // The arrays are written with the sectioned book-keeping layout, and read
+  // with TILEDB_IO_READ, which counts tile reads of compressed attributes
+  CHECK_RC(tiledb_ctx_finalize(tiledb_ctx_), TILEDB_OK);
+  TileDB_Config tiledb_config;
+  memset(&tiledb_config, 0, sizeof(TileDB_Config));
+  tiledb_config.enable_book_keeping_sections_ = true;
+  CHECK_RC(tiledb_ctx_init(&tiledb_ctx_, &tiledb_config), TILEDB_OK);
+  TileDB_CTX* read_ctx;
+  memset(&tiledb_config, 0, sizeof(TileDB_Config));
+  tiledb_config.read_method_ = TILEDB_IO_READ;
+  CHECK_RC(tiledb_ctx_init(&read_ctx, &tiledb_config), TILEDB_OK);
+
+  int64_t domain_size_0 = 100;
+  int64_t domain_size_1 = 10;
+  int64_t cell_num = domain_size_0*domain_size_1;
+  const char* attributes[] = { "ATTR_INT32" };
+  std::vector<int> buffer_a1(2*cell_num);
+  int64_t subarray[] = { 0, 2*domain_size_0-1, 0, domain_size_1-1 };
+
+  // Returns the sorted values of the cells read with the filter, and the
+  // number of tile reads. The tile reads of sorted reads are only counted for
+  // the last tile slab, so the first reads are not sorted.
+  auto read = [&](const char* filter, int mode, size_t& tile_reads) {
+    TileDB_Array* tiledb_array;
+    CHECK_RC(tiledb_array_init(read_ctx, &tiledb_array, array_name_.c_str(), mode, subarray, attributes, 1), TILEDB_OK);
+    if (filter) {
+      CHECK_RC(tiledb_array_apply_filter(tiledb_array, filter), TILEDB_OK);
+    }
+    void* buffers[] = { buffer_a1.data() };
+    size_t buffer_sizes[] = { buffer_a1.size()*sizeof(int) };
+    CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+    size_t tile_io_reads;
+    CHECK_RC(tiledb_array_tile_read_counts(tiledb_array, &tile_reads, &tile_io_reads), TILEDB_OK);
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+    std::vector<int> cells(buffer_a1.begin(), buffer_a1.begin()+buffer_sizes[0]/sizeof(int));
+    std::sort(cells.begin(), cells.end());
+    return cells;
+  };
+
+  for (auto enable_compression : { false, true }) {
+    set_array_name(enable_compression ? "sparse_test_zone_maps_compressed_200x10" : "sparse_test_zone_maps_200x10");
+    CHECK_RC(create_sparse_array_2D(4, 4, 0, 2*domain_size_0-1, 0, domain_size_1-1, 10, enable_compression, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+    CHECK_RC(write_sparse_array_unsorted_2D(domain_size_0, domain_size_1), TILEDB_OK);
+
+    // Tiles of cells below 900 are not read, and no cell of at least 900 is
+    // missed. The filter itself drops any cells below 900 of the tiles read.
+    size_t all_tile_reads, tile_reads;
+    auto all_cells = read(NULL, TILEDB_ARRAY_READ, all_tile_reads);
+    CHECK(all_cells.size() == (size_t)cell_num);
+    for (auto filter : { "ATTR_INT32 >= 900", "(ATTR_INT32 > 899) && 1000 > ATTR_INT32" }) {
+      auto cells = read(filter, TILEDB_ARRAY_READ, tile_reads);
+      REQUIRE(cells.size() >= 100u);
+      CHECK(cells.size() < all_cells.size()/2);
+      for (int k = 0; k < 100; ++k) {
+        CHECK(cells[cells.size()-100+k] == 900+k);
+      }
+      if (enable_compression) { // Only reads of compressed tiles are counted
+        REQUIRE(all_tile_reads > 0);
+        CHECK(tile_reads < all_tile_reads/2);
+      }
+    }
+
+    // Tiles are skipped also when the filter is evaluated with muparserx
+    CHECK(setenv("TILEDB_DISABLE_EXPRESSION_KERNELS", "1", 1) == 0);
+    auto cells_without_kernels = read("ATTR_INT32 >= 900", TILEDB_ARRAY_READ, tile_reads);
+    unsetenv("TILEDB_DISABLE_EXPRESSION_KERNELS");
+    size_t kernel_tile_reads;
+    CHECK(cells_without_kernels == read("ATTR_INT32 >= 900", TILEDB_ARRAY_READ, kernel_tile_reads));
+    if (enable_compression) {
+      CHECK(tile_reads == kernel_tile_reads);
+      CHECK(tile_reads < all_tile_reads/2);
+    }
+
+    // Filters that are not conjunctions of comparisons read every tile
+    for (auto filter : { "ATTR_INT32 >= 900 || ATTR_INT32 < 10", "ATTR_INT32 % 2 == 0" }) {
+      read(filter, TILEDB_ARRAY_READ, tile_reads);
+      if (enable_compression) {
+        CHECK(tile_reads == all_tile_reads);
+      }
+    }
+
+    // Cells of a newer fragment hide cells of older fragments with the same
+    // coordinates even if the filter drops them, so the tiles of newer
+    // fragments are skipped only where they overlap no older fragment
+    std::vector<int> buffer_new(2*domain_size_1, 0);
+    std::vector<int64_t> buffer_coords(4*domain_size_1);
+    for (int64_t j = 0; j < domain_size_1; ++j) {
+      buffer_coords[2*j] = 95;
+      buffer_coords[2*j+1] = j;
+      buffer_coords[2*(domain_size_1+j)] = 150;
+      buffer_coords[2*(domain_size_1+j)+1] = j;
+    }
+    TileDB_Array* tiledb_array;
+    CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), TILEDB_ARRAY_WRITE_UNSORTED, NULL, NULL, 0), TILEDB_OK);
+    const void* buffers[] = { buffer_new.data(), buffer_coords.data() };
+    size_t buffer_sizes[] = { buffer_new.size()*sizeof(int), buffer_coords.size()*sizeof(int64_t) };
+    CHECK_RC(tiledb_array_write(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+
+    auto cells = read("ATTR_INT32 >= 900", TILEDB_ARRAY_READ_SORTED_ROW, tile_reads);
+    for (auto value : cells) {
+      CHECK((value < 950 || value >= 960));
+    }
+    CHECK(std::count(cells.begin(), cells.end(), 0) <= domain_size_1);
+  }
+
+  // Fragments written with the default configuration get the legacy
+  // book-keeping layout, which has no zone maps, so every tile is read
+  CHECK_RC(tiledb_ctx_finalize(tiledb_ctx_), TILEDB_OK);
+  CHECK_RC(tiledb_ctx_init(&tiledb_ctx_, NULL), TILEDB_OK);
+  set_array_name("sparse_test_zone_maps_legacy_200x10");
+  CHECK_RC(create_sparse_array_2D(4, 4, 0, 2*domain_size_0-1, 0, domain_size_1-1, 10, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK_RC(write_sparse_array_unsorted_2D(domain_size_0, domain_size_1), TILEDB_OK);
+  size_t all_tile_reads, tile_reads;
+  read(NULL, TILEDB_ARRAY_READ, all_tile_reads);
+  read("ATTR_INT32 >= 900", TILEDB_ARRAY_READ, tile_reads);
+  CHECK(tile_reads == all_tile_reads);
+  CHECK_RC(tiledb_ctx_finalize(read_ctx), TILEDB_OK);
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test point lookups skip fragments by coordinates filters", "[test_sparse_read_coords_filters]") {
+  int64_t domain_size_0 = 40;
+  int64_t domain_size_1 = 10;
+  int64_t fragment_num = 8;
+  const char* attributes[] = { "ATTR_INT32" };
+  int value;
+
+  // Filters sized for the cells of each fragment with the default filter
+  // settings, filters built as the cells arrive as they have more hashes than
+  // a small size cap, no filters, and no filters for the legacy book-keeping
+  // layout of the default configuration
+  for (std::string mode : { "exact", "incremental", "none", "legacy" }) {
+    bool filters = mode == "exact" || mode == "incremental";
+    set_array_name(("sparse_test_coords_filters_" + mode + "_40x10").c_str());
+    CHECK_RC(create_sparse_array_2D(4, 4, 0, domain_size_0-1, 0, domain_size_1-1, 16, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+    CHECK_RC(tiledb_ctx_finalize(tiledb_ctx_), TILEDB_OK);
+    TileDB_Config tiledb_config;
+    memset(&tiledb_config, 0, sizeof(TileDB_Config));
+    tiledb_config.enable_book_keeping_sections_ = mode != "legacy";
+    if (mode == "none") {
+      tiledb_config.coords_filter_false_positive_rate_ = -1;
+    } else if (mode == "incremental") {
+      tiledb_config.coords_filter_max_size_ = 256;
+    }
+    CHECK_RC(tiledb_ctx_init(&tiledb_ctx_, &tiledb_config), TILEDB_OK);
+    CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1, fragment_num), TILEDB_OK);
+
+    // The fragments interleave by row, so every fragment overlaps a point in
+    // the middle rows, but only the one with its cell passes the filters
+    int64_t subarray[] = { 0, domain_size_0-1, 0, domain_size_1-1 };
+    TileDB_Array* tiledb_array;
+    CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), TILEDB_ARRAY_READ, subarray, attributes, 1), TILEDB_OK);
+    int64_t point_num = 0, total_fragment_num = 0;
+    for (int64_t i = fragment_num; i < domain_size_0-fragment_num; ++i) {
+      for (int64_t j = 0; j < domain_size_1; ++j) {
+        int64_t point[] = { i, i, j, j };
+        CHECK_RC(tiledb_array_reset_subarray(tiledb_array, point), TILEDB_OK);
+        int overlapping_fragment_num;
+        CHECK_RC(tiledb_array_overlapping_fragment_num(tiledb_array, &overlapping_fragment_num), TILEDB_OK);
+        CHECK(overlapping_fragment_num >= 1);
+        if (!filters) {
+          CHECK(overlapping_fragment_num == fragment_num);
+        }
+        ++point_num;
+        total_fragment_num += overlapping_fragment_num;
+
+        void* buffers[] = { &value };
+        size_t buffer_sizes[] = { sizeof(int) };
+        CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+        CHECK(buffer_sizes[0] == sizeof(int));
+        CHECK(value == i*domain_size_1+j);
+      }
+    }
+    if (filters) {
+      CHECK(total_fragment_num < 2*point_num);
+    }
+
+    // Subarrays of more than a point are not affected
+    CHECK_RC(tiledb_array_reset_subarray(tiledb_array, subarray), TILEDB_OK);
+    int overlapping_fragment_num;
+    CHECK_RC(tiledb_array_overlapping_fragment_num(tiledb_array, &overlapping_fragment_num), TILEDB_OK);
+    CHECK(overlapping_fragment_num == fragment_num);
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+  }
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test the sectioned book-keeping layout is opt-in", "[test_sparse_book_keeping_layout]") {
+  int64_t domain_size_0 = 4;
+  int64_t domain_size_1 = 10;
+  set_array_name("sparse_test_book_keeping_layout_4x10");
+  unsetenv("TILEDB_FRAGMENT_MANIFEST");
+  CHECK_RC(create_sparse_array_2D(4, 4, 0, domain_size_0-1, 0, domain_size_1-1, 16, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+
+  // Fragments are written in the legacy layout unless opted in with
+  // enable_book_keeping_sections_, and arrays mixing both layouts read as
+  // usual with either configuration
+  unsetenv("TILEDB_BOOK_KEEPING_SECTIONS");
+  CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1), TILEDB_OK);
+  CHECK_RC(tiledb_ctx_finalize(tiledb_ctx_), TILEDB_OK);
+  TileDB_Config tiledb_config;
+  memset(&tiledb_config, 0, sizeof(TileDB_Config));
+  tiledb_config.enable_book_keeping_sections_ = true;
+  CHECK_RC(tiledb_ctx_init(&tiledb_ctx_, &tiledb_config), TILEDB_OK);
+  CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1), TILEDB_OK);
+
+  PosixFS fs;
+  auto fragments = fs.get_dirs(array_name_);
+  REQUIRE(fragments.size() == 2*(size_t)domain_size_0);
+  int64_t legacy_num = 0, sectioned_num = 0;
+  for (auto& fragment : fragments) {
+    std::string book_keeping = fragment + "/" + TILEDB_BOOK_KEEPING_FILENAME + TILEDB_FILE_SUFFIX;
+    legacy_num += fs.is_file(book_keeping + TILEDB_GZIP_SUFFIX);
+    sectioned_num += fs.is_file(book_keeping);
+  }
+  CHECK(legacy_num == domain_size_0);
+  CHECK(sectioned_num == domain_size_0);
+
+  for (auto enable_book_keeping_sections : { true, false }) {
+    CHECK_RC(tiledb_ctx_finalize(tiledb_ctx_), TILEDB_OK);
+    tiledb_config.enable_book_keeping_sections_ = enable_book_keeping_sections;
+    CHECK_RC(tiledb_ctx_init(&tiledb_ctx_, &tiledb_config), TILEDB_OK);
+    int *buffer = read_sparse_array_2D(0, domain_size_0-1, 0, domain_size_1-1, TILEDB_ARRAY_READ_SORTED_ROW);
+    REQUIRE(buffer != NULL);
+    for (int64_t i = 0; i < domain_size_0*domain_size_1; ++i) {
+      CHECK(buffer[i] == i);
+    }
+    delete [] buffer;
+  }
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test book-keeping of attributes is decoded on first use", "[test_sparse_read_lazy_book_keeping]") {
+  CHECK(setenv("TILEDB_BOOK_KEEPING_SECTIONS", "1", 1) == 0);
+  int64_t domain_size_0 = 4;
+  int64_t domain_size_1 = 10;
+  set_array_name("sparse_test_lazy_book_keeping_4x10");
+  unsetenv("TILEDB_FRAGMENT_MANIFEST");
+  CHECK_RC(create_sparse_array_2D(4, 4, 0, domain_size_0-1, 0, domain_size_1-1, 16, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1), TILEDB_OK);
+
+  // Corrupt the section of ATTR_INT32 in the book-keeping of one fragment
+  PosixFS fs;
+  auto fragments = fs.get_dirs(array_name_);
+  REQUIRE(fragments.size() == (size_t)domain_size_0);
+  std::string book_keeping = fragments[0] + "/" + TILEDB_BOOK_KEEPING_FILENAME + TILEDB_FILE_SUFFIX;
+  ssize_t size = fs.file_size(book_keeping);
+  REQUIRE(size > 0);
+  std::vector<char> bytes(size);
+  REQUIRE(fs.read_from_file(book_keeping, 0, bytes.data(), size) == TILEDB_FS_OK);
+  size_t sectioned;
+  int version, section_num;
+  memcpy(&sectioned, bytes.data(), sizeof(size_t));
+  memcpy(&version, bytes.data()+sizeof(size_t), sizeof(int));
+  memcpy(&section_num, bytes.data()+sizeof(size_t)+sizeof(int), sizeof(int));
+  CHECK(sectioned == TILEDB_BK_SECTIONED);
+  CHECK(version == TILEDB_BK_VERSION);
+  // The domain, ATTR_INT32, the coordinates and the coordinates filter
+  REQUIRE(section_num == 4);
+  int64_t section[3];
+  memcpy(section, bytes.data()+sizeof(size_t)+4*sizeof(int)+3*sizeof(int64_t), 3*sizeof(int64_t));
+  REQUIRE(section[0]+section[1] <= size);
+  memset(bytes.data()+section[0], 0, section[1]);
+  REQUIRE(fs.delete_file(book_keeping) == TILEDB_FS_OK);
+  REQUIRE(fs.write_to_file(book_keeping, bytes.data(), size) == TILEDB_FS_OK);
+  REQUIRE(fs.close_file(book_keeping) == TILEDB_FS_OK);
+
+  // Reading only the coordinates does not decode the section
+  const char* attributes[] = { TILEDB_COORDS };
+  int64_t cell_num = domain_size_0*domain_size_1;
+  std::vector<int64_t> buffer_coords(2*cell_num);
+  TileDB_Array* tiledb_array;
+  CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), TILEDB_ARRAY_READ_SORTED_ROW, NULL, attributes, 1), TILEDB_OK);
+  void* buffers[] = { buffer_coords.data() };
+  size_t buffer_sizes[] = { 2*cell_num*sizeof(int64_t) };
+  CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+  CHECK(buffer_sizes[0] == 2*cell_num*sizeof(int64_t));
+  for (int64_t i = 0; i < cell_num; ++i) {
+    CHECK(buffer_coords[2*i] == i/domain_size_1);
+    CHECK(buffer_coords[2*i+1] == i%domain_size_1);
+  }
+  CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+
+  // Reading the attribute fails on the corrupt section
+  CHECK(read_sparse_array_2D(0, domain_size_0-1, 0, domain_size_1-1, TILEDB_ARRAY_READ) == NULL);
+  unsetenv("TILEDB_BOOK_KEEPING_SECTIONS");
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test book-keeping compression types", "[test_sparse_book_keeping_compression]") {
+  CHECK(setenv("TILEDB_BOOK_KEEPING_SECTIONS", "1", 1) == 0);
+  int64_t domain_size_0 = 4;
+  int64_t domain_size_1 = 10;
+  std::vector<std::pair<std::string, int> > compressions = {
+    { "none", TILEDB_NO_COMPRESSION }, { "gzip", TILEDB_GZIP }, { "lz4", TILEDB_LZ4 },
+    { "bogus", TILEDB_GZIP } };
+#ifdef ENABLE_ZSTD
+  compressions.push_back({ "zstd", TILEDB_ZSTD });
+#endif
+  unsetenv("TILEDB_FRAGMENT_MANIFEST");
+  for (auto& compression : compressions) {
+    set_array_name(("sparse_test_book_keeping_" + compression.first + "_4x10").c_str());
+    CHECK_RC(create_sparse_array_2D(4, 4, 0, domain_size_0-1, 0, domain_size_1-1, 16, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+    CHECK(setenv("TILEDB_BOOK_KEEPING_COMPRESSION", compression.first.c_str(), 1) == 0);
+    CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1), TILEDB_OK);
+    unsetenv("TILEDB_BOOK_KEEPING_COMPRESSION");
+
+    // The sections are compressed as requested and start aligned
+    PosixFS fs;
+    auto fragments = fs.get_dirs(array_name_);
+    REQUIRE(fragments.size() == (size_t)domain_size_0);
+    std::string book_keeping = fragments[0] + "/" + TILEDB_BOOK_KEEPING_FILENAME + TILEDB_FILE_SUFFIX;
+    ssize_t size = fs.file_size(book_keeping);
+    REQUIRE(size > 0);
+    std::vector<char> bytes(size);
+    REQUIRE(fs.read_from_file(book_keeping, 0, bytes.data(), size) == TILEDB_FS_OK);
+    int header[4];
+    memcpy(header, bytes.data()+sizeof(size_t), 4*sizeof(int));
+    CHECK(header[0] == TILEDB_BK_VERSION);
+    REQUIRE(header[1] == 4);
+    CHECK(header[2] == compression.second);
+    for (int i = 0; i < header[1]; ++i) {
+      int64_t section[3];
+      memcpy(section, bytes.data()+sizeof(size_t)+4*sizeof(int)+i*3*sizeof(int64_t), 3*sizeof(int64_t));
+      CHECK(section[0] % TILEDB_BK_SECTION_ALIGNMENT == 0);
+      CHECK(section[0]+section[1] <= size);
+      if (compression.second == TILEDB_NO_COMPRESSION) {
+        CHECK(section[1] == section[2]);
+      }
+    }
+
+    int *buffer = read_sparse_array_2D(0, domain_size_0-1, 0, domain_size_1-1, TILEDB_ARRAY_READ_SORTED_ROW);
+    REQUIRE(buffer != NULL);
+    for (int64_t i = 0; i < domain_size_0*domain_size_1; ++i) {
+      CHECK(buffer[i] == i);
+    }
+    delete [] buffer;
+  }
+  unsetenv("TILEDB_BOOK_KEEPING_SECTIONS");
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Test opening arrays with a fragment manifest", "[test_sparse_fragment_manifest]") {
+  int64_t domain_size_0 = 10;
+  int64_t domain_size_1 = 10;
+  set_array_name("sparse_test_fragment_manifest_10x10");
+  CHECK_RC(create_sparse_array_2D(4, 4, 0, domain_size_0-1, 0, domain_size_1-1, 16, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK(setenv("TILEDB_FRAGMENT_MANIFEST", "1", 1) == 0);
+  CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1), TILEDB_OK);
+  unsetenv("TILEDB_FRAGMENT_MANIFEST");
+
+  PosixFS fs;
+  FragmentManifest manifest(&fs, array_name_);
+  CHECK(manifest.load());
+  CHECK(manifest.fragment_num() == (size_t)domain_size_0);
+
+  auto check_read = [&]() {
+    int *buffer = read_sparse_array_2D(0, domain_size_0-1, 0, domain_size_1-1, TILEDB_ARRAY_READ_SORTED_ROW);
+    REQUIRE(buffer != NULL);
+    for (int64_t i = 0; i < domain_size_0*domain_size_1; ++i) {
+      CHECK(buffer[i] == i);
+    }
+    delete [] buffer;
+  };
+  check_read();
+
+  // Fragments missing from the manifest are still found
+  auto fragments = fs.get_dirs(array_name_);
+  REQUIRE(fragments.size() == (size_t)domain_size_0);
+  CHECK(fs.get_files(array_name_).size() > (size_t)domain_size_0);
+  for (auto i = 0; i < 2; ++i) {
+    REQUIRE(fs.delete_file(manifest.shard_filename(fragments[i])) == TILEDB_FS_OK);
+  }
+  CHECK(manifest.load());
+  CHECK(manifest.fragment_num() == (size_t)domain_size_0-2);
+  check_read();
+
+  // Consolidation replaces the old fragments in the manifest and folds the
+  // shards into it
+  CHECK_RC(tiledb_array_consolidate(tiledb_ctx_, array_name_.c_str()), TILEDB_OK);
+  CHECK(fs.get_dirs(array_name_).size() == 1);
+  CHECK(manifest.load());
+  CHECK(manifest.fragment_num() == 1);
+  CHECK(!fs.is_file(manifest.shard_filename(fs.get_dirs(array_name_)[0])));
+  check_read();
+
+  // Clearing the array removes the manifest and its shards
+  CHECK_RC(tiledb_clear(tiledb_ctx_, array_name_.c_str()), TILEDB_OK);
+  CHECK(!fs.is_file(manifest.filename()));
+  CHECK(fs.get_files(array_name_).size() < (size_t)domain_size_0);
+
+  // Writers fold the shards once there are too many of them
+  CHECK(setenv("TILEDB_FRAGMENT_MANIFEST", "1", 1) == 0);
+  CHECK(setenv("TILEDB_FRAGMENT_MANIFEST_MAX_SHARDS", "3", 1) == 0);
+  CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1), TILEDB_OK);
+  unsetenv("TILEDB_FRAGMENT_MANIFEST");
+  unsetenv("TILEDB_FRAGMENT_MANIFEST_MAX_SHARDS");
+  CHECK(manifest.shard_num() <= 3);
+  CHECK(manifest.load(fs.get_dirs(array_name_)));
+  CHECK(manifest.fragment_num() == (size_t)domain_size_0);
+  check_read();
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Benchmark opening an array with many fragments", "[benchmark_open_many_fragments]") {
+  if (!is_env_set("TILEDB_BENCHMARK")) {
+    return;
+  }
+  CHECK(setenv("TILEDB_BOOK_KEEPING_SECTIONS", "1", 1) == 0);
+
+  int64_t domain_size_0 = 500;
+  int64_t domain_size_1 = 10;
+  set_array_name("sparse_test_benchmark_500_fragments");
+  CHECK_RC(create_sparse_array_2D(4, 4, 0, domain_size_0-1, 0, domain_size_1-1, 16, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+  CHECK(setenv("TILEDB_FRAGMENT_MANIFEST", "1", 1) == 0);
+  CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1), TILEDB_OK);
+  unsetenv("TILEDB_FRAGMENT_MANIFEST");
+
+  // Open the same fragments locally and through SimFS to show the effect of
+  // per-request latency, first with the fragment manifest and then without
+  const char* attributes[] = { "ATTR_INT32" };
+  PosixFS fs;
+  for (auto manifest : { true, false }) {
+    if (!manifest) {
+      REQUIRE(FragmentManifest(&fs, array_name_).clear() == TILEDB_FM_OK);
+    }
+    for (auto sim : { false, true }) {
+      TileDB_CTX* tiledb_ctx = tiledb_ctx_;
+      std::string array_name = array_name_;
+      std::string home = "sim://" + WORKSPACE;
+      if (sim) {
+        TileDB_Config tiledb_config;
+        memset(&tiledb_config, 0, sizeof(TileDB_Config));
+        tiledb_config.home_ = home.c_str();
+        CHECK_RC(tiledb_ctx_init(&tiledb_ctx, &tiledb_config), TILEDB_OK);
+        array_name = "sim://" + array_name_;
+      }
+      for (auto threads : { "1", "" }) {
+        if (strlen(threads)) {
+          CHECK(setenv("TILEDB_BOOK_KEEPING_LOAD_THREADS", threads, 1) == 0);
+        } else {
+          unsetenv("TILEDB_BOOK_KEEPING_LOAD_THREADS");
+        }
+        Catch::Timer t;
+        t.start();
+        TileDB_Array* tiledb_array;
+        CHECK_RC(tiledb_array_init(tiledb_ctx, &tiledb_array, array_name.c_str(), TILEDB_ARRAY_READ, NULL, attributes, 1), TILEDB_OK);
+        auto elapsed = t.getElapsedMilliseconds();
+        CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+        std::cerr << "Open " << domain_size_0 << " fragments " << (sim ? "on SimFS" : "on PosixFS")
+                  << (manifest ? " with" : " without") << " manifest"
+                  << " with " << (strlen(threads) ? threads : std::to_string(TILEDB_SM_BOOK_KEEPING_LOAD_THREADS))
+                  << " load threads elapsed time = " << elapsed << "ms" << std::endl;
+      }
+      if (sim) {
+        CHECK_RC(tiledb_ctx_finalize(tiledb_ctx), TILEDB_OK);
+      }
+    }
+  }
+  unsetenv("TILEDB_BOOK_KEEPING_LOAD_THREADS");
+  unsetenv("TILEDB_BOOK_KEEPING_SECTIONS");
+}
+
+TEST_CASE_METHOD(SparseArrayTestFixture, "Benchmark point lookups over many fragments", "[benchmark_point_lookups]") {
+  if (!is_env_set("TILEDB_BENCHMARK")) {
+    return;
+  }
+  CHECK(setenv("TILEDB_BOOK_KEEPING_SECTIONS", "1", 1) == 0);
+
+  // Interleaved fragments that all overlap most points
+  int64_t domain_size_0 = 1000;
+  int64_t domain_size_1 = 10;
+  int64_t fragment_num = 100;
+  const char* attributes[] = { "ATTR_INT32" };
+  int value;
+  for (auto filters : { false, true }) {
+    set_array_name(filters ? "sparse_test_benchmark_coords_filters" : "sparse_test_benchmark_no_coords_filters");
+    CHECK_RC(create_sparse_array_2D(4, 4, 0, domain_size_0-1, 0, domain_size_1-1, 16, true, TILEDB_ROW_MAJOR, TILEDB_ROW_MAJOR), TILEDB_OK);
+    if (!filters) {
+      CHECK(setenv("TILEDB_BLOOM_FILTER_FPR", "0", 1) == 0);
+    }
+    CHECK_RC(write_sparse_array_fragments_2D(domain_size_0, domain_size_1, fragment_num), TILEDB_OK);
+    unsetenv("TILEDB_BLOOM_FILTER_FPR");
+
+    int64_t subarray[] = { 0, domain_size_0-1, 0, domain_size_1-1 };
+    TileDB_Array* tiledb_array;
+    CHECK_RC(tiledb_array_init(tiledb_ctx_, &tiledb_array, array_name_.c_str(), TILEDB_ARRAY_READ, subarray, attributes, 1), TILEDB_OK);
+    int64_t lookup_num = 0;
+    Catch::Timer t;
+    t.start();
+    for (int64_t i = fragment_num; i < domain_size_0-fragment_num; i += 7) {
+      for (int64_t j = 0; j < domain_size_1; j += 3) {
+        int64_t point[] = { i, i, j, j };
+        CHECK_RC(tiledb_array_reset_subarray(tiledb_array, point), TILEDB_OK);
+        void* buffers[] = { &value };
+        size_t buffer_sizes[] = { sizeof(int) };
+        CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+        CHECK(value == i*domain_size_1+j);
+        ++lookup_num;
+      }
+    }
+    auto elapsed = t.getElapsedMicroseconds();
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+    std::cerr << lookup_num << " point lookups over " << fragment_num << " fragments"
+              << (filters ? " with" : " without") << " coordinates filters elapsed time = " << elapsed << "us ("
+              << lookup_num*1000000/std::max(elapsed, uint64_t(1)) << " lookups/s)" << std::endl;
+  }
+  unsetenv("TILEDB_BOOK_KEEPING_SECTIONS");
+}
+
 class SparseArrayEnvTestFixture : SparseArrayTestFixture {
   public:
   SparseArrayTestFixture *test_fixture;
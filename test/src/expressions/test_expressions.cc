@@ -35,6 +35,10 @@
 #include "expression.h"
 #include "storage_posixfs.h"
 #include "tiledb.h"
+#include "utils.h"
+
+#include <functional>
+#include <iostream>
 
 int rc;
 
@@ -139,3 +143,143 @@ TEST_CASE_METHOD(ArrayFixture, "Test Expressions Dense", "[expressions_dense]")
   const int expected_buffer[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
   check_buffer(buffers, buffer_sizes, expected_buffer, 16);
 }
+
+class BatchArrayFixture {
+ protected:
+  const std::vector<std::string> attribute_names = { "a1", "a2" };
+
+  const char* attr_names[2] = { "a1", "a2" };
+  const int types[3] = { TILEDB_INT32, TILEDB_FLOAT32, TILEDB_INT64 };
+
+  PosixFS *posixfs_;
+  ArraySchema *array_schema_;
+
+  BatchArrayFixture() {
+    posixfs_ = new PosixFS();
+    array_schema_ = new ArraySchema(posixfs_);
+    array_schema_->set_attributes(const_cast<char **>(attr_names), 2);
+    array_schema_->set_cell_val_num(NULL);
+    array_schema_->set_types(types);
+    array_schema_->set_dense(0);
+  }
+
+  ~BatchArrayFixture() {
+    delete array_schema_;
+    delete posixfs_;
+  }
+
+  // Cell i has a1 = i and a2 = i/2.0, with every 100th a1 empty
+  void fill_buffers(int64_t cell_num, std::vector<int>& buffer_a1, std::vector<float>& buffer_a2) {
+    buffer_a1.resize(cell_num);
+    buffer_a2.resize(cell_num);
+    for (int64_t i = 0; i < cell_num; i++) {
+      buffer_a1[i] = i%100 == 99 ? TILEDB_EMPTY_INT32 : i;
+      buffer_a2[i] = i/2.0f;
+    }
+  }
+
+  // Returns the cells the expression keeps, evaluating it over buffers of cell_num cells
+  std::vector<int> evaluate(Expression& expression, int64_t cell_num) {
+    std::vector<int> buffer_a1;
+    std::vector<float> buffer_a2;
+    fill_buffers(cell_num, buffer_a1, buffer_a2);
+    void* buffers[] = { buffer_a1.data(), buffer_a2.data() };
+    size_t buffer_sizes[] = { cell_num*sizeof(int), cell_num*sizeof(float) };
+    CHECK(expression.evaluate(buffers, buffer_sizes) == TILEDB_OK);
+    REQUIRE(buffer_sizes[0]/sizeof(int) == buffer_sizes[1]/sizeof(float));
+    buffer_a1.resize(buffer_sizes[0]/sizeof(int));
+    for (auto i = 0u; i < buffer_a1.size(); i++) {
+      CHECK(buffer_a2[i] == (buffer_a1[i] == TILEDB_EMPTY_INT32 ? buffer_a2[i] : buffer_a1[i]/2.0f));
+    }
+    return buffer_a1;
+  }
+};
+
+TEST_CASE_METHOD(BatchArrayFixture, "Test Compiled Expressions", "[expressions_compiled]") {
+  int64_t cell_num = 3000;
+  std::vector<std::pair<std::string, std::function<bool(int, float)> > > expressions = {
+    { "a1 > 4", [](int a1, float a2) { return a1 > 4; } },
+    { "4 < a1 && a2 <= 600.5", [](int a1, float a2) { return 4 < a1 && a2 <= 600.5; } },
+    { "a1 == 0 or a1 == 2999", [](int a1, float a2) { return a1 == 0 || a1 == 2999; } },
+    { "(a1 + 2) * 2 >= a2 * 8 || a1 != a1", [](int a1, float a2) { return (a1 + 2) * 2.0 >= a2 * 8.0; } },
+    { "-a1 < -2000 and (a2 - 1 > 1000 || a1 / 3 <= 1.5e1)", [](int a1, float a2) { return -a1 < -2000 && (a2 - 1.0 > 1000 || a1 / 3.0 <= 15); } },
+    { "a1 > 4 && a1 > 3000", [](int a1, float a2) { return false; } },
+    // Constants between the values of the attribute types
+    { "a1 < 4.5 || a1 >= 2990.5", [](int a1, float a2) { return a1 < 4.5 || a1 >= 2990.5; } },
+    { "a1 == 4.5 || a1 != 5.5 && a1 <= 10.5", [](int a1, float a2) { return a1 <= 10; } },
+    { "a2 > 0.1 && a2 <= 1000.3", [](int a1, float a2) { return a2 > 0.1 && a2 <= 1000.3; } },
+    { "a2 == 0.1 || a2 == 2.5 || a2 != 2.5 && a2 >= 1499.2", [](int a1, float a2) { return a2 == 2.5f || a2 >= 1499.2; } },
+    // Constants out of the range of the attribute types
+    { "a1 > -1e10 && a1 < 1e10 && a2 < 1e40 && a2 > -1e40", [](int a1, float a2) { return true; } },
+    { "a1 >= 1e10 || a1 == 1e10 || a2 > 1e40", [](int a1, float a2) { return false; } },
+    // Divisions of int32 values are not truncated, and unary minus binds tighter than them
+    { "a1 / 2 == 700 || a1 / 3 == 5", [](int a1, float a2) { return a1 == 1400 || a1 == 15; } },
+    { "-a1 / 4 > -2.5 && a1 / -1 <= -0", [](int a1, float a2) { return a1 >= 0 && a1 < 10; } },
+    { "-(a1 - a2) >= -1000 && -(-a1) > 20", [](int a1, float a2) { return -(a1 - a2) >= -1000 && a1 > 20; } } };
+  for (auto& expression_check : expressions) {
+    INFO("Expression " << expression_check.first);
+    Expression expression(expression_check.first, attribute_names, array_schema_);
+    CHECK(expression.compiled());
+
+    // The cells that pass and the ones with empty values in the expression
+    // attributes are kept, batch after batch
+    bool a1_used = expression_check.first.find("a1") != std::string::npos;
+    std::vector<int> expected;
+    for (int64_t i = 0; i < cell_num; i++) {
+      if (i%100 == 99 && a1_used) {
+        expected.push_back(TILEDB_EMPTY_INT32);
+      } else if (expression_check.second(i, i/2.0f)) {
+        expected.push_back(i%100 == 99 ? TILEDB_EMPTY_INT32 : i);
+      }
+    }
+    CHECK(evaluate(expression, cell_num) == expected);
+
+    // muparserx keeps the same cells
+    setenv("TILEDB_DISABLE_EXPRESSION_KERNELS", "1", 1);
+    Expression fallback(expression_check.first, attribute_names, array_schema_);
+    unsetenv("TILEDB_DISABLE_EXPRESSION_KERNELS");
+    CHECK(!fallback.compiled());
+    CHECK(evaluate(fallback, cell_num) == expected);
+  }
+}
+
+TEST_CASE_METHOD(BatchArrayFixture, "Test Expressions Not Compiled", "[expressions_not_compiled]") {
+  // Unsupported functions and operators, results that are not booleans and
+  // unknown names are left to muparserx
+  for (auto filter : { "a1", "a1 + 1", "sin(a1) > 0", "a1 > 4 ? 1 : 0", "a1 > \"4\"", "a1 & 1 == 1",
+                       "a1 > 4 && a1", "a1 < a2 < 3", "a3 > 1", "1 > 0", "a1 >= 0x10", "a1 >" }) {
+    Expression expression(filter, attribute_names, array_schema_);
+    CHECK(!expression.compiled());
+  }
+}
+
+TEST_CASE_METHOD(BatchArrayFixture, "Benchmark Compiled Expressions", "[benchmark_expressions]") {
+  if (!is_env_set("TILEDB_BENCHMARK")) {
+    return;
+  }
+
+  int64_t cell_num = 10000000;
+  for (auto filter : { "a1 > 5000000", "a1 > 1000 && a2 < 4000000.5", "a1 < 1000 || a1 > 9000000 || a2 == 42",
+                       "(a1 + a2) * 2 > 15000000" }) {
+    // Compiled, then with muparserx as the baseline
+    uint64_t elapsed[2];
+    for (auto i = 0; i < 2; i++) {
+      if (i == 1) setenv("TILEDB_DISABLE_EXPRESSION_KERNELS", "1", 1);
+      Expression expression(filter, attribute_names, array_schema_);
+      unsetenv("TILEDB_DISABLE_EXPRESSION_KERNELS");
+      CHECK(expression.compiled() == (i == 0));
+      std::vector<int> buffer_a1;
+      std::vector<float> buffer_a2;
+      fill_buffers(cell_num, buffer_a1, buffer_a2);
+      void* buffers[] = { buffer_a1.data(), buffer_a2.data() };
+      size_t buffer_sizes[] = { cell_num*sizeof(int), cell_num*sizeof(float) };
+      Catch::Timer t;
+      t.start();
+      CHECK(expression.evaluate(buffers, buffer_sizes) == TILEDB_OK);
+      elapsed[i] = std::max(t.getElapsedMicroseconds(), uint64_t(1));
+      std::cerr << "Evaluate \"" << filter << "\" " << (i == 0 ? "compiled" : "with muparserx") << " over " << cell_num
+                << " cells elapsed time = " << elapsed[i] << "us (" << cell_num/elapsed[i] << "M cells/s)" << std::endl;
+    }
+    std::cerr << "Evaluate \"" << filter << "\" compiled speedup = " << (double)elapsed[1]/elapsed[0] << "x" << std::endl;
+  }
+}
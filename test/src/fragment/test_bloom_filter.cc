@@ -0,0 +1,136 @@
+/**
+ * @file   test_bloom_filter.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the Bloom filter over the coordinates of a sparse fragment
+ */
+
+#include "catch.h"
+#include "bloom_filter.h"
+
+#include <vector>
+
+/** The hash of the 2D cell (i, j) */
+static uint64_t hash_cell(int64_t i, int64_t j) {
+  int64_t coords[] = { i, j };
+  return BloomFilter::hash_coords(coords, 2);
+}
+
+TEST_CASE("Test Bloom filter false-positive rates", "[bloom_filter]") {
+  for (auto key_num : { 0, 1, 1000, 100000 }) {
+    for (auto false_positive_rate : { 0.1, 0.01, 0.001 }) {
+      BloomFilter bloom_filter(key_num, false_positive_rate, TILEDB_BLOOM_FILTER_MAX_SIZE);
+      CHECK(bloom_filter.bit_num() % 64 == 0);
+      CHECK(bloom_filter.hash_num() >= 1);
+      CHECK(bloom_filter.hash_num() <= TILEDB_BLOOM_FILTER_MAX_HASH_NUM);
+      for (int64_t i = 0; i < key_num; ++i) {
+        bloom_filter.insert(hash_cell(i, 2*i));
+      }
+
+      // No false negatives, and about the requested rate of false positives
+      for (int64_t i = 0; i < key_num; ++i) {
+        CHECK(bloom_filter.may_contain(hash_cell(i, 2*i)));
+      }
+      int64_t false_positives = 0;
+      int64_t lookup_num = 100000;
+      for (int64_t i = 0; i < lookup_num; ++i) {
+        false_positives += bloom_filter.may_contain(hash_cell(i, 2*i+1));
+      }
+      CHECK(false_positives <= 2*false_positive_rate*lookup_num);
+
+      // Serialized bits answer the same
+      BloomFilter view(bloom_filter.bit_num(), bloom_filter.hash_num(), bloom_filter.words());
+      for (int64_t i = 0; i < 1000; ++i) {
+        CHECK(view.may_contain(hash_cell(i, i)) == bloom_filter.may_contain(hash_cell(i, i)));
+      }
+    }
+  }
+}
+
+TEST_CASE("Test Bloom filter size cap", "[bloom_filter_max_size]") {
+  int64_t key_num = 100000;
+  BloomFilter bloom_filter(key_num, 0.001, 1024);
+  CHECK(bloom_filter.bit_num() == 1024*8);
+  for (int64_t i = 0; i < key_num; ++i) {
+    bloom_filter.insert(hash_cell(i, 2*i));
+  }
+  for (int64_t i = 0; i < key_num; ++i) {
+    CHECK(bloom_filter.may_contain(hash_cell(i, 2*i)));
+  }
+  CHECK(BloomFilter(key_num, 0.001, 1).bit_num() == 64);
+}
+
+TEST_CASE("Test folding Bloom filters", "[bloom_filter_fold]") {
+  // A filter sized for a bound of keys shrinks to about the size of a filter
+  // sized for the keys inserted, keeping them all
+  size_t max_size = 1024*1024;
+  int64_t key_num = 1000;
+  BloomFilter bloom_filter(BloomFilter::capacity(0.01, max_size), 0.01, max_size);
+  CHECK(bloom_filter.bit_num() == int64_t(max_size*8));
+  for (int64_t i = 0; i < key_num; ++i) {
+    bloom_filter.insert(hash_cell(i, 2*i));
+  }
+  bloom_filter.fold(key_num, 0.01);
+  BloomFilter exact(key_num, 0.01, max_size);
+  CHECK(bloom_filter.bit_num() >= exact.bit_num());
+  CHECK(bloom_filter.bit_num() < 2*exact.bit_num());
+  CHECK(bloom_filter.hash_num() == exact.hash_num());
+  for (int64_t i = 0; i < key_num; ++i) {
+    CHECK(bloom_filter.may_contain(hash_cell(i, 2*i)));
+  }
+  int64_t false_positives = 0;
+  int64_t lookup_num = 100000;
+  for (int64_t i = 0; i < lookup_num; ++i) {
+    false_positives += bloom_filter.may_contain(hash_cell(i, 2*i+1));
+  }
+  CHECK(false_positives <= 2*0.01*lookup_num);
+
+  // Filters that cannot be halved are kept
+  BloomFilter small(1, 0.01, 8);
+  small.insert(hash_cell(1, 2));
+  small.fold(1, 0.01);
+  CHECK(small.bit_num() == 64);
+  CHECK(small.may_contain(hash_cell(1, 2)));
+}
+
+TEST_CASE("Test hashing coordinates", "[bloom_filter_hash_coords]") {
+  // Equal coordinates hash the same, and strided ones like contiguous ones
+  double coords[] = { 0.0, 1.5, -2.0 };
+  double negative_zero[] = { -0.0, 1.5, -2.0 };
+  double subarray[] = { 0.0, 0.0, 1.5, 1.5, -2.0, -2.0 };
+  CHECK(BloomFilter::hash_coords(coords, 3) == BloomFilter::hash_coords(negative_zero, 3));
+  CHECK(BloomFilter::hash_coords(coords, 3) == BloomFilter::hash_coords(subarray, 3, 2));
+  CHECK(BloomFilter::hash_coords(coords, 3) != BloomFilter::hash_coords(coords, 2));
+
+  // Swapped coordinates hash differently
+  int cell[] = { 3, 7 };
+  int swapped[] = { 7, 3 };
+  CHECK(BloomFilter::hash_coords(cell, 2) != BloomFilter::hash_coords(swapped, 2));
+  float cell_float[] = { 3, 7 };
+  CHECK(BloomFilter::hash_coords(cell_float, 2) != BloomFilter::hash_coords(cell, 2));
+}
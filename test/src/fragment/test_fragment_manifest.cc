@@ -0,0 +1,149 @@
+/**
+ * @file   test_fragment_manifest.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the FragmentManifest class
+ */
+
+#include "catch.h"
+#include "fragment_manifest.h"
+#include "storage_posixfs.h"
+#include "utils.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static FragmentManifestEntry manifest_entry(bool dense, char value) {
+  FragmentManifestEntry entry;
+  entry.dense_ = dense;
+  entry.non_empty_domain_.assign(16, value);
+  entry.book_keeping_.assign(100, value);
+  return entry;
+}
+
+TEST_CASE("Test FragmentManifest", "[fragment_manifest]") {
+  TempDir td;
+  PosixFS fs;
+  std::string array = td.get_temp_dir() + "/array";
+  REQUIRE(fs.create_dir(array) == TILEDB_FS_OK);
+  for (auto fragment : { "/__f1", "/__f2", "/__f3" }) {
+    REQUIRE(fs.create_dir(array + fragment) == TILEDB_FS_OK);
+  }
+
+  // Not created unless enabled
+  unsetenv("TILEDB_FRAGMENT_MANIFEST");
+  FragmentManifest manifest(&fs, array);
+  bool recorded = true;
+  CHECK(manifest.add(array + "/__f1", manifest_entry(true, 1), &recorded) == TILEDB_FM_OK);
+  CHECK(!recorded);
+  CHECK(fs.get_files(array).empty());
+  CHECK(!manifest.load());
+  CHECK(manifest.fragment_num() == 0);
+
+  // Each fragment gets its own shard, so writers do not rewrite each other
+  CHECK(setenv("TILEDB_FRAGMENT_MANIFEST", "1", 1) == 0);
+  CHECK(manifest.add(array + "/__f1", manifest_entry(true, 1)) == TILEDB_FM_OK);
+  unsetenv("TILEDB_FRAGMENT_MANIFEST");
+  CHECK(fs.is_file(manifest.filename()));
+  CHECK(fs.is_file(manifest.shard_filename("__f1")));
+  FragmentManifest other(&fs, array);
+  CHECK(other.add(array + "/__f2", manifest_entry(false, 2), &recorded) == TILEDB_FM_OK);
+  CHECK(recorded);
+  CHECK(fs.is_file(manifest.shard_filename(array + "/__f2")));
+
+  FragmentManifest loaded(&fs, array);
+  CHECK(loaded.load());
+  CHECK(loaded.fragment_num() == 2);
+  REQUIRE(loaded.entry(array + "/__f1") != NULL);
+  CHECK(loaded.entry(array + "/__f1")->dense_);
+  CHECK(loaded.entry("__f1")->non_empty_domain_ == std::vector<char>(16, 1));
+  REQUIRE(loaded.entry(array + "/__f2/") != NULL);
+  CHECK(!loaded.entry(array + "/__f2")->dense_);
+  CHECK(loaded.entry(array + "/__f2")->book_keeping_ == std::vector<char>(100, 2));
+  CHECK(loaded.entry(array + "/__f3") == NULL);
+
+  // Compaction folds the shards, without the stale and removed entries
+  CHECK(manifest.add(array + "/__f3", manifest_entry(true, 3)) == TILEDB_FM_OK);
+  REQUIRE(fs.delete_dir(array + "/__f1") == TILEDB_FS_OK);
+  CHECK(manifest.compact({ array + "/__f2" }) == TILEDB_FM_OK);
+  CHECK(fs.get_files(array).size() == 1);
+  CHECK(loaded.load());
+  CHECK(loaded.fragment_num() == 1);
+  CHECK(loaded.entry(array + "/__f1") == NULL);
+  CHECK(loaded.entry(array + "/__f2") == NULL);
+  REQUIRE(loaded.entry(array + "/__f3") != NULL);
+  CHECK(loaded.entry(array + "/__f3")->book_keeping_ == std::vector<char>(100, 3));
+  CHECK(manifest.shard_num() == 0);
+
+  // Opening reads the shards of the listed directories missing from the
+  // manifest only
+  REQUIRE(fs.create_dir(array + "/__f5") == TILEDB_FS_OK);
+  CHECK(manifest.add(array + "/__f5", manifest_entry(false, 5)) == TILEDB_FM_OK);
+  CHECK(manifest.shard_num() == 1);
+  CHECK(loaded.load({ array + "/__f3" }));
+  CHECK(loaded.fragment_num() == 1);
+  CHECK(loaded.load({ array + "/__f3", array + "/__f5" }));
+  CHECK(loaded.fragment_num() == 2);
+  REQUIRE(loaded.entry(array + "/__f5") != NULL);
+  CHECK(loaded.entry(array + "/__f5")->book_keeping_ == std::vector<char>(100, 5));
+  CHECK(manifest.compact({}) == TILEDB_FM_OK);
+  CHECK(manifest.shard_num() == 0);
+  CHECK(loaded.load({ array + "/__f3", array + "/__f5" }));
+  CHECK(loaded.fragment_num() == 2);
+  REQUIRE(fs.delete_dir(array + "/__f5") == TILEDB_FS_OK);
+  CHECK(manifest.compact({}) == TILEDB_FM_OK);
+
+  // Shards are not trusted without the manifest file
+  REQUIRE(fs.create_dir(array + "/__f6") == TILEDB_FS_OK);
+  CHECK(manifest.add(array + "/__f6", manifest_entry(true, 6)) == TILEDB_FM_OK);
+  REQUIRE(fs.move_path(manifest.filename(), manifest.filename() + ".bak") == TILEDB_FS_OK);
+  CHECK(manifest.shard_num() == 0);
+  CHECK(!loaded.load({ array + "/__f3", array + "/__f6" }));
+  CHECK(loaded.fragment_num() == 0);
+  REQUIRE(fs.move_path(manifest.filename() + ".bak", manifest.filename()) == TILEDB_FS_OK);
+  REQUIRE(fs.delete_file(manifest.shard_filename("__f6")) == TILEDB_FS_OK);
+  REQUIRE(fs.delete_dir(array + "/__f6") == TILEDB_FS_OK);
+
+  // A corrupt shard is skipped
+  REQUIRE(fs.create_dir(array + "/__f4") == TILEDB_FS_OK);
+  REQUIRE(write_to_file_after_compression(&fs, loaded.shard_filename("__f4"), "garbage", 7, TILEDB_GZIP) == TILEDB_UT_OK);
+  CHECK(loaded.load());
+  CHECK(loaded.fragment_num() == 1);
+  CHECK(loaded.entry(array + "/__f4") == NULL);
+
+  // A corrupt manifest reads as no manifest
+  REQUIRE(fs.delete_file(loaded.filename()) == TILEDB_FS_OK);
+  REQUIRE(write_to_file_after_compression(&fs, loaded.filename(), "garbage", 7, TILEDB_GZIP) == TILEDB_UT_OK);
+  CHECK(!loaded.load());
+  CHECK(loaded.fragment_num() == 0);
+
+  // Clearing removes the manifest and its shards
+  CHECK(loaded.clear() == TILEDB_FM_OK);
+  CHECK(fs.get_files(array).empty());
+}
@@ -0,0 +1,168 @@
+/**
+ * @file   test_mbr_overlap.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the scan of MBRs for tiles overlapping a subarray
+ */
+
+#include "catch.h"
+#include "mbr_overlap.h"
+#include "utils.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/** Random MBRs of tile_num tiles over [0, 1000) per dimension, as tiles and as columns. */
+template<class T>
+static void random_mbrs(
+    int64_t tile_num,
+    int dim_num,
+    std::vector<T>& mbrs,
+    std::vector<T>& mbr_columns) {
+  std::mt19937 gen(tile_num);
+  std::uniform_int_distribution<int> low(0, 999), extent(0, 20);
+  mbrs.resize(2*dim_num*tile_num);
+  mbr_columns.resize(2*dim_num*tile_num);
+  for (int64_t i = 0; i < tile_num; ++i) {
+    for (int d = 0; d < dim_num; ++d) {
+      T lo = low(gen);
+      T hi = lo + extent(gen);
+      mbrs[2*dim_num*i + 2*d] = lo;
+      mbrs[2*dim_num*i + 2*d + 1] = hi;
+      mbr_columns[2*d*tile_num + i] = lo;
+      mbr_columns[(2*d+1)*tile_num + i] = hi;
+    }
+  }
+}
+
+/** The first overlapping tile in [start, end] found one tile at a time. */
+template<class T>
+static int64_t next_overlapping_mbr_scalar(
+    const std::vector<T>& mbrs,
+    int dim_num,
+    const T* subarray,
+    int64_t start,
+    int64_t end) {
+  for (int64_t i = start; i <= end; ++i) {
+    const T* mbr = &mbrs[2*dim_num*i];
+    bool overlaps = true;
+    for (int d = 0; d < dim_num && overlaps; ++d) {
+      overlaps = mbr[2*d] <= subarray[2*d+1] && mbr[2*d+1] >= subarray[2*d];
+    }
+    if (overlaps) {
+      return i;
+    }
+  }
+  return end+1;
+}
+
+template<class T>
+static void check_next_overlapping_mbr(int dim_num) {
+  int64_t tile_num = 5000;
+  std::vector<T> mbrs, mbr_columns;
+  random_mbrs(tile_num, dim_num, mbrs, mbr_columns);
+  std::vector<std::vector<T>> subarrays = {
+    std::vector<T>(2*dim_num, 500), std::vector<T>(2*dim_num, 2000) };
+  for (int d = 0; d < dim_num; ++d) {
+    subarrays.push_back(std::vector<T>(2*dim_num, 0));
+    for (int i = 0; i < dim_num; ++i) {
+      subarrays.back()[2*i+1] = 1100;
+    }
+    subarrays.back()[2*d] = 100;
+    subarrays.back()[2*d+1] = 130;
+  }
+  for (auto& subarray : subarrays) {
+    for (auto range : { std::make_pair(0l, tile_num-1), std::make_pair(7l, 7l), std::make_pair(100l, 2100l) }) {
+      int64_t pos = range.first-1;
+      do {
+        int64_t expected = next_overlapping_mbr_scalar(mbrs, dim_num, subarray.data(), pos+1, range.second);
+        pos = next_overlapping_mbr(mbr_columns.data(), tile_num, dim_num, subarray.data(), pos+1, range.second);
+        CHECK(pos == expected);
+      } while (pos <= range.second);
+    }
+  }
+}
+
+TEST_CASE("Test scanning MBRs for overlapping tiles", "[mbr_overlap]") {
+  for (auto dim_num : { 1, 2, 3 }) {
+    check_next_overlapping_mbr<int>(dim_num);
+    check_next_overlapping_mbr<int64_t>(dim_num);
+    check_next_overlapping_mbr<float>(dim_num);
+    check_next_overlapping_mbr<double>(dim_num);
+  }
+}
+
+TEST_CASE("Benchmark scanning MBRs for overlapping tiles", "[benchmark_mbr_overlap]") {
+  if (!is_env_set("TILEDB_BENCHMARK")) {
+    return;
+  }
+
+  // One MBR allocation per tile as before, tiles one after the other and
+  // one column per dimension
+  int64_t tile_num = 1000000;
+  int dim_num = 2;
+  std::vector<int64_t> mbrs, mbr_columns;
+  random_mbrs(tile_num, dim_num, mbrs, mbr_columns);
+  std::vector<void*> mbr_pointers(tile_num);
+  for (int64_t i = 0; i < tile_num; ++i) {
+    mbr_pointers[i] = malloc(2*dim_num*sizeof(int64_t));
+    memcpy(mbr_pointers[i], &mbrs[2*dim_num*i], 2*dim_num*sizeof(int64_t));
+  }
+
+  // A subarray overlapping about 1 in 1000 tiles
+  int64_t subarray[] = { 100, 102, 100, 120 };
+  for (auto layout : { "per-tile allocations", "contiguous tiles", "columns" }) {
+    Catch::Timer t;
+    t.start();
+    int64_t overlapping = 0;
+    for (int64_t pos = 0; pos < tile_num; ++pos) {
+      if (layout[0] == 'p') {
+        for (; pos < tile_num; ++pos) {
+          const int64_t* mbr = static_cast<const int64_t*>(mbr_pointers[pos]);
+          if (mbr[0] <= subarray[1] && mbr[1] >= subarray[0] && mbr[2] <= subarray[3] && mbr[3] >= subarray[2]) {
+            break;
+          }
+        }
+      } else if (layout[1] == 'o') {
+        pos = next_overlapping_mbr_scalar(mbrs, dim_num, subarray, pos, tile_num-1);
+      } else {
+        pos = next_overlapping_mbr(mbr_columns.data(), tile_num, dim_num, subarray, pos, tile_num-1);
+      }
+      overlapping += (pos < tile_num);
+    }
+    auto elapsed = t.getElapsedMicroseconds();
+    std::cerr << "Scan " << tile_num << " MBRs with " << layout << " found " << overlapping
+              << " overlapping tiles elapsed time = " << elapsed << "us" << std::endl;
+  }
+
+  for (auto mbr : mbr_pointers) {
+    free(mbr);
+  }
+}
@@ -0,0 +1,181 @@
+/**
+ * @file   test_rtree.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the R-tree over the MBRs of a sparse fragment
+ */
+
+#include "catch.h"
+#include "mbr_overlap.h"
+#include "rtree.h"
+#include "tiledb_constants.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/**
+ * MBRs of tile_num tiles as columns. Ordered tiles follow each other along
+ * the first dimension like tiles in global order do, otherwise they are
+ * scattered over [0, 1000) per dimension.
+ */
+template<class T>
+static std::vector<T> random_mbr_columns(int64_t tile_num, int dim_num, bool ordered) {
+  std::mt19937 gen(tile_num);
+  std::uniform_int_distribution<int> low(0, 999), extent(0, 20);
+  std::vector<T> mbr_columns(2*dim_num*tile_num);
+  for (int64_t i = 0; i < tile_num; ++i) {
+    for (int d = 0; d < dim_num; ++d) {
+      T lo = (ordered && d == 0) ? T(i) : T(low(gen));
+      mbr_columns[2*d*tile_num + i] = lo;
+      mbr_columns[(2*d+1)*tile_num + i] = lo + extent(gen);
+    }
+  }
+  return mbr_columns;
+}
+
+/** The first tile in [start, end] overlapping any of the ranges, found one tile at a time. */
+template<class T>
+static int64_t next_overlapping_tile_scalar(
+    const std::vector<T>& mbr_columns,
+    int64_t tile_num,
+    int dim_num,
+    const std::vector<T>& ranges,
+    int64_t start,
+    int64_t end) {
+  for (int64_t i = start; i <= end; ++i) {
+    for (size_t r = 0; r < ranges.size(); r += 2*dim_num) {
+      bool overlaps = true;
+      for (int d = 0; d < dim_num && overlaps; ++d) {
+        overlaps = mbr_columns[2*d*tile_num + i] <= ranges[r + 2*d+1] &&
+                   mbr_columns[(2*d+1)*tile_num + i] >= ranges[r + 2*d];
+      }
+      if (overlaps) {
+        return i;
+      }
+    }
+  }
+  return end+1;
+}
+
+template<class T>
+static void check_rtree(int coords_type, int64_t tile_num, int dim_num, int fanout, bool ordered) {
+  std::vector<T> mbr_columns = random_mbr_columns<T>(tile_num, dim_num, ordered);
+  RTree rtree(coords_type, dim_num, tile_num, mbr_columns.data(), fanout);
+  CHECK(rtree.level_num() >= (tile_num > 1));
+
+  // A point, no overlap, thin slabs along every dimension, and several
+  // of them as one multi-range query
+  std::vector<std::vector<T>> queries = {
+    std::vector<T>(2*dim_num, 500), std::vector<T>(2*dim_num, 2000), std::vector<T>() };
+  for (int d = 0; d < dim_num; ++d) {
+    std::vector<T> slab(2*dim_num, 0);
+    for (int i = 0; i < dim_num; ++i) {
+      slab[2*i+1] = 1100;
+    }
+    slab[2*d] = 100 + 300*d;
+    slab[2*d+1] = 130 + 300*d;
+    queries.push_back(slab);
+    queries[2].insert(queries[2].end(), slab.begin(), slab.end());
+  }
+
+  for (auto& ranges : queries) {
+    int range_num = ranges.size() / (2*dim_num);
+    for (auto range : { std::make_pair(int64_t(0), tile_num-1), std::make_pair(int64_t(7), int64_t(7)),
+                        std::make_pair(int64_t(100), int64_t(2100)) }) {
+      range.second = std::min(range.second, tile_num-1);
+      int64_t pos = range.first-1;
+      do {
+        int64_t expected = next_overlapping_tile_scalar(mbr_columns, tile_num, dim_num, ranges, pos+1, range.second);
+        pos = rtree.next_overlapping_tile(ranges.data(), range_num, pos+1, range.second);
+        CHECK(pos == expected);
+      } while (pos <= range.second);
+    }
+  }
+}
+
+TEST_CASE("Test searching the R-tree for overlapping tiles", "[rtree]") {
+  for (auto tile_num : { 0, 1, 16, 17, 5000 }) {
+    for (auto dim_num : { 1, 2, 3 }) {
+      for (auto fanout : { 2, 16 }) {
+        for (auto ordered : { true, false }) {
+          check_rtree<int>(TILEDB_INT32, tile_num, dim_num, fanout, ordered);
+          check_rtree<int64_t>(TILEDB_INT64, tile_num, dim_num, fanout, ordered);
+          check_rtree<float>(TILEDB_FLOAT32, tile_num, dim_num, fanout, ordered);
+          check_rtree<double>(TILEDB_FLOAT64, tile_num, dim_num, fanout, ordered);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Benchmark searching the R-tree for overlapping tiles", "[benchmark_rtree]") {
+  if (!is_env_set("TILEDB_BENCHMARK")) {
+    return;
+  }
+
+  // 1M tiles in global order along the first dimension
+  int64_t tile_num = 1000000;
+  int dim_num = 2;
+  std::vector<int64_t> mbr_columns = random_mbr_columns<int64_t>(tile_num, dim_num, true);
+  Catch::Timer t;
+  t.start();
+  RTree rtree(TILEDB_INT64, dim_num, tile_num, mbr_columns.data());
+  std::cerr << "Bulk-load R-tree over " << tile_num << " MBRs elapsed time = "
+            << t.getElapsedMicroseconds() << "us" << std::endl;
+
+  // A selective range, and ten of them as one multi-range query
+  std::vector<int64_t> ranges;
+  for (int64_t r = 0; r < 10; ++r) {
+    std::vector<int64_t> range = { 100000*r + 5000, 100000*r + 5100, 100, 120 };
+    ranges.insert(ranges.end(), range.begin(), range.end());
+  }
+  for (auto range_num : { 1, 10 }) {
+    for (auto search : { "scan", "R-tree" }) {
+      t.start();
+      int64_t overlapping = 0;
+      for (int64_t pos = 0; pos < tile_num; ++pos) {
+        if (search[0] == 's') {
+          int64_t next = tile_num;
+          for (int r = 0; r < range_num; ++r) {
+            next = next_overlapping_mbr(mbr_columns.data(), tile_num, dim_num, &ranges[4*r], pos, next-1);
+          }
+          pos = next;
+        } else {
+          pos = rtree.next_overlapping_tile(ranges.data(), range_num, pos, tile_num-1);
+        }
+        overlapping += (pos < tile_num);
+      }
+      auto elapsed = t.getElapsedMicroseconds();
+      std::cerr << "Search " << tile_num << " MBRs for " << range_num << " range(s) with " << search
+                << " found " << overlapping << " overlapping tiles elapsed time = " << elapsed << "us" << std::endl;
+    }
+  }
+}
@@ -0,0 +1,55 @@
+/**
+ * @file   test_aligned_allocator.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the AlignedAllocator class
+ */
+
+#include "catch.h"
+#include "aligned_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+
+TEST_CASE("Test AlignedAllocator", "[aligned_allocator]") {
+  AlignedBuffer<4096> buffer;
+  for (auto size : { 1ul, 4096ul, 10000ul, 1048576ul }) {
+    buffer.resize(size);
+    CHECK(reinterpret_cast<uintptr_t>(buffer.data())%4096 == 0);
+    memset(buffer.data(), 'A', size);
+    CHECK(buffer[size-1] == 'A');
+  }
+
+  std::vector<int64_t, AlignedAllocator<int64_t, 64> > values(100, 7);
+  CHECK(reinterpret_cast<uintptr_t>(values.data())%64 == 0);
+  CHECK(values[99] == 7);
+  values.push_back(8);
+  CHECK(reinterpret_cast<uintptr_t>(values.data())%64 == 0);
+  CHECK(values.back() == 8);
+  CHECK(values[0] == 7);
+}
@@ -615,6 +615,38 @@ TEST_CASE("Test empty value concept", "[empty_cell_val]") {
 
 }
 
+TEST_CASE("Test parsing environment variables", "[env_uint64]") {
+  unsetenv("TILEDB_TEST_ENV_UINT64");
+  CHECK(get_env_uint64("TILEDB_TEST_ENV_UINT64", 42) == 42);
+  setenv("TILEDB_TEST_ENV_UINT64", "1024", 1);
+  CHECK(get_env_uint64("TILEDB_TEST_ENV_UINT64", 42) == 1024);
+  setenv("TILEDB_TEST_ENV_UINT64", "0", 1);
+  CHECK(get_env_uint64("TILEDB_TEST_ENV_UINT64", 42) == 0);
+
+  // Malformed values keep the default
+  for (auto value : { "", "abc", "12x", "-1", " 12", "99999999999999999999999" }) {
+    setenv("TILEDB_TEST_ENV_UINT64", value, 1);
+    CHECK(get_env_uint64("TILEDB_TEST_ENV_UINT64", 42) == 42);
+  }
+  unsetenv("TILEDB_TEST_ENV_UINT64");
+}
+
+TEST_CASE("Test parsing floating-point environment variables", "[env_double]") {
+  unsetenv("TILEDB_TEST_ENV_DOUBLE");
+  CHECK(get_env_double("TILEDB_TEST_ENV_DOUBLE", 0.5) == 0.5);
+  setenv("TILEDB_TEST_ENV_DOUBLE", "0.001", 1);
+  CHECK(get_env_double("TILEDB_TEST_ENV_DOUBLE", 0.5) == 0.001);
+  setenv("TILEDB_TEST_ENV_DOUBLE", "-2", 1);
+  CHECK(get_env_double("TILEDB_TEST_ENV_DOUBLE", 0.5) == -2);
+
+  // Malformed values keep the default
+  for (auto value : { "", "abc", "0.1x", " 0.1", "nan", "inf", "1e999" }) {
+    setenv("TILEDB_TEST_ENV_DOUBLE", value, 1);
+    CHECK(get_env_double("TILEDB_TEST_ENV_DOUBLE", 0.5) == 0.5);
+  }
+  unsetenv("TILEDB_TEST_ENV_DOUBLE");
+}
+
 TEST_CASE("Test storage URIs", "[storage_uris]") {
   CHECK(!is_supported_cloud_path("gibberish://ddd/d"));
 
@@ -629,4 +661,8 @@ TEST_CASE("Test storage URIs", "[storage_uris]") {
   CHECK(is_supported_cloud_path("abfs://ddd/d"));
   CHECK(is_supported_cloud_path("abfss://ddd/d"));
   CHECK(is_supported_cloud_path("adl://ddd/d"));
+
+  CHECK(is_supported_cloud_path("sim:///ddd/d"));
+  CHECK(is_sim_path("sim:///ddd/d"));
+  CHECK(!is_sim_path("/ddd/d"));
 }
@@ -0,0 +1,105 @@
+/**
+ * @file   test_mmap_registry.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ *
+ * Tests for the MMapRegistry class
+ */
+
+#include "catch.h"
+#include "mmap_registry.h"
+#include "storage_posixfs.h"
+#include "utils.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST_CASE("Test MMapRegistry", "[mmap_registry]") {
+  TempDir td;
+  PosixFS fs;
+  MMapRegistry registry;
+
+  std::string filename = td.get_temp_dir() + "/test_mmap_file";
+  std::vector<char> data(10000);
+  for (auto i=0ul; i<data.size(); i++) {
+    data[i] = i%128;
+  }
+  REQUIRE(fs.write_to_file(filename, data.data(), data.size()) == TILEDB_FS_OK);
+  REQUIRE(fs.close_file(filename) == TILEDB_FS_OK);
+
+  CHECK(registry.acquire(td.get_temp_dir() + "/non_existent_file").get() == NULL);
+
+  {
+    // Holders of the same file share one mapping
+    auto mapped_file = registry.acquire(filename);
+    REQUIRE(mapped_file.get() != NULL);
+    CHECK(mapped_file->size() == 10000);
+    CHECK(memcmp(mapped_file->data(), data.data(), data.size()) == 0);
+    auto mapped_file_1 = registry.acquire(filename);
+    CHECK(mapped_file_1 == mapped_file);
+    CHECK(registry.maps() == 1);
+    CHECK(registry.mapped_files() == 1);
+  }
+
+  // Unmapped with the last holder
+  CHECK(registry.mapped_files() == 0);
+  auto mapped_file = registry.acquire(filename);
+  CHECK(registry.maps() == 2);
+
+  // A replaced file gets a new mapping, the old one stays valid
+  std::string new_filename = filename + ".new";
+  std::vector<char> new_data(5000, 'z');
+  REQUIRE(fs.write_to_file(new_filename, new_data.data(), new_data.size()) == TILEDB_FS_OK);
+  REQUIRE(fs.close_file(new_filename) == TILEDB_FS_OK);
+  REQUIRE(fs.move_path(new_filename, filename) == TILEDB_FS_OK);
+  auto new_mapped_file = registry.acquire(filename);
+  REQUIRE(new_mapped_file.get() != NULL);
+  CHECK(new_mapped_file != mapped_file);
+  CHECK(new_mapped_file->size() == 5000);
+  CHECK(memcmp(new_mapped_file->data(), new_data.data(), new_data.size()) == 0);
+  CHECK(memcmp(mapped_file->data(), data.data(), data.size()) == 0);
+  CHECK(registry.maps() == 3);
+
+  // Access pattern hints on ranges of the mapping
+  CHECK(mapped_file->advise(0, 0, TILEDB_FS_ACCESS_SEQUENTIAL) == TILEDB_FS_OK);
+  CHECK(mapped_file->advise(5000, 100, TILEDB_FS_ACCESS_WILLNEED) == TILEDB_FS_OK);
+  CHECK(mapped_file->advise(9999, 100, TILEDB_FS_ACCESS_RANDOM) == TILEDB_FS_OK);
+  CHECK(mapped_file->advise(20000, 0, TILEDB_FS_ACCESS_RANDOM) == TILEDB_FS_OK);
+  CHECK(memcmp(mapped_file->data(), data.data(), data.size()) == 0);
+
+  // Empty files have nothing to map
+  std::string empty_filename = td.get_temp_dir() + "/test_mmap_empty_file";
+  REQUIRE(fs.create_file(empty_filename, O_WRONLY|O_CREAT, S_IRWXU) == TILEDB_FS_OK);
+  auto empty_mapped_file = registry.acquire(empty_filename);
+  REQUIRE(empty_mapped_file.get() != NULL);
+  CHECK(empty_mapped_file->size() == 0);
+  CHECK(empty_mapped_file->data() == NULL);
+  CHECK(empty_mapped_file->advise(0, 0, TILEDB_FS_ACCESS_WILLNEED) == TILEDB_FS_OK);
+}
@@ -33,14 +33,20 @@
 #include "catch.h"
 #include "buffer.h"
 #include "storage_posixfs.h"
+#include "tiledb.h"
 #include "utils.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstdio>
+#include <iostream>
+#include <numeric>
+#include <random>
 #include <string>
 #include <thread>
 
@@ -188,6 +194,422 @@ TEST_CASE_METHOD(PosixFSTestFixture, "Test PosixFS read/write file", "[read-writ
   free(buffer);
 }
 
+TEST_CASE_METHOD(PosixFSTestFixture, "Test PosixFS read file descriptor cache", "[read_fd_cache]") {
+  test_dir += "read_fd_cache";
+  CHECK_RC(fs.create_dir(test_dir), TILEDB_FS_OK);
+  fs.set_max_open_read_files(2);
+  CHECK(fs.max_open_read_files() == 2);
+
+  char buffer[20];
+  for (auto i=1ul; i<=3; i++) {
+    std::string filename = test_dir+"/foo"+std::to_string(i);
+    CHECK_RC(fs.write_to_file(filename, "hello", 5), TILEDB_FS_OK);
+    CHECK_RC(fs.read_from_file(filename, 0, buffer, 5), TILEDB_FS_OK);
+    CHECK(fs.open_read_files() == std::min(i, (size_t)2));
+  }
+
+  // Least recently used foo1 was evicted
+  CHECK_RC(fs.read_from_file(test_dir+"/foo3", 0, buffer, 5), TILEDB_FS_OK);
+  CHECK(fs.open_read_files() == 2);
+  CHECK_RC(fs.read_from_file(test_dir+"/foo1", 0, buffer, 5), TILEDB_FS_OK);
+  CHECK(fs.open_read_files() == 2);
+  CHECK_RC(fs.close_file(test_dir+"/foo1"), TILEDB_FS_OK);
+  CHECK(fs.open_read_files() == 1);
+
+  // Appends are visible through cached descriptors
+  CHECK_RC(fs.write_to_file(test_dir+"/foo3", "world", 5), TILEDB_FS_OK);
+  CHECK_RC(fs.read_from_file(test_dir+"/foo3", 5, buffer, 5), TILEDB_FS_OK);
+  CHECK(strncmp(buffer, "world", 5) == 0);
+
+  // Deleting or moving invalidates the cache
+  CHECK_RC(fs.delete_file(test_dir+"/foo3"), TILEDB_FS_OK);
+  CHECK(fs.open_read_files() == 0);
+  CHECK_RC(fs.read_from_file(test_dir+"/foo3", 0, buffer, 5), TILEDB_FS_ERR);
+  CHECK_RC(fs.write_to_file(test_dir+"/foo3", "bye", 3), TILEDB_FS_OK);
+  CHECK_RC(fs.read_from_file(test_dir+"/foo3", 0, buffer, 3), TILEDB_FS_OK);
+  CHECK(strncmp(buffer, "bye", 3) == 0);
+  CHECK(fs.open_read_files() == 1);
+  CHECK_RC(fs.move_path(test_dir+"/foo2", test_dir+"/foo3"), TILEDB_FS_OK);
+  CHECK(fs.open_read_files() == 0);
+  CHECK_RC(fs.read_from_file(test_dir+"/foo3", 0, buffer, 5), TILEDB_FS_OK);
+  CHECK(strncmp(buffer, "hello", 5) == 0);
+  CHECK(fs.open_read_files() == 1);
+
+  // Disable caching
+  fs.set_max_open_read_files(0);
+  CHECK(fs.open_read_files() == 0);
+  CHECK_RC(fs.read_from_file(test_dir+"/foo3", 0, buffer, 5), TILEDB_FS_OK);
+  CHECK(fs.open_read_files() == 0);
+
+  fs.set_max_open_read_files(2);
+  CHECK_RC(fs.read_from_file(test_dir+"/foo3", 0, buffer, 5), TILEDB_FS_OK);
+  CHECK(fs.open_read_files() == 1);
+  CHECK_RC(fs.delete_dir(test_dir), TILEDB_FS_OK);
+  CHECK(fs.open_read_files() == 0);
+}
+
+TEST_CASE("Test PosixFS read file descriptor cache env", "[read_fd_cache_env]") {
+  unsetenv("TILEDB_MAX_OPEN_READ_FILES");
+  PosixFS fs;
+  CHECK(fs.max_open_read_files() == TILEDB_MAX_OPEN_READ_FILES); // default
+  CHECK(setenv("TILEDB_MAX_OPEN_READ_FILES", "16", 1) == 0);
+  PosixFS fs1;
+  CHECK(fs1.max_open_read_files() == 16);
+  unsetenv("TILEDB_MAX_OPEN_READ_FILES");
+}
+
+TEST_CASE("Test PosixFS coalescing env", "[coalesce_env]") {
+  CHECK(setenv("TILEDB_COALESCE_MAX_GAP", "4096", 1) == 0);
+  CHECK(setenv("TILEDB_COALESCE_MAX_SIZE", "1048576", 1) == 0);
+  PosixFS fs;
+  CHECK(fs.get_coalesce_max_gap() == 4096);
+  CHECK(fs.get_coalesce_max_size() == 1048576);
+
+  // The env is read once on construction, and invalid sizes keep the default
+  CHECK(setenv("TILEDB_COALESCE_MAX_GAP", "4K", 1) == 0);
+  CHECK(setenv("TILEDB_COALESCE_MAX_SIZE", "-1", 1) == 0);
+  CHECK(fs.get_coalesce_max_gap() == 4096);
+  CHECK(fs.get_coalesce_max_size() == 1048576);
+  PosixFS fs1;
+  CHECK(fs1.get_coalesce_max_gap() == 0);
+  CHECK(fs1.get_coalesce_max_size() == 0);
+  unsetenv("TILEDB_COALESCE_MAX_GAP");
+  unsetenv("TILEDB_COALESCE_MAX_SIZE");
+}
+
+TEST_CASE_METHOD(PosixFSTestFixture, "Test PosixFS vectored reads", "[read_from_file_v]") {
+  test_dir += "read_from_file_v";
+  CHECK_RC(fs.create_dir(test_dir), TILEDB_FS_OK);
+  CHECK_RC(fs.write_to_file(test_dir+"/foo", "hello world", 11), TILEDB_FS_OK);
+  CHECK_RC(fs.write_to_file(test_dir+"/bar", "0123456789", 10), TILEDB_FS_OK);
+
+  char buffer[4][8];
+  std::vector<StorageFSRead> reads = {
+    { test_dir+"/foo", 6, buffer[0], 5 },
+    { test_dir+"/bar", 2, buffer[1], 3 },
+    { test_dir+"/foo", 0, buffer[2], 5 },
+    { test_dir+"/bar", 0, buffer[3], 0 } };
+  CHECK_RC(fs.read_from_file_v(reads), TILEDB_FS_OK);
+  CHECK(strncmp(buffer[0], "world", 5) == 0);
+  CHECK(strncmp(buffer[1], "234", 3) == 0);
+  CHECK(strncmp(buffer[2], "hello", 5) == 0);
+
+  // The reads went through io_uring rather than the pread fallback where the
+  // kernel supports it
+  if (URing().is_supported()) {
+    CHECK(fs.uring_read_num() >= 3);
+  } else {
+    CHECK(fs.uring_read_num() == 0);
+  }
+
+  // More reads than the queue depth, each of them in flight at some point
+  std::vector<char> bytes(4*TILEDB_URING_QUEUE_DEPTH);
+  std::vector<StorageFSRead> many_reads;
+  for (auto i = 0u; i < bytes.size(); i++) {
+    many_reads.push_back({ test_dir+"/bar", (off_t)(i%10), &bytes[i], 1 });
+  }
+  uint64_t uring_read_num = fs.uring_read_num();
+  CHECK_RC(fs.read_from_file_v(many_reads), TILEDB_FS_OK);
+  for (auto i = 0u; i < bytes.size(); i++) {
+    CHECK(bytes[i] == '0'+(char)(i%10));
+  }
+  if (URing().is_supported()) {
+    CHECK(fs.uring_read_num() == uring_read_num+bytes.size());
+  }
+
+  // Base class implementation reads one range at a time
+  CHECK_RC(fs.StorageFS::read_from_file_v(reads), TILEDB_FS_OK);
+  CHECK(strncmp(buffer[0], "world", 5) == 0);
+
+  // Reading past the end or from a non-existent file fails the whole batch
+  reads.push_back({ test_dir+"/bar", 8, buffer[3], 5 });
+  CHECK_RC(fs.read_from_file_v(reads), TILEDB_FS_ERR);
+  reads.back() = { test_dir+"/non-existent", 0, buffer[3], 5 };
+  CHECK_RC(fs.read_from_file_v(reads), TILEDB_FS_ERR);
+  CHECK_RC(fs.StorageFS::read_from_file_v(reads), TILEDB_FS_ERR);
+}
+
+TEST_CASE_METHOD(PosixFSTestFixture, "Test PosixFS batched syncs", "[sync_paths]") {
+  test_dir += "sync_paths";
+  CHECK_RC(fs.create_dir(test_dir), TILEDB_FS_OK);
+
+  std::vector<std::string> paths;
+  for (auto i=0; i<2*TILEDB_SYNC_PATHS_THREADS+1; i++) {
+    std::string filename = test_dir+"/foo"+std::to_string(i);
+    CHECK_RC(fs.write_to_file(filename, "hello", 5), TILEDB_FS_OK);
+    paths.push_back(filename);
+  }
+  paths.push_back(test_dir+"/non-existent");
+  paths.push_back(test_dir);
+  CHECK_RC(fs.sync_paths(paths), TILEDB_FS_OK);
+  CHECK_RC(fs.StorageFS::sync_paths(paths), TILEDB_FS_OK);
+  CHECK_RC(fs.sync_paths({}), TILEDB_FS_OK);
+  CHECK_RC(fs.sync_paths({ test_dir+"/non-existent" }), TILEDB_FS_OK);
+
+  CHECK_RC(fs.delete_dir(test_dir), TILEDB_FS_OK);
+}
+
+TEST_CASE_METHOD(PosixFSTestFixture, "Test PosixFS access pattern hints", "[advise_file]") {
+  test_dir += "advise_file";
+  CHECK_RC(fs.create_dir(test_dir), TILEDB_FS_OK);
+  CHECK_RC(fs.write_to_file(test_dir+"/foo", "hello world", 11), TILEDB_FS_OK);
+  CHECK_RC(fs.close_file(test_dir+"/foo"), TILEDB_FS_OK);
+
+  for (auto advice : { TILEDB_FS_ACCESS_NORMAL, TILEDB_FS_ACCESS_SEQUENTIAL, TILEDB_FS_ACCESS_RANDOM,
+          TILEDB_FS_ACCESS_WILLNEED, TILEDB_FS_ACCESS_DONTNEED }) {
+    CHECK_RC(fs.advise_file(test_dir+"/foo", 0, 0, advice), TILEDB_FS_OK);
+    CHECK_RC(fs.advise_file(test_dir+"/foo", 6, 5, advice), TILEDB_FS_OK);
+  }
+
+  // Hints do not change what is read
+  char buffer[11];
+  CHECK_RC(fs.read_from_file(test_dir+"/foo", 0, buffer, 11), TILEDB_FS_OK);
+  CHECK(strncmp(buffer, "hello world", 11) == 0);
+
+  CHECK_RC(fs.advise_file(test_dir+"/non-existent", 0, 0, TILEDB_FS_ACCESS_RANDOM), TILEDB_FS_ERR);
+
+  // Base class ignores hints
+  CHECK_RC(fs.StorageFS::advise_file(test_dir+"/non-existent", 0, 0, TILEDB_FS_ACCESS_RANDOM), TILEDB_FS_OK);
+}
+
+TEST_CASE_METHOD(PosixFSTestFixture, "Benchmark PosixFS tile reads with read file descriptor cache", "[benchmark_read_fd_cache]") {
+  if (!is_env_set("TILEDB_BENCHMARK")) {
+    return;
+  }
+  test_dir += "benchmark_read_fd_cache";
+  REQUIRE(fs.create_dir(test_dir) == TILEDB_FS_OK);
+
+  // Simulate attribute files with many small tiles
+  const int num_files = 8;
+  const size_t tile_size = 4096;
+  const int tiles_per_file = 1024;
+  std::vector<char> tile(tile_size, 'T');
+  for (auto i=0; i<num_files; i++) {
+    std::string filename = test_dir+"/attr"+std::to_string(i)+".tdb";
+    for (auto j=0; j<tiles_per_file; j++) {
+      REQUIRE(fs.write_to_file(filename, tile.data(), tile_size) == TILEDB_FS_OK);
+    }
+  }
+
+  for (auto max_open : {size_t(0), size_t(TILEDB_MAX_OPEN_READ_FILES)}) {
+    fs.set_max_open_read_files(max_open);
+    Catch::Timer t;
+    t.start();
+    for (auto j=0; j<tiles_per_file; j++) {
+      for (auto i=0; i<num_files; i++) {
+        std::string filename = test_dir+"/attr"+std::to_string(i)+".tdb";
+        CHECK_RC(fs.read_from_file(filename, j*tile_size, tile.data(), tile_size), TILEDB_FS_OK);
+      }
+    }
+    auto elapsed = t.getElapsedMicroseconds();
+    std::cout << "Read file descriptor cache " << (max_open?"on":"off") << ": "
+              << num_files*tiles_per_file << " tile reads in " << elapsed/1000 << "ms = "
+              << (elapsed?(uint64_t)(num_files*tiles_per_file)*1000000/elapsed:0) << " reads/sec" << std::endl;
+  }
+
+  CHECK_RC(fs.delete_dir(test_dir), TILEDB_FS_OK);
+}
+
+TEST_CASE_METHOD(PosixFSTestFixture, "Test PosixFS direct I/O", "[direct_io]") {
+  test_dir += "direct_io";
+  CHECK_RC(fs.create_dir(test_dir), TILEDB_FS_OK);
+
+  CHECK(!fs.direct_io());
+  CHECK(fs.direct_io_min_size() == TILEDB_DIRECT_IO_MIN_SIZE);
+  fs.set_direct_io(true);
+  fs.set_direct_io_min_size(1);
+  CHECK(fs.direct_io());
+
+  // Appends with unaligned heads, tails and sources
+  const size_t alignment = TILEDB_DIRECT_IO_ALIGNMENT;
+  std::vector<char> data(4*alignment + TILEDB_DIRECT_IO_CHUNK_SIZE + 3);
+  for (auto i=0ul; i<data.size(); i++) {
+    data[i] = i%251;
+  }
+  std::vector<std::pair<size_t, size_t>> segments = {
+    { 0, 10 }, { 10, 2*alignment }, { 10+2*alignment, alignment+1 },
+    { 11+3*alignment, data.size()-11-3*alignment } };
+  for (auto& segment : segments) {
+    CHECK_RC(fs.write_to_file(test_dir+"/foo", data.data()+segment.first, segment.second), TILEDB_FS_OK);
+  }
+  CHECK_RC(fs.close_file(test_dir+"/foo"), TILEDB_FS_OK);
+  CHECK(fs.file_size(test_dir+"/foo") == (ssize_t)data.size());
+
+  // Reads at unaligned offsets into unaligned destinations, and aligned ones
+  std::vector<char> buffer(data.size()+1);
+  for (auto offset : { 0ul, 1ul, alignment-1, alignment, 3*alignment+5 }) {
+    for (auto dest : { 0ul, 1ul }) {
+      size_t length = data.size() - offset;
+      memset(buffer.data(), 0, buffer.size());
+      CHECK_RC(fs.read_from_file(test_dir+"/foo", offset, buffer.data()+dest, length), TILEDB_FS_OK);
+      CHECK(memcmp(buffer.data()+dest, data.data()+offset, length) == 0);
+    }
+  }
+  CHECK_RC(fs.read_from_file(test_dir+"/foo", 7, buffer.data(), 100), TILEDB_FS_OK);
+  CHECK(memcmp(buffer.data(), data.data()+7, 100) == 0);
+
+  // Reading past the end fails
+  CHECK_RC(fs.read_from_file(test_dir+"/foo", 1, buffer.data(), data.size()), TILEDB_FS_ERR);
+  CHECK_RC(fs.read_from_file(test_dir+"/non-existent", 0, buffer.data(), 100), TILEDB_FS_ERR);
+
+  // Same with file handles kept open
+  fs.set_keep_write_file_handles_open(true);
+  for (auto& segment : segments) {
+    CHECK_RC(fs.write_to_file(test_dir+"/bar", data.data()+segment.first, segment.second), TILEDB_FS_OK);
+  }
+  CHECK_RC(fs.close_file(test_dir+"/bar"), TILEDB_FS_OK);
+  fs.set_keep_write_file_handles_open(false);
+  CHECK_RC(fs.read_from_file(test_dir+"/bar", 0, buffer.data(), data.size()), TILEDB_FS_OK);
+  CHECK(memcmp(buffer.data(), data.data(), data.size()) == 0);
+
+  CHECK_RC(fs.delete_dir(test_dir), TILEDB_FS_OK);
+}
+
+TEST_CASE("Test PosixFS direct I/O env", "[direct_io_env]") {
+  CHECK(setenv("TILEDB_DIRECT_IO", "1", 1) == 0);
+  CHECK(setenv("TILEDB_DIRECT_IO_MIN_SIZE", "65536", 1) == 0);
+  PosixFS fs;
+  CHECK(fs.direct_io());
+  CHECK(fs.direct_io_min_size() == 65536);
+
+  // Invalid sizes keep the default
+  CHECK(setenv("TILEDB_DIRECT_IO_MIN_SIZE", "64K", 1) == 0);
+  PosixFS fs_invalid;
+  CHECK(fs_invalid.direct_io_min_size() == TILEDB_DIRECT_IO_MIN_SIZE);
+  unsetenv("TILEDB_DIRECT_IO");
+  unsetenv("TILEDB_DIRECT_IO_MIN_SIZE");
+}
+
+// Creates a dense 1D array with an int64 attribute holding the cell index
+static void create_dense_1D_array(TileDB_CTX* tiledb_ctx, const std::string& array_name,
+                                  int64_t cell_num, int64_t tile_extent) {
+  const char* attributes[] = { "a1" };
+  const char* dimensions[] = { "d1" };
+  int64_t domain[] = { 0, cell_num-1 };
+  int64_t tile_extents[] = { tile_extent };
+  const int types[] = { TILEDB_INT64, TILEDB_INT64 };
+  int compression[] = { TILEDB_NO_COMPRESSION, TILEDB_NO_COMPRESSION };
+  TileDB_ArraySchema array_schema;
+  REQUIRE(tiledb_array_set_schema(&array_schema, array_name.c_str(), attributes, 1, 0, TILEDB_ROW_MAJOR, NULL,
+                                  compression, NULL, NULL, NULL, 1, dimensions, 1, domain, sizeof(domain),
+                                  tile_extents, sizeof(tile_extents), TILEDB_ROW_MAJOR, types) == TILEDB_OK);
+  REQUIRE(tiledb_array_create(tiledb_ctx, &array_schema) == TILEDB_OK);
+  REQUIRE(tiledb_array_free_schema(&array_schema) == TILEDB_OK);
+}
+
+// Writes the cells in [begin, end] as a new fragment
+static void write_dense_1D_array(TileDB_CTX* tiledb_ctx, const std::string& array_name, int64_t begin, int64_t end) {
+  std::vector<int64_t> data(end-begin+1);
+  std::iota(data.begin(), data.end(), begin);
+  int64_t subarray[] = { begin, end };
+  TileDB_Array* tiledb_array;
+  REQUIRE(tiledb_array_init(tiledb_ctx, &tiledb_array, array_name.c_str(), TILEDB_ARRAY_WRITE, subarray, NULL, 0) == TILEDB_OK);
+  const void* buffers[] = { data.data() };
+  size_t buffer_sizes[] = { data.size()*sizeof(int64_t) };
+  REQUIRE(tiledb_array_write(tiledb_array, buffers, buffer_sizes) == TILEDB_OK);
+  REQUIRE(tiledb_array_finalize(tiledb_array) == TILEDB_OK);
+}
+
+TEST_CASE_METHOD(PosixFSTestFixture, "Benchmark PosixFS query latency during consolidation with direct I/O", "[benchmark_direct_io]") {
+  if (!is_env_set("TILEDB_BENCHMARK")) {
+    return;
+  }
+  test_dir += "benchmark_direct_io";
+
+  TileDB_Config tiledb_config;
+  memset(&tiledb_config, 0, sizeof(TileDB_Config));
+  tiledb_config.read_method_ = TILEDB_IO_READ;
+  TileDB_CTX* tiledb_ctx;
+  REQUIRE(tiledb_ctx_init(&tiledb_ctx, &tiledb_config) == TILEDB_OK);
+  REQUIRE(tiledb_workspace_create(tiledb_ctx, test_dir.c_str()) == TILEDB_OK);
+
+  // Hot array queried with random 4KB tile reads
+  const int64_t hot_cell_num = 8*1024*1024;
+  const int64_t hot_tile_extent = 512;
+  std::string hot_array = test_dir+"/hot";
+  create_dense_1D_array(tiledb_ctx, hot_array, hot_cell_num, hot_tile_extent);
+  write_dense_1D_array(tiledb_ctx, hot_array, 0, hot_cell_num-1);
+
+  // Cold array of 512MB in four fragments with 2MB tiles, merged by consolidation
+  const int64_t cold_cell_num = 64*1024*1024;
+  const int64_t cold_tile_extent = 256*1024;
+  const int cold_fragment_num = 4;
+
+  for (auto direct_io : { false, true }) {
+    std::string cold_array = test_dir+"/cold_"+(direct_io?"direct":"buffered");
+    create_dense_1D_array(tiledb_ctx, cold_array, cold_cell_num, cold_tile_extent);
+    for (auto i=0; i<cold_fragment_num; i++) {
+      write_dense_1D_array(tiledb_ctx, cold_array, i*cold_cell_num/cold_fragment_num,
+                           (i+1)*cold_cell_num/cold_fragment_num-1);
+    }
+    // The cold fragments start out of the page cache
+    for (auto& fragment : fs.get_dirs(cold_array)) {
+      for (auto& file : fs.get_files(fragment)) {
+        fs.advise_file(file, 0, 0, TILEDB_FS_ACCESS_DONTNEED);
+      }
+    }
+
+    // Warm up the hot array
+    TileDB_Array* tiledb_array;
+    const char* attributes[] = { "a1" };
+    REQUIRE(tiledb_array_init(tiledb_ctx, &tiledb_array, hot_array.c_str(), TILEDB_ARRAY_READ, NULL, attributes, 1) == TILEDB_OK);
+    std::vector<int64_t> hot_data(hot_cell_num);
+    void* buffers[] = { hot_data.data() };
+    size_t buffer_sizes[] = { hot_data.size()*sizeof(int64_t) };
+    REQUIRE(tiledb_array_read(tiledb_array, buffers, buffer_sizes) == TILEDB_OK);
+
+    // Consolidate with its own context, so only its filesystem uses direct I/O
+    TileDB_CTX* consolidation_ctx;
+    if (direct_io) {
+      CHECK(setenv("TILEDB_DIRECT_IO", "1", 1) == 0);
+    }
+    REQUIRE(tiledb_ctx_init(&consolidation_ctx, &tiledb_config) == TILEDB_OK);
+    unsetenv("TILEDB_DIRECT_IO");
+    std::atomic<bool> consolidating(true);
+    int consolidation_rc = TILEDB_ERR;
+    Catch::Timer consolidation_timer;
+    consolidation_timer.start();
+    std::thread consolidation([&]() {
+        consolidation_rc = tiledb_array_consolidate(consolidation_ctx, cold_array.c_str());
+        consolidating = false;
+      });
+
+    std::vector<uint64_t> latencies;
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int64_t> tile_dist(0, hot_cell_num/hot_tile_extent-1);
+    while (consolidating) {
+      int64_t tile = tile_dist(rng);
+      int64_t subarray[] = { tile*hot_tile_extent, (tile+1)*hot_tile_extent-1 };
+      buffer_sizes[0] = hot_tile_extent*sizeof(int64_t);
+      Catch::Timer t;
+      t.start();
+      CHECK_RC(tiledb_array_reset_subarray(tiledb_array, subarray), TILEDB_OK);
+      CHECK_RC(tiledb_array_read(tiledb_array, buffers, buffer_sizes), TILEDB_OK);
+      latencies.push_back(t.getElapsedNanoseconds());
+      CHECK(hot_data[0] == subarray[0]);
+    }
+    consolidation.join();
+    auto elapsed = consolidation_timer.getElapsedMilliseconds();
+    CHECK_RC(consolidation_rc, TILEDB_OK);
+    CHECK_RC(tiledb_ctx_finalize(consolidation_ctx), TILEDB_OK);
+    CHECK_RC(tiledb_array_finalize(tiledb_array), TILEDB_OK);
+
+    std::cout << "Direct I/O " << (direct_io?"on":"off") << ": consolidated "
+              << cold_cell_num*sizeof(int64_t)/(1024*1024) << "MB in " << elapsed << "ms, "
+              << latencies.size() << " concurrent tile reads";
+    if (!latencies.empty()) {
+      std::sort(latencies.begin(), latencies.end());
+      std::cout << " p50=" << latencies[latencies.size()/2]/1000 << "us p99="
+                << latencies[latencies.size()*99/100]/1000 << "us max="
+                << latencies.back()/1000 << "us";
+    }
+    std::cout << std::endl;
+  }
+
+  CHECK_RC(tiledb_ctx_finalize(tiledb_ctx), TILEDB_OK);
+  CHECK_RC(fs.delete_dir(test_dir), TILEDB_FS_OK);
+}
+
 TEST_CASE_METHOD(PosixFSTestFixture, "Test PosixFS large read/write file", "[read-write-large]") {
   if (!is_env_set("TILEDB_TEST_POSIXFS_LARGE")) {
     return;
@@ -0,0 +1,148 @@
+/**
+ * @file   test_sim_fs.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ *
+ * Tests for the SimFS class
+ */
+
+#include "catch.h"
+#include "storage_posixfs.h"
+#include "storage_sim.h"
+#include "tiledb.h"
+#include "utils.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <vector>
+
+class SimFSTestFixture {
+ protected:
+  PosixFS posix_fs;
+
+  TempDir *td;
+  std::string home;
+
+  SimFSTestFixture() {
+    setenv("TILEDB_SIM_LATENCY_US", "5000", 1);
+    setenv("TILEDB_SIM_BANDWIDTH", "0", 1);
+    setenv("TILEDB_SIM_CONCURRENCY", "4", 1);
+    td = new TempDir();
+    home = "sim://" + td->get_temp_dir();
+    SimFS::reset_stats();
+  }
+
+  ~SimFSTestFixture() {
+    unsetenv("TILEDB_SIM_LATENCY_US");
+    unsetenv("TILEDB_SIM_BANDWIDTH");
+    unsetenv("TILEDB_SIM_CONCURRENCY");
+    delete td;
+  }
+};
+
+static long elapsed_ms(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start).count();
+}
+
+TEST_CASE_METHOD(SimFSTestFixture, "Test SimFS paths", "[sim_fs]") {
+  CHECK_THROWS_AS(new SimFS(td->get_temp_dir()), std::system_error);
+
+  SimFS fs(home);
+  CHECK(fs.current_dir() == td->get_temp_dir());
+  CHECK(fs.real_dir(home + "/dir") == td->get_temp_dir() + "/dir");
+  CHECK(fs.real_dir("dir") == td->get_temp_dir() + "/dir");
+  CHECK(fs.real_dir(td->get_temp_dir() + "/dir/../dir2") == td->get_temp_dir() + "/dir2");
+  CHECK(!fs.locking_support());
+
+  REQUIRE(fs.create_dir(home + "/dir") == TILEDB_FS_OK);
+  CHECK(posix_fs.is_dir(td->get_temp_dir() + "/dir"));
+  CHECK(fs.is_dir("dir"));
+  CHECK(fs.get_dirs(home).size() == 1);
+
+  REQUIRE(fs.set_working_dir(home + "/dir") == TILEDB_FS_OK);
+  CHECK(fs.current_dir() == td->get_temp_dir() + "/dir");
+  CHECK(fs.real_dir("file") == td->get_temp_dir() + "/dir/file");
+}
+
+TEST_CASE_METHOD(SimFSTestFixture, "Test SimFS latency and accounting", "[sim_fs]") {
+  SimFS fs(home);
+  std::string test_file = home + "/test_sim_file";
+  std::vector<char> data(1024);
+  for (auto i=0ul; i<data.size(); i++) {
+    data[i] = i%128;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  REQUIRE(fs.write_to_file(test_file, data.data(), data.size()) == TILEDB_FS_OK);
+  REQUIRE(fs.close_file(test_file) == TILEDB_FS_OK);
+  CHECK(elapsed_ms(start) >= 5);
+  CHECK(posix_fs.file_size(td->get_temp_dir() + "/test_sim_file") == 1024);
+  CHECK(fs.file_size(test_file) == 1024);
+
+  std::vector<char> buffer(100);
+  start = std::chrono::steady_clock::now();
+  REQUIRE(fs.read_from_file(test_file, 100, buffer.data(), 100) == TILEDB_FS_OK);
+  CHECK(elapsed_ms(start) >= 5);
+  CHECK(memcmp(buffer.data(), data.data()+100, 100) == 0);
+
+  // 8 ranges with 4 in flight pay the latency twice
+  std::vector<char> buffers(8*100);
+  std::vector<StorageFSRead> reads;
+  for (auto i=0; i<8; i++) {
+    reads.push_back({test_file, i*100, buffers.data()+i*100, 100});
+  }
+  start = std::chrono::steady_clock::now();
+  REQUIRE(fs.read_from_file_v(reads) == TILEDB_FS_OK);
+  CHECK(elapsed_ms(start) >= 10);
+  CHECK(memcmp(buffers.data(), data.data(), 800) == 0);
+
+  auto stats = SimFS::stats();
+  CHECK(stats.metadata_requests == 1);
+  CHECK(stats.write_requests == 1);
+  CHECK(stats.read_requests == 9);
+  CHECK(stats.bytes_written == 1024);
+  CHECK(stats.bytes_read == 900);
+
+  SimFS::reset_stats();
+  CHECK(SimFS::stats().read_requests == 0);
+}
+
+TEST_CASE_METHOD(SimFSTestFixture, "Test SimFS as TileDB home", "[sim_fs]") {
+  TileDB_CTX* tiledb_ctx;
+  TileDB_Config tiledb_config;
+  memset(&tiledb_config, 0, sizeof(TileDB_Config));
+  tiledb_config.home_ = home.c_str();
+  REQUIRE(tiledb_ctx_init(&tiledb_ctx, &tiledb_config) == TILEDB_OK);
+  CHECK(tiledb_workspace_create(tiledb_ctx, (home + "/WORKSPACE").c_str()) == TILEDB_OK);
+  CHECK(tiledb_ctx_finalize(tiledb_ctx) == TILEDB_OK);
+
+  CHECK(posix_fs.is_dir(td->get_temp_dir() + "/WORKSPACE"));
+  CHECK(SimFS::stats().metadata_requests > 0);
+}
@@ -0,0 +1,229 @@
+/**
+ * @file   test_spill_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ *
+ * Tests for the SpillCacheFS class
+ */
+
+#include "catch.h"
+#include "storage_posixfs.h"
+#include "storage_spill_cache.h"
+#include "utils.h"
+
+#include <fcntl.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// PosixFS with added latency standing in for a cloud filesystem
+class SlowPosixFS : public PosixFS {
+ public:
+  std::atomic<size_t> reads{0};
+
+  int read_from_file(const std::string& filename, off_t offset, void *buffer, size_t length) {
+    reads++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return PosixFS::read_from_file(filename, offset, buffer, length);
+  }
+
+  int read_from_file_v(const std::vector<StorageFSRead>& reads) {
+    return StorageFS::read_from_file_v(reads);
+  }
+};
+
+class SpillCacheTestFixture {
+ protected:
+  PosixFS fs;
+
+  TempDir *td;
+  std::string test_file;
+  std::string cache_dir;
+
+  SpillCacheTestFixture() {
+    td = new TempDir();
+    test_file = td->get_temp_dir()+"/test_spill_cache_file";
+    cache_dir = td->get_temp_dir()+"/test_spill_cache_dir";
+    std::vector<char> data(1024);
+    for (auto i=0ul; i<data.size(); i++) {
+      data[i] = i%128;
+    }
+    REQUIRE(fs.write_to_file(test_file, data.data(), data.size()) == TILEDB_FS_OK);
+    REQUIRE(fs.close_file(test_file) == TILEDB_FS_OK);
+  }
+
+  ~SpillCacheTestFixture() {
+    delete td;
+  }
+
+  void check_range(char *buffer, off_t offset, size_t length) {
+    for (auto i=0ul; i<length; i++) {
+      CHECK(buffer[i] == (char)((offset+i)%128));
+    }
+  }
+};
+
+TEST_CASE_METHOD(SpillCacheTestFixture, "Test SpillCacheFS reads", "[spill_cache_read]") {
+  SlowPosixFS *slow_fs = new SlowPosixFS();
+  SpillCacheFS cache_fs(slow_fs, cache_dir);
+  CHECK(cache_fs.filesystem() == slow_fs);
+  CHECK(fs.is_dir(cache_dir));
+  CHECK(cache_fs.file_size(test_file) == 1024);
+
+  char buffer[1024];
+  CHECK_RC(cache_fs.read_from_file(test_file, 100, buffer, 200), TILEDB_FS_OK);
+  check_range(buffer, 100, 200);
+  CHECK(slow_fs->reads == 1);
+  CHECK(cache_fs.misses() == 1);
+  CHECK(cache_fs.size() == 200);
+
+  memset(buffer, 0, 1024);
+  CHECK_RC(cache_fs.read_from_file(test_file, 100, buffer, 200), TILEDB_FS_OK);
+  check_range(buffer, 100, 200);
+  CHECK(slow_fs->reads == 1);
+  CHECK(cache_fs.hits() == 1);
+
+  // Ranges are keyed by offset and length
+  CHECK_RC(cache_fs.read_from_file(test_file, 100, buffer, 100), TILEDB_FS_OK);
+  check_range(buffer, 100, 100);
+  CHECK(slow_fs->reads == 2);
+  CHECK(cache_fs.size() == 300);
+
+  // Vectored reads only forward the missing ranges
+  std::vector<char> buffer_v(600);
+  std::vector<StorageFSRead> reads = { { test_file, 100, buffer_v.data(), 200 },
+                                       { test_file, 500, buffer_v.data()+200, 400 } };
+  CHECK_RC(cache_fs.read_from_file_v(reads), TILEDB_FS_OK);
+  check_range(buffer_v.data(), 100, 200);
+  check_range(buffer_v.data()+200, 500, 400);
+  CHECK(slow_fs->reads == 3);
+  CHECK(cache_fs.size() == 700);
+
+  // Errors from the wrapped filesystem are returned and not cached
+  CHECK_RC(cache_fs.read_from_file(test_file, 1000, buffer, 100), TILEDB_FS_ERR);
+  CHECK_RC(cache_fs.read_from_file(test_file+".non-existent", 0, buffer, 100), TILEDB_FS_ERR);
+  CHECK(cache_fs.size() == 700);
+}
+
+TEST_CASE_METHOD(SpillCacheTestFixture, "Test SpillCacheFS reuse across instances", "[spill_cache_reuse]") {
+  char buffer[1024];
+  {
+    SpillCacheFS cache_fs(new SlowPosixFS(), cache_dir);
+    CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 512), TILEDB_FS_OK);
+  }
+
+  SlowPosixFS *slow_fs = new SlowPosixFS();
+  {
+    SpillCacheFS cache_fs(slow_fs, cache_dir);
+    CHECK(cache_fs.size() == 512);
+    memset(buffer, 0, 1024);
+    CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 512), TILEDB_FS_OK);
+    check_range(buffer, 0, 512);
+    CHECK(slow_fs->reads == 0);
+  }
+
+  // Changing the file invalidates the cached ranges
+  std::vector<char> more(16, 'x');
+  CHECK_RC(fs.write_to_file(test_file, more.data(), more.size()), TILEDB_FS_OK);
+  CHECK_RC(fs.close_file(test_file), TILEDB_FS_OK);
+  slow_fs = new SlowPosixFS();
+  {
+    SpillCacheFS cache_fs(slow_fs, cache_dir);
+    CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 512), TILEDB_FS_OK);
+    check_range(buffer, 0, 512);
+    CHECK(slow_fs->reads == 1);
+    CHECK(cache_fs.size() == 512);
+
+    // So do writes through the cache
+    CHECK_RC(cache_fs.write_to_file(test_file, more.data(), more.size()), TILEDB_FS_OK);
+    CHECK_RC(cache_fs.close_file(test_file), TILEDB_FS_OK);
+    CHECK(cache_fs.size() == 0);
+    CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 512), TILEDB_FS_OK);
+    CHECK(slow_fs->reads == 2);
+
+    // And rewrites by others once the file is reopened
+    CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 16), TILEDB_FS_OK);
+    CHECK(slow_fs->reads == 3);
+    CHECK_RC(cache_fs.close_file(test_file), TILEDB_FS_OK);
+    std::vector<char> other(100, 'y');
+    CHECK_RC(fs.delete_file(test_file), TILEDB_FS_OK);
+    CHECK_RC(fs.write_to_file(test_file, other.data(), other.size()), TILEDB_FS_OK);
+    CHECK_RC(fs.close_file(test_file), TILEDB_FS_OK);
+    CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 16), TILEDB_FS_OK);
+    CHECK(slow_fs->reads == 4);
+    CHECK(buffer[0] == 'y');
+    CHECK(buffer[15] == 'y');
+
+    CHECK_RC(cache_fs.delete_file(test_file), TILEDB_FS_OK);
+    CHECK(cache_fs.size() == 0);
+    CHECK(fs.get_files(cache_dir).size() == 0);
+  }
+}
+
+TEST_CASE_METHOD(SpillCacheTestFixture, "Test SpillCacheFS eviction", "[spill_cache_evict]") {
+  SlowPosixFS *slow_fs = new SlowPosixFS();
+  SpillCacheFS cache_fs(slow_fs, cache_dir, 300);
+
+  char buffer[1024];
+  CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 100), TILEDB_FS_OK);
+  CHECK_RC(cache_fs.read_from_file(test_file, 100, buffer, 100), TILEDB_FS_OK);
+  CHECK_RC(cache_fs.read_from_file(test_file, 200, buffer, 100), TILEDB_FS_OK);
+  CHECK(cache_fs.size() == 300);
+  CHECK(slow_fs->reads == 3);
+
+  // Touch the first range, so the second one is evicted next
+  CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 100), TILEDB_FS_OK);
+  CHECK_RC(cache_fs.read_from_file(test_file, 300, buffer, 100), TILEDB_FS_OK);
+  CHECK(cache_fs.size() == 300);
+  CHECK(slow_fs->reads == 4);
+  CHECK(fs.get_files(cache_dir).size() == 3);
+
+  CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 100), TILEDB_FS_OK);
+  check_range(buffer, 0, 100);
+  CHECK(slow_fs->reads == 4);
+  CHECK_RC(cache_fs.read_from_file(test_file, 100, buffer, 100), TILEDB_FS_OK);
+  check_range(buffer, 100, 100);
+  CHECK(slow_fs->reads == 5);
+
+  // Ranges larger than the budget are not cached
+  CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 1024), TILEDB_FS_OK);
+  CHECK(cache_fs.size() <= 300);
+  CHECK_RC(cache_fs.read_from_file(test_file, 0, buffer, 1024), TILEDB_FS_OK);
+  CHECK(slow_fs->reads == 7);
+
+  // Corrupt entries are dropped on load
+  for (auto& file : fs.get_files(cache_dir)) {
+    CHECK_RC(fs.write_to_file(file, "x", 1), TILEDB_FS_OK);
+    CHECK_RC(fs.close_file(file), TILEDB_FS_OK);
+  }
+  SpillCacheFS reloaded_fs(new SlowPosixFS(), cache_dir, 300);
+  CHECK(reloaded_fs.size() == 0);
+  CHECK(fs.get_files(cache_dir).size() == 0);
+}
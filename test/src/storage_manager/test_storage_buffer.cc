@@ -0,0 +1,261 @@
+/**
+ * @file   test_storage_buffer.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ *
+ * Tests for the StorageBuffer class
+ */
+
+#include "catch.h"
+#include "storage_buffer.h"
+#include "storage_posixfs.h"
+#include "utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+// PosixFS counting the block downloads from StorageBuffer, with slow uploads
+class CountingPosixFS : public PosixFS {
+ public:
+  size_t reads = 0;
+  size_t read_calls = 0;
+  std::atomic<size_t> writes{0};
+  int write_delay_ms = 0;
+
+  int read_from_file_v(const std::vector<StorageFSRead>& reads) {
+    this->reads += reads.size();
+    read_calls++;
+    return PosixFS::read_from_file_v(reads);
+  }
+
+  int write_to_file(const std::string& filename, const void *buffer, size_t buffer_size) {
+    writes++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(write_delay_ms));
+    return PosixFS::write_to_file(filename, buffer, buffer_size);
+  }
+};
+
+// Sets the env of the fixture before its filesystem reads it on construction
+class StorageBufferTestEnv {
+ protected:
+  StorageBufferTestEnv() {
+    REQUIRE(setenv("TILEDB_DOWNLOAD_BUFFER_SIZE", "100", 1) == 0);
+    REQUIRE(setenv("TILEDB_DOWNLOAD_CACHE_SIZE", "300", 1) == 0);
+  }
+};
+
+class StorageBufferTestFixture : protected StorageBufferTestEnv {
+ protected:
+  CountingPosixFS fs;
+
+  TempDir *td;
+  std::string test_file;
+
+  StorageBufferTestFixture() {
+    td = new TempDir();
+    test_file = td->get_temp_dir()+"/test_storage_buffer_file";
+    std::vector<char> data(1024);
+    for (auto i=0ul; i<data.size(); i++) {
+      data[i] = i%128;
+    }
+    REQUIRE(fs.write_to_file(test_file, data.data(), data.size()) == TILEDB_FS_OK);
+    REQUIRE(fs.close_file(test_file) == TILEDB_FS_OK);
+  }
+
+  ~StorageBufferTestFixture() {
+    unsetenv("TILEDB_DOWNLOAD_BUFFER_SIZE");
+    unsetenv("TILEDB_DOWNLOAD_CACHE_SIZE");
+    unsetenv("TILEDB_UPLOAD_BUFFER_SIZE");
+    unsetenv("TILEDB_UPLOAD_QUEUE_DEPTH");
+    delete td;
+  }
+
+  void check_range(std::vector<char>& buffer, off_t offset, size_t length) {
+    for (auto i=0ul; i<length; i++) {
+      CHECK(buffer[i] == (char)((offset+i)%128));
+    }
+  }
+};
+
+TEST_CASE_METHOD(StorageBufferTestFixture, "Test StorageBuffer block cache", "[storage_buffer_read]") {
+  StorageBuffer buffer(&fs, test_file, true);
+  std::vector<char> bytes(1024);
+
+  CHECK_RC(buffer.read_buffer(0, bytes.data(), 50), TILEDB_BF_OK);
+  check_range(bytes, 0, 50);
+  CHECK(fs.reads == 1);
+  CHECK(buffer.cached_blocks() == 1);
+
+  // Missing blocks spanned by a read are downloaded together
+  CHECK_RC(buffer.read_buffer(150, bytes.data(), 100), TILEDB_BF_OK);
+  check_range(bytes, 150, 100);
+  CHECK(fs.reads == 3);
+  CHECK(fs.read_calls == 2);
+  CHECK(buffer.cached_blocks() == 3);
+
+  // Alternating between cached blocks does not download again
+  CHECK_RC(buffer.read_buffer(10, bytes.data(), 20), TILEDB_BF_OK);
+  check_range(bytes, 10, 20);
+  CHECK_RC(buffer.read_buffer(260, bytes.data(), 30), TILEDB_BF_OK);
+  check_range(bytes, 260, 30);
+  CHECK_RC(buffer.read_buffer(90, bytes.data(), 20), TILEDB_BF_OK);
+  check_range(bytes, 90, 20);
+  CHECK(fs.reads == 3);
+
+  // Least recently used block 2 is evicted for the last, partial block
+  CHECK_RC(buffer.read_buffer(1000, bytes.data(), 24), TILEDB_BF_OK);
+  check_range(bytes, 1000, 24);
+  CHECK(fs.reads == 4);
+  CHECK(buffer.cached_blocks() == 3);
+  CHECK_RC(buffer.read_buffer(0, bytes.data(), 200), TILEDB_BF_OK);
+  check_range(bytes, 0, 200);
+  CHECK(fs.reads == 4);
+  CHECK_RC(buffer.read_buffer(250, bytes.data(), 10), TILEDB_BF_OK);
+  check_range(bytes, 250, 10);
+  CHECK(fs.reads == 5);
+
+  // Reads spanning more blocks than the cap
+  CHECK_RC(buffer.read_buffer(0, bytes.data(), 1024), TILEDB_BF_OK);
+  check_range(bytes, 0, 1024);
+  CHECK(buffer.cached_blocks() == 3);
+
+  CHECK_RC(buffer.read_buffer(1000, bytes.data(), 25), TILEDB_BF_ERR);
+  CHECK_RC(buffer.finalize(), TILEDB_BF_OK);
+
+  // Invalid cache sizes keep the default
+  REQUIRE(setenv("TILEDB_DOWNLOAD_CACHE_SIZE", "300M", 1) == 0);
+  CHECK(fs.get_download_cache_size() == 300);
+  PosixFS default_fs;
+  CHECK(default_fs.get_download_cache_size() == 64*1024*1024);
+}
+
+TEST_CASE_METHOD(StorageBufferTestFixture, "Test StorageBuffer batched reads", "[storage_buffer_read_v]") {
+  std::string other_file = td->get_temp_dir()+"/test_storage_buffer_other_file";
+  std::vector<char> data(1024);
+  for (auto i=0ul; i<data.size(); i++) {
+    data[i] = i%128;
+  }
+  REQUIRE(fs.write_to_file(other_file, data.data(), data.size()) == TILEDB_FS_OK);
+  REQUIRE(fs.close_file(other_file) == TILEDB_FS_OK);
+
+  StorageBuffer buffer(&fs, test_file, true);
+  StorageBuffer other_buffer(&fs, other_file, true);
+  std::vector<char> bytes(100), other_bytes(150);
+  CHECK_RC(buffer.read_buffer(0, bytes.data(), 50), TILEDB_BF_OK);
+  CHECK(fs.reads == 1);
+
+  // Only the blocks missing from both buffers are downloaded, with one call
+  CHECK_RC(StorageBuffer::read_buffers_v({&buffer, &other_buffer},
+                                         {{test_file, 50, bytes.data(), 100}, {other_file, 300, other_bytes.data(), 150}}),
+           TILEDB_BF_OK);
+  check_range(bytes, 50, 100);
+  check_range(other_bytes, 300, 150);
+  CHECK(fs.reads == 4);
+  CHECK(fs.read_calls == 2);
+  CHECK(buffer.cached_blocks() == 2);
+  CHECK(other_buffer.cached_blocks() == 2);
+
+  // Cached blocks are not downloaded again
+  CHECK_RC(StorageBuffer::read_buffers_v({&buffer, &other_buffer},
+                                         {{test_file, 0, bytes.data(), 100}, {other_file, 310, other_bytes.data(), 90}}),
+           TILEDB_BF_OK);
+  check_range(bytes, 0, 100);
+  check_range(other_bytes, 310, 90);
+  CHECK(fs.read_calls == 2);
+
+  // A failing read fails the batch and caches nothing
+  CHECK_RC(StorageBuffer::read_buffers_v({&buffer, &other_buffer},
+                                         {{test_file, 500, bytes.data(), 100}, {other_file, 1000, other_bytes.data(), 100}}),
+           TILEDB_BF_ERR);
+  CHECK(fs.read_calls == 2);
+  CHECK(buffer.cached_blocks() == 2);
+  CHECK(other_buffer.cached_blocks() == 2);
+}
+
+TEST_CASE_METHOD(StorageBufferTestFixture, "Test StorageBuffer with known file size", "[storage_buffer_file_size]") {
+  StorageBuffer buffer(&fs, test_file, true, 512);
+  std::vector<char> bytes(1024);
+  CHECK_RC(buffer.read_buffer(400, bytes.data(), 112), TILEDB_BF_OK);
+  check_range(bytes, 400, 112);
+  CHECK_RC(buffer.read_buffer(500, bytes.data(), 100), TILEDB_BF_ERR);
+
+  StorageBuffer non_existent_buffer(&fs, test_file+".non-existent", true);
+  CHECK_RC(non_existent_buffer.read_buffer(0, bytes.data(), 10), TILEDB_BF_ERR);
+}
+
+TEST_CASE_METHOD(StorageBufferTestFixture, "Test StorageBuffer write-behind uploads", "[storage_buffer_write]") {
+  REQUIRE(setenv("TILEDB_UPLOAD_BUFFER_SIZE", "100", 1) == 0);
+
+  std::vector<char> data(1000);
+  for (auto i=0ul; i<data.size(); i++) {
+    data[i] = i%128;
+  }
+
+  std::chrono::duration<double> elapsed[2];
+  for (auto depth : { 0, 2 }) {
+    REQUIRE(setenv("TILEDB_UPLOAD_QUEUE_DEPTH", std::to_string(depth).c_str(), 1) == 0);
+    CountingPosixFS upload_fs;
+    upload_fs.write_delay_ms = 20;
+    std::string filename = test_file + "_write_" + std::to_string(depth);
+    auto start = std::chrono::steady_clock::now();
+    StorageBuffer buffer(&upload_fs, filename);
+    for (auto i=0; i<10; i++) {
+      // Stand-in for compressing the next segment
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      CHECK_RC(buffer.append_buffer(data.data()+i*100, 100), TILEDB_BF_OK);
+    }
+    CHECK_RC(buffer.finalize(), TILEDB_BF_OK);
+    elapsed[depth?1:0] = std::chrono::steady_clock::now() - start;
+    CHECK(upload_fs.writes == 10);
+
+    // Uploads are appended in order
+    CHECK(upload_fs.file_size(filename) == 1000);
+    std::vector<char> read_data(1000);
+    CHECK_RC(upload_fs.read_from_file(filename, 0, read_data.data(), 1000), TILEDB_FS_OK);
+    CHECK(read_data == data);
+  }
+
+  // Compression and uploads overlap
+  CHECK(elapsed[1].count() < elapsed[0].count());
+
+  // Upload errors are reported by finalize
+  CountingPosixFS upload_fs;
+  StorageBuffer buffer(&upload_fs, td->get_temp_dir()+"/non-existent-dir/file");
+  for (auto i=0; i<5; i++) {
+    buffer.append_buffer(data.data()+i*100, 100);
+  }
+  CHECK_RC(buffer.finalize(), TILEDB_BF_ERR);
+
+  // Invalid queue depths keep synchronous uploads
+  REQUIRE(setenv("TILEDB_UPLOAD_QUEUE_DEPTH", "two", 1) == 0);
+  PosixFS default_fs;
+  CHECK(default_fs.get_upload_queue_depth() == 0);
+}
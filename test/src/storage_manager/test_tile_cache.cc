@@ -0,0 +1,93 @@
+/**
+ * @file   test_tile_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ *
+ * Tests for the TileCache class
+ */
+
+#include "catch.h"
+#include "tile_cache.h"
+
+#include <string>
+#include <vector>
+
+TEST_CASE("Test TileCache", "[tile_cache]") {
+  TileCache cache(100);
+  CHECK(cache.capacity() == 100);
+  CHECK(cache.size() == 0);
+
+  std::string key_0 = TileCache::key("__frag_0", 0, 0, false);
+  CHECK(key_0 != TileCache::key("__frag_0", 0, 0, true));
+  CHECK(key_0 != TileCache::key("__frag_0", 1, 0, false));
+  CHECK(key_0 != TileCache::key("__frag_1", 0, 0, false));
+
+  std::vector<char> tile(40, 'a');
+  std::vector<char> buffer(40);
+  CHECK(!cache.get(key_0, buffer.data(), 40));
+  CHECK(cache.misses() == 1);
+
+  cache.put(key_0, tile.data(), 40);
+  CHECK(cache.size() == 40);
+  CHECK(cache.get(key_0, buffer.data(), 40));
+  CHECK(cache.hits() == 1);
+  CHECK(buffer == tile);
+
+  // A different size is a miss
+  CHECK(!cache.get(key_0, buffer.data(), 20));
+  CHECK(cache.misses() == 2);
+
+  // Tiles larger than capacity are not cached
+  std::vector<char> large_tile(101, 'x');
+  cache.put("large", large_tile.data(), 101);
+  CHECK(cache.size() == 40);
+  CHECK(!cache.get("large", large_tile.data(), 101));
+
+  // Least recently used tiles are evicted first
+  std::string key_1 = TileCache::key("__frag_0", 0, 1, false);
+  std::string key_2 = TileCache::key("__frag_0", 0, 2, false);
+  std::vector<char> tile_1(40, 'b');
+  cache.put(key_1, tile_1.data(), 40);
+  CHECK(cache.size() == 80);
+  CHECK(cache.get(key_0, buffer.data(), 40));
+  cache.put(key_2, tile_1.data(), 40);
+  CHECK(cache.size() == 80);
+  CHECK(cache.get(key_0, buffer.data(), 40));
+  CHECK(buffer == tile);
+  CHECK(!cache.get(key_1, buffer.data(), 40));
+  CHECK(cache.get(key_2, buffer.data(), 40));
+  CHECK(buffer == tile_1);
+
+  // Replacing a tile updates the cached size
+  cache.put(key_2, tile.data(), 20);
+  CHECK(cache.size() == 60);
+  CHECK(cache.get(key_2, buffer.data(), 20));
+
+  cache.clear();
+  CHECK(cache.size() == 0);
+  CHECK(!cache.get(key_0, buffer.data(), 40));
+}
@@ -0,0 +1,117 @@
+/**
+ * @file   test_write_session.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2021 Omics Data Automation, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the WriteSession class
+ */
+
+#include "catch.h"
+#include "storage_posixfs.h"
+#include "storage_write_session.h"
+#include "utils.h"
+
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+static blkcnt_t allocated_blocks(const std::string& filename) {
+  struct stat st;
+  memset(&st, 0, sizeof(struct stat));
+  stat(filename.c_str(), &st);
+  return st.st_blocks;
+}
+
+TEST_CASE("Test WriteSession", "[write_session]") {
+  TempDir td;
+  PosixFS fs;
+  std::string foo = td.get_temp_dir() + "/foo";
+  std::string bar = td.get_temp_dir() + "/bar";
+
+  std::vector<char> data(3*1048576);
+  for (auto i=0ul; i<data.size(); i++) {
+    data[i] = i%127;
+  }
+
+  WriteSession session;
+  CHECK(!session.is_open(foo));
+  CHECK(session.sync(foo) == TILEDB_FS_OK);
+  CHECK(session.write(foo, data.data(), 0) == TILEDB_FS_OK);
+  CHECK(!session.is_open(foo));
+
+  // Files only show the data written while blocks are preallocated ahead
+  session.set_size_hint(foo, 2*1048576);
+  CHECK(session.write(foo, data.data(), 100) == TILEDB_FS_OK);
+  CHECK(session.is_open(foo));
+  CHECK(fs.file_size(foo) == 100);
+  CHECK(session.write(foo, data.data()+100, 1048576) == TILEDB_FS_OK);
+  CHECK(session.write(foo, data.data()+100+1048576, data.size()-100-1048576) == TILEDB_FS_OK);
+  CHECK(fs.file_size(foo) == (ssize_t)data.size());
+  CHECK(session.write(bar, "hello", 5) == TILEDB_FS_OK);
+  CHECK(session.sync(foo) == TILEDB_FS_OK);
+  CHECK(fs.file_size(bar) == 5);
+  size_t preallocations = session.preallocations();
+  CHECK(preallocations <= 3);
+
+  // Preallocated blocks past the data are released on close
+  CHECK(session.close() == TILEDB_FS_OK);
+  CHECK(!session.is_open(foo));
+  CHECK(fs.file_size(foo) == (ssize_t)data.size());
+  if (preallocations) {
+    CHECK(allocated_blocks(bar) < 1048576/512);
+  }
+  std::vector<char> buffer(data.size());
+  CHECK(fs.read_from_file(foo, 0, buffer.data(), buffer.size()) == TILEDB_FS_OK);
+  CHECK(memcmp(buffer.data(), data.data(), data.size()) == 0);
+
+  // Appends to existing files
+  CHECK(session.write(bar, " world", 6) == TILEDB_FS_OK);
+  CHECK(session.close() == TILEDB_FS_OK);
+  CHECK(fs.read_from_file(bar, 0, buffer.data(), 11) == TILEDB_FS_OK);
+  CHECK(strncmp(buffer.data(), "hello world", 11) == 0);
+
+  CHECK(session.write(td.get_temp_dir() + "/non-existent-dir/foo", "hello", 5) == TILEDB_FS_ERR);
+}
+
+TEST_CASE("Test PosixFS write sessions", "[write_sessions]") {
+  unsetenv("TILEDB_DISABLE_WRITE_SESSIONS");
+  PosixFS fs;
+  CHECK(fs.write_sessions());
+  fs.set_keep_write_file_handles_open(true);
+  CHECK(!fs.write_sessions());
+  fs.set_keep_write_file_handles_open(false);
+  fs.set_disable_file_locking(true);
+  CHECK(!fs.write_sessions());
+  fs.set_disable_file_locking(false);
+  fs.set_direct_io(true);
+  CHECK(!fs.write_sessions());
+  fs.set_direct_io(false);
+  CHECK(setenv("TILEDB_DISABLE_WRITE_SESSIONS", "1", 1) == 0);
+  CHECK(!fs.write_sessions());
+  unsetenv("TILEDB_DISABLE_WRITE_SESSIONS");
+}